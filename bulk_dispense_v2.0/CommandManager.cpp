@@ -1,4 +1,7 @@
 #include "CommandManager.h"
+#include "DispensePredictor.h"
+#include "DrainScheduler.h"
+#include "Logging.h"
 
 extern unsigned long networkCommandStartTime;
 
@@ -8,6 +11,7 @@ extern unsigned long serialCommandStartTime;
 static StreamSession serialSession = {false, 0, &Serial};
 static StreamSession networkSession = {false, 0, nullptr};
 static int pendingCommands = 0;
+static bool detachedExecution = false;
 
 volatile bool commandLineBeingProcessed = false;
 
@@ -114,6 +118,9 @@ void cm_registerCommand(void)
 
 void cm_commandCompleted(Stream *stream)
 {
+    if (detachedExecution)
+        return;
+
     StreamSession *session = getSessionForStream(stream);
     bool wasActive = session ? session->active : false;
 
@@ -121,9 +128,12 @@ void cm_commandCompleted(Stream *stream)
     {
         pendingCommands--;
 
-        // Keep this user-facing message
-        sendMessage(F("[DEBUG] Command completed. Pending: "), stream, currentClient, false);
-        sendMessage(String(pendingCommands).c_str(), stream, currentClient);
+        // Pending count is debug output
+        if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+        {
+            sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Command completed. Pending: "), false);
+            sendLogMessage(LOG_LEVEL_DEBUG, String(pendingCommands).c_str());
+        }
     }
 
     // End session if needed
@@ -133,6 +143,11 @@ void cm_commandCompleted(Stream *stream)
     }
 }
 
+void cm_setDetachedExecution(bool detached)
+{
+    detachedExecution = detached;
+}
+
 bool cm_isSessionActive(void)
 {
     return serialSession.active || networkSession.active;
@@ -212,3 +227,225 @@ void resetCommandTimers()
     networkCommandStartTime = 0;
     serialCommandStartTime = 0;
 }
+
+// ============================================================
+// Request ID Tracking
+// ============================================================
+
+static TrackedRequest trackedRequests[CM_MAX_TRACKED_REQUESTS];
+
+// Request whose command is being executed right now
+static struct
+{
+    bool active;
+    uint16_t id;
+    char type; // 0 for commands without an async operation
+    uint8_t trough;
+    bool operationWasActive;
+    Stream *stream;
+    unsigned long startTime;
+} dispatchingRequest = {false, 0, 0, 0, false, nullptr, 0};
+
+static char getRequestType(const char *command)
+{
+    if (strncmp(command, "DT ", 3) == 0)
+        return 'T';
+    if (strncmp(command, "D ", 2) == 0)
+        return 'D';
+    if (strncmp(command, "P ", 2) == 0)
+        return 'P';
+    if (strncmp(command, "F ", 2) == 0)
+        return 'F';
+    return 0;
+}
+
+static bool isRequestOperationActive(char type, int trough)
+{
+    const ValveControl &vc = valveControls[trough - 1];
+    switch (type)
+    {
+    case 'D':
+        return vc.isDispensing;
+    case 'P':
+        return vc.isPriming;
+    case 'F':
+        return vc.fillMode;
+    case 'T':
+        return vc.isDraining || isDrainQueued(trough); // A queued drain is still this request's
+    default:
+        return false;
+    }
+}
+
+static bool isRequestStreamAvailable(Stream *stream)
+{
+    return stream == &Serial || (stream == &currentClient && hasActiveClient && currentClient.connected());
+}
+
+static void printRequestTag(Stream *stream, uint16_t id)
+{
+    stream->print(F("[REQ #"));
+    stream->print(id);
+    stream->print(F("] "));
+}
+
+// Strips a leading "#<id>" from command; false if the prefix is malformed
+bool cm_parseRequestId(char *&command, uint16_t &id)
+{
+    char *end;
+    unsigned long value = strtoul(command + 1, &end, 10);
+    if (end == command + 1 || value > 0xFFFF || (*end != ' ' && *end != '\0'))
+    {
+        return false;
+    }
+    id = (uint16_t)value;
+    command = trimLeadingSpaces(end);
+    return *command != '\0';
+}
+
+void cm_beginRequest(uint16_t id, const char *command, Stream *stream)
+{
+    dispatchingRequest.active = true;
+    dispatchingRequest.id = id;
+    dispatchingRequest.stream = stream;
+    dispatchingRequest.startTime = millis();
+    dispatchingRequest.type = getRequestType(command);
+    dispatchingRequest.trough = 0;
+    dispatchingRequest.operationWasActive = false;
+
+    int trough = 0;
+    if (dispatchingRequest.type && sscanf(command, "%*s %d", &trough) == 1 &&
+        trough >= 1 && trough <= NUM_OVERFLOW_SENSORS)
+    {
+        dispatchingRequest.trough = trough;
+        dispatchingRequest.operationWasActive = isRequestOperationActive(dispatchingRequest.type, trough);
+    }
+    else
+    {
+        dispatchingRequest.type = 0; // Invalid trough: the handler reports the error
+    }
+
+    printRequestTag(stream, id);
+    stream->print(F("START "));
+    stream->println(command);
+}
+
+void cm_endRequestDispatch()
+{
+    if (!dispatchingRequest.active)
+        return;
+    dispatchingRequest.active = false;
+
+    Stream *stream = dispatchingRequest.stream;
+    uint16_t id = dispatchingRequest.id;
+    if (!isRequestStreamAvailable(stream))
+        return;
+
+    printRequestTag(stream, id);
+
+    // Commands without an async operation are finished once executed
+    if (!dispatchingRequest.type)
+    {
+        stream->print(F("DONE Duration: "));
+        stream->print(millis() - dispatchingRequest.startTime);
+        stream->println(F(" ms"));
+        return;
+    }
+
+    // The operation must have been started by this command
+    if (dispatchingRequest.operationWasActive ||
+        !isRequestOperationActive(dispatchingRequest.type, dispatchingRequest.trough))
+    {
+        stream->println(F("ERROR Operation not started"));
+        return;
+    }
+
+    for (int i = 0; i < CM_MAX_TRACKED_REQUESTS; i++)
+    {
+        TrackedRequest &request = trackedRequests[i];
+        if (!request.active)
+        {
+            request.active = true;
+            request.id = id;
+            request.type = dispatchingRequest.type;
+            request.trough = dispatchingRequest.trough;
+            request.stream = stream;
+            request.startTime = dispatchingRequest.startTime;
+            request.lastProgressTime = millis();
+            request.dispensesAtStart = dispenseErrorStats[request.trough - 1].count;
+            stream->println(F("ACCEPTED"));
+            return;
+        }
+    }
+    stream->println(F("ACCEPTED (untracked, request table full)"));
+}
+
+static void reportRequestProgress(TrackedRequest &request)
+{
+    FlowSensor *sensor = flowSensors[request.trough - 1];
+    if ((request.type != 'D' && request.type != 'F') || !sensor)
+        return;
+
+    printRequestTag(request.stream, request.id);
+    request.stream->print(F("PROGRESS "));
+    request.stream->print(sensor->dispenseVolume, 1);
+    if (request.type == 'D')
+    {
+        request.stream->print(F("/"));
+        request.stream->print(valveControls[request.trough - 1].targetVolume, 1);
+    }
+    request.stream->println(F(" mL"));
+}
+
+static void reportRequestFinished(const TrackedRequest &request)
+{
+    printRequestTag(request.stream, request.id);
+
+    // A volume dispense that reached its target has its error recorded
+    bool volumeDispense = (request.type == 'D' && valveControls[request.trough - 1].targetVolume > 0);
+    if (volumeDispense && dispenseErrorStats[request.trough - 1].count == request.dispensesAtStart)
+    {
+        request.stream->print(F("ERROR Dispense stopped before target"));
+    }
+    else
+    {
+        request.stream->print(F("DONE"));
+        if (volumeDispense)
+        {
+            request.stream->print(F(" Error: "));
+            request.stream->print(dispenseErrorStats[request.trough - 1].lastError, 2);
+            request.stream->print(F(" mL"));
+        }
+    }
+    request.stream->print(F(" Duration: "));
+    request.stream->print(millis() - request.startTime);
+    request.stream->println(F(" ms"));
+}
+
+void cm_serviceRequests(unsigned long currentTime)
+{
+    for (int i = 0; i < CM_MAX_TRACKED_REQUESTS; i++)
+    {
+        TrackedRequest &request = trackedRequests[i];
+        if (!request.active)
+            continue;
+
+        // Requester went away: nobody to report to
+        if (!isRequestStreamAvailable(request.stream))
+        {
+            request.active = false;
+            continue;
+        }
+
+        if (!isRequestOperationActive(request.type, request.trough))
+        {
+            reportRequestFinished(request);
+            request.active = false;
+        }
+        else if (currentTime - request.lastProgressTime >= CM_REQUEST_PROGRESS_MS)
+        {
+            request.lastProgressTime = currentTime;
+            reportRequestProgress(request);
+        }
+    }
+}
@@ -6,6 +6,26 @@
 #include "NetworkConfig.h"
 #include "Utils.h"
 
+// Request IDs: a command prefixed with "#<id> " (e.g. "#12 D 1 50") gets
+// "[REQ #12] ..." status lines. Its output is bracketed by START and
+// ACCEPTED/ERROR/DONE, and async operations (D, P, F, DT) report
+// PROGRESS and a final DONE/ERROR when they finish.
+#define CM_MAX_TRACKED_REQUESTS 8
+#define CM_REQUEST_PROGRESS_MS 1000
+
+// An async operation started by a command with a request ID
+struct TrackedRequest
+{
+    bool active;
+    uint16_t id;
+    char type;      // 'D' dispense, 'P' prime, 'F' fill, 'T' drain
+    uint8_t trough; // 1-4
+    Stream *stream;
+    unsigned long startTime;
+    unsigned long lastProgressTime;
+    uint16_t dispensesAtStart; // Completed dispense count when started
+};
+
 // Structure to track session state per stream
 struct StreamSession
 {
@@ -24,6 +44,16 @@ bool cm_isSessionActive(void);
 int cm_getPendingCommands(void);
 void cm_abortSession(Stream *stream);
 
+// Commands run on the controller's own behalf (batch scheduler) are not part
+// of a host session: completions they signal while executing are ignored
+void cm_setDetachedExecution(bool detached);
+
+// Request ID tracking
+bool cm_parseRequestId(char *&command, uint16_t &id);
+void cm_beginRequest(uint16_t id, const char *command, Stream *stream);
+void cm_endRequestDispatch();
+void cm_serviceRequests(unsigned long currentTime);
+
 extern volatile bool commandLineBeingProcessed;
 void resetCommandTimers();
 
@@ -8,6 +8,13 @@
 #include "CommandManager.h"
 #include "SystemMonitor.h"
 #include "NetworkConfig.h"
+#include "DispensePredictor.h"
+#include "PressureRegulator.h"
+#include "OperationScheduler.h"
+#include "OperationRecorder.h"
+#include "I2CHealth.h"
+#include "HydraulicSim.h"
+#include "DrainScheduler.h"
 
 // ============================================================
 // Command Function Definitions
@@ -34,6 +41,46 @@ void cmd_set_log_frequency(char *args, CommandCaller *caller)
   }
 }
 
+void cmd_set_log_level(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  char sinkName = 0;
+  int level = -1;
+  int parsed = sscanf(localArgs, " %c %d", &sinkName, &level);
+
+  if (parsed <= 0)
+  {
+    caller->print(F("[INFO] Log level Serial: "));
+    caller->print(getLogLevelName(logSinkLevels[LOG_SINK_SERIAL]));
+    caller->print(F(", Network: "));
+    caller->print(getLogLevelName(logSinkLevels[LOG_SINK_NETWORK]));
+    caller->print(F(" (compiled up to "));
+    caller->print(getLogLevelName(LOG_COMPILE_LEVEL));
+    caller->println(F(")"));
+    return;
+  }
+
+  sinkName = toupper(sinkName);
+  if (parsed != 2 || (sinkName != 'S' && sinkName != 'N') || level < LOG_LEVEL_OFF || level > LOG_LEVEL_DEBUG)
+  {
+    caller->println(F("[ERROR] Invalid arguments. Use: LOGLVL <S/N> <0-4> (0=off, 1=error, 2=warning, 3=message, 4=debug)"));
+    return;
+  }
+
+  logSinkLevels[sinkName == 'S' ? LOG_SINK_SERIAL : LOG_SINK_NETWORK] = level;
+  caller->print(sinkName == 'S' ? F("[MESSAGE] Serial") : F("[MESSAGE] Network"));
+  caller->print(F(" log level set to "));
+  caller->println(getLogLevelName(level));
+
+  if (level > LOG_COMPILE_LEVEL)
+  {
+    caller->println(F("[WARNING] Levels above the compiled level are not built into this firmware."));
+  }
+}
+
 void cmd_fan(char *args, CommandCaller *caller)
 {
   char localArgs[COMMAND_SIZE];
@@ -231,6 +278,11 @@ void cmd_set_pressure_valve(char *args, CommandCaller *caller)
   int percentage = -1;
   if (sscanf(localArgs, "%d", &percentage) == 1 && percentage >= 0 && percentage <= 100)
   {
+    if (pressureRegulator.enabled)
+    {
+      stopPressureRegulation();
+      caller->println(F("[MESSAGE] Pressure regulation disabled for manual valve control."));
+    }
     proportionalValve = setValvePosition(proportionalValve, (float)percentage);
     caller->print(F("[MESSAGE] Pressure valve set to "));
     caller->print(percentage);
@@ -256,6 +308,11 @@ void cmd_calibrate_pressure_valve(char *args, CommandCaller *caller)
   localArgs[COMMAND_SIZE - 1] = '\0';
 
   caller->println(F("[MESSAGE] Calibrating pressure valve, please wait..."));
+  if (pressureRegulator.enabled)
+  {
+    stopPressureRegulation();
+    caller->println(F("[MESSAGE] Pressure regulation disabled for calibration."));
+  }
   calibrateProportionalValve();
   caller->println(F("[MESSAGE] Pressure valve calibration complete."));
 }
@@ -850,17 +907,6 @@ void cmd_drain_trough(char *args, CommandCaller *caller)
     return;
   }
 
-  if (hasIncompatibleDrainage(troughNumber, caller))
-  {
-    // Complete command on both streams if network client is active
-    cm_commandCompleted(serialStream);
-    if (useNetworkStream)
-    {
-      cm_commandCompleted(networkStream);
-    }
-    return;
-  }
-
   stopDispensingIfActive(troughNumber, caller);
   disableFillMode(troughNumber, caller);
 
@@ -873,39 +919,15 @@ void cmd_drain_trough(char *args, CommandCaller *caller)
     return;
   }
 
-  // Start the draining process.
-  valveControls[index].isDraining = true;
-  drainAsyncCompleted[index] = false;
-
-  switch (troughNumber)
+  // Start the drain, or queue it behind the other trough on the same waste bottle.
+  if (!requestDrain(troughNumber, caller))
   {
-  case 1:
-    wasteValve1 = openValve(wasteValve1);
-    wasteValve3 = openValve(wasteValve3);
-    caller->println(F("[MESSAGE] Draining trough 1... Waste valve 1 opened, waste valve 3 opened."));
-    break;
-  case 2:
-    wasteValve1 = openValve(wasteValve1);
-    wasteValve3 = closeValve(wasteValve3);
-    caller->println(F("[MESSAGE] Draining trough 2... Waste valve 1 opened, waste valve 3 closed."));
-    break;
-  case 3:
-    wasteValve2 = openValve(wasteValve2);
-    wasteValve4 = openValve(wasteValve4);
-    caller->println(F("[MESSAGE] Draining trough 3... Waste valve 2 opened, waste valve 4 opened."));
-    break;
-  case 4:
-    wasteValve2 = openValve(wasteValve2);
-    wasteValve4 = closeValve(wasteValve4);
-    caller->println(F("[MESSAGE] Draining trough 4... Waste valve 2 opened, waste valve 4 closed."));
-    break;
-  default:
-    caller->println(F("[ERROR] Drain command received invalid trough number. Use 1-4."));
-    // Reset draining state in case of error.
-    valveControls[index].isDraining = false;
-    return;
+    cm_commandCompleted(serialStream);
+    if (useNetworkStream)
+    {
+      cm_commandCompleted(networkStream);
+    }
   }
-  // The asynchronous monitorWasteSensors() function will handle drain completion or timeout.
 }
 
 void cmd_stop_drain_trough(char *args, CommandCaller *caller)
@@ -927,6 +949,16 @@ void cmd_stop_drain_trough(char *args, CommandCaller *caller)
   {
     for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
     {
+      // Queued drains never started; their commands are still pending.
+      if (cancelQueuedDrain(i + 1) && !drainAsyncCompleted[i])
+      {
+        cm_commandCompleted(serialStream);
+        if (useNetworkStream)
+        {
+          cm_commandCompleted(networkStream);
+        }
+        drainAsyncCompleted[i] = true;
+      }
       if (valveControls[i].isDraining)
       { // only if a drain is active
         valveControls[i].isDraining = false;
@@ -964,6 +996,24 @@ void cmd_stop_drain_trough(char *args, CommandCaller *caller)
     return;
   }
   int index = troughNumber - 1;
+
+  // A queued drain only leaves the queue; the valves belong to the running drain.
+  if (cancelQueuedDrain(troughNumber))
+  {
+    caller->print(F("[MESSAGE] Queued drain cancelled for trough "));
+    caller->println(troughNumber);
+    if (!drainAsyncCompleted[index])
+    {
+      cm_commandCompleted(serialStream);
+      if (useNetworkStream)
+      {
+        cm_commandCompleted(networkStream);
+      }
+      drainAsyncCompleted[index] = true;
+    }
+    return;
+  }
+
   // Stop the drain for this trough.
   valveControls[index].isDraining = false;
   valveControls[index].drainStartTime = 0; // clear recorded start time
@@ -1074,6 +1124,38 @@ void cmd_log_help(char *args, CommandCaller *caller)
   caller->println(F("--------------------------------------------------"));
 }
 
+void cmd_drain_queue(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  char *token = strtok(localArgs, " ");
+  if (token == NULL)
+  {
+    printDrainScheduler(caller);
+    return;
+  }
+
+  if (strcmp(token, "empty") == 0)
+  {
+    char *bottleStr = strtok(NULL, " ");
+    int bottle = bottleStr ? atoi(bottleStr) : 0;
+    if (bottle < 1 || bottle > NUM_WASTE_BOTTLE_SENSORS)
+    {
+      caller->println(F("[ERROR] Invalid bottle number. Use: WQ empty <1-2>"));
+      return;
+    }
+    emptyWasteBottle(bottle - 1);
+    caller->print(F("[MESSAGE] Waste bottle "));
+    caller->print(bottle);
+    caller->println(F(" marked empty."));
+    return;
+  }
+
+  caller->println(F("[ERROR] Invalid argument. Use: WQ (show) or WQ empty <1-2>"));
+}
+
 void cmd_standby(char *args, CommandCaller *caller)
 {
   char localArgs[COMMAND_SIZE];
@@ -1128,7 +1210,12 @@ void cmd_standby(char *args, CommandCaller *caller)
   wasteValve3 = closeValve(wasteValve3);
   wasteValve4 = closeValve(wasteValve4);
 
+  // Stop dispatching batch operations and drop queued drains.
+  abortOperationBatch();
+  clearDrainQueue();
+
   // Close the pressure valve by setting its position to 0%.
+  stopPressureRegulation();
   proportionalValve = setValvePosition(proportionalValve, 0.0);
 
   // Reset global vacuum monitoring flags.
@@ -1243,7 +1330,12 @@ void cmd_get_system_state(char *args, CommandCaller *caller)
     caller->print(buf);
     caller->print(F(", Offset: "));
     dtostrf(flowSensors[i]->offsetCorrection, 4, 2, buf);
-    caller->println(buf);
+    caller->print(buf);
+    caller->print(F(", CRC Errors: "));
+    caller->print(flowSensors[i]->crcErrorCount);
+    caller->print(F(" of "));
+    caller->print(flowSensors[i]->framesRead);
+    caller->println(F(" frames"));
   }
   caller->println();
 
@@ -1365,6 +1457,17 @@ void cmd_get_system_state(char *args, CommandCaller *caller)
   dtostrf(valvePercent, 4, 1, percentStr);
   caller->print(percentStr);
   caller->println(F("%"));
+  caller->print(F("  • Regulation       : "));
+  if (pressureRegulator.enabled)
+  {
+    caller->print(F("ON at "));
+    caller->print(pressureRegulator.setpointPsi, 1);
+    caller->println(pressureRegulator.settled ? F(" psi (settled)") : F(" psi (settling)"));
+  }
+  else
+  {
+    caller->println(F("OFF"));
+  }
   caller->println();
 
   // Pressure Sensor section
@@ -1776,6 +1879,353 @@ void cmd_show_flow_sensor_correction(char *args, CommandCaller *caller)
   caller->println(sensor->fluidType == WATER ? F("WATER") : F("IPA"));
 }
 
+void cmd_dispense_predictor(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  // Get both streams that might be in use
+  Stream *serialStream = &Serial;
+  Stream *networkStream = &currentClient;
+
+  // For completion notifications, check if the network client is active
+  bool useNetworkStream = hasActiveClient && currentClient.connected();
+
+  char *token = strtok(localArgs, " ");
+
+  if (token == NULL)
+  {
+    // No arguments: report every trough
+    caller->print(F("[INFO] Predictive close: "));
+    caller->println(dispenseModelStore.predictiveEnabled ? F("ENABLED") : F("DISABLED"));
+    for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+    {
+      printDispensePredictorStatus(i, caller);
+    }
+  }
+  else if (strcmp(token, "0") == 0 || strcmp(token, "1") == 0)
+  {
+    bool enable = (token[0] == '1');
+    setPredictiveCloseEnabled(enable);
+    caller->print(F("[MESSAGE] Predictive valve close "));
+    caller->println(enable ? F("enabled.") : F("disabled."));
+  }
+  else if (strcmp(token, "save") == 0)
+  {
+    saveDispenseModels();
+    caller->println(F("[MESSAGE] Dispense close models saved to EEPROM."));
+  }
+  else if (strcmp(token, "reset") == 0)
+  {
+    token = strtok(NULL, " ");
+    int troughNumber = (token != NULL) ? atoi(token) : -1;
+    if (troughNumber < 1 || troughNumber > NUM_OVERFLOW_SENSORS)
+    {
+      caller->println(F("[ERROR] Invalid trough number. Use: DPC reset <1-4>"));
+    }
+    else
+    {
+      resetDispenseModel(troughNumber - 1);
+      resetDispenseErrorStats(troughNumber - 1);
+      caller->print(F("[MESSAGE] Dispense close model and statistics reset for Trough "));
+      caller->println(troughNumber);
+    }
+  }
+  else
+  {
+    caller->println(F("[ERROR] Invalid argument. Use: DPC, DPC <0/1>, DPC save or DPC reset <1-4>"));
+  }
+
+  // DPC starts with "D" so it is dispatched as async; complete it here
+  cm_commandCompleted(serialStream);
+  if (useNetworkStream)
+  {
+    cm_commandCompleted(networkStream);
+  }
+}
+
+void cmd_pressure_regulator(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  // Get both streams that might be in use
+  Stream *serialStream = &Serial;
+  Stream *networkStream = &currentClient;
+
+  // For completion notifications, check if the network client is active
+  bool useNetworkStream = hasActiveClient && currentClient.connected();
+
+  char *token = strtok(localArgs, " ");
+
+  if (token == NULL)
+  {
+    printPressureRegulatorStatus(caller);
+  }
+  else if (strcmp(token, "off") == 0)
+  {
+    stopPressureRegulation();
+    caller->println(F("[MESSAGE] Pressure regulation disabled. Valve left at its last position."));
+  }
+  else if (strcmp(token, "tune") == 0)
+  {
+    char *kpToken = strtok(NULL, " ");
+    char *kiToken = strtok(NULL, " ");
+    char *kdToken = strtok(NULL, " ");
+    if (kpToken == NULL || kiToken == NULL || kdToken == NULL)
+    {
+      caller->println(F("[ERROR] Missing gains. Use: PR tune <kp> <ki> <kd>"));
+    }
+    else if (atof(kpToken) < 0 || atof(kiToken) < 0 || atof(kdToken) < 0)
+    {
+      caller->println(F("[ERROR] Gains must not be negative."));
+    }
+    else
+    {
+      setPressureRegulatorGains(atof(kpToken), atof(kiToken), atof(kdToken));
+      caller->println(F("[MESSAGE] Pressure regulator gains updated."));
+    }
+  }
+  else
+  {
+    float setpoint = atof(token);
+    if (setpoint <= 0 || setpoint > pressureSensor.maxPressure)
+    {
+      caller->print(F("[ERROR] Invalid setpoint. Use: PR <psi 1-"));
+      caller->print((int)pressureSensor.maxPressure);
+      caller->println(F(">, PR off or PR tune <kp> <ki> <kd>"));
+    }
+    else
+    {
+      startPressureRegulation(setpoint);
+      caller->print(F("[MESSAGE] Regulating pressure at "));
+      caller->print(setpoint, 1);
+      caller->print(F(" psi (feed-forward "));
+      caller->print(pressureRegulator.feedForward, 1);
+      caller->println(F("%)."));
+    }
+  }
+
+  // PR starts with "P" so it is dispatched as async; complete it here
+  cm_commandCompleted(serialStream);
+  if (useNetworkStream)
+  {
+    cm_commandCompleted(networkStream);
+  }
+}
+
+void cmd_schedule(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  char *token = strtok(localArgs, " ");
+
+  // No arguments: show the batch
+  if (token == NULL)
+  {
+    printOperationBatch(caller);
+    return;
+  }
+
+  if (strcmp(token, "run") == 0)
+  {
+    if (startOperationBatch(caller))
+    {
+      caller->print(F("[MESSAGE] Batch started with "));
+      caller->print(operationBatch.count);
+      caller->println(F(" operations."));
+    }
+    return;
+  }
+
+  if (strcmp(token, "clear") == 0)
+  {
+    clearOperationBatch();
+    caller->println(F("[MESSAGE] Batch cleared."));
+    return;
+  }
+
+  if (strcmp(token, "abort") == 0)
+  {
+    abortOperationBatch();
+    caller->println(F("[MESSAGE] Batch aborted. Running operations continue; use STOPD/SDT to stop them."));
+    return;
+  }
+
+  if (strcmp(token, "max") == 0)
+  {
+    token = strtok(NULL, " ");
+    int maxOps = (token != NULL) ? atoi(token) : 0;
+    if (maxOps < 1 || maxOps > NUM_OVERFLOW_SENSORS)
+    {
+      caller->println(F("[ERROR] Invalid limit. Use: SCHED max <1-4>"));
+      return;
+    }
+    operationBatch.maxPressureOps = maxOps;
+    caller->print(F("[MESSAGE] Concurrent pressurized operations limited to "));
+    caller->println(maxOps);
+    return;
+  }
+
+  // Otherwise: SCHED <D|P|F|DT> <trough> [volume]
+  ScheduledOpType type;
+  if (strcmp(token, "D") == 0)
+    type = SCHED_OP_DISPENSE;
+  else if (strcmp(token, "P") == 0)
+    type = SCHED_OP_PRIME;
+  else if (strcmp(token, "F") == 0)
+    type = SCHED_OP_FILL;
+  else if (strcmp(token, "DT") == 0)
+    type = SCHED_OP_DRAIN;
+  else
+  {
+    caller->println(F("[ERROR] Invalid argument. Use: SCHED <D|P|F|DT> <trough> [volume], SCHED run|clear|abort|max <n>"));
+    return;
+  }
+
+  token = strtok(NULL, " ");
+  int troughNumber = (token != NULL) ? atoi(token) : -1;
+  if (troughNumber < 1 || troughNumber > NUM_OVERFLOW_SENSORS)
+  {
+    caller->println(F("[ERROR] Invalid trough number. Must be 1-4."));
+    return;
+  }
+
+  float volume = 0.0;
+  if (type == SCHED_OP_DISPENSE)
+  {
+    // Batched dispenses need a volume so they finish on their own
+    const float MIN_VOLUME = 1.0;
+    const float MAX_VOLUME = 200.0;
+    token = strtok(NULL, " ");
+    volume = (token != NULL) ? atof(token) : 0.0;
+    if (volume < MIN_VOLUME || volume > MAX_VOLUME)
+    {
+      caller->println(F("[ERROR] Scheduled dispense needs a volume of 1-200 mL."));
+      return;
+    }
+  }
+
+  if (addScheduledOperation(type, troughNumber, volume, caller))
+  {
+    caller->print(F("[MESSAGE] Operation "));
+    caller->print(operationBatch.count);
+    caller->println(F(" added to batch."));
+  }
+}
+
+void cmd_monitor_stats(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  char *token = strtok(localArgs, " ");
+  if (token == NULL)
+  {
+    printMonitorStats(caller);
+    return;
+  }
+
+  if (strcmp(token, "reset") == 0)
+  {
+    resetMonitorStats();
+    caller->println(F("[MESSAGE] Monitor statistics reset."));
+    return;
+  }
+
+  caller->println(F("[ERROR] Invalid argument. Use: MON or MON reset"));
+}
+
+void cmd_operation_recorder(char *args, CommandCaller *caller)
+{
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  char *token = strtok(localArgs, " ");
+  if (token == NULL)
+  {
+    printOperationRecordings(caller);
+    return;
+  }
+
+  long id = atol(token);
+  if (id <= 0 || id > 0xFFFF)
+  {
+    caller->println(F("[ERROR] Invalid recording ID. Use: REC (list) or REC <id>"));
+    return;
+  }
+  if (!printOperationRecording((uint16_t)id, caller))
+  {
+    caller->print(F("[ERROR] No recording #"));
+    caller->print(id);
+    caller->println(F(" (only the most recent operations are kept)."));
+  }
+}
+
+void cmd_i2c_health(char *args, CommandCaller *caller)
+{
+  printI2CHealth(caller);
+}
+
+void cmd_hydraulic_sim(char *args, CommandCaller *caller)
+{
+#if HYDRAULIC_SIM
+  char localArgs[COMMAND_SIZE];
+  strncpy(localArgs, args, COMMAND_SIZE);
+  localArgs[COMMAND_SIZE - 1] = '\0';
+
+  char *token = strtok(localArgs, " ");
+  if (token == NULL)
+  {
+    printHydraulicSim(caller);
+    return;
+  }
+
+  if (strcmp(token, "run") == 0)
+  {
+    char *name = strtok(NULL, " ");
+    if (name == NULL)
+    {
+      printHydraulicSimScenarios(caller);
+      return;
+    }
+    startHydraulicSimScenario(name, caller);
+    return;
+  }
+
+  if (strcmp(token, "fault") == 0)
+  {
+    char *troughStr = strtok(NULL, " ");
+    char *type = strtok(NULL, " ");
+    int trough = troughStr ? atoi(troughStr) : 0;
+    if (type == NULL || trough < 1 || trough > NUM_OVERFLOW_SENSORS || !setHydraulicSimFault(trough, type))
+    {
+      caller->println(F("[ERROR] Use: SIM fault <1-4> <reagent|line|sensor|drain|vacuum|none>"));
+      return;
+    }
+    caller->println(F("[MESSAGE] Simulation fault updated."));
+    return;
+  }
+
+  if (strcmp(token, "reset") == 0)
+  {
+    resetHydraulicSim(false, 0.0);
+    caller->println(F("[MESSAGE] Simulation reset: troughs and bottles empty, lines unprimed, no faults."));
+    return;
+  }
+
+  caller->println(F("[ERROR] Invalid argument. Use: SIM, SIM run [scenario], SIM fault <1-4> <type>, SIM reset"));
+#else
+  caller->println(F("[ERROR] Simulation not available. Build with -DHYDRAULIC_SIM=1."));
+#endif
+}
+
 // ============================================================
 // Global Command Tree and Commander Object
 // ============================================================
@@ -1783,6 +2233,7 @@ Commander commander;
 
 Commander::systemCommand_t API_tree[] = {
     systemCommand("LF", "Set logging interval (ms). Usage: LF <ms>", cmd_set_log_frequency),
+    systemCommand("LOGLVL", "Show or set message level per sink. Usage: LOGLVL [<S/N> <0-4>] (S=Serial, N=Network; 0=off ... 4=debug)", cmd_set_log_level),
     systemCommand("FN", "Manually control fan state. Usage: FN <0/1> (0 = off, 1 = on)", cmd_fan),
     systemCommand("FNAUTO", "Re-enable automatic fan control", cmd_fan_auto),
     systemCommand("R", "Control reagent valve. Usage: R <trough 1-4> <0/1> (0 = close, 1 = open)", cmd_set_reagent_valve),
@@ -1801,6 +2252,7 @@ Commander::systemCommand_t API_tree[] = {
     systemCommand("F", "Fill reagent. Usage: F <trough 1-4> to fill the specified trough", cmd_fill_reagent),
     systemCommand("DT", "Drain trough. Usage: DT <trough 1-4> to initiate drainage", cmd_drain_trough),
     systemCommand("SDT", "Stop draining trough. Usage: SDT <trough 1-4> or SDT all", cmd_stop_drain_trough),
+    systemCommand("WQ", "Drain queue and waste bottle fill estimates. Usage: WQ (show), WQ empty <bottle 1-2>", cmd_drain_queue),
     systemCommand("LOGHELP", "Display detailed logging field definitions and diagnostic information", cmd_log_help),
     systemCommand("STANDBY", "Abort all automated operations and set the system to a safe idle (standby) state", cmd_standby),
     systemCommand("SS", "Display current system state summary", cmd_get_system_state),
@@ -1811,4 +2263,11 @@ Commander::systemCommand_t API_tree[] = {
     systemCommand("SETFS", "Set flow sensor fluid type. Usage: SETFS <sensor 1-4> <W/I> (W=Water, I=IPA)", cmd_set_flow_sensor_fluid),
     systemCommand("SETFSCOR", "Set flow sensor correction parameters: SETFSCOR <sensor 1-4> <slope> <offset>", cmd_set_flow_sensor_correction),
     systemCommand("ENFSCOR", "Enable/disable flow correction: ENFSCOR <sensor 1-4> <0/1>", cmd_enable_flow_sensor_correction),
-    systemCommand("SHOWFSCOR", "Show flow correction settings: SHOWFSCOR <sensor 1-4>", cmd_show_flow_sensor_correction)};
+    systemCommand("SHOWFSCOR", "Show flow correction settings: SHOWFSCOR <sensor 1-4>", cmd_show_flow_sensor_correction),
+    systemCommand("DPC", "Predictive dispense close. Usage: DPC (status), DPC <0/1>, DPC save, DPC reset <trough 1-4>", cmd_dispense_predictor),
+    systemCommand("PR", "Closed-loop pressure regulation. Usage: PR (status), PR <psi>, PR off, PR tune <kp> <ki> <kd>", cmd_pressure_regulator),
+    systemCommand("SCHED", "Batch scheduler. Usage: SCHED <D|P|F|DT> <trough 1-4> [volume], SCHED run, SCHED clear, SCHED abort, SCHED max <1-4>", cmd_schedule),
+    systemCommand("MON", "Monitor run counts and execution times. Usage: MON (show), MON reset", cmd_monitor_stats),
+    systemCommand("REC", "Operation curve recordings. Usage: REC (list), REC <id> (stream points as CSV)", cmd_operation_recorder),
+    systemCommand("I2C", "I2C device health and recovery counters. Usage: I2C", cmd_i2c_health),
+    systemCommand("SIM", "Hydraulic simulation (simulation build). Usage: SIM (state), SIM run [scenario], SIM fault <trough 1-4> <type|none>, SIM reset", cmd_hydraulic_sim)};
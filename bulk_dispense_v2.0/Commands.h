@@ -15,6 +15,7 @@
  *
  * Commands include:
  *   LF      - Set log frequency: LF <ms>
+ *   LOGLVL  - Message level per sink: LOGLVL [<S/N> <0-4>]
  *   FN      - Fan manual control: FN <0/1> (0 = off, 1 = on)
  *   FNAUTO  - Enable fan auto control
  *   R       - Reagent valve control: R <1-4> <0/1>
@@ -22,6 +23,7 @@
  *   W       - Waste valve control: W <1-4> <0/1>
  *   PV      - Set pressure valve: PV <percentage>
  *   CALPV   - Calibrate pressure valve
+ *   PR      - Closed-loop pressure regulation: PR [psi | off | tune <kp> <ki> <kd>]
  *   STARTFSM- Start flow sensor measurement: STARTFSM <1-4>
  *   STOPFSM - Stop flow sensor measurement: STOPFSM <1-4>
  *   RF      - Reset flow sensor dispense volume: RFS <1-4>
@@ -33,10 +35,19 @@
  *   F       - Fill reagent: F <1-4>
  *   DT      - Drain trough: DT <1-4>
  *   SDT     - Stop draining trough: SDT <1-4> or SDT all
+ *   WQ      - Drain queue and bottle fill: WQ, WQ empty <1-2>
+ *   SCHED   - Batch scheduler: SCHED <D|P|F|DT> <1-4> [volume],
+ *             SCHED run | clear | abort | max <1-4>
+ *   MON     - Monitor statistics: MON [reset]
+ *   REC     - Operation recordings: REC [id]
+ *   I2C     - I2C device health: I2C
+ *   SIM     - Hydraulic simulation (simulation build): SIM,
+ *             SIM run [scenario] | fault <1-4> <type|none> | reset
  *   SETFS   - Set flow sensor fluid type: SETFS <1-4> <W/I>
  *   SETFSCOR- Set flow sensor correction: SETFSCOR <1-4> <slope> <offset>
  *   ENFSCOR - Enable/disable flow correction: ENFSCOR <1-4> <0/1>
  *   SHOWFSCOR- Show flow correction settings: SHOWFSCOR <1-4>
+ *   DPC     - Predictive dispense close: DPC [0/1 | save | reset <1-4>]
  *   LOGHELP - Display detailed log field definitions and diagnostic info
  *   STANDBY - Abort all automated operations and set the system to a
  *             safe, idle state (standby mode)
@@ -53,6 +64,7 @@
 // Command Function Prototypes
 // ============================================================
 void cmd_set_log_frequency(char *args, CommandCaller *caller);
+void cmd_set_log_level(char *args, CommandCaller *caller);
 void cmd_fan(char *args, CommandCaller *caller);
 void cmd_fan_auto(char *args, CommandCaller *caller);
 void cmd_set_reagent_valve(char *args, CommandCaller *caller);
@@ -71,6 +83,7 @@ void cmd_prime_valves(char *args, CommandCaller *caller);
 void cmd_fill_reagent(char *args, CommandCaller *caller);
 void cmd_drain_trough(char *args, CommandCaller *caller);
 void cmd_stop_drain_trough(char *args, CommandCaller *caller);
+void cmd_drain_queue(char *args, CommandCaller *caller);
 void cmd_log_help(char *args, CommandCaller *caller);
 void cmd_standby(char *args, CommandCaller *caller);
 void cmd_print_help(char *args, CommandCaller *caller);
@@ -79,11 +92,18 @@ void cmd_set_flow_sensor_fluid(char *args, CommandCaller *caller);
 void cmd_set_flow_sensor_correction(char *args, CommandCaller *caller);
 void cmd_enable_flow_sensor_correction(char *args, CommandCaller *caller);
 void cmd_show_flow_sensor_correction(char *args, CommandCaller *caller);
+void cmd_dispense_predictor(char *args, CommandCaller *caller);
+void cmd_pressure_regulator(char *args, CommandCaller *caller);
+void cmd_schedule(char *args, CommandCaller *caller);
+void cmd_monitor_stats(char *args, CommandCaller *caller);
+void cmd_operation_recorder(char *args, CommandCaller *caller);
+void cmd_i2c_health(char *args, CommandCaller *caller);
+void cmd_hydraulic_sim(char *args, CommandCaller *caller);
 
 // ============================================================
 // Global Command Tree and Commander Object
 // ============================================================
-extern Commander::systemCommand_t API_tree[30];
+extern Commander::systemCommand_t API_tree[39];
 extern Commander commander;
 
 #endif // COMMANDS_H
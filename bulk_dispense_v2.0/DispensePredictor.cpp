@@ -0,0 +1,290 @@
+#include "DispensePredictor.h"
+#include <EEPROM.h>
+#include <math.h>
+#include "Sensors.h"
+
+/************************************************************
+ * DispensePredictor.cpp
+ *
+ * Implements the predictive valve close declared in
+ * DispensePredictor.h:
+ *
+ * 1. Model storage: EEPROM load/save of the learned models
+ * 2. Dispense control: early close decision and the settling
+ *    measurement that learns from each dispense
+ * 3. Statistics: per-trough dispense error reporting
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+DispenseModelStore dispenseModelStore;
+DispenseErrorStats dispenseErrorStats[NUM_OVERFLOW_SENSORS];
+
+static DispenseSettleState settleStates[NUM_OVERFLOW_SENSORS];
+
+// ============================================================
+// Model Storage
+// ============================================================
+
+static uint8_t computeModelChecksum(const DispenseModelStore &store)
+{
+  const uint8_t *bytes = (const uint8_t *)&store;
+  uint8_t sum = 0;
+  for (size_t i = 0; i < offsetof(DispenseModelStore, checksum); i++)
+  {
+    sum += bytes[i];
+  }
+  return sum;
+}
+
+static void setDefaultModel(DispenseModel &model)
+{
+  model.latencyMs = DISPENSE_DEFAULT_LATENCY_MS;
+  model.decayMs = DISPENSE_DEFAULT_DECAY_MS;
+  model.learnedCount = 0;
+}
+
+void loadDispenseModels()
+{
+  EEPROM.get(DISPENSE_MODEL_EEPROM_ADDR, dispenseModelStore);
+
+  if (dispenseModelStore.magic == DISPENSE_MODEL_MAGIC &&
+      dispenseModelStore.version == DISPENSE_MODEL_VERSION &&
+      dispenseModelStore.checksum == computeModelChecksum(dispenseModelStore))
+  {
+    Serial.println(F("[MESSAGE] Dispense close models loaded from EEPROM."));
+  }
+  else
+  {
+    // Blank or outdated EEPROM: start unlearned with prediction off
+    dispenseModelStore.magic = DISPENSE_MODEL_MAGIC;
+    dispenseModelStore.version = DISPENSE_MODEL_VERSION;
+    dispenseModelStore.predictiveEnabled = 0;
+    for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+    {
+      setDefaultModel(dispenseModelStore.models[i]);
+    }
+    Serial.println(F("[MESSAGE] No stored dispense close models. Using defaults."));
+  }
+
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    settleStates[i].active = false;
+    resetDispenseErrorStats(i);
+  }
+}
+
+void saveDispenseModels()
+{
+  dispenseModelStore.checksum = computeModelChecksum(dispenseModelStore);
+  EEPROM.put(DISPENSE_MODEL_EEPROM_ADDR, dispenseModelStore); // Only rewrites changed bytes
+}
+
+void resetDispenseModel(int trough)
+{
+  setDefaultModel(dispenseModelStore.models[trough]);
+  saveDispenseModels();
+}
+
+void setPredictiveCloseEnabled(bool enabled)
+{
+  dispenseModelStore.predictiveEnabled = enabled ? 1 : 0;
+  saveDispenseModels();
+}
+
+// ============================================================
+// Dispense Control
+// ============================================================
+
+// Volume still delivered after closing at flowRate (mL/min)
+float predictDispenseOvershoot(int trough, float flowRate)
+{
+  if (flowRate <= 0)
+  {
+    return 0.0;
+  }
+
+  const DispenseModel &model = dispenseModelStore.models[trough];
+  float overshoot = flowRate / 60000.0 * (model.latencyMs + model.decayMs);
+  return (overshoot > DISPENSE_MAX_PREDICTED_OVERSHOOT_ML) ? DISPENSE_MAX_PREDICTED_OVERSHOOT_ML : overshoot;
+}
+
+bool shouldCloseDispense(int trough, float dispenseVolume, float flowRate, float targetVolume)
+{
+  if (dispenseVolume >= targetVolume)
+  {
+    return true;
+  }
+  if (!dispenseModelStore.predictiveEnabled)
+  {
+    return false;
+  }
+  return dispenseVolume + predictDispenseOvershoot(trough, flowRate) >= targetVolume;
+}
+
+void beginDispenseSettle(int trough, float dispenseVolume, float flowRate)
+{
+  DispenseSettleState &state = settleStates[trough];
+  state.active = true;
+  state.predicted = dispenseVolume < valveControls[trough].targetVolume;
+  state.closeTime = millis();
+  state.latencyMs = 0;
+  state.flowAtClose = flowRate;
+  state.volumeAtClose = dispenseVolume;
+  state.predictedOvershoot = predictDispenseOvershoot(trough, flowRate);
+}
+
+bool isDispenseSettling(int trough)
+{
+  return settleStates[trough].active;
+}
+
+void cancelDispenseSettle(int trough)
+{
+  settleStates[trough].active = false;
+}
+
+static void learnFromDispense(int trough, const DispenseSettleState &state, float finalVolume)
+{
+  DispenseModel &model = dispenseModelStore.models[trough];
+
+  // Time at full close flow that would deliver the measured overshoot
+  float coastMs = (finalVolume - state.volumeAtClose) * 60000.0 / state.flowAtClose;
+  if (coastMs < 0)
+    coastMs = 0;
+  if (coastMs > DISPENSE_MAX_COAST_MS)
+    coastMs = DISPENSE_MAX_COAST_MS;
+
+  float latencyMs = (state.latencyMs < coastMs) ? state.latencyMs : coastMs;
+  float decayMs = coastMs - latencyMs;
+
+  if (model.learnedCount == 0)
+  {
+    model.latencyMs = latencyMs;
+    model.decayMs = decayMs;
+  }
+  else
+  {
+    model.latencyMs += DISPENSE_MODEL_ALPHA * (latencyMs - model.latencyMs);
+    model.decayMs += DISPENSE_MODEL_ALPHA * (decayMs - model.decayMs);
+  }
+
+  if (model.learnedCount < 0xFFFF)
+  {
+    model.learnedCount++;
+  }
+
+  // Limit EEPROM wear: persist every few learned dispenses
+  if (model.learnedCount % DISPENSE_MODEL_SAVE_INTERVAL == 0)
+  {
+    saveDispenseModels();
+  }
+}
+
+static void recordDispenseError(int trough, float error)
+{
+  DispenseErrorStats &stats = dispenseErrorStats[trough];
+
+  stats.count++;
+  float delta = error - stats.meanError;
+  stats.meanError += delta / stats.count;
+  stats.m2 += delta * (error - stats.meanError);
+  stats.meanAbsError += (fabs(error) - stats.meanAbsError) / stats.count;
+
+  if (stats.count == 1 || error < stats.minError)
+    stats.minError = error;
+  if (stats.count == 1 || error > stats.maxError)
+    stats.maxError = error;
+  stats.lastError = error;
+}
+
+// Track the flow after the valves closed; true once the dispense has settled
+bool serviceDispenseSettle(int trough, FlowSensor *sensor, unsigned long currentTime)
+{
+  DispenseSettleState &state = settleStates[trough];
+  if (!state.active)
+  {
+    return true;
+  }
+
+  FlowSample sample;
+  bool fresh = getLatestFlowSample(*sensor, sample) && (long)(sample.timeMs - state.closeTime) >= 0;
+
+  if (fresh && state.latencyMs == 0 &&
+      sample.flowRate < state.flowAtClose * DISPENSE_LATENCY_FLOW_FRACTION)
+  {
+    state.latencyMs = sample.timeMs - state.closeTime;
+    if (state.latencyMs == 0)
+    {
+      state.latencyMs = 1; // Keep 0 meaning "not seen yet"
+    }
+  }
+
+  bool settled = fresh && sample.flowRate < DISPENSE_SETTLED_FLOW_RATE;
+  if (!settled && currentTime - state.closeTime < DISPENSE_SETTLE_TIMEOUT_MS)
+  {
+    return false;
+  }
+
+  float finalVolume = fresh ? sample.dispenseVolume : sensor->dispenseVolume;
+
+  // Only a clean stop from a meaningful flow says anything about the valve
+  if (settled && state.latencyMs > 0 && state.flowAtClose >= DISPENSE_SETTLED_FLOW_RATE * 10)
+  {
+    learnFromDispense(trough, state, finalVolume);
+  }
+  recordDispenseError(trough, finalVolume - valveControls[trough].targetVolume);
+
+  state.active = false;
+  return true;
+}
+
+// ============================================================
+// Statistics
+// ============================================================
+
+void resetDispenseErrorStats(int trough)
+{
+  memset(&dispenseErrorStats[trough], 0, sizeof(DispenseErrorStats));
+}
+
+void printDispensePredictorStatus(int trough, Stream *stream)
+{
+  const DispenseModel &model = dispenseModelStore.models[trough];
+  const DispenseErrorStats &stats = dispenseErrorStats[trough];
+
+  stream->print(F("[INFO] Trough "));
+  stream->print(trough + 1);
+  stream->print(F(" close model: latency "));
+  stream->print(model.latencyMs, 1);
+  stream->print(F(" ms, decay "));
+  stream->print(model.decayMs, 1);
+  stream->print(F(" ms, learned from "));
+  stream->print(model.learnedCount);
+  stream->println(F(" dispenses"));
+
+  stream->print(F("  Errors (final - target, mL): N="));
+  stream->print(stats.count);
+  if (stats.count == 0)
+  {
+    stream->println();
+    return;
+  }
+  stream->print(F(" mean="));
+  stream->print(stats.meanError, 3);
+  stream->print(F(" MAE="));
+  stream->print(stats.meanAbsError, 3);
+  stream->print(F(" stddev="));
+  stream->print(stats.count > 1 ? sqrt(stats.m2 / (stats.count - 1)) : 0.0, 3);
+  stream->print(F(" min="));
+  stream->print(stats.minError, 3);
+  stream->print(F(" max="));
+  stream->print(stats.maxError, 3);
+  stream->print(F(" last="));
+  stream->println(stats.lastError, 3);
+}
@@ -0,0 +1,117 @@
+#ifndef DISPENSEPREDICTOR_H
+#define DISPENSEPREDICTOR_H
+
+#include <Controllino.h>
+#include "Hardware.h"
+
+/************************************************************
+ * DispensePredictor.h
+ *
+ * Predictive valve close for volume dispenses. For each trough
+ * the firmware learns how long the flow keeps running after
+ * closeDispenseValves() (valve latency plus flow decay) and
+ * closes the valves early by the predicted overshoot volume.
+ *
+ * - Learned parameters are stored in EEPROM.
+ * - Every volume dispense is followed by a short settling
+ *   phase that measures the delivered volume and updates the
+ *   model and the per-trough error statistics.
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Predictor Configuration
+// ============================================================
+
+#define DISPENSE_MODEL_EEPROM_ADDR 0
+#define DISPENSE_MODEL_MAGIC 0x4450     // "DP"
+#define DISPENSE_MODEL_VERSION 1
+#define DISPENSE_MODEL_SAVE_INTERVAL 10 // Learned dispenses between EEPROM writes
+
+#define DISPENSE_MODEL_ALPHA 0.25                // EWMA weight of the newest dispense
+#define DISPENSE_DEFAULT_LATENCY_MS 40.0         // Model used before anything is learned
+#define DISPENSE_DEFAULT_DECAY_MS 60.0
+#define DISPENSE_MAX_COAST_MS 1000.0             // Upper bound for latency + decay
+#define DISPENSE_MAX_PREDICTED_OVERSHOOT_ML 5.0  // Never close earlier than this
+#define DISPENSE_LATENCY_FLOW_FRACTION 0.9       // Flow below this fraction of the close flow ends the latency
+#define DISPENSE_SETTLED_FLOW_RATE 1.0           // mL/min, flow considered stopped
+#define DISPENSE_SETTLE_TIMEOUT_MS 1500          // Longest wait for the flow to stop
+
+// ============================================================
+// Predictor Structures
+// ============================================================
+
+// Learned close behaviour of one trough (persisted)
+struct DispenseModel
+{
+  float latencyMs; // Close command until the flow starts falling
+  float decayMs;   // Equivalent full-flow time of the decay that follows
+  uint16_t learnedCount;
+};
+
+// EEPROM image of all models
+struct DispenseModelStore
+{
+  uint16_t magic;
+  uint8_t version;
+  uint8_t predictiveEnabled;
+  DispenseModel models[NUM_OVERFLOW_SENSORS];
+  uint8_t checksum;
+};
+
+// Final volume minus target volume, per trough (RAM only)
+struct DispenseErrorStats
+{
+  uint16_t count;
+  float meanError;
+  float m2;            // Welford sum of squared deviations
+  float meanAbsError;
+  float minError;
+  float maxError;
+  float lastError;
+};
+
+// Measurement in progress after the valves of a trough closed
+struct DispenseSettleState
+{
+  bool active;
+  bool predicted;      // Closed early by the model
+  unsigned long closeTime;
+  unsigned long latencyMs; // 0 until the flow has started falling
+  float flowAtClose;   // mL/min
+  float volumeAtClose; // mL
+  float predictedOvershoot;
+};
+
+// ============================================================
+// Global Variables
+// ============================================================
+extern DispenseModelStore dispenseModelStore;
+extern DispenseErrorStats dispenseErrorStats[NUM_OVERFLOW_SENSORS];
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+
+// Model storage
+void loadDispenseModels();
+void saveDispenseModels();
+void resetDispenseModel(int trough);
+void setPredictiveCloseEnabled(bool enabled);
+
+// Dispense control (trough is 0-based)
+float predictDispenseOvershoot(int trough, float flowRate);
+bool shouldCloseDispense(int trough, float dispenseVolume, float flowRate, float targetVolume);
+void beginDispenseSettle(int trough, float dispenseVolume, float flowRate);
+bool isDispenseSettling(int trough);
+bool serviceDispenseSettle(int trough, FlowSensor *sensor, unsigned long currentTime);
+void cancelDispenseSettle(int trough);
+
+// Statistics
+void resetDispenseErrorStats(int trough);
+void printDispensePredictorStatus(int trough, Stream *stream);
+
+#endif // DISPENSEPREDICTOR_H
@@ -0,0 +1,418 @@
+#include "DrainScheduler.h"
+#include "CommandManager.h"
+#include "NetworkConfig.h"
+#include "Utils.h"
+
+/************************************************************
+ * DrainScheduler.cpp
+ *
+ * Implements the drain queue declared in DrainScheduler.h:
+ *
+ * 1. Requests: start now or queue behind the bottle's drain
+ * 2. Service: drain end accounting, bottle fill and handoff
+ * 3. Reporting: queue, bottle estimates and drain session
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+DrainScheduler drainScheduler;
+
+static unsigned long lastSessionMakespanMs = 0;
+static unsigned long lastSessionBaselineMs = 0;
+static uint8_t lastSessionDrains = 0;
+
+static int getBottleIndex(int trough) { return (trough <= 2) ? 0 : 1; }
+
+static bool isBottleDraining(int bottleIdx)
+{
+  return valveControls[bottleIdx * 2].isDraining || valveControls[bottleIdx * 2 + 1].isDraining;
+}
+
+static Stream *getCompletionStream()
+{
+  return hasActiveClient ? (Stream *)&currentClient : (Stream *)&Serial;
+}
+
+// Volume that reached the trough since its last drain
+static float getExpectedDrainVolume(int trough)
+{
+  float total = flowSensors[trough - 1]->totalVolume;
+  float mark = drainScheduler.troughMark[trough - 1];
+  if (total < mark)
+  {
+    mark = 0.0; // Total was reset (RFT)
+  }
+  return total - mark;
+}
+
+static bool hasBottleRoomFor(int trough)
+{
+  int bottleIdx = getBottleIndex(trough);
+  return drainScheduler.bottleVolume[bottleIdx] + getExpectedDrainVolume(trough) <= DRAIN_BOTTLE_CAPACITY_ML;
+}
+
+static bool hasQueuedDrainOnBottle(int bottleIdx)
+{
+  for (uint8_t q = 0; q < drainScheduler.queueCount; q++)
+  {
+    if (getBottleIndex(drainScheduler.queue[q]) == bottleIdx)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void removeQueuedDrain(uint8_t position)
+{
+  for (uint8_t q = position; q + 1 < drainScheduler.queueCount; q++)
+  {
+    drainScheduler.queue[q] = drainScheduler.queue[q + 1];
+  }
+  drainScheduler.queueCount--;
+}
+
+// ============================================================
+// Requests
+// ============================================================
+
+static void startDrain(int trough, Stream *stream)
+{
+  int index = trough - 1;
+  int bottleIdx = getBottleIndex(trough);
+
+  // Hand the bottle over under vacuum instead of venting it first
+  if (drainScheduler.handoff[bottleIdx])
+  {
+    globalVacuumMonitoring[bottleIdx] = false;
+    drainScheduler.handoff[bottleIdx] = false;
+    drainScheduler.ventStart[bottleIdx] = 0; // Not a vent
+  }
+
+  valveControls[index].isDraining = true;
+
+  drainScheduler.drainVolume[index] = getExpectedDrainVolume(trough);
+  drainScheduler.troughMark[index] = flowSensors[index]->totalVolume;
+  drainScheduler.drainStartTime[index] = millis();
+  drainScheduler.draining[index] = true;
+
+  switch (trough)
+  {
+  case 1:
+    wasteValve1 = openValve(wasteValve1);
+    wasteValve3 = openValve(wasteValve3);
+    sendMessage(F("[MESSAGE] Draining trough 1... Waste valve 1 opened, waste valve 3 opened."), stream, currentClient);
+    break;
+  case 2:
+    wasteValve1 = openValve(wasteValve1);
+    wasteValve3 = closeValve(wasteValve3);
+    sendMessage(F("[MESSAGE] Draining trough 2... Waste valve 1 opened, waste valve 3 closed."), stream, currentClient);
+    break;
+  case 3:
+    wasteValve2 = openValve(wasteValve2);
+    wasteValve4 = openValve(wasteValve4);
+    sendMessage(F("[MESSAGE] Draining trough 3... Waste valve 2 opened, waste valve 4 opened."), stream, currentClient);
+    break;
+  case 4:
+    wasteValve2 = openValve(wasteValve2);
+    wasteValve4 = closeValve(wasteValve4);
+    sendMessage(F("[MESSAGE] Draining trough 4... Waste valve 2 opened, waste valve 4 closed."), stream, currentClient);
+    break;
+  }
+  // The asynchronous monitorWasteSensor() function will handle drain completion or timeout.
+}
+
+bool requestDrain(int trough, Stream *stream)
+{
+  if (isDrainQueued(trough))
+  {
+    sendMessage(F("[ERROR] Drain already queued for this trough."), stream, currentClient);
+    return false;
+  }
+
+  // The command stays pending until the drain ends, whenever it starts
+  drainAsyncCompleted[trough - 1] = false;
+
+  if (!drainScheduler.session.active)
+  {
+    memset(&drainScheduler.session, 0, sizeof(DrainSession));
+    drainScheduler.session.active = true;
+    drainScheduler.session.startTime = millis();
+  }
+
+  int bottleIdx = getBottleIndex(trough);
+  if (!isBottleDraining(bottleIdx) && !hasQueuedDrainOnBottle(bottleIdx) && hasBottleRoomFor(trough))
+  {
+    startDrain(trough, stream);
+    return true;
+  }
+
+  drainScheduler.queue[drainScheduler.queueCount++] = trough;
+  drainScheduler.session.waits[bottleIdx]++;
+  sendMessage(F("[MESSAGE] Drain of trough "), stream, currentClient, false);
+  sendMessage(String(trough).c_str(), stream, currentClient, false);
+  sendMessage(F(" queued for waste bottle "), stream, currentClient, false);
+  sendMessage(String(bottleIdx + 1).c_str(), stream, currentClient, false);
+  sendMessage(F(" (position "), stream, currentClient, false);
+  sendMessage(String(drainScheduler.queueCount).c_str(), stream, currentClient, false);
+  sendMessage(F(")."), stream, currentClient);
+  return true;
+}
+
+bool isDrainQueued(int trough)
+{
+  for (uint8_t q = 0; q < drainScheduler.queueCount; q++)
+  {
+    if (drainScheduler.queue[q] == trough)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cancelQueuedDrain(int trough)
+{
+  for (uint8_t q = 0; q < drainScheduler.queueCount; q++)
+  {
+    if (drainScheduler.queue[q] == trough)
+    {
+      removeQueuedDrain(q);
+      int bottleIdx = getBottleIndex(trough);
+      if (!hasQueuedDrainOnBottle(bottleIdx))
+      {
+        drainScheduler.bottleHeld[bottleIdx] = false;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// Drops the queue without completing the queued commands; the callers abort the session
+void clearDrainQueue()
+{
+  drainScheduler.queueCount = 0;
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    drainScheduler.bottleHeld[b] = false;
+    drainScheduler.handoff[b] = false;
+  }
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    drainScheduler.draining[i] = false;
+  }
+  drainScheduler.session.active = false;
+}
+
+void onDrainComplete(int trough)
+{
+  // The next drain starts from serviceDrainScheduler(): started here, the
+  // monitor loop that called us would complete it in the same pass
+  drainScheduler.handoff[getBottleIndex(trough)] = true;
+}
+
+void emptyWasteBottle(int bottleIdx)
+{
+  drainScheduler.bottleVolume[bottleIdx] = 0.0;
+  drainScheduler.bottleHeld[bottleIdx] = false;
+}
+
+// ============================================================
+// Service
+// ============================================================
+
+// Without the queue, a drain behind another on its bottle was rejected: the
+// host retried once that drain had ended and the bottle had vented
+static unsigned long getRejectAndRetryMs(const DrainSession &session)
+{
+  unsigned long baselineMs = 0;
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    unsigned long bottleMs =
+        session.bottleMs[b] + session.waits[b] * (DRAIN_HOST_RETRY_MS + drainScheduler.ventMs[b]);
+    if (bottleMs > baselineMs)
+    {
+      baselineMs = bottleMs; // The bottles drained in parallel already
+    }
+  }
+  return baselineMs;
+}
+
+static void endDrainSession(unsigned long currentTime)
+{
+  DrainSession &session = drainScheduler.session;
+  session.active = false;
+  session.endTime = currentTime;
+  if (session.drains < 2)
+  {
+    return; // A single drain has nothing to compare
+  }
+
+  lastSessionDrains = session.drains;
+  lastSessionMakespanMs = session.endTime - session.startTime;
+  lastSessionBaselineMs = getRejectAndRetryMs(session);
+
+  Stream *stream = getCompletionStream();
+  char line[96];
+  snprintf(line, sizeof(line), "[MESSAGE] Drain session: %u drains, makespan %lu ms, reject-and-retry %lu ms",
+           lastSessionDrains, lastSessionMakespanMs, lastSessionBaselineMs);
+  sendMessage(line, stream, currentClient);
+}
+
+static void holdBottle(int bottleIdx, int trough)
+{
+  if (drainScheduler.bottleHeld[bottleIdx])
+  {
+    return; // Reported once
+  }
+  drainScheduler.bottleHeld[bottleIdx] = true;
+
+  char volumeStr[10];
+  dtostrf(drainScheduler.bottleVolume[bottleIdx] + getExpectedDrainVolume(trough), 1, 0, volumeStr);
+  sendMessage(F("[WARNING] Drain of trough "), &Serial, currentClient, false);
+  sendMessage(String(trough).c_str(), &Serial, currentClient, false);
+  sendMessage(F(" held: waste bottle "), &Serial, currentClient, false);
+  sendMessage(String(bottleIdx + 1).c_str(), &Serial, currentClient, false);
+  sendMessage(F(" would reach an estimated "), &Serial, currentClient, false);
+  sendMessage(volumeStr, &Serial, currentClient, false);
+  sendMessage(F(" mL. Empty it and send WQ empty "), &Serial, currentClient, false);
+  sendMessage(String(bottleIdx + 1).c_str(), &Serial, currentClient);
+}
+
+void serviceDrainScheduler(unsigned long currentTime)
+{
+  // Drain ends, however the drain stopped
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    if (!drainScheduler.draining[i] || valveControls[i].isDraining)
+    {
+      continue;
+    }
+    int bottleIdx = getBottleIndex(i + 1);
+    drainScheduler.draining[i] = false;
+    drainScheduler.session.drains++;
+    drainScheduler.session.bottleMs[bottleIdx] += currentTime - drainScheduler.drainStartTime[i];
+
+    drainScheduler.bottleVolume[bottleIdx] += drainScheduler.drainVolume[i];
+    if (readBinarySensor(wasteBottleSensors[bottleIdx]))
+    {
+      drainScheduler.bottleVolume[bottleIdx] = DRAIN_BOTTLE_CAPACITY_ML; // Sensor beats the estimate
+    }
+  }
+
+  // Oldest queued drain first on each free bottle
+  bool bottleVisited[NUM_WASTE_BOTTLE_SENSORS] = {false};
+  uint8_t q = 0;
+  while (q < drainScheduler.queueCount)
+  {
+    int trough = drainScheduler.queue[q];
+    int bottleIdx = getBottleIndex(trough);
+    if (bottleVisited[bottleIdx] || isBottleDraining(bottleIdx))
+    {
+      q++;
+      continue;
+    }
+    bottleVisited[bottleIdx] = true;
+
+    if (!hasBottleRoomFor(trough))
+    {
+      holdBottle(bottleIdx, trough);
+      q++;
+      continue;
+    }
+
+    // The bottle may have filled since the drain was queued
+    if (readBinarySensor(wasteBottleSensors[bottleIdx]))
+    {
+      drainScheduler.bottleVolume[bottleIdx] = DRAIN_BOTTLE_CAPACITY_ML; // Sensor beats the estimate
+      holdBottle(bottleIdx, trough);
+      q++;
+      continue;
+    }
+
+    // The checks the DT ran when it was queued, for the trough as it is now
+    Stream *stream = getCompletionStream();
+    removeQueuedDrain(q);
+    drainScheduler.bottleHeld[bottleIdx] = false;
+    stopDispensingIfActive(trough, stream);
+    disableFillMode(trough, stream);
+    startDrain(trough, stream);
+  }
+
+  // No drain took the bottle over: let the vent run, and time it for the report
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    drainScheduler.handoff[b] = false;
+    if (globalVacuumMonitoring[b] && drainScheduler.ventStart[b] == 0)
+    {
+      drainScheduler.ventStart[b] = currentTime;
+    }
+    else if (!globalVacuumMonitoring[b] && drainScheduler.ventStart[b] != 0)
+    {
+      drainScheduler.ventMs[b] = currentTime - drainScheduler.ventStart[b];
+      drainScheduler.ventStart[b] = 0;
+    }
+  }
+
+  if (drainScheduler.session.active && drainScheduler.queueCount == 0 && !isBottleDraining(0) &&
+      !isBottleDraining(1))
+  {
+    endDrainSession(currentTime);
+  }
+}
+
+// ============================================================
+// Reporting
+// ============================================================
+
+void printDrainScheduler(Stream *stream)
+{
+  char line[96];
+  char volumeStr[10];
+
+  sendMessage(F("[INFO] Drain queue:"), stream, currentClient, false);
+  if (drainScheduler.queueCount == 0)
+  {
+    sendMessage(F(" empty"), stream, currentClient, false);
+  }
+  for (uint8_t q = 0; q < drainScheduler.queueCount; q++)
+  {
+    sendMessage(F(" T"), stream, currentClient, false);
+    sendMessage(String(drainScheduler.queue[q]).c_str(), stream, currentClient, false);
+  }
+  sendMessage(F(""), stream, currentClient);
+
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    int draining = 0;
+    for (int i = b * 2; i < b * 2 + 2; i++)
+    {
+      if (valveControls[i].isDraining)
+      {
+        draining = i + 1;
+      }
+    }
+    dtostrf(drainScheduler.bottleVolume[b], 1, 0, volumeStr);
+    snprintf(line, sizeof(line), "  Bottle %d: ~%s of %d mL%s%s", b + 1, volumeStr, (int)DRAIN_BOTTLE_CAPACITY_ML,
+             drainScheduler.bottleHeld[b] ? ", HELD" : "", draining ? ", draining trough " : "");
+    sendMessage(line, stream, currentClient, !draining);
+    if (draining)
+    {
+      sendMessage(String(draining).c_str(), stream, currentClient);
+    }
+  }
+
+  if (lastSessionDrains == 0)
+  {
+    return;
+  }
+  snprintf(line, sizeof(line), "[INFO] Last drain session: %u drains, makespan %lu ms, reject-and-retry %lu ms",
+           lastSessionDrains, lastSessionMakespanMs, lastSessionBaselineMs);
+  sendMessage(line, stream, currentClient);
+}
@@ -0,0 +1,91 @@
+#ifndef DRAINSCHEDULER_H
+#define DRAINSCHEDULER_H
+
+#include <Controllino.h>
+#include "Hardware.h"
+
+/************************************************************
+ * DrainScheduler.h
+ *
+ * Drain queue for the two waste bottles. Troughs 1/2 drain into
+ * bottle 1 and troughs 3/4 into bottle 2, one trough per bottle
+ * at a time. A DT for a trough whose bottle is busy is queued
+ * instead of rejected; the command stays pending until its
+ * drain has run. A queued drain re-runs the DT checks when it
+ * starts.
+ *
+ * - When a drain completes, the next queued drain on that bottle
+ *   starts in the same loop pass, without venting the bottle's
+ *   vacuum in between.
+ * - Each bottle's fill is estimated from the volume that passed
+ *   the troughs' flow sensors since their last drain. A drain
+ *   that would overfill the bottle is held in the queue instead
+ *   of being cut off by the bottle full sensor (or by the sensor
+ *   itself); WQ empty <1-2> releases it once the bottle has been
+ *   emptied.
+ * - Drains requested back to back form a session. A session of
+ *   more than one drain reports its makespan against the reject-
+ *   and-retry flow it replaces: each bottle's drains back to back,
+ *   plus a host retry and a measured bottle vent for every drain
+ *   that had to wait.
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Drain Scheduler Configuration
+// ============================================================
+
+#define DRAIN_BOTTLE_CAPACITY_ML 1800.0 // Usable bottle volume below the full sensor
+#define DRAIN_HOST_RETRY_MS 1000        // Host retry interval assumed for a rejected DT
+
+// ============================================================
+// Drain Scheduler Structures
+// ============================================================
+
+struct DrainSession
+{
+  bool active;
+  uint8_t drains; // Drains finished in the session
+  unsigned long startTime;
+  unsigned long endTime;
+  unsigned long bottleMs[NUM_WASTE_BOTTLE_SENSORS]; // Sum of the drain times per bottle
+  uint8_t waits[NUM_WASTE_BOTTLE_SENSORS];          // Drains queued behind another (rejected before)
+};
+
+struct DrainScheduler
+{
+  uint8_t queue[NUM_OVERFLOW_SENSORS]; // Troughs (1-4) waiting, oldest first
+  uint8_t queueCount;
+  float bottleVolume[NUM_WASTE_BOTTLE_SENSORS]; // Estimated mL in each bottle
+  bool bottleHeld[NUM_WASTE_BOTTLE_SENSORS];    // Queued drains held for a full bottle
+  bool handoff[NUM_WASTE_BOTTLE_SENSORS];       // A drain just completed on the bottle
+  float troughMark[NUM_OVERFLOW_SENSORS];       // Flow sensor total at the last drain
+  float drainVolume[NUM_OVERFLOW_SENSORS];      // Expected volume of the running drain
+  unsigned long drainStartTime[NUM_OVERFLOW_SENSORS];
+  bool draining[NUM_OVERFLOW_SENSORS];          // isDraining as of the last service
+  unsigned long ventStart[NUM_WASTE_BOTTLE_SENSORS]; // Vacuum release being watched since; 0 if none
+  unsigned long ventMs[NUM_WASTE_BOTTLE_SENSORS];    // Last measured vacuum release time
+  DrainSession session;
+};
+
+// ============================================================
+// Global Variables
+// ============================================================
+extern DrainScheduler drainScheduler;
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+bool requestDrain(int trough, Stream *stream); // Starts the drain or queues it
+bool isDrainQueued(int trough);
+bool cancelQueuedDrain(int trough);
+void clearDrainQueue();
+void onDrainComplete(int trough); // From waste_handleDrainComplete()
+void emptyWasteBottle(int bottleIdx);
+void serviceDrainScheduler(unsigned long currentTime); // Call every loop, after the monitors
+void printDrainScheduler(Stream *stream);
+
+#endif // DRAINSCHEDULER_H
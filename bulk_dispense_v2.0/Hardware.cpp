@@ -1,6 +1,8 @@
 #include "Hardware.h"
 #include <Wire.h>
 #include "Utils.h"
+#include "Sensors.h"
+#include "HydraulicSim.h"
 
 /************************************************************
  * Hardware.cpp
@@ -132,8 +134,9 @@ bool globalVacuumMonitoring[NUM_WASTE_VACUUM_SENSORS] = { false, false };
 // Global flag for enclosure liquid error state.
 bool globalEnclosureLiquidError = false;
 
-// Calibration variable for proportional valve.
+// Calibration variables for proportional valve.
 float proportionalValveMaxFeedback = 0.0;
+float proportionalValveCalPressure[PRESSURE_CAL_POINTS] = { 0.0 }; // psi per calibration step
 
 // Async command flags.
 bool dispenseAsyncCompleted[NUM_OVERFLOW_SENSORS] = { false, false, false, false };
@@ -166,13 +169,21 @@ void printFanState(bool state) {
 }
 
 OnOffValve openValve(OnOffValve valve) {
+#if HYDRAULIC_SIM
+  updateHydraulicSim(millis()); // Integrate up to the switch with the old valve state
+#else
   digitalWrite(valve.controlPin, HIGH);
+#endif
   valve.isOpen = true;
   return valve;
 }
 
 OnOffValve closeValve(OnOffValve valve) {
+#if HYDRAULIC_SIM
+  updateHydraulicSim(millis());
+#else
   digitalWrite(valve.controlPin, LOW);
+#endif
   valve.isOpen = false;
   return valve;
 }
@@ -186,24 +197,40 @@ ProportionalValve setValvePosition(ProportionalValve valve, float percentage) {
   if (percentage < 0) percentage = 0;
   if (percentage > 100) percentage = 100;
   valve.controlVoltage = (percentage / 100.0) * 10.0;
+#if HYDRAULIC_SIM
+  updateHydraulicSim(millis());
+#else
   int pwmValue = (int)((valve.controlVoltage / 10.0) * 255);
   analogWrite(valve.controlPin, pwmValue);
+#endif
   return valve;
 }
 
 float getValveFeedback(const ProportionalValve &valve) {
+#if HYDRAULIC_SIM
+  return valve.controlVoltage;
+#else
   int analogValue = analogRead(valve.feedbackPin);
   // Map analog reading (0-1023) to 0-10 volts (scaled to 10000 for mV then divided)
   float voltage = map(analogValue, 0, 1023, 0, 10000) / 1000.0;
   return voltage;
+#endif
 }
 
 void calibrateProportionalValve() {
   sendMessage(F("[MESSAGE] Starting proportional valve calibration..."), &Serial, currentClient);
+  // Step up through the valve range recording the supply pressure (feed-forward data).
+  for (int i = 0; i < PRESSURE_CAL_POINTS - 1; i++) {
+    proportionalValve = setValvePosition(proportionalValve, i * PRESSURE_CAL_STEP_PERCENT);
+    delay(PRESSURE_CAL_SETTLE_MS);
+    proportionalValveCalPressure[i] = readPressure(pressureSensor);
+  }
+
   // Set valve to fully open (100%).
   proportionalValve = setValvePosition(proportionalValve, 100.0);
   delay(1000);  // Wait for stabilization.
   proportionalValveMaxFeedback = getValveFeedback(proportionalValve);
+  proportionalValveCalPressure[PRESSURE_CAL_POINTS - 1] = readPressure(pressureSensor);
   
   sendMessage(F("[MESSAGE] Calibrated max feedback voltage: "), &Serial, currentClient, false);
   char voltageStr[10];
@@ -211,14 +238,37 @@ void calibrateProportionalValve() {
   sendMessage(voltageStr, &Serial, currentClient);
 }
 
+// Last channel written to the multiplexer (0xFF = unknown)
+static uint8_t selectedMultiplexerAddr = 0;
+static uint8_t selectedMultiplexerChannel = 0xFF;
+
 void selectMultiplexerChannel(uint8_t multiplexerAddr, uint8_t channel) {
-  Wire.beginTransmission(multiplexerAddr);
-  Wire.write(1 << channel);  // Select channel by shifting 1 into the desired bit position.
-  Wire.endTransmission();
+  // Skip the bus write when the channel is already selected
+  if (multiplexerAddr == selectedMultiplexerAddr && channel == selectedMultiplexerChannel) {
+    return;
+  }
+
+  I2C_BUS.beginTransmission(multiplexerAddr);
+  I2C_BUS.write(1 << channel);  // Select channel by shifting 1 into the desired bit position.
+  if (I2C_BUS.endTransmission() == 0) {
+    selectedMultiplexerAddr = multiplexerAddr;
+    selectedMultiplexerChannel = channel;
+  } else {
+    invalidateMultiplexerChannel();
+  }
+}
+
+// Force the next selectMultiplexerChannel() to write (after a bus reset or error)
+void invalidateMultiplexerChannel() {
+  selectedMultiplexerChannel = 0xFF;
 }
 
 bool readBinarySensor(const BinarySensor &sensor) {
+#if HYDRAULIC_SIM
+  return simReadBinarySensor(sensor);
+#else
   int reading = digitalRead(sensor.inputPin);
   return sensor.activeHigh ? (reading == HIGH) : (reading == LOW);
+#endif
 }
 
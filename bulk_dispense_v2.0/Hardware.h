@@ -74,6 +74,11 @@ extern const uint8_t WASTE_VACUUM_SENSORS[NUM_WASTE_VACUUM_SENSORS];
 // Pressure Sensor
 #define PRESSURE_SENSOR_PIN CONTROLLINO_AI12
 
+// Proportional valve calibration (pressure sampled at 0, 25, ... 100%)
+#define PRESSURE_CAL_POINTS 5
+#define PRESSURE_CAL_STEP_PERCENT 25.0
+#define PRESSURE_CAL_SETTLE_MS 500
+
 // I2C and Flow Sensor parameters
 #define MULTIPLEXER_ADDR 0x70
 #define TEMP_HUM_SENSOR_ADDR 0x44
@@ -82,6 +87,18 @@ extern const uint8_t WASTE_VACUUM_SENSORS[NUM_WASTE_VACUUM_SENSORS];
 #define FLOW_SENSOR_CMD_WATER 0x3608
 #define FLOW_SENSOR_CMD_IPA 0x3615
 
+// Flow sensor acquisition
+#define FLOW_SENSOR_SAMPLE_INTERVAL_MS 10 // Per-sensor read period (monitors consume every 25 ms)
+#define FLOW_SAMPLE_RING_SIZE 8           // Time-stamped samples kept per sensor (power of 2)
+#define FLOW_SENSOR_FRAME_SIZE 9          // Flow, temperature and flag words, each followed by a CRC byte
+
+// Temperature/humidity acquisition (split-phase SHT31 single shot)
+#define TEMP_HUM_SAMPLE_INTERVAL_MS 1000 // Period between measurement starts
+#define TEMP_HUM_MEASUREMENT_MS 16        // High-repeatability conversion time
+#define TEMP_HUM_READ_TIMEOUT_MS 100      // Give up on a measurement not ready by then
+#define TEMP_HUM_MAX_AGE_MS 5000          // Older cached readings are reported invalid
+#define TEMP_HUM_FRAME_SIZE 6             // Temperature and humidity words, each followed by a CRC byte
+
 // ============================================================
 // Structure Definitions
 // ============================================================
@@ -121,6 +138,7 @@ struct TempHumidity
   float temperature;
   float humidity;
   bool valid;
+  unsigned long timestamp; // millis() when the measurement was collected
 };
 
 // Fluid type enum for flow sensors
@@ -130,6 +148,29 @@ enum FluidType
   IPA
 };
 
+// Time-stamped flow sample published by the acquisition scheduler
+struct FlowSample
+{
+  unsigned long timeMs;
+  float flowRate;       // mL/min
+  float dispenseVolume; // mL since the dispense volume was last reset
+};
+
+// Decoded SLF3S measurement frame (raw words, CRC already verified)
+struct FlowSensorFrame
+{
+  int16_t flowRaw;        // Scale factor 32 -> mL/min
+  int16_t temperatureRaw; // Scale factor 200 -> degrees C
+  uint16_t flags;
+};
+
+// Per-sensor ring of the most recent samples
+struct FlowSampleRing
+{
+  FlowSample samples[FLOW_SAMPLE_RING_SIZE];
+  uint16_t count; // Samples published since the ring was cleared (next slot = count % size)
+};
+
 // Flow Sensor Structure
 struct FlowSensor
 {
@@ -152,6 +193,15 @@ struct FlowSensor
   float slopeCorrection;  // Multiplier for volume correction (default 1.0)
   float offsetCorrection; // Offset for volume correction (default 0.0)
   bool useCorrection;     // Flag to enable/disable correction
+  uint32_t framesRead;    // Measurement frames received
+  uint16_t crcErrorCount; // Frames rejected by the CRC check
+  // Fixed-point volume integrator (dispenseVolume/totalVolume mirror these in mL)
+  uint32_t lastSampleMicros;     // micros() when the last integrated frame was read
+  int64_t lastCorrectedFlowQ16;  // Corrected flow of that frame, 1/32 mL/min LSBs in Q16
+  int64_t integratorRemainder;   // Area below one nanolitre carried to the next sample
+  int64_t dispenseVolumeNl;
+  int64_t totalVolumeNl;
+  FlowSampleRing ring;    // Samples published by serviceFlowSensorAcquisition()
 };
 
 // Valve Control Structure (for dispense operations)
@@ -220,8 +270,9 @@ extern BinarySensor wasteBottleSensors[NUM_WASTE_BOTTLE_SENSORS];
 extern BinarySensor wasteVacuumSensors[NUM_WASTE_VACUUM_SENSORS];
 extern BinarySensor enclosureLiquidSensor;
 
-// Calibration variable
+// Calibration variables
 extern float proportionalValveMaxFeedback;
+extern float proportionalValveCalPressure[PRESSURE_CAL_POINTS];
 
 // Global vacuum monitoring flags for waste bottle 1 and 2.
 extern bool globalVacuumMonitoring[NUM_WASTE_VACUUM_SENSORS];
@@ -251,6 +302,7 @@ float getValveFeedback(const ProportionalValve &valve);
 void calibrateProportionalValve();
 
 void selectMultiplexerChannel(uint8_t multiplexerAddr, uint8_t channel);
+void invalidateMultiplexerChannel();
 
 bool readBinarySensor(const BinarySensor &sensor);
 
@@ -0,0 +1,573 @@
+#include "HydraulicSim.h"
+
+#if HYDRAULIC_SIM
+
+#include "Sensors.h"
+#include "Utils.h"
+#include "NetworkConfig.h"
+#include "OperationScheduler.h"
+#include "PressureRegulator.h"
+
+/************************************************************
+ * HydraulicSim.cpp
+ *
+ * Implements the simulation build declared in HydraulicSim.h:
+ *
+ * 1. Plant model: pressure, flow, priming, troughs and waste
+ * 2. Sensor emulation: binary sensors and supply pressure
+ * 3. I2C emulation: multiplexer, SLF3S flow sensors and SHT31
+ * 4. Scenarios: plant setup, faults and scheduler batches
+ * 5. Reporting: plant state and scenario list
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+HydraulicSimState hydraulicSim;
+SimulatedWire simWire;
+
+static OnOffValve *const SIM_REAGENT_VALVES[NUM_OVERFLOW_SENSORS] = {&reagentValve1, &reagentValve2, &reagentValve3, &reagentValve4};
+static OnOffValve *const SIM_MEDIA_VALVES[NUM_OVERFLOW_SENSORS] = {&mediaValve1, &mediaValve2, &mediaValve3, &mediaValve4};
+
+// Per bottle: the valve that connects the bottle to the drain line, and the
+// selector that picks the odd trough when open (and vents the bottle when
+// the drain valve is closed)
+static OnOffValve *const SIM_DRAIN_VALVES[NUM_WASTE_BOTTLE_SENSORS] = {&wasteValve1, &wasteValve2};
+static OnOffValve *const SIM_SELECTOR_VALVES[NUM_WASTE_BOTTLE_SENSORS] = {&wasteValve3, &wasteValve4};
+
+static const char *const SIM_FAULT_NAMES[] = {"reagent", "line", "sensor", "drain", "vacuum"};
+#define SIM_FAULT_TYPE_COUNT (sizeof(SIM_FAULT_NAMES) / sizeof(SIM_FAULT_NAMES[0]))
+
+// ============================================================
+// Plant Model
+// ============================================================
+
+// Liquid, pressure and faults start over; emulated device state (mux
+// selection, sensors measuring) is kept so it still matches the firmware's
+void resetHydraulicSim(bool linesPrimed, float troughVolume)
+{
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    SimTrough &trough = hydraulicSim.troughs[i];
+    trough.volume = troughVolume;
+    trough.lineFill = linesPrimed ? SIM_LINE_VOLUME_ML : 0.0;
+    trough.flow = 0.0;
+    trough.drainFlow = 0.0;
+    trough.faults = 0;
+  }
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    hydraulicSim.bottles[b].volume = 0.0;
+    hydraulicSim.bottles[b].vacuum = 1.0; // Pump always on; bottles start sealed
+  }
+  hydraulicSim.pressure = 0.0;
+  hydraulicSim.lastUpdateTime = millis();
+}
+
+// First-order step that stays stable for any dt (blocking delays included)
+static float approach(float value, float target, float dtMs, float tauMs)
+{
+  return value + (target - value) * dtMs / (tauMs + dtMs);
+}
+
+static float getTroughConductance(int i)
+{
+  const SimTrough &trough = hydraulicSim.troughs[i];
+  if (trough.faults & SIM_FAULT_LINE)
+  {
+    return 0.0;
+  }
+  float conductance = 0.0;
+  if (SIM_REAGENT_VALVES[i]->isOpen && !(trough.faults & SIM_FAULT_REAGENT))
+  {
+    conductance += SIM_REAGENT_FLOW_PER_PSI;
+  }
+  if (SIM_MEDIA_VALVES[i]->isOpen)
+  {
+    conductance += SIM_MEDIA_FLOW_PER_PSI;
+  }
+  return conductance;
+}
+
+static void updateDrain(int b, float dtMs)
+{
+  SimBottle &bottle = hydraulicSim.bottles[b];
+  bool drainOpen = SIM_DRAIN_VALVES[b]->isOpen;
+  bool selectorOpen = SIM_SELECTOR_VALVES[b]->isOpen;
+  int first = b * 2;
+
+  bool stuck = (hydraulicSim.troughs[first].faults | hydraulicSim.troughs[first + 1].faults) & SIM_FAULT_VACUUM;
+  if (selectorOpen && !drainOpen && !stuck)
+  {
+    bottle.vacuum = approach(bottle.vacuum, 0.0, dtMs, SIM_VACUUM_RELEASE_MS);
+  }
+  else
+  {
+    bottle.vacuum = approach(bottle.vacuum, 1.0, dtMs, SIM_VACUUM_BUILD_MS);
+  }
+
+  hydraulicSim.troughs[first].drainFlow = 0.0;
+  hydraulicSim.troughs[first + 1].drainFlow = 0.0;
+  if (!drainOpen)
+  {
+    return;
+  }
+
+  SimTrough &trough = hydraulicSim.troughs[selectorOpen ? first : first + 1];
+  if (trough.faults & SIM_FAULT_DRAIN)
+  {
+    return;
+  }
+  float rate = SIM_DRAIN_FLOW_ML_MIN * bottle.vacuum;
+  float drained = rate * dtMs / 60000.0;
+  if (drained > trough.volume)
+  {
+    drained = trough.volume;
+  }
+  trough.volume -= drained;
+  bottle.volume += drained;
+  trough.drainFlow = (drained > 0.0) ? rate : 0.0;
+}
+
+void updateHydraulicSim(unsigned long currentTime)
+{
+  unsigned long elapsed = currentTime - hydraulicSim.lastUpdateTime;
+  if (elapsed == 0)
+  {
+    return;
+  }
+  hydraulicSim.lastUpdateTime = currentTime;
+  float dtMs = elapsed;
+
+  // Supply pressure sags with every open path
+  float conductance[NUM_OVERFLOW_SENSORS];
+  uint8_t openPaths = 0;
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    conductance[i] = getTroughConductance(i);
+    if (conductance[i] > 0.0)
+    {
+      openPaths++;
+    }
+  }
+  float valvePercent = proportionalValve.controlVoltage * 10.0;
+  float targetPressure = valvePercent / 100.0 * SIM_SUPPLY_MAX_PSI - openPaths * SIM_PRESSURE_DROP_PER_PATH_PSI;
+  if (targetPressure < 0.0)
+  {
+    targetPressure = 0.0;
+  }
+  hydraulicSim.pressure = approach(hydraulicSim.pressure, targetPressure, dtMs, SIM_PRESSURE_TAU_MS);
+
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    SimTrough &trough = hydraulicSim.troughs[i];
+    float previousFlow = trough.flow;
+    trough.flow = approach(trough.flow, conductance[i] * hydraulicSim.pressure, dtMs, SIM_FLOW_TAU_MS);
+
+    // The line fills before anything reaches the trough
+    float delivered = (previousFlow + trough.flow) * 0.5 * dtMs / 60000.0;
+    if (trough.lineFill < SIM_LINE_VOLUME_ML)
+    {
+      float toLine = min(delivered, (float)(SIM_LINE_VOLUME_ML - trough.lineFill));
+      trough.lineFill += toLine;
+      delivered -= toLine;
+    }
+    trough.volume += delivered;
+  }
+
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    updateDrain(b, dtMs);
+  }
+}
+
+// ============================================================
+// Sensor Emulation
+// ============================================================
+
+bool simReadBinarySensor(const BinarySensor &sensor)
+{
+  updateHydraulicSim(millis());
+
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    const SimTrough &trough = hydraulicSim.troughs[i];
+    if (&sensor == &overflowSensors[i])
+    {
+      return trough.volume >= SIM_TROUGH_OVERFLOW_ML;
+    }
+    if (&sensor == &reagentBubbleSensors[i])
+    {
+      return trough.lineFill >= SIM_LINE_VOLUME_ML && !(trough.faults & SIM_FAULT_REAGENT);
+    }
+  }
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    if (&sensor == &wasteLineSensors[b])
+    {
+      return hydraulicSim.troughs[b * 2].drainFlow > 0.0 || hydraulicSim.troughs[b * 2 + 1].drainFlow > 0.0;
+    }
+    if (&sensor == &wasteBottleSensors[b])
+    {
+      return hydraulicSim.bottles[b].volume >= SIM_BOTTLE_FULL_ML;
+    }
+    if (&sensor == &wasteVacuumSensors[b])
+    {
+      return hydraulicSim.bottles[b].vacuum >= 0.5;
+    }
+  }
+  return false; // Enclosure stays dry
+}
+
+float simReadPressureVoltage(const PressureSensor &sensor)
+{
+  updateHydraulicSim(millis());
+  return hydraulicSim.pressure / sensor.maxPressure * 10.0;
+}
+
+// ============================================================
+// I2C Emulation
+// ============================================================
+
+// Lowest selected multiplexer channel, or -1 if none
+static int getSelectedChannel()
+{
+  for (int channel = 0; channel < 8; channel++)
+  {
+    if (hydraulicSim.muxChannels & (1 << channel))
+    {
+      return channel;
+    }
+  }
+  return -1;
+}
+
+// Emulated flow sensor on the selected channel, or -1 if it does not answer
+static int getAddressedFlowSensor(uint8_t address)
+{
+  int channel = getSelectedChannel();
+  if (channel < 0 || channel >= NUM_FLOW_SENSORS || address != flowSensors[channel]->sensorAddr ||
+      (hydraulicSim.troughs[channel].faults & SIM_FAULT_SENSOR))
+  {
+    return -1;
+  }
+  return channel;
+}
+
+static bool isTempHumAddressed(uint8_t address)
+{
+  return address == TEMP_HUM_SENSOR_ADDR && getSelectedChannel() == TEMP_HUM_SENSOR_CHANNEL;
+}
+
+static void putSensirionWord(uint8_t *frame, uint16_t word)
+{
+  frame[0] = word >> 8;
+  frame[1] = word & 0xFF;
+  frame[2] = computeSensirionCrc(frame, 2);
+}
+
+void SimulatedWire::beginTransmission(uint8_t address)
+{
+  this->address = address;
+  txLength = 0;
+}
+
+size_t SimulatedWire::write(uint8_t data)
+{
+  if (txLength < sizeof(txBuffer))
+  {
+    txBuffer[txLength++] = data;
+  }
+  return 1;
+}
+
+// 0 = ACK, 2 = address NACK (as Wire)
+uint8_t SimulatedWire::endTransmission()
+{
+  updateHydraulicSim(millis());
+  uint16_t command = (txLength == 2) ? ((txBuffer[0] << 8) | txBuffer[1]) : 0;
+
+  if (address == MULTIPLEXER_ADDR)
+  {
+    if (txLength == 1)
+    {
+      hydraulicSim.muxChannels = txBuffer[0];
+    }
+    return 0;
+  }
+
+  int sensorIdx = getAddressedFlowSensor(address);
+  if (sensorIdx >= 0)
+  {
+    if (command == FLOW_SENSOR_CMD_WATER || command == FLOW_SENSOR_CMD_IPA)
+    {
+      hydraulicSim.troughs[sensorIdx].sensorMeasuring = true;
+    }
+    else if (command == 0x3FF9 || command == 0x0006) // Stop, soft reset
+    {
+      hydraulicSim.troughs[sensorIdx].sensorMeasuring = false;
+    }
+    return 0;
+  }
+
+  if (isTempHumAddressed(address))
+  {
+    if (command == 0x2400)
+    {
+      hydraulicSim.tempHumMeasuring = true;
+      hydraulicSim.tempHumStartTime = millis();
+    }
+    return 0;
+  }
+  return 2;
+}
+
+uint8_t SimulatedWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+  updateHydraulicSim(millis());
+  rxLength = 0;
+  rxIndex = 0;
+
+  int sensorIdx = getAddressedFlowSensor(address);
+  if (sensorIdx >= 0 && hydraulicSim.troughs[sensorIdx].sensorMeasuring)
+  {
+    putSensirionWord(&rxBuffer[0], (uint16_t)(int16_t)(hydraulicSim.troughs[sensorIdx].flow * 32.0));
+    putSensirionWord(&rxBuffer[3], (uint16_t)(int16_t)(SIM_SENSOR_TEMPERATURE_C * 200.0));
+    putSensirionWord(&rxBuffer[6], 0);
+    rxLength = FLOW_SENSOR_FRAME_SIZE;
+  }
+  else if (isTempHumAddressed(address) && hydraulicSim.tempHumMeasuring &&
+           millis() - hydraulicSim.tempHumStartTime >= SIM_TEMP_HUM_CONVERSION_MS)
+  {
+    putSensirionWord(&rxBuffer[0], (uint16_t)((SIM_ENCLOSURE_TEMPERATURE_C + 45.0) / 175.0 * 65535.0));
+    putSensirionWord(&rxBuffer[3], (uint16_t)(SIM_ENCLOSURE_HUMIDITY / 100.0 * 65535.0));
+    rxLength = TEMP_HUM_FRAME_SIZE;
+    hydraulicSim.tempHumMeasuring = false;
+  }
+
+  if (rxLength > quantity)
+  {
+    rxLength = quantity;
+  }
+  return rxLength;
+}
+
+int SimulatedWire::available()
+{
+  return rxLength - rxIndex;
+}
+
+int SimulatedWire::read()
+{
+  return (rxIndex < rxLength) ? rxBuffer[rxIndex++] : -1;
+}
+
+// ============================================================
+// Scenarios
+// ============================================================
+
+#define SIM_SETUP_PRIMED 0x01 // Reagent lines already primed
+#define SIM_SETUP_FULL 0x02   // Troughs at SIM_SCENARIO_TROUGH_ML
+
+struct SimScenarioOp
+{
+  uint8_t type;   // ScheduledOpType
+  uint8_t trough; // 1-4
+  uint8_t volume; // mL, dispense only
+};
+
+struct SimScenario
+{
+  const char *name;
+  const char *description;
+  uint8_t setup;       // SIM_SETUP_* bits
+  uint8_t faultTrough; // 1-4, 0 = none
+  uint8_t fault;       // SIM_FAULT_* bit
+  uint8_t opCount;
+  SimScenarioOp ops[SIM_SCENARIO_MAX_OPS];
+};
+
+static const SimScenario SIM_SCENARIOS[] = {
+    {"dispense", "D 25 mL on all troughs", SIM_SETUP_PRIMED, 0, 0, 4,
+     {{SCHED_OP_DISPENSE, 1, 25}, {SCHED_OP_DISPENSE, 2, 25}, {SCHED_OP_DISPENSE, 3, 25}, {SCHED_OP_DISPENSE, 4, 25}}},
+    {"prime", "P on all troughs, lines empty", 0, 0, 0, 4,
+     {{SCHED_OP_PRIME, 1, 0}, {SCHED_OP_PRIME, 2, 0}, {SCHED_OP_PRIME, 3, 0}, {SCHED_OP_PRIME, 4, 0}}},
+    {"fill", "F on all troughs until the first overflow", SIM_SETUP_PRIMED, 0, 0, 4,
+     {{SCHED_OP_FILL, 1, 0}, {SCHED_OP_FILL, 2, 0}, {SCHED_OP_FILL, 3, 0}, {SCHED_OP_FILL, 4, 0}}},
+    {"drain", "DT on all troughs", SIM_SETUP_PRIMED | SIM_SETUP_FULL, 0, 0, 4,
+     {{SCHED_OP_DRAIN, 1, 0}, {SCHED_OP_DRAIN, 2, 0}, {SCHED_OP_DRAIN, 3, 0}, {SCHED_OP_DRAIN, 4, 0}}},
+    {"cycle", "P, D 50 mL, DT on troughs 1 and 3", 0, 0, 0, 6,
+     {{SCHED_OP_PRIME, 1, 0}, {SCHED_OP_PRIME, 3, 0}, {SCHED_OP_DISPENSE, 1, 50}, {SCHED_OP_DISPENSE, 3, 50},
+      {SCHED_OP_DRAIN, 1, 0}, {SCHED_OP_DRAIN, 3, 0}}},
+    {"noreagent", "P 1 with an empty reagent bottle (no-liquid timeout)", 0, 1, SIM_FAULT_REAGENT, 1,
+     {{SCHED_OP_PRIME, 1, 0}}},
+    {"noflow", "D 1 with a blocked line (flow timeout)", SIM_SETUP_PRIMED, 1, SIM_FAULT_LINE, 1,
+     {{SCHED_OP_DISPENSE, 1, 25}}},
+    {"nodrain", "DT 1 with a blocked drain (initiation timeout)", SIM_SETUP_PRIMED | SIM_SETUP_FULL, 1, SIM_FAULT_DRAIN, 1,
+     {{SCHED_OP_DRAIN, 1, 0}}}};
+
+#define SIM_SCENARIO_COUNT (sizeof(SIM_SCENARIOS) / sizeof(SIM_SCENARIOS[0]))
+
+static const SimScenario *activeScenario = NULL;
+
+bool setHydraulicSimFault(int trough, const char *type)
+{
+  uint8_t &faults = hydraulicSim.troughs[trough - 1].faults;
+  if (strcmp(type, "none") == 0)
+  {
+    faults = 0;
+    return true;
+  }
+  for (uint8_t f = 0; f < SIM_FAULT_TYPE_COUNT; f++)
+  {
+    if (strcmp(type, SIM_FAULT_NAMES[f]) == 0)
+    {
+      updateHydraulicSim(millis());
+      faults |= (1 << f);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool startHydraulicSimScenario(const char *name, Stream *stream)
+{
+  const SimScenario *scenario = NULL;
+  for (uint8_t s = 0; s < SIM_SCENARIO_COUNT; s++)
+  {
+    if (strcmp(name, SIM_SCENARIOS[s].name) == 0)
+    {
+      scenario = &SIM_SCENARIOS[s];
+      break;
+    }
+  }
+  if (scenario == NULL)
+  {
+    sendMessage(F("[ERROR] Unknown scenario. Use SIM run to list them."), stream, currentClient);
+    return false;
+  }
+
+  if (operationBatch.running)
+  {
+    sendMessage(F("[ERROR] Batch is running. Wait for it to finish or use SCHED abort."), stream, currentClient);
+    return false;
+  }
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    const ValveControl &vc = valveControls[i];
+    if (vc.isDispensing || vc.isPriming || vc.fillMode || vc.isDraining)
+    {
+      sendMessage(F("[ERROR] Troughs must be idle to start a scenario."), stream, currentClient);
+      return false;
+    }
+  }
+
+  resetHydraulicSim(scenario->setup & SIM_SETUP_PRIMED, (scenario->setup & SIM_SETUP_FULL) ? SIM_SCENARIO_TROUGH_ML : 0.0);
+  if (scenario->faultTrough > 0)
+  {
+    hydraulicSim.troughs[scenario->faultTrough - 1].faults = scenario->fault;
+  }
+  if (!pressureRegulator.enabled)
+  {
+    proportionalValve = setValvePosition(proportionalValve, SIM_SCENARIO_VALVE_PERCENT);
+  }
+
+  clearOperationBatch();
+  for (uint8_t n = 0; n < scenario->opCount; n++)
+  {
+    const SimScenarioOp &op = scenario->ops[n];
+    addScheduledOperation((ScheduledOpType)op.type, op.trough, op.volume, stream);
+  }
+  if (!startOperationBatch(stream))
+  {
+    return false;
+  }
+
+  activeScenario = scenario;
+  sendMessage(F("[MESSAGE] Simulation scenario started: "), stream, currentClient, false);
+  sendMessage(scenario->description, stream, currentClient);
+  return true;
+}
+
+void serviceHydraulicSim(unsigned long currentTime)
+{
+  updateHydraulicSim(currentTime);
+
+  if (activeScenario == NULL)
+  {
+    return;
+  }
+  Stream *stream = hasActiveClient ? (Stream *)&currentClient : (Stream *)&Serial;
+
+  // Fill runs until stopped: stop it once the trough is full, as the host would
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    if (valveControls[i].fillMode && hydraulicSim.troughs[i].volume >= SIM_TROUGH_OVERFLOW_ML)
+    {
+      disableFillMode(i + 1, stream);
+      stopDispenseOperation(i + 1, stream);
+    }
+  }
+
+  if (!operationBatch.running)
+  {
+    sendMessage(F("[MESSAGE] Simulation scenario finished: "), stream, currentClient, false);
+    sendMessage(activeScenario->name, stream, currentClient);
+    activeScenario = NULL;
+    printHydraulicSim(stream);
+  }
+}
+
+// ============================================================
+// Reporting
+// ============================================================
+
+void printHydraulicSimScenarios(Stream *stream)
+{
+  char line[80];
+  sendMessage(F("[INFO] Simulation scenarios (SIM run <name>):"), stream, currentClient);
+  for (uint8_t s = 0; s < SIM_SCENARIO_COUNT; s++)
+  {
+    snprintf(line, sizeof(line), "  %-9s %s", SIM_SCENARIOS[s].name, SIM_SCENARIOS[s].description);
+    sendMessage(line, stream, currentClient);
+  }
+}
+
+void printHydraulicSim(Stream *stream)
+{
+  char line[80];
+  char pressureStr[8];
+
+  updateHydraulicSim(millis());
+  dtostrf(hydraulicSim.pressure, 1, 1, pressureStr);
+  snprintf(line, sizeof(line), "[INFO] Simulation: supply %s psi%s", pressureStr,
+           activeScenario ? ", scenario running" : "");
+  sendMessage(line, stream, currentClient);
+
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    const SimTrough &trough = hydraulicSim.troughs[i];
+    char volumeStr[8], lineStr[8], flowStr[8];
+    dtostrf(trough.volume, 1, 1, volumeStr);
+    dtostrf(trough.lineFill, 1, 1, lineStr);
+    dtostrf(trough.flow, 1, 1, flowStr);
+    snprintf(line, sizeof(line), "  Trough %d: %s mL, line %s mL, flow %s mL/min, faults 0x%02X", i + 1, volumeStr,
+             lineStr, flowStr, trough.faults);
+    sendMessage(line, stream, currentClient);
+  }
+
+  for (int b = 0; b < NUM_WASTE_BOTTLE_SENSORS; b++)
+  {
+    char volumeStr[8];
+    dtostrf(hydraulicSim.bottles[b].volume, 1, 0, volumeStr);
+    snprintf(line, sizeof(line), "  Bottle %d: %s mL, vacuum %d%%", b + 1, volumeStr,
+             (int)(hydraulicSim.bottles[b].vacuum * 100.0));
+    sendMessage(line, stream, currentClient);
+  }
+}
+
+#endif // HYDRAULIC_SIM
@@ -0,0 +1,160 @@
+#ifndef HYDRAULICSIM_H
+#define HYDRAULICSIM_H
+
+#include <Controllino.h>
+#include <Wire.h>
+#include "Hardware.h"
+
+/************************************************************
+ * HydraulicSim.h
+ *
+ * Hydraulic simulation build of the Bulk Dispense firmware, for
+ * testing the monitors and measuring cycle times without liquid
+ * on the instrument. Compile with -DHYDRAULIC_SIM=1; the
+ * production build is unchanged.
+ *
+ * In the simulation build no valve, pressure or I2C device is
+ * driven. Instead a plant model tracks:
+ *
+ * - Supply pressure from the proportional valve position
+ * - Flow through each trough's reagent and media valve path as
+ *   a function of supply pressure
+ * - Reagent line priming (bubble sensor) and trough volume
+ *   (overflow sensor)
+ * - Waste bottle volume, bottle vacuum, drain flow and the waste
+ *   line sensors
+ *
+ * The flow sensors, SHT31 and multiplexer are emulated at the
+ * I2C transaction level (SimulatedWire), so the acquisition,
+ * CRC and recovery paths run unchanged.
+ *
+ * Scripted scenarios (SIM run <name>) set up the plant, inject
+ * faults and load a batch into the operation scheduler, which
+ * reports per-operation times and the makespan. The model has
+ * no noise, so timeouts fire the same way on every run.
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+#ifndef HYDRAULIC_SIM
+#define HYDRAULIC_SIM 0
+#endif
+
+// Device I2C traffic goes through I2C_BUS
+#if HYDRAULIC_SIM
+#define I2C_BUS simWire
+#else
+#define I2C_BUS Wire
+#endif
+
+#if HYDRAULIC_SIM
+
+// ============================================================
+// Plant Model Configuration
+// ============================================================
+
+#define SIM_SUPPLY_MAX_PSI 40.0            // Supply pressure at 100% valve, no load
+#define SIM_PRESSURE_DROP_PER_PATH_PSI 1.5 // Supply sag per open trough path
+#define SIM_PRESSURE_TAU_MS 250            // Supply response time constant
+#define SIM_REAGENT_FLOW_PER_PSI 2.5       // mL/min per psi through an open reagent valve
+#define SIM_MEDIA_FLOW_PER_PSI 2.5         // mL/min per psi through an open media valve
+#define SIM_FLOW_TAU_MS 80                 // Flow response to valve and pressure changes
+#define SIM_LINE_VOLUME_ML 3.0             // Reagent line volume up to the bubble sensor
+#define SIM_TROUGH_OVERFLOW_ML 200.0       // Overflow sensor trips at this volume
+#define SIM_DRAIN_FLOW_ML_MIN 600.0        // Drain flow at full bottle vacuum
+#define SIM_VACUUM_BUILD_MS 1000           // Bottle vacuum build-up time constant
+#define SIM_VACUUM_RELEASE_MS 1500         // Bottle vacuum release time constant (vented)
+#define SIM_BOTTLE_FULL_ML 1800.0          // Waste bottle sensor trips at this volume
+#define SIM_SENSOR_TEMPERATURE_C 23.0      // Flow sensor liquid temperature
+#define SIM_ENCLOSURE_TEMPERATURE_C 25.0
+#define SIM_ENCLOSURE_HUMIDITY 40.0
+#define SIM_TEMP_HUM_CONVERSION_MS 15      // SHT31 NACKs reads until the conversion is done
+
+// Scenario setup
+#define SIM_SCENARIO_VALVE_PERCENT 60.0 // Proportional valve position unless PR is regulating
+#define SIM_SCENARIO_TROUGH_ML 150.0    // Trough volume before drain scenarios
+#define SIM_SCENARIO_MAX_OPS 6
+
+// Faults, per trough (SIM fault <1-4> <type>)
+#define SIM_FAULT_REAGENT 0x01 // Reagent bottle empty: no reagent flow, bubble sensor dry
+#define SIM_FAULT_LINE 0x02    // Trough line blocked: no flow through either valve
+#define SIM_FAULT_SENSOR 0x04  // Flow sensor does not answer on the bus
+#define SIM_FAULT_DRAIN 0x08   // Drain line blocked
+#define SIM_FAULT_VACUUM 0x10  // The trough's waste bottle does not vent
+
+// ============================================================
+// Simulation Structures
+// ============================================================
+
+struct SimTrough
+{
+  float volume;         // mL in the trough
+  float lineFill;       // mL in the reagent line (primed at SIM_LINE_VOLUME_ML)
+  float flow;           // mL/min through the flow sensor
+  float drainFlow;      // mL/min into the waste line
+  bool sensorMeasuring; // Emulated SLF3S continuous measurement running
+  uint8_t faults;       // SIM_FAULT_* bits
+};
+
+struct SimBottle
+{
+  float volume; // mL
+  float vacuum; // 0 = vented, 1 = full vacuum
+};
+
+struct HydraulicSimState
+{
+  SimTrough troughs[NUM_OVERFLOW_SENSORS];
+  SimBottle bottles[NUM_WASTE_BOTTLE_SENSORS];
+  float pressure;        // psi
+  uint8_t muxChannels;   // Emulated multiplexer channel mask
+  bool tempHumMeasuring; // Emulated SHT31 conversion in progress
+  unsigned long tempHumStartTime;
+  unsigned long lastUpdateTime;
+};
+
+// Stand-in for Wire with the calls the device code uses; answers
+// for the multiplexer, flow sensors and SHT31 from the plant model
+class SimulatedWire
+{
+public:
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  uint8_t endTransmission();
+  uint8_t requestFrom(uint8_t address, uint8_t quantity);
+  int available();
+  int read();
+
+private:
+  uint8_t address;
+  uint8_t txBuffer[2];
+  uint8_t txLength;
+  uint8_t rxBuffer[FLOW_SENSOR_FRAME_SIZE];
+  uint8_t rxLength;
+  uint8_t rxIndex;
+};
+
+// ============================================================
+// Global Variables
+// ============================================================
+extern HydraulicSimState hydraulicSim;
+extern SimulatedWire simWire;
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+void resetHydraulicSim(bool linesPrimed, float troughVolume);
+void updateHydraulicSim(unsigned long currentTime); // Integrate the plant up to now
+void serviceHydraulicSim(unsigned long currentTime); // Call every loop
+bool simReadBinarySensor(const BinarySensor &sensor);
+float simReadPressureVoltage(const PressureSensor &sensor);
+bool setHydraulicSimFault(int trough, const char *type);
+bool startHydraulicSimScenario(const char *name, Stream *stream);
+void printHydraulicSimScenarios(Stream *stream);
+void printHydraulicSim(Stream *stream);
+
+#endif // HYDRAULIC_SIM
+
+#endif // HYDRAULICSIM_H
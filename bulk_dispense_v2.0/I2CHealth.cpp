@@ -0,0 +1,331 @@
+#include "I2CHealth.h"
+#include <Wire.h>
+#include "Logging.h"
+#include "Sensors.h"
+
+/************************************************************
+ * I2CHealth.cpp
+ *
+ * Implements the I2C health manager declared in I2CHealth.h:
+ *
+ * 1. Error reporting: per-device counters and episode start
+ * 2. Recovery: staged backoff / soft reset / reinitialize steps
+ * 3. Bus clear: SCL clock pulsing and STOP generation
+ * 4. Reporting: per-device health status
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+I2CDeviceHealth i2cDeviceHealth[I2C_DEVICE_COUNT];
+
+static bool busClearPending = false;
+static unsigned long lastBusClearTime = 0;
+static uint16_t busClearCount = 0;
+
+static const char *const I2C_DEVICE_NAMES[I2C_DEVICE_COUNT] = {"FLOW1", "FLOW2", "FLOW3", "FLOW4", "SHT31"};
+static const char *const I2C_STATE_NAMES[] = {"HEALTHY", "BACKOFF", "RESET", "START", "VERIFY", "FAILED"};
+
+// ============================================================
+// Error Reporting
+// ============================================================
+
+void initializeI2CHealth()
+{
+  for (uint8_t device = 0; device < I2C_DEVICE_COUNT; device++)
+  {
+    memset(&i2cDeviceHealth[device], 0, sizeof(I2CDeviceHealth));
+  }
+  busClearPending = false;
+  busClearCount = 0;
+
+#if defined(WIRE_HAS_TIMEOUT)
+  // A stuck bus must not hang the loop inside Wire
+  Wire.setWireTimeout(I2C_WIRE_TIMEOUT_US, true);
+#endif
+}
+
+static void printDeviceMessage(uint8_t level, const __FlashStringHelper *prefix, uint8_t device,
+                               const __FlashStringHelper *suffix)
+{
+  if (!LOG_ENABLED(level))
+  {
+    return;
+  }
+  sendLogMessage(level, prefix, false);
+  sendLogMessage(level, I2C_DEVICE_NAMES[device], false);
+  sendLogMessage(level, suffix);
+}
+
+static void giveUpRecovery(uint8_t device, unsigned long currentTime)
+{
+  I2CDeviceHealth &health = i2cDeviceHealth[device];
+  health.state = I2C_DEVICE_FAILED;
+  health.failures++;
+
+  if (device == I2C_DEVICE_TEMP_HUM)
+  {
+    health.stepTime = currentTime + I2C_TEMP_HUM_RETRY_MS;
+  }
+  else
+  {
+    // Same end state as before: the connection monitor reinitializes it later
+    FlowSensor &sensor = *flowSensors[device];
+    sensor.sensorInitialized = false;
+    sensor.sensorStopped = true;
+    sensor.sensorConnected = 0;
+  }
+  printDeviceMessage(LOG_LEVEL_ERROR, F("[ERROR] I2C device "), device, F(" did not recover. Marked as failed."));
+}
+
+static void scheduleRecoveryAttempt(uint8_t device, unsigned long currentTime)
+{
+  I2CDeviceHealth &health = i2cDeviceHealth[device];
+  if (++health.attempts > I2C_MAX_RECOVERY_ATTEMPTS)
+  {
+    giveUpRecovery(device, currentTime);
+    return;
+  }
+  health.state = I2C_DEVICE_BACKOFF;
+  health.stepTime = currentTime + ((unsigned long)I2C_BACKOFF_BASE_MS << (health.attempts - 1));
+}
+
+void reportI2CError(uint8_t device, unsigned long currentTime)
+{
+  I2CDeviceHealth &health = i2cDeviceHealth[device];
+  health.totalErrors++;
+  health.lastErrorTime = currentTime;
+
+  // Several devices failing together: suspect the bus, not the devices
+  uint8_t failingDevices = 0;
+  for (uint8_t d = 0; d < I2C_DEVICE_COUNT; d++)
+  {
+    if (i2cDeviceHealth[d].totalErrors > 0 &&
+        currentTime - i2cDeviceHealth[d].lastErrorTime <= I2C_BUS_ERROR_WINDOW_MS)
+    {
+      failingDevices++;
+    }
+  }
+  if (failingDevices >= 2 && currentTime - lastBusClearTime >= I2C_BUS_CLEAR_MIN_INTERVAL_MS)
+  {
+    busClearPending = true;
+  }
+
+  if (health.state == I2C_DEVICE_VERIFY)
+  {
+    scheduleRecoveryAttempt(device, currentTime);
+    return;
+  }
+  if (health.state != I2C_DEVICE_HEALTHY)
+  {
+    return;
+  }
+
+  if (++health.consecutiveErrors >= I2C_ERROR_THRESHOLD)
+  {
+    printDeviceMessage(LOG_LEVEL_WARNING, F("[WARNING] I2C device "), device, F(" failing. Starting recovery."));
+    health.attempts = 0;
+    scheduleRecoveryAttempt(device, currentTime);
+  }
+}
+
+void reportI2CSuccess(uint8_t device)
+{
+  I2CDeviceHealth &health = i2cDeviceHealth[device];
+  if (health.state == I2C_DEVICE_VERIFY)
+  {
+    health.recoveries++;
+    printDeviceMessage(LOG_LEVEL_MESSAGE, F("[MESSAGE] I2C device "), device, F(" recovered."));
+  }
+  health.state = I2C_DEVICE_HEALTHY;
+  health.consecutiveErrors = 0;
+  health.attempts = 0;
+}
+
+void resetI2CDeviceHealth(uint8_t device)
+{
+  I2CDeviceHealth &health = i2cDeviceHealth[device];
+  health.state = I2C_DEVICE_HEALTHY;
+  health.consecutiveErrors = 0;
+  health.attempts = 0;
+}
+
+bool isI2CDeviceRecovering(uint8_t device)
+{
+  uint8_t state = i2cDeviceHealth[device].state;
+  return state == I2C_DEVICE_BACKOFF || state == I2C_DEVICE_RESET_WAIT || state == I2C_DEVICE_START_WAIT;
+}
+
+// ============================================================
+// Recovery
+// ============================================================
+
+// One bus transaction at most
+static void runRecoveryStep(uint8_t device, unsigned long currentTime)
+{
+  I2CDeviceHealth &health = i2cDeviceHealth[device];
+  bool isTempHum = (device == I2C_DEVICE_TEMP_HUM);
+
+  switch (health.state)
+  {
+  case I2C_DEVICE_FAILED:
+    // Only the SHT31 gets here (flow sensors wait for reinitialization)
+    health.attempts = 0;
+    scheduleRecoveryAttempt(device, currentTime);
+    break;
+
+  case I2C_DEVICE_BACKOFF:
+    if (isTempHum ? softResetTempHumSensor() : softResetFlowSensor(*flowSensors[device]))
+    {
+      health.state = I2C_DEVICE_RESET_WAIT;
+      health.stepTime = currentTime + (isTempHum ? I2C_TEMP_HUM_RESET_MS : I2C_FLOW_RESET_MS);
+    }
+    else
+    {
+      scheduleRecoveryAttempt(device, currentTime);
+    }
+    break;
+
+  case I2C_DEVICE_RESET_WAIT:
+    if (isTempHum)
+    {
+      health.state = I2C_DEVICE_VERIFY; // Single-shot sensor: nothing to restart
+    }
+    else if (resumeFlowSensorMeasurement(*flowSensors[device]))
+    {
+      health.state = I2C_DEVICE_START_WAIT;
+      health.stepTime = currentTime + I2C_FLOW_START_MS;
+    }
+    else
+    {
+      scheduleRecoveryAttempt(device, currentTime);
+    }
+    break;
+
+  case I2C_DEVICE_START_WAIT:
+    health.state = I2C_DEVICE_VERIFY;
+    break;
+
+  default:
+    break;
+  }
+}
+
+bool serviceI2CRecovery(unsigned long currentTime)
+{
+#if defined(WIRE_HAS_TIMEOUT)
+  if (Wire.getWireTimeoutFlag())
+  {
+    Wire.clearWireTimeoutFlag();
+    busClearPending = true;
+  }
+#endif
+
+  if (busClearPending)
+  {
+    busClearPending = false;
+    lastBusClearTime = currentTime;
+    busClearCount++;
+    sendLogMessage(LOG_LEVEL_WARNING, F("[WARNING] I2C bus fault suspected. Clearing the bus."));
+    clearI2CBus();
+    return true;
+  }
+
+  for (uint8_t device = 0; device < I2C_DEVICE_COUNT; device++)
+  {
+    I2CDeviceHealth &health = i2cDeviceHealth[device];
+    bool stepping = isI2CDeviceRecovering(device) ||
+                    (health.state == I2C_DEVICE_FAILED && device == I2C_DEVICE_TEMP_HUM);
+    if (!stepping)
+    {
+      continue;
+    }
+
+    // A flow sensor stopped by a command mid-recovery needs no more recovery
+    if (device != I2C_DEVICE_TEMP_HUM &&
+        (!flowSensors[device]->sensorInitialized || flowSensors[device]->sensorStopped))
+    {
+      resetI2CDeviceHealth(device);
+      continue;
+    }
+
+    if ((long)(currentTime - health.stepTime) >= 0)
+    {
+      runRecoveryStep(device, currentTime);
+      return true;
+    }
+  }
+  return false;
+}
+
+// ============================================================
+// Bus Clear
+// ============================================================
+
+// Open-drain emulation: drive low, or release to the pull-up
+static void setI2CLine(uint8_t pin, bool high)
+{
+  if (high)
+  {
+    pinMode(pin, INPUT_PULLUP);
+  }
+  else
+  {
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
+  }
+  delayMicroseconds(5);
+}
+
+// A slave stopped mid-byte holds SDA low; up to nine clocks let it finish,
+// then a STOP returns the bus to idle. Takes well under a millisecond.
+void clearI2CBus()
+{
+  Wire.end();
+
+  setI2CLine(SDA, true);
+  setI2CLine(SCL, true);
+  for (uint8_t pulse = 0; pulse < 9 && digitalRead(SDA) == LOW; pulse++)
+  {
+    setI2CLine(SCL, false);
+    setI2CLine(SCL, true);
+  }
+
+  // STOP: SDA rises while SCL is high
+  setI2CLine(SCL, false);
+  setI2CLine(SDA, false);
+  setI2CLine(SCL, true);
+  setI2CLine(SDA, true);
+
+  Wire.begin();
+#if defined(WIRE_HAS_TIMEOUT)
+  Wire.setWireTimeout(I2C_WIRE_TIMEOUT_US, true);
+#endif
+  invalidateMultiplexerChannel();
+}
+
+// ============================================================
+// Reporting
+// ============================================================
+
+void printI2CHealth(Stream *stream)
+{
+  char line[80];
+
+  stream->print(F("[INFO] I2C bus clears: "));
+  stream->println(busClearCount);
+
+  for (uint8_t device = 0; device < I2C_DEVICE_COUNT; device++)
+  {
+    const I2CDeviceHealth &health = i2cDeviceHealth[device];
+    snprintf(line, sizeof(line), "  %-5s %-7s errors %u (%u in a row), attempt %u/%u, recovered %u, failed %u",
+             I2C_DEVICE_NAMES[device], I2C_STATE_NAMES[health.state], health.totalErrors,
+             health.consecutiveErrors, health.attempts, I2C_MAX_RECOVERY_ATTEMPTS, health.recoveries,
+             health.failures);
+    stream->println(line);
+  }
+}
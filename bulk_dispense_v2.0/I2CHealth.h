@@ -0,0 +1,93 @@
+#ifndef I2CHEALTH_H
+#define I2CHEALTH_H
+
+#include <Controllino.h>
+#include "Hardware.h"
+
+/************************************************************
+ * I2CHealth.h
+ *
+ * Asynchronous I2C health manager for the flow sensors and the
+ * SHT31. Read failures are reported here instead of being
+ * handled inline; a device with consecutive errors is taken out
+ * of the sampling rotation and recovered in steps spread over
+ * loop ticks, so the other channels keep sampling:
+ *
+ * 1. Backoff: wait (doubling with every attempt)
+ * 2. Soft reset: reset command on the device's mux channel
+ * 3. Reinitialize: restart continuous measurement (flow sensors)
+ * 4. Verify: the next good sample ends the recovery
+ *
+ * A device that does not recover after I2C_MAX_RECOVERY_ATTEMPTS
+ * is marked failed. Errors on several devices at once, or a
+ * Wire timeout, point at the bus itself: it is cleared by
+ * clocking SCL until SDA is released and sending a STOP.
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// I2C Health Configuration
+// ============================================================
+
+#define I2C_ERROR_THRESHOLD 2            // Consecutive errors that start a recovery
+#define I2C_MAX_RECOVERY_ATTEMPTS 5
+#define I2C_BACKOFF_BASE_MS 20           // First backoff; doubles with every attempt
+#define I2C_FLOW_RESET_MS 25             // SLF3S start-up time after a soft reset
+#define I2C_FLOW_START_MS 12             // SLF3S time to the first measurement
+#define I2C_TEMP_HUM_RESET_MS 2          // SHT31 soft reset time
+#define I2C_TEMP_HUM_RETRY_MS 30000      // Failed SHT31: start over after this long
+#define I2C_BUS_ERROR_WINDOW_MS 50       // Errors on 2+ devices within this window clear the bus
+#define I2C_BUS_CLEAR_MIN_INTERVAL_MS 1000
+#define I2C_WIRE_TIMEOUT_US 25000        // Wire transaction timeout (cores that support it)
+
+// Device IDs: flow sensors 0-3 share the trough index
+#define I2C_DEVICE_TEMP_HUM NUM_FLOW_SENSORS
+#define I2C_DEVICE_COUNT (NUM_FLOW_SENSORS + 1)
+
+// ============================================================
+// I2C Health Structures
+// ============================================================
+
+enum I2CDeviceState
+{
+  I2C_DEVICE_HEALTHY,
+  I2C_DEVICE_BACKOFF,     // Waiting before the soft reset
+  I2C_DEVICE_RESET_WAIT,  // Soft reset sent
+  I2C_DEVICE_START_WAIT,  // Measurement restarted, waiting for the first sample
+  I2C_DEVICE_VERIFY,      // Back in rotation; next sample decides
+  I2C_DEVICE_FAILED
+};
+
+struct I2CDeviceHealth
+{
+  uint8_t state;             // I2CDeviceState
+  uint8_t consecutiveErrors;
+  uint8_t attempts;          // Recovery attempts in the current episode
+  uint16_t totalErrors;
+  uint16_t recoveries;       // Episodes that ended with a good sample
+  uint16_t failures;         // Episodes given up
+  unsigned long stepTime;    // When the next recovery step is due
+  unsigned long lastErrorTime;
+};
+
+// ============================================================
+// Global Variables
+// ============================================================
+extern I2CDeviceHealth i2cDeviceHealth[I2C_DEVICE_COUNT];
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+void initializeI2CHealth();
+void reportI2CError(uint8_t device, unsigned long currentTime);
+void reportI2CSuccess(uint8_t device);
+void resetI2CDeviceHealth(uint8_t device);
+bool isI2CDeviceRecovering(uint8_t device); // Out of the sampling rotation
+bool serviceI2CRecovery(unsigned long currentTime); // True if it used the bus this call
+void clearI2CBus();
+void printI2CHealth(Stream *stream);
+
+#endif // I2CHEALTH_H
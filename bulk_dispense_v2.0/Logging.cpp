@@ -23,6 +23,108 @@
 // ============================================================
 LoggingManagement logging = {0, 250}; // Default log interval: 250 ms
 
+// Runtime threshold per sink (LOG_SINK_SERIAL, LOG_SINK_NETWORK)
+uint8_t logSinkLevels[LOG_SINK_COUNT] = {LOG_DEFAULT_SERIAL_LEVEL, LOG_DEFAULT_NETWORK_LEVEL};
+
+static const char *const LOG_LEVEL_NAMES[] = {"OFF", "ERROR", "WARNING", "MESSAGE", "DEBUG"};
+
+// ============================================================
+// Leveled Messages
+// ============================================================
+// Line state per sink: pieces printed without a newline belong to the
+// line their first piece started, and are shown or dropped with it
+static bool sinkLineOpen[LOG_SINK_COUNT] = {false, false};
+static bool sinkLineShown[LOG_SINK_COUNT] = {true, true};
+
+static bool isNetworkSinkActive(uint8_t level)
+{
+  return level <= logSinkLevels[LOG_SINK_NETWORK] && hasActiveClient && currentClient.connected();
+}
+
+bool isLogLevelActive(uint8_t level)
+{
+  return level <= logSinkLevels[LOG_SINK_SERIAL] || isNetworkSinkActive(level);
+}
+
+bool acceptSinkOutput(LogSink sink, uint8_t level, bool addNewline)
+{
+  if (!sinkLineOpen[sink])
+  {
+    sinkLineShown[sink] = level <= logSinkLevels[sink];
+  }
+  sinkLineOpen[sink] = !addNewline;
+  return sinkLineShown[sink];
+}
+
+static uint8_t getTagLevel(const char *tag)
+{
+  if (strncmp(tag, "[ERROR]", 7) == 0)
+    return LOG_LEVEL_ERROR;
+  if (strncmp(tag, "[WARNING]", 9) == 0)
+    return LOG_LEVEL_WARNING;
+  if (strncmp(tag, "[MESSAGE]", 9) == 0 || strncmp(tag, "[INFO]", 6) == 0)
+    return LOG_LEVEL_MESSAGE;
+  if (strncmp(tag, "[DEBUG]", 7) == 0)
+    return LOG_LEVEL_DEBUG;
+  return LOG_LEVEL_OFF; // Untagged lines are always sent
+}
+
+uint8_t getMessageLevel(const char *message)
+{
+  return (message && message[0] == '[') ? getTagLevel(message) : LOG_LEVEL_OFF;
+}
+
+uint8_t getMessageLevel(const __FlashStringHelper *message)
+{
+  char tag[10];
+  strncpy_P(tag, (const char *)message, sizeof(tag) - 1);
+  tag[sizeof(tag) - 1] = '\0';
+  return getMessageLevel(tag);
+}
+
+void sendLogMessage(uint8_t level, const char *message, bool addNewline)
+{
+  if (acceptSinkOutput(LOG_SINK_SERIAL, level, addNewline))
+  {
+    if (addNewline)
+      Serial.println(message);
+    else
+      Serial.print(message);
+  }
+  if (hasActiveClient && currentClient.connected() && acceptSinkOutput(LOG_SINK_NETWORK, level, addNewline))
+  {
+    if (addNewline)
+      currentClient.println(message);
+    else
+      currentClient.print(message);
+    currentClient.flush();
+  }
+}
+
+void sendLogMessage(uint8_t level, const __FlashStringHelper *message, bool addNewline)
+{
+  if (acceptSinkOutput(LOG_SINK_SERIAL, level, addNewline))
+  {
+    if (addNewline)
+      Serial.println(message);
+    else
+      Serial.print(message);
+  }
+  if (hasActiveClient && currentClient.connected() && acceptSinkOutput(LOG_SINK_NETWORK, level, addNewline))
+  {
+    if (addNewline)
+      currentClient.println(message);
+    else
+      currentClient.print(message);
+    currentClient.flush();
+  }
+}
+
+const char *getLogLevelName(uint8_t level)
+{
+  return (level <= LOG_LEVEL_DEBUG) ? LOG_LEVEL_NAMES[level] : "UNKNOWN";
+}
+
 // ============================================================
 // logData()
 // ============================================================
@@ -19,6 +19,42 @@
  * Version: 2.0
  ************************************************************/
 
+// ============================================================
+// Message Levels
+// ============================================================
+// Lower is more important. A message is sent to a sink (Serial,
+// network client) when its level is at or below that sink's
+// runtime threshold (LOGLVL command). sendMessage() takes the level
+// from the line's tag ([ERROR], [WARNING], [MESSAGE]/[INFO], [DEBUG]);
+// untagged lines are always sent.
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_MESSAGE 3
+#define LOG_LEVEL_DEBUG 4
+
+// Levels above LOG_COMPILE_LEVEL are removed from the build entirely
+// (e.g. -DLOG_COMPILE_LEVEL=3 for a build without debug output).
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_DEFAULT_SERIAL_LEVEL LOG_LEVEL_MESSAGE
+#define LOG_DEFAULT_NETWORK_LEVEL LOG_LEVEL_MESSAGE
+
+enum LogSink
+{
+  LOG_SINK_SERIAL,
+  LOG_SINK_NETWORK,
+  LOG_SINK_COUNT
+};
+
+// Compile-time constant check first, so disabled levels (and the
+// formatting of their arguments) are eliminated by the compiler
+#define LOG_ENABLED(level) ((level) <= LOG_COMPILE_LEVEL && isLogLevelActive(level))
+
+#define LOG_DEBUG(message) do { if (LOG_ENABLED(LOG_LEVEL_DEBUG)) sendLogMessage(LOG_LEVEL_DEBUG, message); } while (0)
+
 // ============================================================
 // Logging Management Structure
 // ============================================================
@@ -31,6 +67,7 @@ struct LoggingManagement {
 // Global Logging Instance
 // ============================================================
 extern LoggingManagement logging;
+extern uint8_t logSinkLevels[LOG_SINK_COUNT];
 
 // ============================================================
 // Logging Function Prototypes
@@ -48,6 +85,29 @@ void logData(const char* module, const char* message);
 
 const char* getFlowDiagString(const FlowSensor &sensor, bool isDispensing);
 
+/**
+ * isLogLevelActive() / sendLogMessage()
+ * -------------------------------------
+ * Leveled messages. Use LOG_ENABLED()/LOG_DEBUG() rather than calling
+ * these directly so disabled levels compile away.
+ */
+bool isLogLevelActive(uint8_t level);
+void sendLogMessage(uint8_t level, const char *message, bool addNewline = true);
+void sendLogMessage(uint8_t level, const __FlashStringHelper *message, bool addNewline = true);
+const char *getLogLevelName(uint8_t level);
+
+/**
+ * getMessageLevel() / acceptSinkOutput()
+ * --------------------------------------
+ * Level of a message from its tag (LOG_LEVEL_OFF when untagged), and
+ * whether a piece of output at that level goes to the sink. A piece
+ * printed without a newline carries the line on, so the rest of the
+ * line follows the decision made for its first piece.
+ */
+uint8_t getMessageLevel(const char *message);
+uint8_t getMessageLevel(const __FlashStringHelper *message);
+bool acceptSinkOutput(LogSink sink, uint8_t level, bool addNewline);
+
 /**
  * logSystemState()
  * ----------------
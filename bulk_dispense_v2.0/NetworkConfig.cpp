@@ -1,5 +1,6 @@
 #include "NetworkConfig.h"
 #include "Commands.h"
+#include "Utils.h"
 #include <Controllino.h>
 
 // Network configuration
@@ -11,7 +12,6 @@ const uint16_t TCP_PORT = 8080;
 EthernetServer tcpServer(TCP_PORT);
 EthernetClient currentClient;
 bool hasActiveClient = false;
-String currentCommand = "";
 
 void initializeNetwork()
 {
@@ -45,6 +45,7 @@ void handleTcpConnections()
         {
             currentClient = newClient;
             hasActiveClient = true;
+            resetNetworkCommandBuffer();
             Serial.println(F("[MESSAGE] New client connected"));
         }
     }
@@ -0,0 +1,371 @@
+#include "OperationRecorder.h"
+#include <math.h>
+#include "Logging.h"
+#include "Sensors.h"
+
+/************************************************************
+ * OperationRecorder.cpp
+ *
+ * Implements the operation recorder declared in
+ * OperationRecorder.h:
+ *
+ * 1. Recording: start, sample and finish per operation
+ * 2. Adaptive downsampling: deadband filter and compaction
+ * 3. Export: recording list and per-operation point dump
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+static OperationRecording recordings[REC_MAX_RECORDINGS];
+static uint16_t nextRecordingId = 1;
+
+// Operations left unrecorded for lack of a slot, per trough and type;
+// cleared when the operation ends so the warning is sent once per operation
+static bool notRecorded[NUM_OVERFLOW_SENSORS][REC_OP_DRAIN + 1];
+
+static const char *const REC_OP_NAMES[] = {"D", "P", "F", "DT"};
+
+static OnOffValve *const REC_REAGENT_VALVES[NUM_OVERFLOW_SENSORS] = {&reagentValve1, &reagentValve2, &reagentValve3, &reagentValve4};
+static OnOffValve *const REC_MEDIA_VALVES[NUM_OVERFLOW_SENSORS] = {&mediaValve1, &mediaValve2, &mediaValve3, &mediaValve4};
+static OnOffValve *const REC_WASTE_VALVES[NUM_OVERFLOW_SENSORS] = {&wasteValve1, &wasteValve2, &wasteValve3, &wasteValve4};
+
+// ============================================================
+// Adaptive Downsampling
+// ============================================================
+
+// Keep the first point, every state change and every other remaining point
+static void compactRecording(OperationRecording &rec)
+{
+  uint8_t kept = 1;
+  uint8_t previousState = rec.points[0].state;
+  for (uint8_t i = 1; i < rec.count; i++)
+  {
+    uint8_t state = rec.points[i].state;
+    if (state != previousState || i % 2 == 0)
+    {
+      rec.points[kept++] = rec.points[i];
+    }
+    previousState = state;
+  }
+  rec.count = kept;
+
+  if (rec.scale < 128)
+  {
+    rec.scale *= 2;
+  }
+}
+
+static void addRecordPoint(OperationRecording &rec, unsigned long timeMs, float flowRate, float volume,
+                           float pressure, uint8_t state, bool force)
+{
+  unsigned long offsetMs = ((long)(timeMs - rec.startTime) > 0) ? timeMs - rec.startTime : 0;
+  uint16_t timeCs = (offsetMs / 10 > 0xFFFF) ? 0xFFFF : offsetMs / 10;
+
+  if (rec.count > 0 && !force)
+  {
+    const RecordPoint &last = rec.points[rec.count - 1];
+    bool changed = state != last.state ||
+                   fabs(flowRate * 10.0 - last.flowDeci) >= REC_FLOW_DEADBAND * 10.0 * rec.scale ||
+                   fabs(pressure * 2.0 - last.pressureHalf) >= REC_PRESSURE_DEADBAND * 2.0 * rec.scale ||
+                   (unsigned long)(timeCs - last.timeCs) * 10 >= (unsigned long)REC_MAX_POINT_GAP_MS * rec.scale;
+    if (!changed)
+    {
+      return;
+    }
+  }
+
+  if (rec.count >= REC_MAX_POINTS)
+  {
+    compactRecording(rec);
+  }
+  if (rec.count >= REC_MAX_POINTS)
+  {
+    rec.count = REC_MAX_POINTS - 1; // Only state changes left: replace the newest
+  }
+
+  RecordPoint &point = rec.points[rec.count++];
+  point.timeCs = timeCs;
+  point.flowDeci = (int16_t)constrain(flowRate * 10.0, -32768.0, 32767.0);
+  point.volumeCenti = (uint16_t)constrain(volume * 100.0, 0.0, 65535.0);
+  point.pressureHalf = (uint8_t)constrain(pressure * 2.0 + 0.5, 0.0, 255.0);
+  point.state = state;
+}
+
+// ============================================================
+// Recording
+// ============================================================
+
+static bool isRecordedOpRunning(uint8_t type, int i)
+{
+  const ValveControl &vc = valveControls[i];
+  switch (type)
+  {
+  case REC_OP_DISPENSE:
+    return vc.isDispensing;
+  case REC_OP_PRIME:
+    return vc.isPriming;
+  case REC_OP_FILL:
+    return vc.fillMode;
+  default:
+    return vc.isDraining;
+  }
+}
+
+static uint8_t readRecordState(int i)
+{
+  int bottle = i / 2;
+  uint8_t state = 0;
+  if (REC_REAGENT_VALVES[i]->isOpen)
+    state |= REC_STATE_REAGENT;
+  if (REC_MEDIA_VALVES[i]->isOpen)
+    state |= REC_STATE_MEDIA;
+  if (REC_WASTE_VALVES[i]->isOpen)
+    state |= REC_STATE_WASTE;
+  if (readBinarySensor(overflowSensors[i]))
+    state |= REC_STATE_OVERFLOW;
+  if (readBinarySensor(reagentBubbleSensors[i]))
+    state |= REC_STATE_BUBBLE;
+  if (readBinarySensor(wasteLineSensors[bottle]))
+    state |= REC_STATE_LINE;
+  if (readBinarySensor(wasteVacuumSensors[bottle]))
+    state |= REC_STATE_VACUUM;
+  return state;
+}
+
+static OperationRecording *findActiveRecording(uint8_t type, int i)
+{
+  for (int r = 0; r < REC_MAX_RECORDINGS; r++)
+  {
+    if (recordings[r].active && recordings[r].type == type && recordings[r].trough == i + 1)
+    {
+      return &recordings[r];
+    }
+  }
+  return NULL;
+}
+
+// Reuses the oldest finished recording; NULL if every slot is recording
+static OperationRecording *allocateRecording()
+{
+  OperationRecording *oldest = NULL;
+  for (int r = 0; r < REC_MAX_RECORDINGS; r++)
+  {
+    OperationRecording &rec = recordings[r];
+    if (rec.active)
+      continue;
+    if (rec.id == 0)
+      return &rec;
+    if (oldest == NULL || (uint16_t)(rec.id - oldest->id) > 0x7FFF)
+      oldest = &rec;
+  }
+  return oldest;
+}
+
+static bool startRecording(uint8_t type, int i, unsigned long currentTime, float pressure, uint8_t state)
+{
+  OperationRecording *rec = allocateRecording();
+  if (rec == NULL)
+  {
+    sendLogMessage(LOG_LEVEL_WARNING, F("[WARNING] No free recording slot; operation not recorded."));
+    return false;
+  }
+
+  rec->id = nextRecordingId++;
+  if (nextRecordingId == 0)
+    nextRecordingId = 1;
+  rec->type = type;
+  rec->trough = i + 1;
+  rec->active = true;
+  rec->count = 0;
+  rec->scale = 1;
+  rec->targetVolume = (type == REC_OP_DISPENSE) ? valveControls[i].targetVolume : 0.0;
+  rec->startTime = currentTime;
+  rec->endTime = 0;
+  rec->lastSampleTime = currentTime;
+  rec->ringCount = flowSensors[i]->ring.count; // Only samples from this operation on
+  addRecordPoint(*rec, currentTime, 0.0, 0.0, pressure, state, true);
+
+  if (LOG_ENABLED(LOG_LEVEL_MESSAGE))
+  {
+    char message[48];
+    snprintf(message, sizeof(message), "[MESSAGE] Recording #%u: %s trough %d", rec->id, REC_OP_NAMES[type], i + 1);
+    sendLogMessage(LOG_LEVEL_MESSAGE, message);
+  }
+  return true;
+}
+
+// Flow sensor samples published since the last call, at the sensor's rate
+static void sampleFlowRecording(OperationRecording &rec, int i, float pressure, uint8_t state)
+{
+  const FlowSampleRing &ring = flowSensors[i]->ring;
+  uint16_t available = (ring.count < FLOW_SAMPLE_RING_SIZE) ? ring.count : FLOW_SAMPLE_RING_SIZE;
+  uint16_t fresh = ring.count - rec.ringCount; // Ring cleared or wrapped: huge, capped below
+  if (fresh > available)
+  {
+    fresh = available;
+  }
+
+  for (uint16_t n = fresh; n > 0; n--)
+  {
+    const FlowSample &sample = ring.samples[(ring.count - n) % FLOW_SAMPLE_RING_SIZE];
+    addRecordPoint(rec, sample.timeMs, sample.flowRate, sample.dispenseVolume, pressure, state, false);
+  }
+  rec.ringCount = ring.count;
+}
+
+static void finishRecording(OperationRecording &rec, unsigned long currentTime, float pressure, uint8_t state)
+{
+  // The monitors act on samples already consumed, so the last point holds the final volume
+  const RecordPoint &last = rec.points[rec.count - 1];
+  addRecordPoint(rec, currentTime, last.flowDeci / 10.0, last.volumeCenti / 100.0, pressure, state, true);
+  rec.active = false;
+  rec.endTime = currentTime;
+}
+
+void serviceOperationRecorder(unsigned long currentTime)
+{
+  float pressure = 0.0;
+  bool pressureRead = false;
+
+  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  {
+    for (uint8_t type = REC_OP_DISPENSE; type <= REC_OP_DRAIN; type++)
+    {
+      bool running = isRecordedOpRunning(type, i);
+      OperationRecording *rec = findActiveRecording(type, i);
+      if (rec == NULL && (!running || notRecorded[i][type]))
+      {
+        notRecorded[i][type] = running;
+        continue;
+      }
+
+      if (!pressureRead)
+      {
+        pressure = readPressure(pressureSensor);
+        pressureRead = true;
+      }
+      uint8_t state = readRecordState(i);
+
+      if (rec == NULL)
+      {
+        notRecorded[i][type] = !startRecording(type, i, currentTime, pressure, state);
+      }
+      else if (!running)
+      {
+        finishRecording(*rec, currentTime, pressure, state);
+      }
+      else if (type != REC_OP_DRAIN)
+      {
+        sampleFlowRecording(*rec, i, pressure, state);
+      }
+      else if (currentTime - rec->lastSampleTime >= REC_DRAIN_SAMPLE_MS)
+      {
+        // No flow sensor on the waste path: pressure and states only
+        rec->lastSampleTime = currentTime;
+        addRecordPoint(*rec, currentTime, 0.0, 0.0, pressure, state, false);
+      }
+    }
+  }
+}
+
+// ============================================================
+// Export
+// ============================================================
+
+static void printRecordingSummary(const OperationRecording &rec, Stream *stream)
+{
+  unsigned long durationMs = (rec.active ? millis() : rec.endTime) - rec.startTime;
+  float finalVolume = rec.points[rec.count - 1].volumeCenti / 100.0;
+
+  stream->print(F("  #"));
+  stream->print(rec.id);
+  stream->print(' ');
+  stream->print(REC_OP_NAMES[rec.type]);
+  stream->print(F(" trough "));
+  stream->print(rec.trough);
+  stream->print(F(": "));
+  stream->print(durationMs / 1000.0, 1);
+  stream->print(F(" s, "));
+  stream->print(rec.count);
+  stream->print(F(" points"));
+  if (rec.type != REC_OP_DRAIN)
+  {
+    stream->print(F(", volume "));
+    stream->print(finalVolume, 2);
+    stream->print(F(" mL"));
+  }
+  if (rec.targetVolume > 0)
+  {
+    stream->print(F(", target "));
+    stream->print(rec.targetVolume, 2);
+    stream->print(F(" mL, error "));
+    stream->print(finalVolume - rec.targetVolume, 2);
+    stream->print(F(" mL"));
+  }
+  stream->println(rec.active ? F(" (RECORDING)") : F(""));
+}
+
+void printOperationRecordings(Stream *stream)
+{
+  stream->println(F("[INFO] Operation recordings:"));
+  bool any = false;
+  for (int r = 0; r < REC_MAX_RECORDINGS; r++)
+  {
+    if (recordings[r].id != 0)
+    {
+      printRecordingSummary(recordings[r], stream);
+      any = true;
+    }
+  }
+  if (!any)
+  {
+    stream->println(F("  (none)"));
+  }
+}
+
+bool printOperationRecording(uint16_t id, Stream *stream)
+{
+  static const char STATE_LETTERS[] = "RMWOBLV"; // REC_STATE_* bit order
+
+  for (int r = 0; r < REC_MAX_RECORDINGS; r++)
+  {
+    const OperationRecording &rec = recordings[r];
+    if (id == 0 || rec.id != id)
+    {
+      continue;
+    }
+
+    stream->println(F("[INFO] Recording:"));
+    printRecordingSummary(rec, stream);
+    stream->println(F("t_ms,flow_ml_min,volume_ml,pressure_psi,state"));
+    stream->println(F("# state: R=reagent M=media W=waste open, O=overflow B=bubble L=waste line V=vacuum"));
+
+    for (uint8_t p = 0; p < rec.count; p++)
+    {
+      const RecordPoint &point = rec.points[p];
+      char states[sizeof(STATE_LETTERS)];
+      for (uint8_t b = 0; b < sizeof(STATE_LETTERS) - 1; b++)
+      {
+        states[b] = (point.state & (1 << b)) ? STATE_LETTERS[b] : '-';
+      }
+      states[sizeof(STATE_LETTERS) - 1] = '\0';
+
+      stream->print((unsigned long)point.timeCs * 10);
+      stream->print(',');
+      stream->print(point.flowDeci / 10.0, 1);
+      stream->print(',');
+      stream->print(point.volumeCenti / 100.0, 2);
+      stream->print(',');
+      stream->print(point.pressureHalf / 2.0, 1);
+      stream->print(',');
+      stream->println(states);
+    }
+    return true;
+  }
+  return false;
+}
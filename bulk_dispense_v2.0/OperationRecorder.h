@@ -0,0 +1,97 @@
+#ifndef OPERATIONRECORDER_H
+#define OPERATIONRECORDER_H
+
+#include <Controllino.h>
+#include "Hardware.h"
+
+/************************************************************
+ * OperationRecorder.h
+ *
+ * Per-operation curve recorder. Every dispense, prime, fill and
+ * drain gets a recording with its own operation ID, holding
+ * flow rate, integrated volume, supply pressure and the valve /
+ * sensor states over the whole operation:
+ *
+ * - Flow operations are sampled at the flow sensor's native
+ *   rate from its sample ring; drains on a fixed period.
+ * - A point is kept only when something changed (valve or
+ *   sensor state, flow or pressure beyond a deadband) or the
+ *   heartbeat gap has passed.
+ * - When a recording fills up, every other unchanged point is
+ *   dropped and the deadbands and gap double, so the buffer
+ *   always spans the whole operation.
+ *
+ * The last REC_MAX_RECORDINGS operations are kept in
+ * preallocated RAM and streamed on request (REC command).
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Recorder Configuration
+// ============================================================
+
+#define REC_MAX_RECORDINGS 4       // Most recent operations kept
+#define REC_MAX_POINTS 24          // Points per recording
+#define REC_DRAIN_SAMPLE_MS 50     // Sample period for operations without a flow sensor
+#define REC_FLOW_DEADBAND 0.5      // mL/min change that keeps a point (doubles on compaction)
+#define REC_PRESSURE_DEADBAND 0.5  // psi change that keeps a point (doubles on compaction)
+#define REC_MAX_POINT_GAP_MS 500   // Heartbeat when nothing changes (doubles on compaction)
+
+// Valve and sensor states stored with each point
+#define REC_STATE_REAGENT 0x01  // Reagent valve open
+#define REC_STATE_MEDIA 0x02    // Media valve open
+#define REC_STATE_WASTE 0x04    // Waste valve open
+#define REC_STATE_OVERFLOW 0x08 // Overflow sensor wet
+#define REC_STATE_BUBBLE 0x10   // Bubble sensor sees liquid
+#define REC_STATE_LINE 0x20     // Waste line sensor sees liquid
+#define REC_STATE_VACUUM 0x40   // Waste bottle under vacuum
+
+// ============================================================
+// Recorder Structures
+// ============================================================
+
+enum RecordedOpType
+{
+  REC_OP_DISPENSE,
+  REC_OP_PRIME,
+  REC_OP_FILL,
+  REC_OP_DRAIN
+};
+
+// Quantized to keep a point at 8 bytes
+struct RecordPoint
+{
+  uint16_t timeCs;      // Centiseconds since the operation started
+  int16_t flowDeci;     // 0.1 mL/min
+  uint16_t volumeCenti; // 0.01 mL
+  uint8_t pressureHalf; // 0.5 psi
+  uint8_t state;        // REC_STATE_* bits
+};
+
+struct OperationRecording
+{
+  uint16_t id;        // Operation ID; 0 while the slot is unused
+  uint8_t type;       // RecordedOpType
+  uint8_t trough;     // 1-4
+  bool active;
+  uint8_t count;
+  uint8_t scale;      // Deadband and gap multiplier, doubled on each compaction
+  float targetVolume; // mL, volume dispenses only
+  unsigned long startTime;
+  unsigned long endTime;
+  unsigned long lastSampleTime; // Drains: last fixed-period sample
+  uint16_t ringCount;           // Flow sample ring position consumed so far
+  RecordPoint points[REC_MAX_POINTS];
+};
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+void serviceOperationRecorder(unsigned long currentTime); // Call every loop, after flow acquisition
+void printOperationRecordings(Stream *stream);
+bool printOperationRecording(uint16_t id, Stream *stream);
+
+#endif // OPERATIONRECORDER_H
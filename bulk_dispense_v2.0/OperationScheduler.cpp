@@ -0,0 +1,356 @@
+#include "OperationScheduler.h"
+#include "Commands.h"
+#include "CommandManager.h"
+#include "CommandSession.h"
+#include "PressureRegulator.h"
+#include "Sensors.h"
+#include "Utils.h"
+#include "DrainScheduler.h"
+
+/************************************************************
+ * OperationScheduler.cpp
+ *
+ * Implements the batch scheduler declared in
+ * OperationScheduler.h:
+ *
+ * 1. Batch management: queue, start, clear and abort
+ * 2. Dispatch: budget checks and command dispatch
+ * 3. Reporting: per-operation timing and makespan
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+OperationBatch operationBatch = {{}, 0, SCHED_DEFAULT_PRESSURE_OPS, false, 0, 0};
+
+static const char *const SCHED_OP_COMMANDS[] = {"D", "P", "F", "DT"};
+
+// ============================================================
+// Batch Management
+// ============================================================
+
+bool addScheduledOperation(ScheduledOpType type, int trough, float volume, Stream *stream)
+{
+  if (operationBatch.running)
+  {
+    sendMessage(F("[ERROR] Batch is running. Wait for it to finish or use SCHED abort."), stream, currentClient);
+    return false;
+  }
+  if (operationBatch.count >= SCHED_MAX_OPS)
+  {
+    sendMessage(F("[ERROR] Batch is full."), stream, currentClient);
+    return false;
+  }
+
+  ScheduledOp &op = operationBatch.ops[operationBatch.count++];
+  op.type = type;
+  op.trough = trough;
+  op.state = SCHED_OP_PENDING;
+  op.volume = volume;
+  op.startTime = 0;
+  op.endTime = 0;
+  return true;
+}
+
+bool startOperationBatch(Stream *stream)
+{
+  if (operationBatch.running)
+  {
+    sendMessage(F("[ERROR] Batch is already running."), stream, currentClient);
+    return false;
+  }
+  if (operationBatch.count == 0)
+  {
+    sendMessage(F("[ERROR] Batch is empty. Add operations with SCHED <D|P|F|DT> <trough> [volume]."), stream, currentClient);
+    return false;
+  }
+
+  // A finished batch can be run again as-is
+  for (int i = 0; i < operationBatch.count; i++)
+  {
+    operationBatch.ops[i].state = SCHED_OP_PENDING;
+    operationBatch.ops[i].startTime = 0;
+    operationBatch.ops[i].endTime = 0;
+  }
+  operationBatch.startTime = millis();
+  operationBatch.endTime = 0;
+  operationBatch.running = true;
+  return true;
+}
+
+void clearOperationBatch()
+{
+  operationBatch.count = 0;
+  operationBatch.running = false;
+}
+
+void abortOperationBatch()
+{
+  if (!operationBatch.running)
+  {
+    return;
+  }
+  for (int i = 0; i < operationBatch.count; i++)
+  {
+    if (operationBatch.ops[i].state == SCHED_OP_PENDING)
+    {
+      operationBatch.ops[i].state = SCHED_OP_FAILED;
+    }
+  }
+  operationBatch.running = false;
+  operationBatch.endTime = millis();
+}
+
+// ============================================================
+// Dispatch
+// ============================================================
+
+static bool isTroughBusy(int trough)
+{
+  const ValveControl &vc = valveControls[trough - 1];
+  return vc.isDispensing || vc.isPriming || vc.fillMode || vc.isDraining || isDrainQueued(trough);
+}
+
+// True while the operation's own monitor still owns the trough
+static bool isOperationActive(const ScheduledOp &op)
+{
+  const ValveControl &vc = valveControls[op.trough - 1];
+  switch (op.type)
+  {
+  case SCHED_OP_DISPENSE:
+    return vc.isDispensing;
+  case SCHED_OP_PRIME:
+    return vc.isPriming;
+  case SCHED_OP_FILL:
+    return vc.fillMode;
+  default:
+    return vc.isDraining || isDrainQueued(op.trough);
+  }
+}
+
+static bool hasEarlierOperationOnTrough(int index)
+{
+  for (int i = 0; i < index; i++)
+  {
+    const ScheduledOp &op = operationBatch.ops[i];
+    if (op.trough == operationBatch.ops[index].trough &&
+        (op.state == SCHED_OP_PENDING || op.state == SCHED_OP_RUNNING))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool canStartOperation(int index, int runningPressureOps)
+{
+  const ScheduledOp &op = operationBatch.ops[index];
+
+  if (hasEarlierOperationOnTrough(index) || isTroughBusy(op.trough))
+  {
+    return false;
+  }
+
+  if (op.type == SCHED_OP_DRAIN)
+  {
+    // The drain queue shares the waste bottles (troughs 1/2 and 3/4)
+    return true;
+  }
+
+  // Pressure budget
+  if (runningPressureOps >= operationBatch.maxPressureOps)
+  {
+    return false;
+  }
+  if (runningPressureOps > 0)
+  {
+    // Only add load to a supply that is holding up under the current one
+    if (readPressure(pressureSensor) < SCHED_MIN_START_PRESSURE_PSI)
+    {
+      return false;
+    }
+    if (pressureRegulator.enabled && !pressureRegulator.settled)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void markOperationDetached(const ScheduledOp &op)
+{
+  int index = op.trough - 1;
+  switch (op.type)
+  {
+  case SCHED_OP_DISPENSE:
+    dispenseAsyncCompleted[index] = true;
+    break;
+  case SCHED_OP_PRIME:
+    primeAsyncCompleted[index] = true;
+    break;
+  case SCHED_OP_DRAIN:
+    drainAsyncCompleted[index] = true;
+    break;
+  default:
+    break; // Fill completes synchronously
+  }
+}
+
+static void dispatchOperation(ScheduledOp &op, Stream *stream)
+{
+  char command[COMMAND_SIZE];
+  if (op.type == SCHED_OP_DISPENSE)
+  {
+    char volumeStr[10];
+    dtostrf(op.volume, 1, 1, volumeStr);
+    snprintf(command, sizeof(command), "D %d %s", op.trough, volumeStr);
+  }
+  else
+  {
+    snprintf(command, sizeof(command), "%s %d", SCHED_OP_COMMANDS[op.type], op.trough);
+  }
+
+  sendMessage(F("[MESSAGE] Scheduler starting: "), stream, currentClient, false);
+  sendMessage(command, stream, currentClient);
+
+  // Batch operations stay out of the host's command session: nothing is
+  // registered, completions the handler signals now are dropped, and the
+  // monitors' completion for the operation is marked as already sent
+  resetAsyncFlagsForCommand(command);
+  cm_setDetachedExecution(true);
+  commander.execute(command, stream);
+  cm_setDetachedExecution(false);
+  markOperationDetached(op);
+
+  op.startTime = millis();
+  if (isOperationActive(op))
+  {
+    op.state = SCHED_OP_RUNNING;
+    return;
+  }
+
+  // Rejected by the command handler (already reported on the stream)
+  op.state = SCHED_OP_FAILED;
+  op.endTime = op.startTime;
+}
+
+void serviceOperationScheduler(unsigned long currentTime)
+{
+  if (!operationBatch.running)
+  {
+    return;
+  }
+
+  Stream *stream = hasActiveClient ? (Stream *)&currentClient : (Stream *)&Serial;
+  int runningPressureOps = 0;
+  bool allFinished = true;
+
+  // Retire finished operations
+  for (int i = 0; i < operationBatch.count; i++)
+  {
+    ScheduledOp &op = operationBatch.ops[i];
+    if (op.state == SCHED_OP_RUNNING)
+    {
+      if (!isOperationActive(op))
+      {
+        op.state = SCHED_OP_DONE;
+        op.endTime = currentTime;
+      }
+      else if (op.type != SCHED_OP_DRAIN)
+      {
+        runningPressureOps++;
+      }
+    }
+  }
+
+  // Start everything the budgets allow, in queue order
+  for (int i = 0; i < operationBatch.count; i++)
+  {
+    ScheduledOp &op = operationBatch.ops[i];
+    if (op.state == SCHED_OP_PENDING && canStartOperation(i, runningPressureOps))
+    {
+      dispatchOperation(op, stream);
+      if (op.state == SCHED_OP_RUNNING && op.type != SCHED_OP_DRAIN)
+      {
+        runningPressureOps++;
+      }
+    }
+    if (op.state == SCHED_OP_PENDING || op.state == SCHED_OP_RUNNING)
+    {
+      allFinished = false;
+    }
+  }
+
+  if (allFinished)
+  {
+    operationBatch.running = false;
+    operationBatch.endTime = millis();
+    printOperationBatch(stream);
+  }
+}
+
+// ============================================================
+// Reporting
+// ============================================================
+
+void printOperationBatch(Stream *stream)
+{
+  static const char *const STATE_NAMES[] = {"PENDING", "RUNNING", "DONE", "FAILED"};
+  char line[80];
+  unsigned long now = millis();
+  unsigned long serialMs = 0;
+
+  snprintf(line, sizeof(line), "[INFO] Batch: %u operations, %s, max %u pressurized",
+           operationBatch.count, operationBatch.running ? "RUNNING" : "IDLE", operationBatch.maxPressureOps);
+  sendMessage(line, stream, currentClient);
+
+  for (int i = 0; i < operationBatch.count; i++)
+  {
+    const ScheduledOp &op = operationBatch.ops[i];
+    char volumeStr[10] = "";
+    if (op.type == SCHED_OP_DISPENSE)
+    {
+      volumeStr[0] = ' ';
+      dtostrf(op.volume, 1, 1, volumeStr + 1);
+    }
+
+    if (op.state == SCHED_OP_PENDING)
+    {
+      snprintf(line, sizeof(line), "  %d: %s %u%s %s", i + 1, SCHED_OP_COMMANDS[op.type], op.trough,
+               volumeStr, STATE_NAMES[op.state]);
+    }
+    else
+    {
+      unsigned long endTime = (op.state == SCHED_OP_RUNNING) ? now : op.endTime;
+      serialMs += endTime - op.startTime;
+      snprintf(line, sizeof(line), "  %d: %s %u%s %s start +%lu ms, duration %lu ms", i + 1,
+               SCHED_OP_COMMANDS[op.type], op.trough, volumeStr, STATE_NAMES[op.state],
+               op.startTime - operationBatch.startTime, endTime - op.startTime);
+    }
+    sendMessage(line, stream, currentClient);
+  }
+
+  if (operationBatch.startTime == 0)
+  {
+    return; // Never run
+  }
+
+  // Serial dispatch would take the sum of the operation durations
+  unsigned long makespanMs = (operationBatch.running ? now : operationBatch.endTime) - operationBatch.startTime;
+  snprintf(line, sizeof(line), "[INFO] Makespan: %lu ms, serial dispatch: %lu ms", makespanMs, serialMs);
+  sendMessage(line, stream, currentClient, false);
+  if (makespanMs > 0)
+  {
+    sendMessage(F(", speedup "), stream, currentClient, false);
+    sendMessage(String((float)serialMs / makespanMs, 2).c_str(), stream, currentClient, false);
+    sendMessage(F("x"), stream, currentClient);
+  }
+  else
+  {
+    sendMessage(F(""), stream, currentClient);
+  }
+}
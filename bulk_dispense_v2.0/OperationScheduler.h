@@ -0,0 +1,92 @@
+#ifndef OPERATIONSCHEDULER_H
+#define OPERATIONSCHEDULER_H
+
+#include <Controllino.h>
+#include "Hardware.h"
+
+/************************************************************
+ * OperationScheduler.h
+ *
+ * Batch scheduler for per-trough operations (dispense, prime,
+ * fill, drain). A batch is queued with SCHED, then run: each
+ * operation starts as soon as
+ *
+ * - every earlier operation on the same trough has finished,
+ * - the pressure budget allows another pressurized operation
+ *   (count limit, supply at threshold, regulator settled).
+ *
+ * Drains are dispatched right away; the drain queue
+ * (DrainScheduler.h) runs them on the shared waste bottles.
+ *
+ * Operations are dispatched through the normal command handlers.
+ * Makespan and the serial-dispatch equivalent are reported.
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Scheduler Configuration
+// ============================================================
+
+#define SCHED_MAX_OPS 8
+#define SCHED_DEFAULT_PRESSURE_OPS 2    // Concurrent dispense/prime/fill operations
+#define SCHED_MIN_START_PRESSURE_PSI 15.0 // Supply needed to add another pressurized operation
+
+// ============================================================
+// Scheduler Structures
+// ============================================================
+
+enum ScheduledOpType
+{
+  SCHED_OP_DISPENSE,
+  SCHED_OP_PRIME,
+  SCHED_OP_FILL,
+  SCHED_OP_DRAIN
+};
+
+enum ScheduledOpState
+{
+  SCHED_OP_PENDING,
+  SCHED_OP_RUNNING,
+  SCHED_OP_DONE,
+  SCHED_OP_FAILED // Command rejected the operation
+};
+
+struct ScheduledOp
+{
+  uint8_t type;   // ScheduledOpType
+  uint8_t trough; // 1-4
+  uint8_t state;  // ScheduledOpState
+  float volume;   // mL, dispense only
+  unsigned long startTime;
+  unsigned long endTime;
+};
+
+struct OperationBatch
+{
+  ScheduledOp ops[SCHED_MAX_OPS];
+  uint8_t count;
+  uint8_t maxPressureOps;
+  bool running;
+  unsigned long startTime;
+  unsigned long endTime;
+};
+
+// ============================================================
+// Global Variables
+// ============================================================
+extern OperationBatch operationBatch;
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+bool addScheduledOperation(ScheduledOpType type, int trough, float volume, Stream *stream);
+bool startOperationBatch(Stream *stream);
+void clearOperationBatch();
+void abortOperationBatch(); // Stops dispatching; running operations are left to their monitors
+void serviceOperationScheduler(unsigned long currentTime); // Call every loop
+void printOperationBatch(Stream *stream);
+
+#endif // OPERATIONSCHEDULER_H
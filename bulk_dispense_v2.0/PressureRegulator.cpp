@@ -0,0 +1,200 @@
+#include "PressureRegulator.h"
+#include <math.h>
+#include "Sensors.h"
+
+/************************************************************
+ * PressureRegulator.cpp
+ *
+ * Implements the closed-loop pressure regulator declared in
+ * PressureRegulator.h:
+ *
+ * 1. Control: start/stop, gains and the fixed-tick PID update
+ * 2. Feed-forward: inverse of the valve calibration curve
+ * 3. Reporting: regulator status
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Global Variables
+// ============================================================
+PressureRegulator pressureRegulator = {
+  false, 0.0,
+  PRESSURE_REGULATOR_DEFAULT_KP, PRESSURE_REGULATOR_DEFAULT_KI, PRESSURE_REGULATOR_DEFAULT_KD,
+  0.0, 0.0, 0.0, 0.0, 0, 0, false
+};
+
+// ============================================================
+// Feed-forward
+// ============================================================
+
+// Valve % expected to hold setpointPsi, from calibrateProportionalValve() data
+float getPressureFeedForward(float setpointPsi)
+{
+  const float *cal = proportionalValveCalPressure;
+
+  // No usable curve (e.g. calibrated without supply air): assume linear
+  if (cal[PRESSURE_CAL_POINTS - 1] - cal[0] < 1.0)
+  {
+    return constrain(setpointPsi / pressureSensor.maxPressure * 100.0, 0.0, 100.0);
+  }
+
+  if (setpointPsi <= cal[0])
+  {
+    return 0.0;
+  }
+
+  float lowerPressure = cal[0];
+  for (int i = 1; i < PRESSURE_CAL_POINTS; i++)
+  {
+    // Treat the curve as non-decreasing so noise cannot fold it back
+    float upperPressure = (cal[i] > lowerPressure) ? cal[i] : lowerPressure;
+    if (setpointPsi <= upperPressure && upperPressure > lowerPressure)
+    {
+      float fraction = (setpointPsi - lowerPressure) / (upperPressure - lowerPressure);
+      return ((i - 1) + fraction) * PRESSURE_CAL_STEP_PERCENT;
+    }
+    lowerPressure = upperPressure;
+  }
+  return 100.0;
+}
+
+// ============================================================
+// Control
+// ============================================================
+
+void startPressureRegulation(float setpointPsi)
+{
+  PressureRegulator &reg = pressureRegulator;
+  float currentPercent = proportionalValve.controlVoltage * 10.0;
+
+  reg.setpointPsi = setpointPsi;
+  reg.feedForward = getPressureFeedForward(setpointPsi);
+
+  if (!reg.enabled)
+  {
+    // Bumpless start from the current valve position
+    reg.integral = constrain(currentPercent - reg.feedForward, -100.0, 100.0);
+    reg.filteredPressure = readPressure(pressureSensor);
+    reg.output = currentPercent;
+    reg.lastTickTime = millis() - PRESSURE_REGULATOR_TICK_MS; // Run on the next call
+    reg.enabled = true;
+  }
+
+  reg.inBandSince = 0;
+  reg.settled = false;
+}
+
+void stopPressureRegulation()
+{
+  pressureRegulator.enabled = false;
+  pressureRegulator.settled = false;
+}
+
+void setPressureRegulatorGains(float kp, float ki, float kd)
+{
+  pressureRegulator.kp = kp;
+  pressureRegulator.ki = ki;
+  pressureRegulator.kd = kd;
+}
+
+void regulatePressure(unsigned long currentTime)
+{
+  PressureRegulator &reg = pressureRegulator;
+  if (!reg.enabled || currentTime - reg.lastTickTime < PRESSURE_REGULATOR_TICK_MS)
+  {
+    return;
+  }
+
+  // A long blocking call must not turn into one huge integral step
+  float dt = (currentTime - reg.lastTickTime) / 1000.0;
+  if (dt > 5 * PRESSURE_REGULATOR_TICK_MS / 1000.0)
+  {
+    dt = 5 * PRESSURE_REGULATOR_TICK_MS / 1000.0;
+  }
+  reg.lastTickTime = currentTime;
+
+  float previousPressure = reg.filteredPressure;
+  reg.filteredPressure += PRESSURE_REGULATOR_FILTER_ALPHA * (readPressure(pressureSensor) - reg.filteredPressure);
+
+  float error = reg.setpointPsi - reg.filteredPressure;
+  float derivative = -(reg.filteredPressure - previousPressure) / dt;
+  float unclamped = reg.feedForward + reg.kp * error + reg.integral + reg.kd * derivative;
+
+  // Anti-windup: hold the integral while the valve is saturated in the error's direction
+  bool saturatedHigh = (unclamped >= 100.0 && error > 0);
+  bool saturatedLow = (unclamped <= 0.0 && error < 0);
+  if (!saturatedHigh && !saturatedLow)
+  {
+    reg.integral = constrain(reg.integral + reg.ki * error * dt, -100.0, 100.0);
+  }
+
+  reg.output = constrain(reg.feedForward + reg.kp * error + reg.integral + reg.kd * derivative, 0.0, 100.0);
+  proportionalValve = setValvePosition(proportionalValve, reg.output);
+
+  if (fabs(error) <= PRESSURE_REGULATOR_TOLERANCE_PSI)
+  {
+    if (reg.inBandSince == 0)
+    {
+      reg.inBandSince = currentTime;
+    }
+    reg.settled = (currentTime - reg.inBandSince >= PRESSURE_REGULATOR_SETTLE_MS);
+  }
+  else
+  {
+    reg.inBandSince = 0;
+    reg.settled = false;
+  }
+}
+
+bool isPressureSettled()
+{
+  return pressureRegulator.enabled && pressureRegulator.settled;
+}
+
+// ============================================================
+// Reporting
+// ============================================================
+
+void printPressureRegulatorStatus(Stream *stream)
+{
+  const PressureRegulator &reg = pressureRegulator;
+
+  stream->print(F("[INFO] Pressure regulation: "));
+  if (!reg.enabled)
+  {
+    stream->println(F("OFF (open-loop)"));
+  }
+  else
+  {
+    stream->print(F("ON, setpoint "));
+    stream->print(reg.setpointPsi, 1);
+    stream->print(F(" psi, measured "));
+    stream->print(reg.filteredPressure, 1);
+    stream->print(F(" psi, valve "));
+    stream->print(reg.output, 1);
+    stream->println(reg.settled ? F("% (settled)") : F("% (settling)"));
+    stream->print(F("  Feed-forward: "));
+    stream->print(reg.feedForward, 1);
+    stream->print(F("%, integral: "));
+    stream->print(reg.integral, 1);
+    stream->println(F("%"));
+  }
+
+  stream->print(F("  Gains: Kp="));
+  stream->print(reg.kp, 3);
+  stream->print(F(" Ki="));
+  stream->print(reg.ki, 3);
+  stream->print(F(" Kd="));
+  stream->println(reg.kd, 3);
+
+  stream->print(F("  Calibration (psi at 0/25/50/75/100%):"));
+  for (int i = 0; i < PRESSURE_CAL_POINTS; i++)
+  {
+    stream->print(' ');
+    stream->print(proportionalValveCalPressure[i], 1);
+  }
+  stream->println();
+}
@@ -0,0 +1,72 @@
+#ifndef PRESSUREREGULATOR_H
+#define PRESSUREREGULATOR_H
+
+#include <Controllino.h>
+#include "Hardware.h"
+
+/************************************************************
+ * PressureRegulator.h
+ *
+ * Closed-loop control of the supply pressure through the
+ * proportional valve. A PID loop on readPressure() runs on a
+ * fixed tick from the main loop:
+ *
+ * - Feed-forward: valve position interpolated from the
+ *   pressures recorded by calibrateProportionalValve()
+ * - Anti-windup: the integral stops growing while the valve
+ *   output is saturated in the direction of the error
+ * - Derivative on the filtered measurement (no setpoint kick)
+ *
+ * Author: Rud Lucien
+ * Date: 2025-04-08
+ * Version: 2.0
+ ************************************************************/
+
+// ============================================================
+// Regulator Configuration
+// ============================================================
+
+#define PRESSURE_REGULATOR_TICK_MS 20
+#define PRESSURE_REGULATOR_DEFAULT_KP 2.0  // % valve per psi
+#define PRESSURE_REGULATOR_DEFAULT_KI 4.0  // % valve per psi-second
+#define PRESSURE_REGULATOR_DEFAULT_KD 0.05 // % valve per psi/second
+#define PRESSURE_REGULATOR_FILTER_ALPHA 0.3 // Measurement low-pass weight
+#define PRESSURE_REGULATOR_TOLERANCE_PSI 0.5
+#define PRESSURE_REGULATOR_SETTLE_MS 200    // Time within tolerance before "settled"
+
+// ============================================================
+// Regulator Structure
+// ============================================================
+struct PressureRegulator
+{
+  bool enabled;
+  float setpointPsi;
+  float kp;
+  float ki;
+  float kd;
+  float feedForward;       // Valve % for the setpoint from calibration data
+  float integral;          // Valve % contributed by the integral term
+  float filteredPressure;  // psi
+  float output;            // Valve % last written
+  unsigned long lastTickTime;
+  unsigned long inBandSince; // 0 while outside the tolerance band
+  bool settled;
+};
+
+// ============================================================
+// Global Variables
+// ============================================================
+extern PressureRegulator pressureRegulator;
+
+// ============================================================
+// Function Prototypes
+// ============================================================
+void startPressureRegulation(float setpointPsi);
+void stopPressureRegulation();
+void setPressureRegulatorGains(float kp, float ki, float kd);
+void regulatePressure(unsigned long currentTime); // Call every loop
+bool isPressureSettled();
+float getPressureFeedForward(float setpointPsi);
+void printPressureRegulatorStatus(Stream *stream);
+
+#endif // PRESSUREREGULATOR_H
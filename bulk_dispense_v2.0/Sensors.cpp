@@ -1,7 +1,10 @@
 #include "Sensors.h"
 #include <Wire.h>
-#include <math.h> // For isnan()
+#include <math.h> // For NAN
 #include "Utils.h"
+#include "Logging.h"
+#include "I2CHealth.h"
+#include "HydraulicSim.h"
 
 /************************************************************
  * Sensors.cpp
@@ -19,6 +22,88 @@
 // Internal Helper Functions
 // ============================================================
 
+// Trapezoid of two Q16 flow values (1/32 mL/min LSBs) over dt microseconds:
+// one LSB for one microsecond is 1/1920 nL, so area / (2 * 1920 * 65536) = nL
+#define FLOW_INTEGRATOR_DIVISOR (2LL * 1920LL * 65536LL)
+
+// Sensirion CRC-8 (polynomial 0x31, init 0xFF) lookup table
+static const uint8_t SENSIRION_CRC_TABLE[256] PROGMEM = {
+  0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+  0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+  0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+  0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+  0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+  0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+  0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+  0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+  0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+  0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+  0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+  0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+  0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+  0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+  0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+  0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC
+};
+
+// Flow in Q16 LSBs with the slope/offset correction applied (reverse flow counts as zero)
+static int64_t getCorrectedFlowQ16(const FlowSensor &sensor, int16_t flowRaw)
+{
+  if (flowRaw < 0)
+    flowRaw = 0;
+
+  if (!sensor.useCorrection)
+    return (int64_t)flowRaw << 16;
+
+  // y = mx + b with the offset (mL/min) converted to LSBs: 32 * 65536 = 2097152
+  int64_t slopeQ16 = (int64_t)(sensor.slopeCorrection * 65536.0f);
+  int64_t offsetQ16 = (int64_t)(sensor.offsetCorrection * 2097152.0f);
+  return flowRaw * slopeQ16 + offsetQ16;
+}
+
+// Trapezoidal integration between the previous and this frame's arrival times
+static void integrateFlowSample(FlowSensor &sensor, int16_t flowRaw, uint32_t sampleMicros)
+{
+  int64_t flowQ16 = getCorrectedFlowQ16(sensor, flowRaw);
+
+  if (sensor.lastUpdateTime > 0)
+  {
+    uint32_t elapsedMicros = sampleMicros - sensor.lastSampleMicros;
+    int64_t area = (sensor.lastCorrectedFlowQ16 + flowQ16) * (int64_t)elapsedMicros + sensor.integratorRemainder;
+    int64_t incrementNl = area / FLOW_INTEGRATOR_DIVISOR;
+    sensor.integratorRemainder = area - incrementNl * FLOW_INTEGRATOR_DIVISOR;
+
+    sensor.dispenseVolumeNl += incrementNl;
+    sensor.totalVolumeNl += incrementNl;
+    sensor.dispenseVolume = sensor.dispenseVolumeNl / 1000000.0f;
+    sensor.totalVolume = sensor.totalVolumeNl / 1000000.0f;
+  }
+
+  sensor.lastSampleMicros = sampleMicros;
+  sensor.lastCorrectedFlowQ16 = flowQ16;
+}
+
+// Start integrating from now, with zero flow as the previous sample
+static void restartFlowIntegrator(FlowSensor &sensor)
+{
+  sensor.lastSampleMicros = micros();
+  sensor.lastCorrectedFlowQ16 = getCorrectedFlowQ16(sensor, 0);
+  sensor.integratorRemainder = 0;
+}
+
+// Flow sensors share their I2C health device ID with their trough index
+static uint8_t getFlowSensorIndex(const FlowSensor &sensor)
+{
+  for (uint8_t i = 0; i < NUM_FLOW_SENSORS; i++)
+  {
+    if (flowSensors[i] == &sensor)
+    {
+      return i;
+    }
+  }
+  return 0;
+}
+
 bool isFlowSensorConnected(FlowSensor &sensor)
 {
   // Try multiple times with delays
@@ -27,8 +112,8 @@ bool isFlowSensorConnected(FlowSensor &sensor)
     selectMultiplexerChannel(sensor.multiplexerAddr, sensor.channel);
     delay(20);
 
-    Wire.beginTransmission(sensor.sensorAddr);
-    uint8_t error = Wire.endTransmission();
+    I2C_BUS.beginTransmission(sensor.sensorAddr);
+    uint8_t error = I2C_BUS.endTransmission();
 
     if (error == 0)
     {
@@ -45,22 +130,141 @@ bool isFlowSensorConnected(FlowSensor &sensor)
 // ============================================================
 // Temperature & Humidity Sensor Functions
 // ============================================================
+// Split-phase SHT31 acquisition: serviceTempHumidityStep() starts a single-shot
+// measurement on one call and collects both values on a later one, so the loop
+// never waits out the conversion. Callers read the cached result.
+enum TempHumPhase
+{
+  TEMP_HUM_IDLE,
+  TEMP_HUM_MEASURING
+};
+
+static TempHumidity tempHumReading = {NAN, NAN, false, 0};
+static uint8_t tempHumPhase = TEMP_HUM_IDLE;
+static unsigned long tempHumStartTime = 0; // When the last measurement was started
+
 bool tempHumSensorInit()
 {
   selectMultiplexerChannel(MULTIPLEXER_ADDR, TEMP_HUM_SENSOR_CHANNEL);
-  return sht31.begin(TEMP_HUM_SENSOR_ADDR);
+#if HYDRAULIC_SIM
+  // The library talks to Wire directly; the first split-phase step fills the cache
+  tempHumPhase = TEMP_HUM_IDLE;
+  tempHumStartTime = millis() - TEMP_HUM_SAMPLE_INTERVAL_MS;
+  return true;
+#else
+  if (!sht31.begin(TEMP_HUM_SENSOR_ADDR))
+  {
+    return false;
+  }
+
+  // Prime the cache with one blocking read (setup only)
+  float temperature, humidity;
+  if (sht31.readBoth(&temperature, &humidity))
+  {
+    tempHumReading.temperature = temperature;
+    tempHumReading.humidity = humidity;
+    tempHumReading.valid = true;
+    tempHumReading.timestamp = millis();
+  }
+  tempHumPhase = TEMP_HUM_IDLE;
+  tempHumStartTime = millis();
+  return true;
+#endif
 }
 
+// Latest cached measurement; invalid if none arrived within TEMP_HUM_MAX_AGE_MS
 TempHumidity readTempHumidity()
 {
-  TempHumidity data;
-  selectMultiplexerChannel(MULTIPLEXER_ADDR, TEMP_HUM_SENSOR_CHANNEL);
-  data.temperature = sht31.readTemperature();
-  data.humidity = sht31.readHumidity();
-  data.valid = !(isnan(data.temperature) || isnan(data.humidity));
+  TempHumidity data = tempHumReading;
+  data.valid = tempHumReading.valid && (millis() - tempHumReading.timestamp <= TEMP_HUM_MAX_AGE_MS);
   return data;
 }
 
+static bool isTempHumidityStepDue(unsigned long currentTime)
+{
+  unsigned long wait = (tempHumPhase == TEMP_HUM_IDLE) ? TEMP_HUM_SAMPLE_INTERVAL_MS : TEMP_HUM_MEASUREMENT_MS;
+  return currentTime - tempHumStartTime >= wait;
+}
+
+// One I2C transaction: start a measurement, or collect the one in progress
+static void serviceTempHumidityStep(unsigned long currentTime)
+{
+  selectMultiplexerChannel(MULTIPLEXER_ADDR, TEMP_HUM_SENSOR_CHANNEL);
+
+  if (tempHumPhase == TEMP_HUM_IDLE)
+  {
+    // Single shot, high repeatability, no clock stretching
+    I2C_BUS.beginTransmission(TEMP_HUM_SENSOR_ADDR);
+    I2C_BUS.write(0x24);
+    I2C_BUS.write(0x00);
+    if (I2C_BUS.endTransmission() == 0)
+    {
+      tempHumPhase = TEMP_HUM_MEASURING;
+    }
+    else
+    {
+      reportI2CError(I2C_DEVICE_TEMP_HUM, currentTime);
+    }
+    tempHumStartTime = currentTime; // A failed start is retried next period
+    return;
+  }
+
+  // The sensor NACKs the read until the conversion is done
+  I2C_BUS.requestFrom((uint8_t)TEMP_HUM_SENSOR_ADDR, (uint8_t)TEMP_HUM_FRAME_SIZE);
+  if (I2C_BUS.available() < TEMP_HUM_FRAME_SIZE)
+  {
+    while (I2C_BUS.available())
+    {
+      I2C_BUS.read();
+    }
+    if (currentTime - tempHumStartTime >= TEMP_HUM_READ_TIMEOUT_MS)
+    {
+      tempHumPhase = TEMP_HUM_IDLE;
+      reportI2CError(I2C_DEVICE_TEMP_HUM, currentTime);
+    }
+    return;
+  }
+
+  uint8_t frame[TEMP_HUM_FRAME_SIZE];
+  for (uint8_t b = 0; b < TEMP_HUM_FRAME_SIZE; b++)
+  {
+    frame[b] = I2C_BUS.read();
+  }
+  tempHumPhase = TEMP_HUM_IDLE;
+
+  if (computeSensirionCrc(&frame[0], 2) != frame[2] || computeSensirionCrc(&frame[3], 2) != frame[5])
+  {
+    reportI2CError(I2C_DEVICE_TEMP_HUM, currentTime);
+    return; // Keep the previous reading; it ages out if errors persist
+  }
+  reportI2CSuccess(I2C_DEVICE_TEMP_HUM);
+
+  uint16_t temperatureRaw = (frame[0] << 8) | frame[1];
+  uint16_t humidityRaw = (frame[3] << 8) | frame[4];
+  tempHumReading.temperature = -45.0 + 175.0 * temperatureRaw / 65535.0;
+  tempHumReading.humidity = 100.0 * humidityRaw / 65535.0;
+  tempHumReading.valid = true;
+  tempHumReading.timestamp = currentTime;
+}
+
+// Recovery step for the I2C health manager: the sensor needs 2 ms afterwards
+bool softResetTempHumSensor()
+{
+  selectMultiplexerChannel(MULTIPLEXER_ADDR, TEMP_HUM_SENSOR_CHANNEL);
+  I2C_BUS.beginTransmission(TEMP_HUM_SENSOR_ADDR);
+  I2C_BUS.write(0x30);
+  I2C_BUS.write(0xA2);
+  if (I2C_BUS.endTransmission() != 0)
+  {
+    return false;
+  }
+
+  // Start a fresh measurement as soon as sampling resumes
+  tempHumPhase = TEMP_HUM_IDLE;
+  tempHumStartTime = millis() - TEMP_HUM_SAMPLE_INTERVAL_MS;
+  return true;
+}
+
 // ============================================================
 // Flow Sensor Functions
 // ============================================================
@@ -80,6 +284,9 @@ FlowSensor createFlowSensor(uint8_t muxAddr, uint8_t addr, uint8_t chan, uint16_
   sensor.sensorConnected = 0;
   sensor.dispenseVolume = 0.0;
   sensor.totalVolume = 0.0;
+  sensor.dispenseVolumeNl = 0;
+  sensor.totalVolumeNl = 0;
+  sensor.integratorRemainder = 0;
   sensor.isValidReading = false;
   sensor.fluidType = WATER; // Add default fluid type initialization
   return sensor;
@@ -142,20 +349,23 @@ bool initializeFlowSensor(FlowSensor &sensor)
   }
 
   // Try to reset sensor first
-  Wire.beginTransmission(sensor.sensorAddr);
-  Wire.write(0x00);
-  Wire.write(0x06);
-  Wire.endTransmission();
+  I2C_BUS.beginTransmission(sensor.sensorAddr);
+  I2C_BUS.write(0x00);
+  I2C_BUS.write(0x06);
+  I2C_BUS.endTransmission();
   delay(100);
 
   // Start measurement mode
-  sendMessage(F("[DEBUG] Sending start measurement command to sensor on channel "), &Serial, currentClient, false);
-  sendMessage(String(sensor.channel).c_str(), &Serial, currentClient);
+  if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+  {
+    sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Sending start measurement command to sensor on channel "), false);
+    sendLogMessage(LOG_LEVEL_DEBUG, String(sensor.channel).c_str());
+  }
 
-  Wire.beginTransmission(sensor.sensorAddr);
-  Wire.write(sensor.measurementCmd >> 8);
-  Wire.write(sensor.measurementCmd & 0xFF);
-  if (Wire.endTransmission() != 0)
+  I2C_BUS.beginTransmission(sensor.sensorAddr);
+  I2C_BUS.write(sensor.measurementCmd >> 8);
+  I2C_BUS.write(sensor.measurementCmd & 0xFF);
+  if (I2C_BUS.endTransmission() != 0)
   {
     sendMessage(F("[ERROR] Failed to start measurement mode."), &Serial, currentClient);
     resetI2CBus(); // Reset the I2C bus if communication fails
@@ -166,93 +376,198 @@ bool initializeFlowSensor(FlowSensor &sensor)
   sensor.sensorInitialized = true;
   sensor.sensorStopped = false;
   sensor.dispenseVolume = 0.0;
+  sensor.dispenseVolumeNl = 0;
   sensor.lastUpdateTime = millis();
+  restartFlowIntegrator(sensor);
+  clearFlowSampleRing(sensor);
+  resetI2CDeviceHealth(getFlowSensorIndex(sensor));
 
   return true;
 }
 
 bool readFlowSensorData(FlowSensor &sensor)
 {
-  static int softResetAttempt = 0;
-
   if (!sensor.sensorInitialized || sensor.sensorStopped)
   {
     sensor.flowRate = -1;
     sensor.temperature = -1;
     sensor.highFlowFlag = -1;
     if (sensor.totalVolume == 0.0)
+    {
       sensor.dispenseVolume = 0.0;
+      sensor.dispenseVolumeNl = 0;
+    }
     return false;
   }
 
   selectMultiplexerChannel(sensor.multiplexerAddr, sensor.channel);
-  Wire.requestFrom(sensor.sensorAddr, (uint8_t)9);
-  if (Wire.available() < 9)
+  I2C_BUS.requestFrom(sensor.sensorAddr, (uint8_t)FLOW_SENSOR_FRAME_SIZE);
+  if (I2C_BUS.available() < FLOW_SENSOR_FRAME_SIZE)
   {
-    sendMessage(F("[ERROR] Not enough bytes received from flow sensor on channel "), &Serial, currentClient, false);
-    sendMessage(String(sensor.channel).c_str(), &Serial, currentClient);
-    if (softResetAttempt < 2)
+    // Recovery runs from the acquisition scheduler, off this call
+    while (I2C_BUS.available())
     {
-      sendMessage(F("[WARNING] Attempting soft reset to recover..."), &Serial, currentClient);
-      Wire.beginTransmission(sensor.sensorAddr);
-      Wire.write(0x00);
-      Wire.write(0x06);
-      if (Wire.endTransmission() == 0)
-      {
-        delay(25);
-        softResetAttempt++;
-        return false;
-      }
+      I2C_BUS.read();
     }
-    sendMessage(F("[ERROR] Multiple failures. Sensor will remain in error state."), &Serial, currentClient);
-    sensor.sensorInitialized = false;
-    sensor.sensorStopped = true;
-    sensor.sensorConnected = 0;
-    softResetAttempt = 0;
+    reportI2CError(getFlowSensorIndex(sensor), millis());
     return false;
   }
-  softResetAttempt = 0;
 
-  uint16_t flowRaw = (Wire.read() << 8) | Wire.read();
-  Wire.read(); // Skip CRC
-  uint16_t tempRaw = (Wire.read() << 8) | Wire.read();
-  Wire.read(); // Skip CRC
-  uint16_t auxRaw = (Wire.read() << 8) | Wire.read();
-  Wire.read(); // Skip CRC
+  uint32_t sampleMicros = micros(); // Time the frame arrived
+  uint8_t frame[FLOW_SENSOR_FRAME_SIZE];
+  for (uint8_t b = 0; b < FLOW_SENSOR_FRAME_SIZE; b++)
+  {
+    frame[b] = I2C_BUS.read();
+  }
+  sensor.framesRead++;
+
+  // A corrupted frame is dropped; lastUpdateTime is kept so the next good
+  // sample integrates over the gap and no volume is lost
+  FlowSensorFrame decoded;
+  if (!decodeFlowSensorFrame(frame, decoded))
+  {
+    sensor.crcErrorCount++;
+    reportI2CError(getFlowSensorIndex(sensor), millis());
+    return false;
+  }
+  reportI2CSuccess(getFlowSensorIndex(sensor));
 
-  sensor.flowRate = ((int16_t)flowRaw) / 32.0;
-  sensor.temperature = ((int16_t)tempRaw) / 200.0;
-  sensor.highFlowFlag = (auxRaw & 0x02) ? 1 : 0;
+  sensor.flowRate = decoded.flowRaw / 32.0;
+  sensor.temperature = decoded.temperatureRaw / 200.0;
+  sensor.highFlowFlag = (decoded.flags & 0x02) ? 1 : 0;
   sensor.sensorConnected = 1;
   if (sensor.flowRate < 0)
     sensor.flowRate = 0.0;
 
   unsigned long currentTime = millis();
-  if (sensor.lastUpdateTime > 0)
+  integrateFlowSample(sensor, decoded.flowRaw, sampleMicros);
+  sensor.lastUpdateTime = currentTime;
+  sensor.isValidReading = true;
+
+  // Publish to the sensor's ring for the monitors
+  FlowSample &sample = sensor.ring.samples[sensor.ring.count % FLOW_SAMPLE_RING_SIZE];
+  sample.timeMs = currentTime;
+  sample.flowRate = sensor.flowRate;
+  sample.dispenseVolume = sensor.dispenseVolume;
+  if (++sensor.ring.count == 0)
+    sensor.ring.count = FLOW_SAMPLE_RING_SIZE; // Wrapped - keep the ring non-empty
+  return true;
+}
+
+uint8_t computeSensirionCrc(const uint8_t *data, uint8_t length)
+{
+  uint8_t crc = 0xFF;
+  for (uint8_t i = 0; i < length; i++)
   {
-    float elapsedMinutes = (currentTime - sensor.lastUpdateTime) / 60000.0;
-    float increment = sensor.flowRate * elapsedMinutes;
+    crc = pgm_read_byte(&SENSIRION_CRC_TABLE[crc ^ data[i]]);
+  }
+  return crc;
+}
 
-    // Apply calibration to the increment if enabled
-    if (sensor.useCorrection)
+// Split a 9-byte frame into its three words, checking each word's CRC byte
+bool decodeFlowSensorFrame(const uint8_t *frame, FlowSensorFrame &decoded)
+{
+  for (uint8_t word = 0; word < FLOW_SENSOR_FRAME_SIZE; word += 3)
+  {
+    if (computeSensirionCrc(&frame[word], 2) != frame[word + 2])
     {
-      // Apply the linear calibration formula: y = mx + b
-      // Where m is slope, b is offset, x is measured increment
-      increment = sensor.slopeCorrection * increment + sensor.offsetCorrection * elapsedMinutes;
+      return false;
     }
+  }
+
+  decoded.flowRaw = (int16_t)((frame[0] << 8) | frame[1]);
+  decoded.temperatureRaw = (int16_t)((frame[3] << 8) | frame[4]);
+  decoded.flags = (uint16_t)((frame[6] << 8) | frame[7]);
+  return true;
+}
+
+// ============================================================
+// Flow Sensor Acquisition Scheduler
+// ============================================================
 
-    sensor.dispenseVolume += increment;
-    sensor.totalVolume += increment;
+// Performs at most one I2C transaction per call. A due I2C recovery step goes
+// first, then a due SHT31 step (two short transactions a second); otherwise
+// the next active flow sensor whose sample period has elapsed, starting with
+// the one on the multiplexer channel that is already selected so back-to-back
+// reads skip the mux write. Devices under recovery are left out of rotation.
+void serviceFlowSensorAcquisition(unsigned long currentTime)
+{
+  static unsigned long lastSampleTime[NUM_FLOW_SENSORS] = {0};
+  static uint8_t lastSensorRead = 0;
+
+  // Most overdue sensor first, so a slow loop pass cannot starve the others;
+  // on a tie, the sensor on the multiplexer channel already selected
+  int next = -1;
+  unsigned long nextOverdue = 0;
+  for (int i = 0; i < NUM_FLOW_SENSORS; i++)
+  {
+    FlowSensor *sensor = flowSensors[i];
+
+    // Stopped sensors need no bus traffic, just their idle readings
+    if (!sensor->sensorInitialized || sensor->sensorStopped)
+    {
+      readFlowSensorData(*sensor);
+      continue;
+    }
+
+    unsigned long sinceSample = currentTime - lastSampleTime[i];
+    if (isI2CDeviceRecovering(i) || sinceSample < FLOW_SENSOR_SAMPLE_INTERVAL_MS)
+    {
+      continue;
+    }
+
+    unsigned long overdue = sinceSample - FLOW_SENSOR_SAMPLE_INTERVAL_MS;
+    if (next < 0 || overdue > nextOverdue ||
+        (overdue == nextOverdue && sensor->channel == flowSensors[lastSensorRead]->channel))
+    {
+      next = i;
+      nextOverdue = overdue;
+    }
   }
-  sensor.lastUpdateTime = currentTime;
-  sensor.isValidReading = true;
+
+  if (serviceI2CRecovery(currentTime))
+  {
+    return;
+  }
+
+  if (!isI2CDeviceRecovering(I2C_DEVICE_TEMP_HUM) && isTempHumidityStepDue(currentTime))
+  {
+    serviceTempHumidityStep(currentTime);
+    return;
+  }
+
+  if (next < 0)
+  {
+    return;
+  }
+
+  lastSampleTime[next] = currentTime;
+  lastSensorRead = next;
+  readFlowSensorData(*flowSensors[next]);
+}
+
+void clearFlowSampleRing(FlowSensor &sensor)
+{
+  sensor.ring.count = 0;
+}
+
+bool getLatestFlowSample(const FlowSensor &sensor, FlowSample &sample)
+{
+  if (sensor.ring.count == 0)
+  {
+    return false;
+  }
+  sample = sensor.ring.samples[(sensor.ring.count - 1) % FLOW_SAMPLE_RING_SIZE];
   return true;
 }
 
 bool startFlowSensorMeasurement(FlowSensor &sensor)
 {
-  sendMessage(F("[DEBUG] Starting flow measurement for sensor on channel "), &Serial, currentClient, false);
-  sendMessage(String(sensor.channel).c_str(), &Serial, currentClient);
+  if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+  {
+    sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Starting flow measurement for sensor on channel "), false);
+    sendLogMessage(LOG_LEVEL_DEBUG, String(sensor.channel).c_str());
+  }
 
   // Check connection first
   if (!isFlowSensorConnected(sensor))
@@ -269,9 +584,12 @@ bool startFlowSensorMeasurement(FlowSensor &sensor)
   // Simple approach: Always do full initialization
   for (int attempt = 0; attempt < 3; attempt++)
   {
-    sendMessage(F("[DEBUG] Attempt "), &Serial, currentClient, false);
-    sendMessage(String(attempt + 1).c_str(), &Serial, currentClient, false);
-    sendMessage(F(" to initialize sensor."), &Serial, currentClient);
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+    {
+      sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Attempt "), false);
+      sendLogMessage(LOG_LEVEL_DEBUG, String(attempt + 1).c_str(), false);
+      sendLogMessage(LOG_LEVEL_DEBUG, F(" to initialize sensor."));
+    }
 
     if (initializeFlowSensor(sensor))
     {
@@ -292,10 +610,10 @@ bool stopFlowSensorMeasurement(FlowSensor &sensor)
   selectMultiplexerChannel(sensor.multiplexerAddr, sensor.channel);
   delay(50);
 
-  Wire.beginTransmission(sensor.sensorAddr);
-  Wire.write(0x3F);
-  Wire.write(0xF9);
-  int result = Wire.endTransmission();
+  I2C_BUS.beginTransmission(sensor.sensorAddr);
+  I2C_BUS.write(0x3F);
+  I2C_BUS.write(0xF9);
+  int result = I2C_BUS.endTransmission();
 
   if (result == 0)
   {
@@ -319,6 +637,26 @@ bool stopFlowSensorMeasurement(FlowSensor &sensor)
   return false;
 }
 
+// Recovery steps for the I2C health manager: no delays, the manager waits
+// I2C_FLOW_RESET_MS after the reset before resuming measurement
+bool softResetFlowSensor(FlowSensor &sensor)
+{
+  selectMultiplexerChannel(sensor.multiplexerAddr, sensor.channel);
+  I2C_BUS.beginTransmission(sensor.sensorAddr); // Same reset as initializeFlowSensor()
+  I2C_BUS.write(0x00);
+  I2C_BUS.write(0x06);
+  return I2C_BUS.endTransmission() == 0;
+}
+
+bool resumeFlowSensorMeasurement(FlowSensor &sensor)
+{
+  selectMultiplexerChannel(sensor.multiplexerAddr, sensor.channel);
+  I2C_BUS.beginTransmission(sensor.sensorAddr);
+  I2C_BUS.write(sensor.measurementCmd >> 8);
+  I2C_BUS.write(sensor.measurementCmd & 0xFF);
+  return I2C_BUS.endTransmission() == 0;
+}
+
 bool setFlowSensorFluidType(FlowSensor &sensor, FluidType fluidType)
 {
   // First stop measurement if running
@@ -382,8 +720,12 @@ const char *getFluidTypeString(FluidType type)
 // ============================================================
 float readPressureVoltage(const PressureSensor &sensor)
 {
+#if HYDRAULIC_SIM
+  return simReadPressureVoltage(sensor);
+#else
   int analogValue = analogRead(sensor.analogPin);
   return (analogValue / 1023.0) * 10.0;
+#endif
 }
 
 float readPressure(const PressureSensor &sensor)
@@ -398,8 +740,11 @@ float readPressure(const PressureSensor &sensor)
 void resetFlowSensorDispenseVolume(FlowSensor &sensor)
 {
   sensor.dispenseVolume = 0.0;
+  sensor.dispenseVolumeNl = 0;
   sensor.lastUpdateTime = millis();
+  restartFlowIntegrator(sensor);
   sensor.sensorStopped = true; // Ensure sensor is stopped
+  clearFlowSampleRing(sensor);
   sendMessage(F("[MESSAGE] Dispense volume reset for flow sensor on channel "), &Serial, currentClient, false);
   sendMessage(String(sensor.channel).c_str(), &Serial, currentClient);
 }
@@ -407,6 +752,7 @@ void resetFlowSensorDispenseVolume(FlowSensor &sensor)
 void resetFlowSensorTotalVolume(FlowSensor &sensor)
 {
   sensor.totalVolume = 0.0;
+  sensor.totalVolumeNl = 0;
   sendMessage(F("[MESSAGE] Total volume reset for flow sensor on channel "), &Serial, currentClient, false);
   sendMessage(String(sensor.channel).c_str(), &Serial, currentClient);
 }
@@ -20,7 +20,8 @@
 // Temperature & Humidity Sensor Functions
 // ============================================================
 bool tempHumSensorInit();
-TempHumidity readTempHumidity();
+TempHumidity readTempHumidity(); // Cached; refreshed by serviceFlowSensorAcquisition()
+bool softResetTempHumSensor();
 
 // ============================================================
 // Flow Sensor Configuration Functions
@@ -33,11 +34,26 @@ bool isFlowSensorConnected(FlowSensor &sensor);
 // ============================================================
 bool initializeFlowSensor(FlowSensor &sensor);
 bool readFlowSensorData(FlowSensor &sensor);
+uint8_t computeSensirionCrc(const uint8_t *data, uint8_t length);
+bool decodeFlowSensorFrame(const uint8_t *frame, FlowSensorFrame &decoded);
 bool startFlowSensorMeasurement(FlowSensor &sensor);
 bool stopFlowSensorMeasurement(FlowSensor &sensor);
 bool setFlowSensorFluidType(FlowSensor &sensor, FluidType fluidType);
 const char* getFluidTypeString(FluidType type);
 
+// ============================================================
+// Flow Sensor Acquisition Functions
+// ============================================================
+void serviceFlowSensorAcquisition(unsigned long currentTime);
+void clearFlowSampleRing(FlowSensor &sensor);
+bool getLatestFlowSample(const FlowSensor &sensor, FlowSample &sample);
+
+// ============================================================
+// Flow Sensor Recovery Functions (I2C health manager)
+// ============================================================
+bool softResetFlowSensor(FlowSensor &sensor);
+bool resumeFlowSensorMeasurement(FlowSensor &sensor);
+
 // ============================================================
 // Flow Sensor Volume Management Functions
 // ============================================================
@@ -5,6 +5,9 @@
 #include <Wire.h>
 #include "CommandSession.h"
 #include "CommandManager.h"
+#include "DispensePredictor.h"
+#include "Logging.h"
+#include "DrainScheduler.h"
 
 /************************************************************
  * SystemMonitor.cpp
@@ -14,6 +17,7 @@
  * 2. Fill System: Trough filling monitoring
  * 3. Waste System: Drainage and vacuum monitoring
  * 4. Safety Systems: Enclosure and temperature monitoring
+ * 5. Monitor Scheduler: Timer wheel, activation and run statistics
  ************************************************************/
 
 // ============================================================
@@ -43,7 +47,6 @@ static bool wasteVacuumReleased[2] = {false};
 
 // Enclosure monitoring variables
 static bool enclosureLeakAbortCalled = false;
-static unsigned long enclosureLeakCheckTime = 0;
 static unsigned long enclosureLeakErrorTime = 0;
 
 // Constants
@@ -137,50 +140,64 @@ void handleTimeoutCondition(int troughNumber)
   valveControls[troughNumber - 1].targetVolume = -1;
 }
 
-void monitorOverflowSensors(unsigned long currentTime)
+void monitorOverflowSensor(int i, unsigned long currentTime)
 {
-  static unsigned long previousOverflowCheckTime = 0;
-
-  // Check every 25ms (non-blocking)
-  if (currentTime - previousOverflowCheckTime >= 25)
+  if (readBinarySensor(overflowSensors[i]))
   {
-    previousOverflowCheckTime = currentTime;
-    for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
-    {
-      if (readBinarySensor(overflowSensors[i]))
-      {
-        handleOverflowCondition(i + 1);
-      }
-    }
+    handleOverflowCondition(i + 1);
   }
 }
 
-void monitorFlowSensors(unsigned long currentTime)
+void monitorFlowSensor(int i, unsigned long currentTime)
 {
-  static unsigned long previousCheckTime = 0;
   const unsigned long FLOW_TIMEOUT_MS = 30000; // 30 seconds timeout
   const float MIN_FLOW_RATE_THRESHOLD = 1.0;
   const float MAX_TROUGH_VOLUME = 210.0;
 
-  if (currentTime - previousCheckTime < 25)
+  if (!valveControls[i].isDispensing)
   {
-    return; // Only check every 25ms
+    cancelDispenseSettle(i); // Stopped or aborted while settling
+    return;
   }
-  previousCheckTime = currentTime;
 
-  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  FlowSensor *sensor = flowSensors[i];
+  if (!sensor)
+    return;
+
+  // 1. Check for overflow (highest priority)
+  if (readBinarySensor(overflowSensors[i]))
   {
-    if (!valveControls[i].isDispensing)
-      continue;
+    cancelDispenseSettle(i);
+    flow_handleDispenseOverflow(i, sensor);
+    if (!dispenseAsyncCompleted[i])
+    {
+      if (hasActiveClient)
+      {
+        cm_commandCompleted(&currentClient);
+      }
+      else
+      {
+        cm_commandCompleted(&Serial);
+      }
+      dispenseAsyncCompleted[i] = true;
+    }
+    return;
+  }
 
-    FlowSensor *sensor = flowSensors[i];
-    if (!sensor)
-      continue;
+  // 2. Skip checks if in manual control
+  if (valveControls[i].manualControl)
+  {
+    valveControls[i].lastFlowCheckTime = 0;
+    valveControls[i].lastFlowChangeTime = 0;
+    return;
+  }
 
-    // 1. Check for overflow (highest priority)
-    if (readBinarySensor(overflowSensors[i]))
+  // Valves already closed: wait for the flow to stop before completing
+  if (isDispenseSettling(i))
+  {
+    if (serviceDispenseSettle(i, sensor, currentTime))
     {
-      flow_handleDispenseOverflow(i, sensor);
+      flow_handleVolumeComplete(i, sensor);
       if (!dispenseAsyncCompleted[i])
       {
         if (hasActiveClient)
@@ -193,52 +210,28 @@ void monitorFlowSensors(unsigned long currentTime)
         }
         dispenseAsyncCompleted[i] = true;
       }
-      continue;
     }
+    return;
+  }
 
-    // 2. Skip checks if in manual control
-    if (valveControls[i].manualControl)
-    {
-      valveControls[i].lastFlowCheckTime = 0;
-      valveControls[i].lastFlowChangeTime = 0;
-      continue;
-    }
+  // Flow checks use the latest sample published by the acquisition scheduler
+  FlowSample sample;
+  if (!getLatestFlowSample(*sensor, sample))
+  {
+    sample.flowRate = 0.0; // No reading since the dispense started
+    sample.dispenseVolume = 0.0;
+  }
 
-    // 3. Check for flow timeout
-    if (sensor->flowRate < MIN_FLOW_RATE_THRESHOLD)
+  // 3. Check for flow timeout
+  if (sample.flowRate < MIN_FLOW_RATE_THRESHOLD)
+  {
+    if (valveControls[i].lastFlowCheckTime == 0)
     {
-      if (valveControls[i].lastFlowCheckTime == 0)
-      {
-        valveControls[i].lastFlowCheckTime = currentTime;
-      }
-      else if (currentTime - valveControls[i].lastFlowCheckTime >= FLOW_TIMEOUT_MS)
-      {
-        handleTimeoutCondition(i + 1);
-        if (!dispenseAsyncCompleted[i])
-        {
-          if (hasActiveClient)
-          {
-            cm_commandCompleted(&currentClient);
-          }
-          else
-          {
-            cm_commandCompleted(&Serial);
-          }
-          dispenseAsyncCompleted[i] = true;
-        }
-        continue;
-      }
+      valveControls[i].lastFlowCheckTime = currentTime;
     }
-    else
+    else if (currentTime - valveControls[i].lastFlowCheckTime >= FLOW_TIMEOUT_MS)
     {
-      valveControls[i].lastFlowCheckTime = 0;
-    }
-
-    // 4. Check if target volume reached
-    if (valveControls[i].targetVolume > 0 &&
-        sensor->dispenseVolume >= valveControls[i].targetVolume)
-    {
-      flow_handleVolumeComplete(i, sensor);
+      handleTimeoutCondition(i + 1);
       if (!dispenseAsyncCompleted[i])
       {
         if (hasActiveClient)
@@ -251,25 +244,38 @@ void monitorFlowSensors(unsigned long currentTime)
         }
         dispenseAsyncCompleted[i] = true;
       }
-      continue;
+      return;
     }
+  }
+  else
+  {
+    valveControls[i].lastFlowCheckTime = 0;
+  }
 
-    // 5. Safety check for maximum volume
-    if (sensor->dispenseVolume >= MAX_TROUGH_VOLUME)
+  // 4. Check if target volume reached (or will be, counting the predicted overshoot)
+  if (valveControls[i].targetVolume > 0 &&
+      shouldCloseDispense(i, sample.dispenseVolume, sample.flowRate, valveControls[i].targetVolume))
+  {
+    closeDispenseValves(i + 1);
+    beginDispenseSettle(i, sample.dispenseVolume, sample.flowRate);
+    return;
+  }
+
+  // 5. Safety check for maximum volume
+  if (sample.dispenseVolume >= MAX_TROUGH_VOLUME)
+  {
+    flow_handleSafetyLimitExceeded(i, sensor, MAX_TROUGH_VOLUME);
+    if (!dispenseAsyncCompleted[i])
     {
-      flow_handleSafetyLimitExceeded(i, sensor, MAX_TROUGH_VOLUME);
-      if (!dispenseAsyncCompleted[i])
+      if (hasActiveClient)
       {
-        if (hasActiveClient)
-        {
-          cm_commandCompleted(&currentClient);
-        }
-        else
-        {
-          cm_commandCompleted(&Serial);
-        }
-        dispenseAsyncCompleted[i] = true;
+        cm_commandCompleted(&currentClient);
+      }
+      else
+      {
+        cm_commandCompleted(&Serial);
       }
+      dispenseAsyncCompleted[i] = true;
     }
   }
 }
@@ -295,6 +301,8 @@ void flow_handleVolumeComplete(int i, FlowSensor *sensor)
   sendMessage(String(i + 1).c_str(), &Serial, currentClient, false);
   sendMessage(F(". Final volume dispensed: "), &Serial, currentClient, false);
   sendMessage(String(sensor->dispenseVolume, 1).c_str(), &Serial, currentClient, false);
+  sendMessage(F(" mL. Error: "), &Serial, currentClient, false);
+  sendMessage(String(dispenseErrorStats[i].lastError, 2).c_str(), &Serial, currentClient, false);
   sendMessage(F(" mL."), &Serial, currentClient);
 
   resetFlowSensorDispenseVolume(*sensor);
@@ -322,74 +330,74 @@ void flow_handleSafetyLimitExceeded(int i, FlowSensor *sensor, float maxVolume)
 // Prime System Implementation
 // ============================================================
 
-void monitorPrimeSensors(unsigned long currentTime)
+void monitorPrimeSensor(int i, unsigned long currentTime)
 {
-  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  if (!valveControls[i].isPriming)
   {
-    if (!valveControls[i].isPriming)
-    {
-      resetPrimingStates(i);
-      continue;
-    }
+    resetPrimingStates(i);
+    return;
+  }
 
-    FlowSensor *sensor = flowSensors[i];
-    if (!sensor)
-      continue;
+  FlowSensor *sensor = flowSensors[i];
+  if (!sensor)
+    return;
 
-    // Initialize priming if needed
-    if (primeModeStartTime[i] == 0)
+  // Initialize priming if needed
+  if (primeModeStartTime[i] == 0)
+  {
+    primeModeStartTime[i] = currentTime;
+    // Reset flow sensor volume counter when starting prime
+    resetFlowSensorDispenseVolume(*sensor);
+    // Start measurement explicitly
+    startFlowSensorMeasurement(*sensor);
+    // Log that we're starting
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))
     {
-      primeModeStartTime[i] = currentTime;
-      // Reset flow sensor volume counter when starting prime
-      resetFlowSensorDispenseVolume(*sensor);
-      // Start measurement explicitly
-      startFlowSensorMeasurement(*sensor);
-      // Log that we're starting
-      sendMessage(F("[DEBUG] Started flow measurement for sensor "), &Serial, currentClient, false);
-      sendMessage(String(i + 1).c_str(), &Serial, currentClient);
+      sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Started flow measurement for sensor "), false);
+      sendLogMessage(LOG_LEVEL_DEBUG, String(i + 1).c_str());
     }
+  }
 
-    // 1. Check overflow (highest priority)
-    if (readBinarySensor(overflowSensors[i]))
+  // 1. Check overflow (highest priority)
+  if (readBinarySensor(overflowSensors[i]))
+  {
+    handlePrimingOverflow(i);
+    return;
+  }
+
+  // 2. Check flow rate
+  if (sensor->flowRate < MIN_FLOW_RATE_PRIME)
+  {
+    if (handleLowFlowCondition(i, currentTime))
     {
-      handlePrimingOverflow(i);
-      continue;
+      return;
     }
+  }
+  else
+  {
+    primeLowFlowTime[i] = 0;
+  }
 
-    // 2. Check flow rate
-    if (sensor->flowRate < MIN_FLOW_RATE_PRIME)
+  // 3. Bubble Detection Logic
+  if (!primeModeFailed[i] && !primeModeSuccess[i])
+  {
+    if (readBinarySensor(reagentBubbleSensors[i]))
     {
-      if (handleLowFlowCondition(i, currentTime))
-      {
-        continue;
-      }
+      handleBubbleDetected(i, currentTime);
     }
     else
     {
-      primeLowFlowTime[i] = 0;
-    }
-
-    // 3. Bubble Detection Logic
-    if (!primeModeFailed[i] && !primeModeSuccess[i])
-    {
-      if (readBinarySensor(reagentBubbleSensors[i]))
+      if (handleNoBubbleDetected(i, currentTime))
       {
-        handleBubbleDetected(i, currentTime);
-      }
-      else
-      {
-        if (handleNoBubbleDetected(i, currentTime))
-        {
-          continue;
-        }
+        return;
       }
     }
+  }
 
-    // 4. Volume-based check (replaces time-based check)
-    if (primeVolumeTarget[i] > 0.0 && sensor && sensor->dispenseVolume >= primeVolumeTarget[i])
-    {
-      handlePrimingComplete(i);
-    }
+  // 4. Volume-based check (replaces time-based check)
+  if (primeVolumeTarget[i] > 0.0 && sensor && sensor->dispenseVolume >= primeVolumeTarget[i])
+  {
+    handlePrimingComplete(i);
   }
 }
 
@@ -413,15 +421,17 @@ void handlePrimingOverflow(int i)
 
   closeDispenseValves(i + 1);
   valveControls[i].isPriming = false;
-  primeAsyncCompleted[i] = true;
-
-  if (hasActiveClient)
+  if (!primeAsyncCompleted[i])
   {
-    cm_commandCompleted(&currentClient);
-  }
-  else
-  {
-    cm_commandCompleted(&Serial);
+    if (hasActiveClient)
+    {
+      cm_commandCompleted(&currentClient);
+    }
+    else
+    {
+      cm_commandCompleted(&Serial);
+    }
+    primeAsyncCompleted[i] = true;
   }
 
   resetPrimingStates(i);
@@ -444,15 +454,17 @@ bool handleLowFlowCondition(int i, unsigned long currentTime)
 
     closeDispenseValves(i + 1);
     valveControls[i].isPriming = false;
-    primeAsyncCompleted[i] = true;
-
-    if (hasActiveClient)
-    {
-      cm_commandCompleted(&currentClient);
-    }
-    else
+    if (!primeAsyncCompleted[i])
     {
-      cm_commandCompleted(&Serial);
+      if (hasActiveClient)
+      {
+        cm_commandCompleted(&currentClient);
+      }
+      else
+      {
+        cm_commandCompleted(&Serial);
+      }
+      primeAsyncCompleted[i] = true;
     }
 
     resetPrimingStates(i);
@@ -485,11 +497,14 @@ void handleBubbleDetected(int i, unsigned long currentTime)
       // Set target using line-specific additional volume
       primeVolumeTarget[i] = sensor->dispenseVolume + PRIME_ADDITIONAL_VOLUME_ML[i];
 
-      sendMessage(F("[DEBUG] Fluid detected in reagent line "), &Serial, currentClient, false);
-      sendMessage(String(i + 1).c_str(), &Serial, currentClient, false);
-      sendMessage(F(". Will dispense "), &Serial, currentClient, false);
-      sendMessage(String(PRIME_ADDITIONAL_VOLUME_ML[i]).c_str(), &Serial, currentClient, false);
-      sendMessage(F(" mL more."), &Serial, currentClient);
+      if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+      {
+        sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Fluid detected in reagent line "), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, String(i + 1).c_str(), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, F(". Will dispense "), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, String(PRIME_ADDITIONAL_VOLUME_ML[i]).c_str(), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, F(" mL more."));
+      }
     }
 
     // Check if we've reached the volume target
@@ -520,15 +535,17 @@ bool handleNoBubbleDetected(int i, unsigned long currentTime)
 
     closeDispenseValves(i + 1);
     valveControls[i].isPriming = false;
-    primeAsyncCompleted[i] = true;
-
-    if (hasActiveClient)
+    if (!primeAsyncCompleted[i])
     {
-      cm_commandCompleted(&currentClient);
-    }
-    else
-    {
-      cm_commandCompleted(&Serial);
+      if (hasActiveClient)
+      {
+        cm_commandCompleted(&currentClient);
+      }
+      else
+      {
+        cm_commandCompleted(&Serial);
+      }
+      primeAsyncCompleted[i] = true;
     }
 
     primeModeFailed[i] = true;
@@ -560,15 +577,17 @@ void handlePrimingComplete(int i)
 
   valveControls[i].isPriming = false;
   primeModeSuccess[i] = true;
-  primeAsyncCompleted[i] = true;
-
-  if (hasActiveClient)
-  {
-    cm_commandCompleted(&currentClient);
-  }
-  else
+  if (!primeAsyncCompleted[i])
   {
-    cm_commandCompleted(&Serial);
+    if (hasActiveClient)
+    {
+      cm_commandCompleted(&currentClient);
+    }
+    else
+    {
+      cm_commandCompleted(&Serial);
+    }
+    primeAsyncCompleted[i] = true;
   }
 
   resetPrimingStates(i);
@@ -578,7 +597,7 @@ void handlePrimingComplete(int i)
 // Fill System Implementation
 // ============================================================
 
-void monitorFillSensors(unsigned long currentTime)
+void monitorFillSensor(int i, unsigned long currentTime)
 {
   const float MAX_FILL_VOLUME_ML = 230.0;
   const unsigned long MAX_FILL_TIME_MS = 240000; // 4 minutes
@@ -586,76 +605,73 @@ void monitorFillSensors(unsigned long currentTime)
   const float MIN_FLOW_RATE_FILL = 1;
   const unsigned long SENSOR_CHECK_INTERVAL = 500;
 
-  for (int i = 0; i < NUM_OVERFLOW_SENSORS; i++)
+  if (!valveControls[i].fillMode)
   {
-    if (!valveControls[i].fillMode)
-    {
-      // Reset states when not in fill mode
-      fillModeStartTime[i] = 0;
-      fillModeLowFlowTime[i] = 0;
-      fillModeLastCheck[i] = 0;
-      continue;
-    }
+    // Reset states when not in fill mode
+    fillModeStartTime[i] = 0;
+    fillModeLowFlowTime[i] = 0;
+    fillModeLastCheck[i] = 0;
+    return;
+  }
 
-    FlowSensor *sensor = flowSensors[i];
-    if (!sensor)
-      continue;
+  FlowSensor *sensor = flowSensors[i];
+  if (!sensor)
+    return;
 
-    // Initialize fill operation if needed
-    if (fillModeStartTime[i] == 0)
-    {
-      fillModeStartTime[i] = currentTime;
+  // Initialize fill operation if needed
+  if (fillModeStartTime[i] == 0)
+  {
+    fillModeStartTime[i] = currentTime;
 
-      // Start flow measurement explicitly - ADD THIS CODE
-      resetFlowSensorDispenseVolume(*sensor);
-      startFlowSensorMeasurement(*sensor);
-      sendMessage(F("[MESSAGE] Started flow measurement for fill mode on sensor "), &Serial, currentClient, false);
-      sendMessage(String(i + 1).c_str(), &Serial, currentClient);
+    // Start flow measurement explicitly - ADD THIS CODE
+    resetFlowSensorDispenseVolume(*sensor);
+    startFlowSensorMeasurement(*sensor);
+    sendMessage(F("[MESSAGE] Started flow measurement for fill mode on sensor "), &Serial, currentClient, false);
+    sendMessage(String(i + 1).c_str(), &Serial, currentClient);
 
-      fillModeInitialVolume[i] = 0.0; // Reset to zero since we're starting fresh
-      fillModeLowFlowTime[i] = 0;
-    }
+    fillModeInitialVolume[i] = 0.0; // Reset to zero since we're starting fresh
+    fillModeLowFlowTime[i] = 0;
+  }
 
-    float addedVolume = sensor->dispenseVolume - fillModeInitialVolume[i];
+  float addedVolume = sensor->dispenseVolume - fillModeInitialVolume[i];
 
-    // Check maximum fill time (primary safety check)
-    if (currentTime - fillModeStartTime[i] >= MAX_FILL_TIME_MS)
-    {
-      fill_handleMaxTimeReached(i + 1);
-      continue;
-    }
+  // Check maximum fill time (primary safety check)
+  if (currentTime - fillModeStartTime[i] >= MAX_FILL_TIME_MS)
+  {
+    fill_handleMaxTimeReached(i + 1);
+    return;
+  }
 
-    // Check maximum volume
-    if (addedVolume >= MAX_FILL_VOLUME_ML)
-    {
-      fill_handleMaxVolumeReached(i + 1);
-      continue;
-    }
+  // Check maximum volume
+  if (addedVolume >= MAX_FILL_VOLUME_ML)
+  {
+    fill_handleMaxVolumeReached(i + 1);
+    return;
+  }
 
-    // Monitor flow rate
-    if (sensor->flowRate < MIN_FLOW_RATE_FILL)
+  // Monitor flow rate
+  if (sensor->flowRate < MIN_FLOW_RATE_FILL)
+  {
+    if (fillModeLowFlowTime[i] == 0)
     {
-      if (fillModeLowFlowTime[i] == 0)
-      {
-        fillModeLowFlowTime[i] = currentTime;
-      }
-      else if ((currentTime - fillModeLowFlowTime[i]) >= FLOW_TIMEOUT_MS)
-      {
-        fill_handleFlowTimeout(i + 1);
-        continue;
-      }
+      fillModeLowFlowTime[i] = currentTime;
     }
-    else
+    else if ((currentTime - fillModeLowFlowTime[i]) >= FLOW_TIMEOUT_MS)
     {
-      fillModeLowFlowTime[i] = 0;
+      fill_handleFlowTimeout(i + 1);
+      return;
     }
+  }
+  else
+  {
+    fillModeLowFlowTime[i] = 0;
+  }
 
-    // Periodic overflow sensor check
-    if (currentTime - fillModeLastCheck[i] >= SENSOR_CHECK_INTERVAL)
-    {
-      fillModeLastCheck[i] = currentTime;
-      fill_handleOverflowCheck(i + 1);
-    }
+  // Periodic overflow sensor check
+  if (currentTime - fillModeLastCheck[i] >= SENSOR_CHECK_INTERVAL)
+  {
+    fillModeLastCheck[i] = currentTime;
+    fill_handleOverflowCheck(i + 1);
   }
 }
 
@@ -747,35 +763,79 @@ void fill_handleOverflowCheck(int trough)
 // Waste System Implementation
 // ============================================================
 
-void monitorWasteSensors(unsigned long currentTime)
+void monitorWasteSensor(int sensorIdx, unsigned long currentTime)
 {
   const unsigned long DRAIN_COMPLETE_DELAY = 5000;    // 5 seconds
   const unsigned long MAX_DRAIN_TIME = 240000;        // 4 minutes
   const unsigned long DRAIN_INITIATE_TIMEOUT = 30000; // 30 seconds
 
-  for (int sensorIdx = 0; sensorIdx < 2; sensorIdx++)
+  bool liquidDetected = readBinarySensor(wasteLineSensors[sensorIdx]);
+
+  for (int i = sensorIdx * 2; i < sensorIdx * 2 + 2; i++)
   {
-    bool liquidDetected = readBinarySensor(wasteLineSensors[sensorIdx]);
+    if (!valveControls[i].isDraining)
+      continue;
 
-    for (int i = sensorIdx * 2; i < sensorIdx * 2 + 2; i++)
+    // Initialize drain start time if needed
+    if (valveControls[i].drainStartTime == 0)
     {
-      if (!valveControls[i].isDraining)
-        continue;
+      valveControls[i].drainStartTime = currentTime;
+      if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+      {
+        sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Trough "), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, String(i + 1).c_str(), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, F(" drainStartTime set to: "), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, String(currentTime).c_str());
+      }
+    }
+
+    // Check for maximum drain time timeout
+    if (currentTime - valveControls[i].drainStartTime >= MAX_DRAIN_TIME)
+    {
+      waste_handleMaxDrainTimeout(i + 1, currentTime - valveControls[i].drainStartTime);
+      if (!drainAsyncCompleted[i])
+      {
+        if (hasActiveClient)
+        {
+          cm_commandCompleted(&currentClient);
+        }
+        else
+        {
+          cm_commandCompleted(&Serial);
+        }
+        drainAsyncCompleted[i] = true;
+      }
+      continue;
+    }
 
-      // Initialize drain start time if needed
-      if (valveControls[i].drainStartTime == 0)
+    // Check for initiation timeout if no liquid detected
+    if (!liquidDetected && !wasteLiquidDetected[sensorIdx] &&
+        currentTime - valveControls[i].drainStartTime >= DRAIN_INITIATE_TIMEOUT)
+    {
+      waste_handleInitiationTimeout(i + 1);
+      if (!drainAsyncCompleted[i])
       {
-        valveControls[i].drainStartTime = currentTime;
-        sendMessage(F("[DEBUG] Trough "), &Serial, currentClient, false);
-        sendMessage(String(i + 1).c_str(), &Serial, currentClient, false);
-        sendMessage(F(" drainStartTime set to: "), &Serial, currentClient, false);
-        sendMessage(String(currentTime).c_str(), &Serial, currentClient);
+        if (hasActiveClient)
+        {
+          cm_commandCompleted(&currentClient);
+        }
+        else
+        {
+          cm_commandCompleted(&Serial);
+        }
+        drainAsyncCompleted[i] = true;
       }
+    }
+  }
 
-      // Check for maximum drain time timeout
-      if (currentTime - valveControls[i].drainStartTime >= MAX_DRAIN_TIME)
+  // Check waste bottle full condition
+  if (readBinarySensor(wasteBottleSensors[sensorIdx]))
+  {
+    for (int i = sensorIdx * 2; i < sensorIdx * 2 + 2; i++)
+    {
+      if (valveControls[i].isDraining)
       {
-        waste_handleMaxDrainTimeout(i + 1, currentTime - valveControls[i].drainStartTime);
+        waste_handleBottleFull(i + 1);
         if (!drainAsyncCompleted[i])
         {
           if (hasActiveClient)
@@ -788,14 +848,25 @@ void monitorWasteSensors(unsigned long currentTime)
           }
           drainAsyncCompleted[i] = true;
         }
-        continue;
       }
+    }
+    return;
+  }
 
-      // Check for initiation timeout if no liquid detected
-      if (!liquidDetected && !wasteLiquidDetected[sensorIdx] &&
-          currentTime - valveControls[i].drainStartTime >= DRAIN_INITIATE_TIMEOUT)
+  // Monitor drain completion
+  if (readBinarySensor(wasteLineSensors[sensorIdx]))
+  {
+    wasteDrainCompleteTime[sensorIdx] = currentTime;
+    wasteLiquidDetected[sensorIdx] = true;
+  }
+  else if (wasteLiquidDetected[sensorIdx] &&
+           (currentTime - wasteDrainCompleteTime[sensorIdx] >= DRAIN_COMPLETE_DELAY))
+  {
+    for (int i = sensorIdx * 2; i < sensorIdx * 2 + 2; i++)
+    {
+      if (valveControls[i].isDraining)
       {
-        waste_handleInitiationTimeout(i + 1);
+        waste_handleDrainComplete(i + 1);
         if (!drainAsyncCompleted[i])
         {
           if (hasActiveClient)
@@ -810,80 +881,25 @@ void monitorWasteSensors(unsigned long currentTime)
         }
       }
     }
+    wasteDrainCompleteTime[sensorIdx] = 0;
+    wasteLiquidDetected[sensorIdx] = false;
+    wasteVacuumReleased[sensorIdx] = false;
+  }
 
-    // Check waste bottle full condition
-    if (readBinarySensor(wasteBottleSensors[sensorIdx]))
-    {
-      for (int i = sensorIdx * 2; i < sensorIdx * 2 + 2; i++)
-      {
-        if (valveControls[i].isDraining)
-        {
-          waste_handleBottleFull(i + 1);
-          if (!drainAsyncCompleted[i])
-          {
-            if (hasActiveClient)
-            {
-              cm_commandCompleted(&currentClient);
-            }
-            else
-            {
-              cm_commandCompleted(&Serial);
-            }
-            drainAsyncCompleted[i] = true;
-          }
-        }
-      }
-      continue;
-    }
-
-    // Monitor drain completion
-    if (readBinarySensor(wasteLineSensors[sensorIdx]))
+  // Check vacuum release
+  if (!wasteVacuumReleased[sensorIdx] && !readBinarySensor(wasteVacuumSensors[sensorIdx]))
+  {
+    if (sensorIdx == 0)
     {
-      wasteDrainCompleteTime[sensorIdx] = currentTime;
-      wasteLiquidDetected[sensorIdx] = true;
+      wasteValve3 = closeValve(wasteValve3);
+      sendMessage(F("[MESSAGE] Vacuum released. Waste valve 3 closed."), &Serial, currentClient);
     }
-    else if (wasteLiquidDetected[sensorIdx] &&
-             (currentTime - wasteDrainCompleteTime[sensorIdx] >= DRAIN_COMPLETE_DELAY))
-    {
-      for (int i = sensorIdx * 2; i < sensorIdx * 2 + 2; i++)
-      {
-        if (valveControls[i].isDraining)
-        {
-          waste_handleDrainComplete(i + 1);
-          if (!drainAsyncCompleted[i])
-          {
-            if (hasActiveClient)
-            {
-              cm_commandCompleted(&currentClient);
-            }
-            else
-            {
-              cm_commandCompleted(&Serial);
-            }
-            drainAsyncCompleted[i] = true;
-          }
-        }
-      }
-      wasteDrainCompleteTime[sensorIdx] = 0;
-      wasteLiquidDetected[sensorIdx] = false;
-      wasteVacuumReleased[sensorIdx] = false;
-    }
-
-    // Check vacuum release
-    if (!wasteVacuumReleased[sensorIdx] && !readBinarySensor(wasteVacuumSensors[sensorIdx]))
+    else
     {
-      if (sensorIdx == 0)
-      {
-        wasteValve3 = closeValve(wasteValve3);
-        sendMessage(F("[MESSAGE] Vacuum released. Waste valve 3 closed."), &Serial, currentClient);
-      }
-      else
-      {
-        wasteValve4 = closeValve(wasteValve4);
-        sendMessage(F("[MESSAGE] Vacuum released. Waste valve 4 closed."), &Serial, currentClient);
-      }
-      wasteVacuumReleased[sensorIdx] = true;
+      wasteValve4 = closeValve(wasteValve4);
+      sendMessage(F("[MESSAGE] Vacuum released. Waste valve 4 closed."), &Serial, currentClient);
     }
+    wasteVacuumReleased[sensorIdx] = true;
   }
 }
 
@@ -903,7 +919,7 @@ void waste_handleDrainTimeout(int trough, unsigned long drainDuration)
     wasteValve1 = closeValve(wasteValve1);
     wasteValve3 = openValve(wasteValve3);
     globalVacuumMonitoring[0] = true; // Enable vacuum monitoring
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE (after drain timeout)"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE (after drain timeout)"));
     break;
   case 2:
     wasteValve1 = closeValve(wasteValve1);
@@ -913,7 +929,7 @@ void waste_handleDrainTimeout(int trough, unsigned long drainDuration)
     wasteValve2 = closeValve(wasteValve2);
     wasteValve4 = openValve(wasteValve4);
     globalVacuumMonitoring[1] = true; // Enable vacuum monitoring
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE (after drain timeout)"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE (after drain timeout)"));
     break;
   case 4:
     wasteValve2 = closeValve(wasteValve2);
@@ -974,7 +990,7 @@ void waste_handleDrainComplete(int trough)
     wasteValve1 = closeValve(wasteValve1);
     wasteValve3 = openValve(wasteValve3);
     globalVacuumMonitoring[0] = true;
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE"));
     break;
   case 2:
     wasteValve1 = closeValve(wasteValve1);
@@ -984,7 +1000,7 @@ void waste_handleDrainComplete(int trough)
     wasteValve2 = closeValve(wasteValve2);
     wasteValve4 = openValve(wasteValve4);
     globalVacuumMonitoring[1] = true;
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE"));
     break;
   case 4:
     wasteValve2 = closeValve(wasteValve2);
@@ -997,6 +1013,9 @@ void waste_handleDrainComplete(int trough)
 
   sendMessage(F("[MESSAGE] Draining complete for trough "), &Serial, currentClient, false);
   sendMessage(String(trough).c_str(), &Serial, currentClient);
+
+  // A queued drain on this bottle takes it over before it vents
+  onDrainComplete(trough);
 }
 
 void waste_handleMaxDrainTimeout(int trough, unsigned long drainDuration)
@@ -1014,7 +1033,7 @@ void waste_handleMaxDrainTimeout(int trough, unsigned long drainDuration)
     wasteValve1 = closeValve(wasteValve1);
     wasteValve3 = openValve(wasteValve3);
     globalVacuumMonitoring[0] = true; // Enable vacuum monitoring
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE (after max drain timeout)"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE (after max drain timeout)"));
     break;
   case 2:
     wasteValve1 = closeValve(wasteValve1);
@@ -1024,7 +1043,7 @@ void waste_handleMaxDrainTimeout(int trough, unsigned long drainDuration)
     wasteValve2 = closeValve(wasteValve2);
     wasteValve4 = openValve(wasteValve4);
     globalVacuumMonitoring[1] = true; // Enable vacuum monitoring
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE (after max drain timeout)"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE (after max drain timeout)"));
     break;
   case 4:
     wasteValve2 = closeValve(wasteValve2);
@@ -1056,7 +1075,7 @@ void waste_handleInitiationTimeout(int trough)
     wasteValve1 = closeValve(wasteValve1);
     wasteValve3 = openValve(wasteValve3);
     globalVacuumMonitoring[0] = true; // Enable vacuum monitoring
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE (after initiation timeout)"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 1 to ACTIVE (after initiation timeout)"));
     break;
   case 2:
     wasteValve1 = closeValve(wasteValve1);
@@ -1066,7 +1085,7 @@ void waste_handleInitiationTimeout(int trough)
     wasteValve2 = closeValve(wasteValve2);
     wasteValve4 = openValve(wasteValve4);
     globalVacuumMonitoring[1] = true; // Enable vacuum monitoring
-    sendMessage(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE (after initiation timeout)"), &Serial, currentClient);
+    LOG_DEBUG(F("[DEBUG] Setting vacuum monitor for bottle 2 to ACTIVE (after initiation timeout)"));
     break;
   case 4:
     wasteValve2 = closeValve(wasteValve2);
@@ -1082,22 +1101,22 @@ void waste_handleInitiationTimeout(int trough)
   sendMessage(F(" (no liquid detected in drain line)."), &Serial, currentClient);
 }
 
-void monitorVacuumRelease(unsigned long currentTime)
+void monitorVacuumRelease(int bottleIdx, unsigned long currentTime)
 {
-  for (int bottleIdx = 0; bottleIdx < 2; bottleIdx++)
-  {
-    // Skip if vacuum monitoring is not active
-    if (!globalVacuumMonitoring[bottleIdx])
-      continue;
+  // Skip if vacuum monitoring is not active
+  if (!globalVacuumMonitoring[bottleIdx])
+    return;
 
-    // Check if vacuum has been released - add debug output
-    bool vacuumPresent = readBinarySensor(wasteVacuumSensors[bottleIdx]);
-    if (!vacuumPresent)
+  // Check if vacuum has been released - add debug output
+  bool vacuumPresent = readBinarySensor(wasteVacuumSensors[bottleIdx]);
+  if (!vacuumPresent)
+  {
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))
     {
-      sendMessage(F("[DEBUG] Vacuum released detected for bottle "), &Serial, currentClient, false);
-      sendMessage(String(bottleIdx + 1).c_str(), &Serial, currentClient);
-      vacuum_handleVacuumRelease(bottleIdx);
+      sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Vacuum released detected for bottle "), false);
+      sendLogMessage(LOG_LEVEL_DEBUG, String(bottleIdx + 1).c_str());
     }
+    vacuum_handleVacuumRelease(bottleIdx);
   }
 }
 
@@ -1136,15 +1155,6 @@ void vacuum_handleVacuumRelease(int bottleIdx)
 // Enclosure Protection
 void monitorEnclosureLiquidSensor(unsigned long currentTime)
 {
-
-  const unsigned long CHECK_INTERVAL = 25; // check every 25 ms
-
-  if (currentTime - enclosureLeakCheckTime < CHECK_INTERVAL)
-  {
-    return;
-  }
-  enclosureLeakCheckTime = currentTime;
-
   if (readBinarySensor(enclosureLiquidSensor))
   {
     enclosure_handleLeakDetected(currentTime, enclosureLeakErrorTime);
@@ -1197,14 +1207,26 @@ void monitorEnclosureTemp(unsigned long currentTime)
   // Static variables preserve state between calls
   static bool enclosureFanAutoActive = false;
   static unsigned long enclosureTempWarningTime = 0;
+  static unsigned long lastReadingTime = 0;
+  static unsigned long lastReadErrorTime = 0;
 
-  // Read temperature sensor
+  // Cached reading; only act when a new measurement has arrived
   TempHumidity th = readTempHumidity();
   if (!th.valid)
   {
-    sendMessage(F("[ERROR] Failed to read enclosure temperature!"), &Serial, currentClient);
+    if (lastReadErrorTime == 0 || currentTime - lastReadErrorTime >= TEMP_HUM_MAX_AGE_MS)
+    {
+      sendMessage(F("[ERROR] Failed to read enclosure temperature!"), &Serial, currentClient);
+      lastReadErrorTime = currentTime;
+    }
+    return;
+  }
+  lastReadErrorTime = 0;
+  if (th.timestamp == lastReadingTime)
+  {
     return;
   }
+  lastReadingTime = th.timestamp;
 
   float currentTemp = th.temperature;
 
@@ -1259,16 +1281,6 @@ void temp_printWarning(float currentTemp, unsigned long currentTime, unsigned lo
 
 void monitorFlowSensorConnections(unsigned long currentTime)
 {
-  static unsigned long flowSensorCheckTime = 0;
-  const unsigned long CHECK_INTERVAL = 30000; // 30 seconds
-
-  // Only check and attempt recovery every 30 seconds
-  if (currentTime - flowSensorCheckTime < CHECK_INTERVAL)
-  {
-    return;
-  }
-  flowSensorCheckTime = currentTime;
-
   FlowSensor *sensors[] = {&flow1, &flow2, &flow3, &flow4};
   for (int i = 0; i < NUM_FLOW_SENSORS; i++)
   {
@@ -1342,7 +1354,282 @@ void resetWasteMonitorState()
 
 void resetEnclosureLeakMonitorState()
 {
-  enclosureLeakCheckTime = 0;
   enclosureLeakErrorTime = 0;
   enclosureLeakAbortCalled = false;
 }
+
+// ============================================================
+// Monitor Scheduler
+// ============================================================
+
+// Every monitor runs once per unit (trough, waste bottle or the whole system).
+// A unit's entry is on the wheel only while the unit is active; the entry sits
+// in the slot its due time hashes to and runs when the wheel reaches it.
+
+enum MonitorScope
+{
+  MONITOR_SCOPE_TROUGH,
+  MONITOR_SCOPE_BOTTLE,
+  MONITOR_SCOPE_SYSTEM
+};
+
+struct MonitorTask
+{
+  const char *name;
+  uint8_t scope;                                     // MonitorScope
+  unsigned long periodMs;
+  void (*run)(int unit, unsigned long currentTime);
+  bool (*isActive)(int unit);                        // NULL: always active
+};
+
+struct MonitorEntry
+{
+  uint8_t task;
+  uint8_t unit;
+  uint8_t next;   // Next entry in the same slot, MONITOR_ENTRY_NONE at the end
+  bool scheduled; // On the wheel
+  unsigned long dueTime;
+};
+
+struct MonitorStats
+{
+  unsigned long runCount;
+  unsigned long totalMicros;
+  unsigned long maxMicros;
+};
+
+#define MONITOR_ENTRY_NONE 0xFF
+
+static bool isTroughDispensing(int i) { return valveControls[i].isDispensing; }
+static bool isTroughPriming(int i) { return valveControls[i].isPriming; }
+static bool isTroughFilling(int i) { return valveControls[i].fillMode; }
+static bool isVacuumMonitored(int bottleIdx) { return globalVacuumMonitoring[bottleIdx]; }
+
+// Draining, or still waiting on drain completion or vacuum release
+static bool isWasteBottleActive(int sensorIdx)
+{
+  return valveControls[sensorIdx * 2].isDraining || valveControls[sensorIdx * 2 + 1].isDraining ||
+         wasteLiquidDetected[sensorIdx] || !wasteVacuumReleased[sensorIdx];
+}
+
+static void runEnclosureLiquidMonitor(int, unsigned long currentTime) { monitorEnclosureLiquidSensor(currentTime); }
+static void runEnclosureTempMonitor(int, unsigned long currentTime) { monitorEnclosureTemp(currentTime); }
+static void runFlowConnectionMonitor(int, unsigned long currentTime) { monitorFlowSensorConnections(currentTime); }
+
+static const MonitorTask MONITOR_TASKS[] = {
+  {"OVERFLOW", MONITOR_SCOPE_TROUGH, 25, monitorOverflowSensor, isTroughDispensing},
+  {"DISPENSE", MONITOR_SCOPE_TROUGH, 25, monitorFlowSensor, isTroughDispensing},
+  {"PRIME", MONITOR_SCOPE_TROUGH, 25, monitorPrimeSensor, isTroughPriming},
+  {"FILL", MONITOR_SCOPE_TROUGH, 25, monitorFillSensor, isTroughFilling},
+  {"WASTE", MONITOR_SCOPE_BOTTLE, 25, monitorWasteSensor, isWasteBottleActive},
+  {"VACUUM", MONITOR_SCOPE_BOTTLE, 25, monitorVacuumRelease, isVacuumMonitored},
+  {"LEAK", MONITOR_SCOPE_SYSTEM, 25, runEnclosureLiquidMonitor, NULL},
+  {"TEMP", MONITOR_SCOPE_SYSTEM, 250, runEnclosureTempMonitor, NULL},
+  {"FLOWCONN", MONITOR_SCOPE_SYSTEM, 30000, runFlowConnectionMonitor, NULL},
+};
+
+#define MONITOR_TASK_COUNT (sizeof(MONITOR_TASKS) / sizeof(MONITOR_TASKS[0]))
+#define MONITOR_ENTRY_COUNT (6 * NUM_OVERFLOW_SENSORS) // Upper bound on units over all tasks
+
+static MonitorEntry monitorEntries[MONITOR_ENTRY_COUNT];
+static uint8_t monitorEntryCount = 0;
+static uint8_t monitorWheel[MONITOR_WHEEL_SLOTS];
+static unsigned long monitorWheelTick = 0; // Last tick whose slot needs no revisit
+static MonitorStats monitorStats[MONITOR_TASK_COUNT];
+static unsigned long monitorStatsStartTime = 0; // millis()
+
+static uint8_t getMonitorUnitCount(uint8_t scope)
+{
+  switch (scope)
+  {
+  case MONITOR_SCOPE_TROUGH:
+    return NUM_OVERFLOW_SENSORS;
+  case MONITOR_SCOPE_BOTTLE:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+static uint8_t getMonitorSlot(unsigned long dueTime)
+{
+  return (dueTime / MONITOR_WHEEL_TICK_MS) & (MONITOR_WHEEL_SLOTS - 1);
+}
+
+static void initializeMonitorWheel(unsigned long currentTime)
+{
+  for (uint8_t slot = 0; slot < MONITOR_WHEEL_SLOTS; slot++)
+  {
+    monitorWheel[slot] = MONITOR_ENTRY_NONE;
+  }
+
+  monitorEntryCount = 0;
+  for (uint8_t t = 0; t < MONITOR_TASK_COUNT; t++)
+  {
+    for (uint8_t unit = 0; unit < getMonitorUnitCount(MONITOR_TASKS[t].scope); unit++)
+    {
+      MonitorEntry &entry = monitorEntries[monitorEntryCount++];
+      entry.task = t;
+      entry.unit = unit;
+      entry.next = MONITOR_ENTRY_NONE;
+      entry.scheduled = false;
+      entry.dueTime = 0;
+    }
+  }
+
+  monitorWheelTick = currentTime / MONITOR_WHEEL_TICK_MS - 1;
+  resetMonitorStats();
+}
+
+static void scheduleMonitorEntry(uint8_t e, unsigned long dueTime)
+{
+  MonitorEntry &entry = monitorEntries[e];
+  uint8_t slot = getMonitorSlot(dueTime);
+  entry.dueTime = dueTime;
+  entry.next = monitorWheel[slot];
+  entry.scheduled = true;
+  monitorWheel[slot] = e;
+}
+
+static void unscheduleMonitorEntry(uint8_t e)
+{
+  MonitorEntry &entry = monitorEntries[e];
+  uint8_t *link = &monitorWheel[getMonitorSlot(entry.dueTime)];
+  while (*link != MONITOR_ENTRY_NONE)
+  {
+    if (*link == e)
+    {
+      *link = entry.next;
+      break;
+    }
+    link = &monitorEntries[*link].next;
+  }
+  entry.scheduled = false;
+}
+
+static void runMonitorEntry(uint8_t e, unsigned long currentTime)
+{
+  const MonitorEntry &entry = monitorEntries[e];
+  MonitorStats &stats = monitorStats[entry.task];
+
+  unsigned long start = micros();
+  MONITOR_TASKS[entry.task].run(entry.unit, currentTime);
+  unsigned long elapsed = micros() - start;
+
+  stats.runCount++;
+  stats.totalMicros += elapsed;
+  if (elapsed > stats.maxMicros)
+  {
+    stats.maxMicros = elapsed;
+  }
+}
+
+// Run every due entry in one slot and put it back one period later
+static void serviceMonitorSlot(uint8_t slot, unsigned long currentTime)
+{
+  uint8_t *link = &monitorWheel[slot];
+  while (*link != MONITOR_ENTRY_NONE)
+  {
+    uint8_t e = *link;
+    MonitorEntry &entry = monitorEntries[e];
+
+    // Entries a full wheel turn or more ahead share the slot; leave them
+    if ((long)(currentTime - entry.dueTime) < 0)
+    {
+      link = &entry.next;
+      continue;
+    }
+
+    *link = entry.next;
+    entry.scheduled = false;
+    runMonitorEntry(e, currentTime);
+
+    // Re-armed even if the run ended the operation: the activation pass
+    // retires it and gives the monitor its final pass
+    scheduleMonitorEntry(e, currentTime + MONITOR_TASKS[entry.task].periodMs);
+  }
+}
+
+void serviceSystemMonitors(unsigned long currentTime)
+{
+  if (monitorEntryCount == 0)
+  {
+    initializeMonitorWheel(currentTime);
+  }
+
+  // 1. Activation: arm units that became active; run units that went idle
+  //    once more so their monitor clears its per-unit state, then retire them
+  for (uint8_t e = 0; e < monitorEntryCount; e++)
+  {
+    MonitorEntry &entry = monitorEntries[e];
+    const MonitorTask &task = MONITOR_TASKS[entry.task];
+    bool active = (task.isActive == NULL) || task.isActive(entry.unit);
+
+    if (active && !entry.scheduled)
+    {
+      scheduleMonitorEntry(e, currentTime + task.periodMs);
+    }
+    else if (!active && entry.scheduled)
+    {
+      unscheduleMonitorEntry(e);
+      runMonitorEntry(e, currentTime);
+    }
+  }
+
+  // 2. Advance the wheel. The current tick's slot is revisited next call, as
+  //    entries due later within this tick are not due yet.
+  unsigned long currentTick = currentTime / MONITOR_WHEEL_TICK_MS;
+  unsigned long ticks = currentTick - monitorWheelTick;
+  if (ticks > MONITOR_WHEEL_SLOTS)
+  {
+    ticks = MONITOR_WHEEL_SLOTS; // Each slot once is enough after a long stall
+  }
+  for (unsigned long tick = currentTick - ticks + 1; tick != currentTick + 1; tick++)
+  {
+    serviceMonitorSlot(tick & (MONITOR_WHEEL_SLOTS - 1), currentTime);
+  }
+  monitorWheelTick = currentTick - 1;
+}
+
+// ============================================================
+// Monitor Statistics
+// ============================================================
+
+void resetMonitorStats()
+{
+  memset(monitorStats, 0, sizeof(monitorStats));
+  monitorStatsStartTime = millis();
+}
+
+void printMonitorStats(Stream *stream)
+{
+  unsigned long elapsedMs = millis() - monitorStatsStartTime;
+  char line[96];
+
+  stream->print(F("[INFO] Monitor statistics over "));
+  stream->print(elapsedMs / 1000.0, 1);
+  stream->println(F(" s:"));
+
+  for (uint8_t t = 0; t < MONITOR_TASK_COUNT; t++)
+  {
+    const MonitorStats &stats = monitorStats[t];
+    uint8_t scheduled = 0;
+    uint8_t units = 0;
+    for (uint8_t e = 0; e < monitorEntryCount; e++)
+    {
+      if (monitorEntries[e].task == t)
+      {
+        units++;
+        if (monitorEntries[e].scheduled)
+          scheduled++;
+      }
+    }
+
+    snprintf(line, sizeof(line), "  %-8s %5lu ms, active %u/%u, runs %lu, avg %lu us, max %lu us, load ",
+             MONITOR_TASKS[t].name, MONITOR_TASKS[t].periodMs, scheduled, units, stats.runCount,
+             stats.runCount ? stats.totalMicros / stats.runCount : 0UL, stats.maxMicros);
+    stream->print(line);
+    stream->print(elapsedMs ? 0.1 * stats.totalMicros / elapsedMs : 0.0, 2); // % of loop time
+    stream->println(F("%"));
+  }
+}
@@ -17,12 +17,18 @@
  * - Fill System: Handles trough filling operations
  * - Waste System: Manages waste drainage and vacuum
  * - Safety Systems: Overflow, enclosure, temperature monitoring
+ * - Monitor Scheduler: Runs the monitors from a timer wheel
+ *
+ * Trough monitors take the trough index (0-3) and waste monitors
+ * the bottle index (0-1). serviceSystemMonitors() schedules each
+ * one only while its trough or bottle is active, at the
+ * monitor's own period.
  *
  * Version: 2.0
  ************************************************************/
 
 // ==================== Prime System ====================
-void monitorPrimeSensors(unsigned long currentTime);
+void monitorPrimeSensor(int i, unsigned long currentTime);
 void handlePrimingOverflow(int i);
 bool handleLowFlowCondition(int i, unsigned long currentTime);
 void handleBubbleDetected(int i, unsigned long currentTime);
@@ -32,7 +38,7 @@ void resetPrimingStates(int i);
 void resetPrimeMonitorState();
 
 // ==================== Fill System ====================
-void monitorFillSensors(unsigned long currentTime);
+void monitorFillSensor(int i, unsigned long currentTime);
 void fill_handleMaxTimeReached(int trough);
 void fill_handleMaxVolumeReached(int trough);
 void fill_handleFlowTimeout(int trough);
@@ -40,8 +46,8 @@ void fill_handleOverflowCheck(int trough);
 void resetFillMonitorState();
 
 // ==================== Waste System ====================
-void monitorWasteSensors(unsigned long currentTime);
-void monitorVacuumRelease(unsigned long currentTime);
+void monitorWasteSensor(int sensorIdx, unsigned long currentTime);
+void monitorVacuumRelease(int bottleIdx, unsigned long currentTime);
 void waste_handleMaxDrainTimeout(int trough, unsigned long drainDuration);
 void waste_handleInitiationTimeout(int trough);
 void waste_handleBottleFull(int trough);
@@ -63,11 +69,19 @@ void temp_handleNormalTemperature(bool &fanOnDueToAutoMode);
 void temp_printWarning(float currentTemp, unsigned long currentTime, unsigned long &lastWarningTime);
 
 // Flow Safety
-void monitorFlowSensors(unsigned long currentTime);
-void monitorOverflowSensors(unsigned long currentTime);
+void monitorFlowSensor(int i, unsigned long currentTime);
+void monitorOverflowSensor(int i, unsigned long currentTime);
 void monitorFlowSensorConnections(unsigned long currentTime);
 void flow_handleDispenseOverflow(int i, FlowSensor *sensor);
 void flow_handleVolumeComplete(int i, FlowSensor *sensor);
 void flow_handleSafetyLimitExceeded(int i, FlowSensor *sensor, float maxVolume);
 
+// ==================== Monitor Scheduler ====================
+#define MONITOR_WHEEL_SLOTS 16  // Power of 2
+#define MONITOR_WHEEL_TICK_MS 5 // Wheel resolution
+
+void serviceSystemMonitors(unsigned long currentTime); // Call every loop
+void resetMonitorStats();
+void printMonitorStats(Stream *stream);
+
 #endif // SYSTEMMONITOR_H
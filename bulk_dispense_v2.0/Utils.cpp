@@ -10,6 +10,11 @@
 #include <ctype.h>
 #include "CommandManager.h"
 #include "SystemMonitor.h"
+#include "PressureRegulator.h"
+#include "Logging.h"
+#include "I2CHealth.h"
+#include "HydraulicSim.h"
+#include "DrainScheduler.h"
 
 /************************************************************
  * Utils.cpp
@@ -115,11 +120,33 @@ void processMultipleCommands(char *commandLine, Stream *stream, CommandSource so
     strncpy(commandCopy, start, len);
     commandCopy[len] = '\0'; // Null-terminate
     char *trimmed = trimLeadingSpaces(commandCopy);
+
+    // Optional "#<id>" correlation prefix
+    bool hasRequestId = false;
+    uint16_t requestId = 0;
+    if (trimmed[0] == '#')
+    {
+      hasRequestId = cm_parseRequestId(trimmed, requestId);
+      if (!hasRequestId)
+      {
+        sendMessage(F("[ERROR] Invalid request ID. Use: #<0-65535> <command>"), stream, currentClient);
+        trimmed[0] = '\0'; // Skip this command
+      }
+    }
+
     if (strlen(trimmed) > 0)
     {
-      sendMessage(F("[DEBUG] Token extracted: '"), &Serial, currentClient, false);
-      sendMessage(trimmed, &Serial, currentClient, false);
-      sendMessage(F("'"), &Serial, currentClient);
+      if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+      {
+        sendLogMessage(LOG_LEVEL_DEBUG, F("[DEBUG] Token extracted: '"), false);
+        sendLogMessage(LOG_LEVEL_DEBUG, trimmed, false);
+        sendLogMessage(LOG_LEVEL_DEBUG, F("'"));
+      }
+
+      if (hasRequestId)
+      {
+        cm_beginRequest(requestId, trimmed, stream);
+      }
 
       resetAsyncFlagsForCommand(trimmed);
 
@@ -139,6 +166,11 @@ void processMultipleCommands(char *commandLine, Stream *stream, CommandSource so
         // so complete them here.
         cm_commandCompleted(stream);
       }
+
+      if (hasRequestId)
+      {
+        cm_endRequestDispatch();
+      }
     }
     if (comma == NULL)
       break;
@@ -153,63 +185,58 @@ void processMultipleCommands(char *commandLine, Stream *stream, CommandSource so
   }
 }
 
-void handleSerialCommands()
+// Consume the bytes already received on stream (never waits). Returns true
+// once a full line is in line.data; characters past the buffer are dropped.
+bool readCommandLine(Stream &stream, CommandLineBuffer &line)
 {
-  static char commandBuffer[COMMAND_SIZE];
-  static uint8_t commandIndex = 0;
-
-  while (Serial.available() > 0)
+  while (stream.available() > 0)
   {
-    char c = Serial.read();
+    char c = stream.read();
     if (c == '\n')
     {
-      commandBuffer[commandIndex] = '\0'; // Null-terminate the command
-
-      // Print the received command to Serial
-      Serial.print(F("[SERIAL COMMAND] Received: "));
-      Serial.println(commandBuffer);
-
-      // Echo to network client if connected
-      if (hasActiveClient && currentClient.connected())
-      {
-        currentClient.print(F("[SERIAL COMMAND] Received: "));
-        currentClient.println(commandBuffer);
-      }
-
-      // Process the command line
-      processMultipleCommands(commandBuffer, &Serial, SOURCE_SERIAL);
-      commandIndex = 0; // Reset buffer index
+      line.data[line.length] = '\0'; // Null-terminate the command
+      line.length = 0;               // Next call starts a new line
+      return true;
     }
     else if (c != '\r')
     { // Ignore carriage returns
-      if (commandIndex < (COMMAND_SIZE - 1))
+      if (line.length < (COMMAND_SIZE - 1))
       {
-        commandBuffer[commandIndex++] = c;
+        line.data[line.length++] = c;
       }
     }
   }
+  return false;
 }
 
-String processClientData()
+void handleSerialCommands()
 {
-  String command = "";
+  static CommandLineBuffer serialLine = {{0}, 0};
 
-  if (hasActiveClient && currentClient.connected())
+  while (readCommandLine(Serial, serialLine))
   {
-    while (currentClient.available())
+    // Print the received command to Serial
+    Serial.print(F("[SERIAL COMMAND] Received: "));
+    Serial.println(serialLine.data);
+
+    // Echo to network client if connected
+    if (hasActiveClient && currentClient.connected())
     {
-      char c = currentClient.read();
-      if (c == '\n')
-      {
-        return command; // Remove debug print since processMultipleCommands handles it
-      }
-      else if (c != '\r')
-      {
-        command += c;
-      }
+      currentClient.print(F("[SERIAL COMMAND] Received: "));
+      currentClient.println(serialLine.data);
     }
+
+    // Process the command line
+    processMultipleCommands(serialLine.data, &Serial, SOURCE_SERIAL);
   }
-  return "";
+}
+
+static CommandLineBuffer networkLine = {{0}, 0};
+
+// Drop any partial line left by the previous client
+void resetNetworkCommandBuffer()
+{
+  networkLine.length = 0;
 }
 
 void handleNetworkCommands()
@@ -219,13 +246,17 @@ void handleNetworkCommands()
     return;
   }
 
-  while (currentClient.available())
+  while (readCommandLine(currentClient, networkLine))
   {
-    // Get the command from network
-    String command = currentClient.readStringUntil('\n');
-    command.trim();
+    // Trim surrounding whitespace in place
+    char *command = trimLeadingSpaces(networkLine.data);
+    size_t length = strlen(command);
+    while (length > 0 && isspace(command[length - 1]))
+    {
+      command[--length] = '\0';
+    }
 
-    if (command.length() > 0)
+    if (length > 0)
     {
       // Print the received command to both streams
       Serial.print(F("[NETWORK COMMAND] Received: "));
@@ -241,23 +272,27 @@ void handleNetworkCommands()
       // since it will be handled by cm_startSession
       networkCommandStartTime = millis();
 
-      // Convert to char array for processing
-      char commandBuffer[COMMAND_SIZE];
-      command.toCharArray(commandBuffer, COMMAND_SIZE);
-
       // Process the command line
-      processMultipleCommands(commandBuffer, &currentClient, SOURCE_NETWORK);
+      processMultipleCommands(command, &currentClient, SOURCE_NETWORK);
 
       // Make sure all messages are sent before processing another command
       currentClient.flush();
     }
+
+    // The command may have dropped the client
+    if (!hasActiveClient || !currentClient.connected())
+    {
+      return;
+    }
   }
 }
 
 void sendMessage(const char *message, Stream *response, EthernetClient client, bool addNewline)
 {
+  uint8_t level = getMessageLevel(message);
+
   // Send to Serial if available
-  if (response && response == &Serial)
+  if (response && response == &Serial && acceptSinkOutput(LOG_SINK_SERIAL, level, addNewline))
   {
     if (addNewline)
     {
@@ -270,7 +305,7 @@ void sendMessage(const char *message, Stream *response, EthernetClient client, b
   }
 
   // Send to TCP client if connected
-  if (client && client.connected())
+  if (client && client.connected() && acceptSinkOutput(LOG_SINK_NETWORK, level, addNewline))
   {
     if (addNewline)
     {
@@ -286,8 +321,10 @@ void sendMessage(const char *message, Stream *response, EthernetClient client, b
 
 void sendMessage(const __FlashStringHelper *message, Stream *response, EthernetClient client, bool addNewline)
 {
+  uint8_t level = getMessageLevel(message);
+
   // Send to Serial if available
-  if (response && response == &Serial)
+  if (response && response == &Serial && acceptSinkOutput(LOG_SINK_SERIAL, level, addNewline))
   {
     if (addNewline)
     {
@@ -300,7 +337,7 @@ void sendMessage(const __FlashStringHelper *message, Stream *response, EthernetC
   }
 
   // Send to TCP client if connected
-  if (client && client.connected())
+  if (client && client.connected() && acceptSinkOutput(LOG_SINK_NETWORK, level, addNewline))
   {
     if (addNewline)
     {
@@ -340,15 +377,41 @@ bool checkAndSetPressure(float thresholdPressure, int valvePosition, unsigned lo
     sendMessage(F("[MESSAGE] System is already pressurized."), &Serial, currentClient);
     return true;
   }
-  setPressureValve(valvePosition);
-  while (millis() - startTime < timeout)
+  if (pressureRegulator.enabled)
   {
+    // Closed loop: the regulator owns the valve, proceed as soon as it settles
+    if (pressureRegulator.setpointPsi < thresholdPressure)
+    {
+      sendMessage(F("[ERROR] Pressure regulator setpoint is below the required pressure. Operation aborted."), &Serial, currentClient);
+      return false;
+    }
+    while (millis() - startTime < timeout)
+    {
+      regulatePressure(millis());
+      if (isPressureSettled() && isPressureOK(thresholdPressure))
+      {
+        sendMessage(F("[MESSAGE] Regulated pressure settled."), &Serial, currentClient);
+        return true;
+      }
+    }
     if (isPressureOK(thresholdPressure))
     {
       sendMessage(F("[MESSAGE] Pressure threshold reached."), &Serial, currentClient);
       return true;
     }
-    delay(100);
+  }
+  else
+  {
+    setPressureValve(valvePosition);
+    while (millis() - startTime < timeout)
+    {
+      if (isPressureOK(thresholdPressure))
+      {
+        sendMessage(F("[MESSAGE] Pressure threshold reached."), &Serial, currentClient);
+        return true;
+      }
+      delay(100);
+    }
   }
   sendMessage(F("[ERROR] Pressure threshold not reached. Current pressure: "), &Serial, currentClient, false);
   sendMessage(String(readPressure(pressureSensor)).c_str(), &Serial, currentClient, false);
@@ -359,9 +422,7 @@ bool checkAndSetPressure(float thresholdPressure, int valvePosition, unsigned lo
 void resetI2CBus()
 {
   sendMessage(F("[MESSAGE] Resetting I2C bus..."), &Serial, currentClient);
-  Wire.end();
-  delay(100);
-  Wire.begin();
+  clearI2CBus();
 }
 
 // ============================================================
@@ -456,8 +517,8 @@ void stopDispenseOperation(int troughNumber, Stream *stream)
       selectMultiplexerChannel(sensor->multiplexerAddr, sensor->channel);
       delay(20);
       
-      Wire.beginTransmission(sensor->sensorAddr);
-      int commResult = Wire.endTransmission();
+      I2C_BUS.beginTransmission(sensor->sensorAddr);
+      int commResult = I2C_BUS.endTransmission();
       
       // If communication failed, reset I2C bus before stopping measurement
       if (commResult != 0) {
@@ -574,25 +635,6 @@ bool isWasteBottleFullForTrough(int troughNumber, Stream *stream)
   return false;
 }
 
-bool hasIncompatibleDrainage(int troughNumber, Stream *stream)
-{
-  if ((troughNumber == 1 && valveControls[1].isDraining) ||
-      (troughNumber == 2 && valveControls[0].isDraining))
-  {
-    sendMessage(F("[ERROR] Troughs 1 and 2 cannot be drained simultaneously."), stream, currentClient);
-    asyncCommandCompleted(&Serial);
-    return true;
-  }
-  if ((troughNumber == 3 && valveControls[3].isDraining) ||
-      (troughNumber == 4 && valveControls[2].isDraining))
-  {
-    sendMessage(F("[ERROR] Troughs 3 and 4 cannot be drained simultaneously."), stream, currentClient);
-    asyncCommandCompleted(&Serial);
-    return true;
-  }
-  return false;
-}
-
 bool validateTroughNumber(int troughNumber, Stream *stream)
 {
   if (troughNumber < 1 || troughNumber > 4)
@@ -753,6 +795,7 @@ void abortAllAutomatedOperations(Stream *stream)
   resetWasteMonitorState();
   resetEnclosureLeakMonitorState();
   resetFillMonitorState();
+  clearDrainQueue();
 
   sendMessage(F("[ERROR] Enclosure liquid detected. Automated operations halted. Resolve the leak before proceeding."), stream, currentClient);
   sendMessage(F("[MESSAGE] All automated operations aborted due to enclosure leak."), stream, currentClient);
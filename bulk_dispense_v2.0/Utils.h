@@ -23,13 +23,21 @@ enum CommandSource
   SOURCE_NETWORK
 };
 
+// Fixed-size line assembler for a command stream (no heap, never blocks)
+struct CommandLineBuffer
+{
+  char data[COMMAND_SIZE];
+  uint8_t length;
+};
+
 // Command Processing
 void executeCommandWithActionTags(const char *command, Stream *stream);
 char *trimLeadingSpaces(char *str);
 bool isCommandPrefix(const char *token);
 void processMultipleCommands(char *commandLine, Stream *stream, CommandSource source);
 void handleSerialCommands();
-String processClientData();
+bool readCommandLine(Stream &stream, CommandLineBuffer &line);
+void resetNetworkCommandBuffer();
 void handleNetworkCommands();
 void sendMessage(const char *message, Stream *response, EthernetClient client, bool addNewline = true);
 void sendMessage(const __FlashStringHelper *message, Stream *response, EthernetClient client, bool addNewline = true);
@@ -57,7 +65,6 @@ bool isFillModeActive(int troughNumber);
 // Helper Functions
 void stopDispensingIfActive(int troughNumber, Stream *stream);
 bool isWasteBottleFullForTrough(int troughNumber, Stream *stream);
-bool hasIncompatibleDrainage(int troughNumber, Stream *stream);
 bool validateTroughNumber(int troughNumber, Stream *stream);
 void stopDispensingForFill(int troughNumber, Stream *stream);
 void stopPrimingForFill(int troughNumber, Stream *stream);
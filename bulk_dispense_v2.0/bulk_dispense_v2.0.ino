@@ -24,6 +24,14 @@
 #include "Utils.h"         // Utility functions
 #include "SystemMonitor.h" // System monitor functions
 #include "NetworkConfig.h" // Network configuration and functions
+#include "DispensePredictor.h" // Learned dispense valve close
+#include "PressureRegulator.h" // Closed-loop supply pressure
+#include "OperationScheduler.h" // Batch operation scheduler
+#include "CommandManager.h" // Command sessions and request IDs
+#include "OperationRecorder.h" // Per-operation curve recordings
+#include "I2CHealth.h" // I2C error tracking and recovery
+#include "HydraulicSim.h" // Simulation build (-DHYDRAULIC_SIM=1)
+#include "DrainScheduler.h" // Drain queue on the shared waste bottles
 
 //=================================================================
 // Setup Function: System Initialization
@@ -66,6 +74,10 @@ void setup()
   }
 
   // --- Initialize Hardware ---
+#if HYDRAULIC_SIM
+  resetHydraulicSim(false, 0.0);
+  Serial.println(F("[WARNING] Hydraulic simulation build: valves, sensors and I2C devices are simulated."));
+#endif
   fanSetup(fan);
   proportionalValveSetup(proportionalValve);
   calibrateProportionalValve();
@@ -92,6 +104,7 @@ void setup()
   Wire.end();
   delay(100);
   Wire.begin();
+  initializeI2CHealth();
   delay(100);
   Serial.println(F("[MESSAGE] I2C bus reset complete."));
 
@@ -103,6 +116,8 @@ void setup()
     flowSensors[i]->sensorConnected = 0;
     flowSensors[i]->dispenseVolume = 0.0;
     flowSensors[i]->totalVolume = 0.0;
+    flowSensors[i]->dispenseVolumeNl = 0;
+    flowSensors[i]->totalVolumeNl = 0;
     flowSensors[i]->lastUpdateTime = 0;
     flowSensors[i]->isValidReading = false;
     flowSensors[i]->isIPA = false; // Default to water
@@ -111,6 +126,9 @@ void setup()
   // Initialize all flow sensors at startup
   initializeAllFlowSensors();
 
+  // Learned valve close behaviour for volume dispenses
+  loadDispenseModels();
+
   // --- Initialize Temperature/Humidity Sensor ---
   if (!tempHumSensorInit())
   {
@@ -141,22 +159,31 @@ void loop()
   handleTcpConnections();  // Check for new TCP connections
   handleNetworkCommands(); // Process TCP commands if available
 
-  // Monitor various system parameters.
-  monitorOverflowSensors(currentTime);
-  monitorFlowSensors(currentTime);
-  monitorPrimeSensors(currentTime);
-  monitorFillSensors(currentTime);
-  monitorWasteSensors(currentTime);
-  monitorVacuumRelease(currentTime);
-  monitorEnclosureLiquidSensor(currentTime);
-  monitorEnclosureTemp(currentTime);
-  monitorFlowSensorConnections(currentTime);
-
-  // Read flow sensor data.
-  readFlowSensorData(flow1);
-  readFlowSensorData(flow2);
-  readFlowSensorData(flow3);
-  readFlowSensorData(flow4);
+  // Regulate supply pressure on its fixed tick (no-op while open-loop).
+  regulatePressure(currentTime);
+
+  // Run the monitors that are due (only those for active troughs and bottles).
+  serviceSystemMonitors(currentTime);
+
+  // Start queued drains on free waste bottles (right after a drain completes).
+  serviceDrainScheduler(currentTime);
+
+  // Read flow sensors and the SHT31 on the shared bus (at most one I2C transaction per loop).
+  serviceFlowSensorAcquisition(currentTime);
+
+  // Record flow, pressure and valve events of running operations.
+  serviceOperationRecorder(currentTime);
+
+  // Retire finished batch operations and start the next ones.
+  serviceOperationScheduler(currentTime);
+
+#if HYDRAULIC_SIM
+  // Advance the plant model and the running scenario.
+  serviceHydraulicSim(currentTime);
+#endif
+
+  // Report progress and completion of commands sent with a request ID.
+  cm_serviceRequests(currentTime);
 
   // Log system state periodically.
   if (currentTime - logging.previousLogTime >= logging.logInterval)
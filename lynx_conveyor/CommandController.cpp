@@ -28,6 +28,7 @@ const CommandInfo COMMAND_TABLE[] = {
     {"move", CMD_MODIFYING, CMD_FLAG_ASYNC},
     {"network", CMD_READ_ONLY, CMD_FLAG_NO_HISTORY},
     {"stop", CMD_EMERGENCY, 0},
+    {"subscribe", CMD_READ_ONLY, CMD_FLAG_NO_HISTORY},
     {"system", CMD_READ_ONLY, CMD_FLAG_NO_HISTORY},
     {"teach", CMD_MODIFYING, 0},  
     {"tray", CMD_MODIFYING, CMD_FLAG_ASYNC},
@@ -1,4 +1,5 @@
 #include "Commands.h"
+#include "StatusEvents.h"
 
 // External declaration for the logging structure
 extern LoggingManagement logging;
@@ -1923,9 +1924,10 @@ bool cmd_system_state(char *args, CommandCaller *caller)
     case 1: // "state"
     {
         Console.acknowledge(F("SYSTEM_STATE"));
-        // Capture and print system state
-        SystemState currentState = captureSystemState();
-        printSystemState(currentState);
+        // Print this scan's system state snapshot (system,state,delta: only what changed for this caller)
+        char *mode = strtok(NULL, " ");
+        SystemState currentState = getSystemState();
+        printSystemState(currentState, mode != NULL && strcmp(mode, "delta") == 0);
         return true;
     }
 
@@ -1934,7 +1936,7 @@ bool cmd_system_state(char *args, CommandCaller *caller)
         Console.acknowledge(F("SAFETY_STATE"));
 
         // Capture system state, validate safety, and print results
-        SystemState currentState = captureSystemState();
+        SystemState currentState = getSystemState();
         SafetyValidationResult safety = validateSafety(currentState);
 
         printSafetyStatus(safety);
@@ -1945,7 +1947,7 @@ bool cmd_system_state(char *args, CommandCaller *caller)
     case 3: // "trays"
     {
         // Display tray system status
-        SystemState currentState = captureSystemState();
+        SystemState currentState = getSystemState();
         updateTrayTrackingFromSensors(currentState);
 
         sprintf(msg, "[TRAY], %d", trayTracking.totalTraysInSystem);
@@ -2029,6 +2031,11 @@ bool cmd_system_state(char *args, CommandCaller *caller)
             "    > Provides complete snapshot of current hardware state\n"
             "    > Use for diagnostics and troubleshooting\n"
             "\n"
+            "  system,state,delta - Display only what changed since your last report\n"
+            "    > Tracked separately for serial and each network client\n"
+            "    > A full report is sent every 10th request or after 60 seconds\n"
+            "    > Prints 'No changes' when nothing changed\n"
+            "\n"
             "  system,safety - Display safety validation status\n"
             "    > Shows detailed safety checks and their current status\n"
             "    > Reports any safety constraints preventing operations\n"
@@ -2078,22 +2085,117 @@ static const SubcommandInfo TRAY_COMMANDS[] = {
     {"gripped", 5},
     {"help", 8},
     {"load", 1}, // Base command, will check for "ready" or "request" separately
+    {"pipeline", 12},
     {"placed", 2},
     {"released", 3},
     {"removed", 6},
     {"status", 7},
+    {"timing", 11},
     {"unload", 4} // Base command, will check for "ready" or "request" separately
 };
 
 static const size_t TRAY_COMMAND_COUNT = sizeof(TRAY_COMMANDS) / sizeof(SubcommandInfo);
 
+// Safety checks shared by tray commands that move the shuttle or operate valves.
+// Queued unloads re-run them at dispatch (TrayPipeline.cpp).
+bool checkTrayCommandSafety(int cmdCode)
+{
+    char msg[100];
+    char reason[160]; // Rendered safety reason text
+
+    // Capture current system state and validate safety
+    SystemState state = getSystemState();
+    SafetyValidationResult safety = validateSafety(state);
+
+    // Comprehensive safety validation with prioritized messages
+    bool safeToExecute = true;
+    const char* errorReason = "";
+
+    // Check emergency conditions first (highest priority)
+    if (state.eStopActive)
+    {
+        safeToExecute = false;
+        errorReason = "E-STOP_ACTIVE";
+    }
+    // Check motor fault conditions
+    else if (state.motorState == MOTOR_STATE_FAULTED &&
+             (cmdCode == 1 || cmdCode == 4 || cmdCode == 9 || cmdCode == 10))
+    {
+        safeToExecute = false;
+        errorReason = "MOTOR_FAULTED";
+    }
+    // Check pneumatic pressure for valve operations
+    else if (!isSafetyCheckPassed(safety, SAFETY_CHECK_PRESSURE) &&
+             (cmdCode == 2 || cmdCode == 3 || cmdCode == 5 || cmdCode == 6))
+    {
+        safeToExecute = false;
+        errorReason = "INSUFFICIENT_PRESSURE";
+    }
+    // Check for lock/unlock operation failures
+    else if ((!isSafetyCheckPassed(safety, SAFETY_CHECK_LOCK_OPERATION) || !isSafetyCheckPassed(safety, SAFETY_CHECK_UNLOCK_OPERATION)) &&
+             (cmdCode == 1 || cmdCode == 2 || cmdCode == 3 || cmdCode == 4 ||
+              cmdCode == 5 || cmdCode == 6 || cmdCode == 9 || cmdCode == 10))
+    {
+        safeToExecute = false;
+        errorReason = "VALVE_OPERATION_FAILURE";
+
+        // Provide specific details about which operation failed
+        if (!isSafetyCheckPassed(safety, SAFETY_CHECK_LOCK_OPERATION))
+        {
+            Console.serialInfo(formatSafetyReason(safety, SAFETY_CHECK_LOCK_OPERATION, reason, sizeof(reason)));
+        }
+        if (!isSafetyCheckPassed(safety, SAFETY_CHECK_UNLOCK_OPERATION))
+        {
+            Console.serialInfo(formatSafetyReason(safety, SAFETY_CHECK_UNLOCK_OPERATION, reason, sizeof(reason)));
+        }
+    }
+    // Check operation sequence validity
+    else if (!isSafetyCheckPassed(safety, SAFETY_CHECK_OPERATION_SEQUENCE))
+    {
+        safeToExecute = false;
+        errorReason = "SEQUENCE_ERROR";
+    }
+    // Check position tracking (your original checks)
+    else if (!isSafetyCheckPassed(safety, SAFETY_CHECK_TARGET_POSITION) || !isSafetyCheckPassed(safety, SAFETY_CHECK_TRAY_POSITION))
+    {
+        safeToExecute = false;
+        errorReason = "POSITION_TRACKING_ERROR";
+    }
+
+    if (!safeToExecute)
+    {
+        sprintf(msg, "%s", errorReason);
+        Console.error(msg);
+        Console.serialInfo(F("Cannot execute tray commands while system is in an unsafe state"));
+        Console.serialInfo(F("Use 'system,reset' to clear the alert and try again"));
+        Console.serialInfo(F("For diagnosis, use 'system,safety' to see detailed system status"));
+        return false;
+    }
+
+    return true;
+}
+
+// Unload needs a homed, ready motor
+bool checkTrayUnloadMotorReady(const SystemState &state)
+{
+    if (!state.isHomed || state.motorState == MOTOR_STATE_FAULTED ||
+        state.motorState == MOTOR_STATE_NOT_READY)
+    {
+        Console.error(F("MOTOR_NOT_READY"));
+        Console.serialInfo(F("Motor not initialized or homed"));
+        Console.serialInfo(F("Use 'motor,init' and 'motor,home' commands"));
+        return false;
+    }
+    return true;
+}
+
 // Tray command handler
 bool cmd_tray(char *args, CommandCaller *caller)
 {
     // Create a local copy of arguments
-    char localArgs[COMMAND_SIZE];
-    strncpy(localArgs, args, COMMAND_SIZE);
-    localArgs[COMMAND_SIZE - 1] = '\0';
+    char localArgs[TRAY_COMMAND_SIZE];
+    strncpy(localArgs, args, TRAY_COMMAND_SIZE);
+    localArgs[TRAY_COMMAND_SIZE - 1] = '\0';
 
     // Skip leading spaces
     char *trimmed = trimLeadingSpaces(localArgs);
@@ -2101,7 +2203,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
     // Check for empty argument
     if (strlen(trimmed) == 0)
     {
-        Console.error(F("Missing parameter. Usage: tray,<load|unload|load,ready|unload,ready|placed|gripped|released|status|help>"));
+        Console.error(F("Missing parameter. Usage: tray,<load|unload|load,ready|unload,ready|placed|gripped|released|status|timing|pipeline|help>"));
         return false;
     }
 
@@ -2109,7 +2211,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
     char *subcommand = strtok(trimmed, " ");
     if (subcommand == NULL)
     {
-        Console.error(F("Missing parameter. Usage: tray,<load|unload|load,ready|unload,ready|placed|gripped|released|status|help>"));
+        Console.error(F("Missing parameter. Usage: tray,<load|unload|load,ready|unload,ready|placed|gripped|released|status|timing|pipeline|help>"));
         return false;
     }
 
@@ -2123,7 +2225,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
         subcommand = strtok(NULL, " ");
         if (subcommand == NULL)
         {
-            Console.error(F("Missing parameter. Usage: tray,<load|unload|load,ready|unload,ready|placed|gripped|released|status|help>"));
+            Console.error(F("Missing parameter. Usage: tray,<load|unload|load,ready|unload,ready|placed|gripped|released|status|timing|pipeline|help>"));
             return false;
         }
         subcommand = trimLeadingSpaces(subcommand);
@@ -2134,6 +2236,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     // Shared buffer for all formatted output in this function
     char msg[100];
+    char reason[160]; // Rendered safety reason text
 
     // Handle the compound commands for load and unload with the second parameter
     if (cmdCode == 1 || cmdCode == 4)
@@ -2150,82 +2253,15 @@ bool cmd_tray(char *args, CommandCaller *caller)
     { // Command not found in binary search
         sprintf(msg, "Unknown tray command: %s", subcommand);
         Console.error(msg);
-        Console.error(F("Valid options: load,request | unload,request | load,ready | unload,ready | placed | gripped | removed | released | status | help"));
+        Console.error(F("Valid options: load,request | unload,request | load,ready | unload,ready | placed | gripped | removed | released | status | timing | pipeline | help"));
         return false;
     }
 
     // Check system safety state before processing any tray command
-    // (except help and status which should always work)
-    if (cmdCode != 7 && cmdCode != 8)
-    { // Skip check for status and help commands
-        // Capture current system state and validate safety
-        SystemState state = captureSystemState();
-        SafetyValidationResult safety = validateSafety(state);
-
-        // Comprehensive safety validation with prioritized messages
-        bool safeToExecute = true;
-        const char* errorReason = "";
-
-        // Check emergency conditions first (highest priority)
-        if (state.eStopActive)
-        {
-            safeToExecute = false;
-            errorReason = "E-STOP_ACTIVE";
-        }
-        // Check motor fault conditions
-        else if (state.motorState == MOTOR_STATE_FAULTED &&
-                 (cmdCode == 1 || cmdCode == 4 || cmdCode == 9 || cmdCode == 10))
-        {
-            safeToExecute = false;
-            errorReason = "MOTOR_FAULTED";
-        }
-        // Check pneumatic pressure for valve operations
-        else if (!safety.pneumaticPressureSufficient &&
-                 (cmdCode == 2 || cmdCode == 3 || cmdCode == 5 || cmdCode == 6))
-        {
-            safeToExecute = false;
-            errorReason = "INSUFFICIENT_PRESSURE";
-        }
-        // Check for lock/unlock operation failures
-        else if ((!safety.lockOperationSuccessful || !safety.unlockOperationSuccessful) &&
-                 (cmdCode == 1 || cmdCode == 2 || cmdCode == 3 || cmdCode == 4 ||
-                  cmdCode == 5 || cmdCode == 6 || cmdCode == 9 || cmdCode == 10))
-        {
-            safeToExecute = false;
-            errorReason = "VALVE_OPERATION_FAILURE";
-
-            // Provide specific details about which operation failed
-            if (!safety.lockOperationSuccessful)
-            {
-                Console.serialInfo(safety.lockFailureDetails);
-            }
-            if (!safety.unlockOperationSuccessful)
-            {
-                Console.serialInfo(safety.unlockFailureDetails);
-            }
-        }
-        // Check operation sequence validity
-        else if (!safety.operationSequenceValid)
-        {
-            safeToExecute = false;
-            errorReason = "SEQUENCE_ERROR";
-        }
-        // Check position tracking (your original checks)
-        else if (!safety.targetPositionValid || !safety.trayPositionValid)
-        {
-            safeToExecute = false;
-            errorReason = "POSITION_TRACKING_ERROR";
-        }
-
-        if (!safeToExecute)
-        {
-            sprintf(msg, "%s", errorReason);
-            Console.error(msg);
-            Console.serialInfo(F("Cannot execute tray commands while system is in an unsafe state"));
-            Console.serialInfo(F("Use 'system,reset' to clear the alert and try again"));
-            Console.serialInfo(F("For diagnosis, use 'system,safety' to see detailed system status"));
-            return false;
-        }
+    // (except help, status, timing and pipeline which should always work)
+    if (cmdCode != 7 && cmdCode != 8 && cmdCode != 11 && cmdCode != 12 && !checkTrayCommandSafety(cmdCode))
+    {
+        return false;
     }
 
     // Use switch-case for cleaner flow control
@@ -2233,14 +2269,14 @@ bool cmd_tray(char *args, CommandCaller *caller)
     {
     case 1: // "load,request"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         updateTrayTrackingFromSensors(state);
         SafetyValidationResult safety = validateSafety(state);
 
-        if (!safety.safeToMove)
+        if (!isSafetyCheckPassed(safety, SAFETY_CHECK_MOVE))
         {
             Console.error(F("MOTOR_NOT_READY"));
-            Console.serialInfo(safety.moveUnsafeReason);
+            Console.serialInfo(formatSafetyReason(safety, SAFETY_CHECK_MOVE, reason, sizeof(reason)));
             Console.serialInfo(F("Motor must be initialized and homed before loading/unloading operations"));
             return false;
         }
@@ -2264,10 +2300,10 @@ bool cmd_tray(char *args, CommandCaller *caller)
             return false;
         }
 
-        if (!safety.safeToLoadTrayToPos1)
+        if (!isSafetyCheckPassed(safety, SAFETY_CHECK_LOAD_POS1))
         {
             Console.error(F("UNSAFE_TO_LOAD"));
-            Console.serialInfo(safety.loadTrayPos1UnsafeReason);
+            Console.serialInfo(formatSafetyReason(safety, SAFETY_CHECK_LOAD_POS1, reason, sizeof(reason)));
             return false;
         }
 
@@ -2295,7 +2331,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
         trayTracking.position1Occupied = true;
         trayTracking.lastLoadTime = millis();
 
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         if (!state.tray1Present)
         {
             Console.error(F("NO_TRAY_DETECTED"));
@@ -2347,15 +2383,11 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     case 4: // "unload,request"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         updateTrayTrackingFromSensors(state);
 
-        if (!state.isHomed || state.motorState == MOTOR_STATE_FAULTED ||
-            state.motorState == MOTOR_STATE_NOT_READY)
+        if (!checkTrayUnloadMotorReady(state))
         {
-            Console.error(F("MOTOR_NOT_READY"));
-            Console.serialInfo(F("Motor not initialized or homed"));
-            Console.serialInfo(F("Use 'motor,init' and 'motor,home' commands"));
             return false;
         }
 
@@ -2367,6 +2399,19 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
         if (operationInProgress)
         {
+            // Pipelined mode: the shuttle picks this up straight after dropping off the tray
+            if (trayPipeline.enabled && currentOperation.type == OPERATION_LOADING)
+            {
+                if (!queueTrayUnload())
+                {
+                    Console.error(F("UNLOAD_QUEUE_FULL"));
+                    return false;
+                }
+                Console.acknowledge(F("UNLOAD_QUEUED"));
+                Console.serialInfo(F("Unload will start when the current load drops off its tray"));
+                return true;
+            }
+
             Console.error(F("SYSTEM_BUSY"));
             return false;
         }
@@ -2410,13 +2455,13 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     case 5: // "gripped"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         SafetyValidationResult safety = validateSafety(state);
 
-        if (!safety.safeToUnlockGrippedTray)
+        if (!isSafetyCheckPassed(safety, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY))
         {
             Console.error(F("UNSAFE_TO_UNLOCK"));
-            Console.serialInfo(safety.grippedTrayUnlockUnsafeReason);
+            Console.serialInfo(formatSafetyReason(safety, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, reason, sizeof(reason)));
             return false;
         }
 
@@ -2452,7 +2497,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     case 6: // "removed"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         if (state.tray1Present)
         {
             Console.error(F("TRAY_STILL_PRESENT"));
@@ -2471,7 +2516,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     case 7: // "status"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         updateTrayTrackingFromSensors(state);
 
         sprintf(msg, "TRAYS_TOTAL:%d", trayTracking.totalTraysInSystem);
@@ -2553,6 +2598,20 @@ bool cmd_tray(char *args, CommandCaller *caller)
             "    LOADS:[number] - Total number of loads completed\n"
             "    UNLOADS:[number] - Total number of unloads completed\n"
             "\n"
+            "PIPELINED LOADING:\n"
+            "  tray,pipeline,on|off - Enable/disable queuing unload requests during a load\n"
+            "     > A queued unload starts at the load's drop-off position instead of\n"
+            "       returning the empty shuttle to position 1 first\n"
+            "     > tray,unload,request during a load returns [ACK] UNLOAD_QUEUED\n"
+            "  tray,pipeline,status - Pipeline state and empty travel saved\n"
+            "  tray,pipeline,plan[,MIX] - Estimate trays/hour for a request mix (e.g. LULULU)\n"
+            "     > Without MIX, reports a set of representative mixes\n"
+            "\n"
+            "TRAY TIMING COMMAND:\n"
+            "  tray,timing - Show recorded step durations for the loading/unloading workflows\n"
+            "  tray,timing,reset - Clear the recorded step durations\n"
+            "  Steps sharing a group number run concurrently\n"
+            "\n"
             "TROUBLESHOOTING:\n"
             "  • If an operation fails, use 'system,reset' to reset the system state\n"
             "  • Use 'system,trays' for human-readable tray system status\n"
@@ -2564,7 +2623,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     case 9: // "load,ready"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
 
         if (operationInProgress && currentOperation.type == OPERATION_LOADING)
         {
@@ -2601,7 +2660,7 @@ bool cmd_tray(char *args, CommandCaller *caller)
 
     case 10: // "unload,ready"
     {
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
 
         if (operationInProgress && currentOperation.type == OPERATION_UNLOADING)
         {
@@ -2610,6 +2669,13 @@ bool cmd_tray(char *args, CommandCaller *caller)
             return true;
         }
 
+        if (hasQueuedTrayUnload())
+        {
+            Console.println(F("[BUSY], UNLOAD_QUEUED"));
+            Console.serialInfo(F("Unload will start after the current load, please wait..."));
+            return true;
+        }
+
         if (trayTracking.totalTraysInSystem == 0)
         {
             Console.error(F("NO_TRAYS_TO_UNLOAD"));
@@ -2644,11 +2710,55 @@ bool cmd_tray(char *args, CommandCaller *caller)
         }
     }
 
+    case 11: // "timing"
+    {
+        char *action = strtok(NULL, " ");
+        if (action != NULL && strcmp(action, "reset") == 0)
+        {
+            resetWorkflowTiming();
+            Console.acknowledge(F("TRAY_TIMING_RESET"));
+            return true;
+        }
+
+        Console.acknowledge(F("TRAY_TIMING"));
+        printWorkflowTiming(TRAY_LOADING_WORKFLOW, trayLoadingTiming);
+        printWorkflowTiming(TRAY_UNLOADING_WORKFLOW, trayUnloadingTiming);
+        return true;
+    }
+
+    case 12: // "pipeline"
+    {
+        char *action = strtok(NULL, " ");
+        if (action == NULL || strcmp(action, "status") == 0)
+        {
+            printTrayPipelineStatus();
+            return true;
+        }
+
+        if (strcmp(action, "on") == 0 || strcmp(action, "off") == 0)
+        {
+            setTrayPipelineEnabled(strcmp(action, "on") == 0);
+            Console.acknowledge(trayPipeline.enabled ? F("PIPELINE_ENABLED") : F("PIPELINE_DISABLED"));
+            return true;
+        }
+
+        if (strcmp(action, "plan") == 0)
+        {
+            printTrayRoutePlan(strtok(NULL, " "));
+            return true;
+        }
+
+        sprintf(msg, "Unknown pipeline option: %s", action);
+        Console.error(msg);
+        Console.error(F("Usage: tray,pipeline,<on|off|status|plan[,MIX]>"));
+        return false;
+    }
+
     default:
     {
         sprintf(msg, "Unknown tray command: %s", subcommand);
         Console.error(msg);
-        Console.error(F("Valid options: load,request | unload,request | load,ready | unload,ready | placed | gripped | removed | released | status | help"));
+        Console.error(F("Valid options: load,request | unload,request | load,ready | unload,ready | placed | gripped | removed | released | status | timing | pipeline | help"));
         return false;
     }
     }
@@ -2947,6 +3057,126 @@ bool cmd_abort(char *args, CommandCaller *caller)
     return true;
 }
 
+// Define the test subcommands lookup table (MUST BE SORTED ALPHABETICALLY)
+static const SubcommandInfo TEST_COMMANDS[] = {
+    {"clear", 6},
+    {"help", 7},
+    {"home", 1},
+    {"position", 2},
+    {"results", 4},
+    {"save", 5},
+    {"tray", 3}};
+
+static const size_t TEST_COMMAND_COUNT = sizeof(TEST_COMMANDS) / sizeof(SubcommandInfo);
+
+// Test command handler - runs a test with sample recording and reports its results
+bool cmd_test(char *args, CommandCaller *caller)
+{
+    // Create a local copy of arguments
+    char localArgs[COMMAND_SIZE];
+    strncpy(localArgs, args, COMMAND_SIZE);
+    localArgs[COMMAND_SIZE - 1] = '\0';
+
+    // Skip leading spaces
+    char *trimmed = trimLeadingSpaces(localArgs);
+
+    char *subcommand = strtok(trimmed, " ");
+    if (subcommand == nullptr)
+    {
+        Console.error(F("Missing subcommand. Usage: test,<home|position|tray|results|save|clear|help>"));
+        return false;
+    }
+
+    int cmdCode = findSubcommandCode(subcommand, TEST_COMMANDS, TEST_COMMAND_COUNT);
+
+    // Tests take over the motor until they finish or are aborted
+    if ((cmdCode == 1 || cmdCode == 2 || cmdCode == 3) && (operationInProgress || testInProgress))
+    {
+        Console.error(F("SYSTEM_BUSY"));
+        return false;
+    }
+
+    switch (cmdCode)
+    {
+    case 1: // "home"
+        Console.acknowledge(F("TEST_STARTED"));
+        return runRecordedTest("homing", testHomingRepeatability);
+
+    case 2: // "position"
+        Console.acknowledge(F("TEST_STARTED"));
+        return runRecordedTest("position", testPositionCycling);
+
+    case 3: // "tray"
+        Console.acknowledge(F("TEST_STARTED"));
+        return runRecordedTest("tray", testTrayHandling);
+
+    case 4: // "results"
+    {
+        char *format = strtok(NULL, " ");
+        if (format != NULL && strcmp(format, "csv") == 0)
+        {
+            printTestResultsCsv();
+        }
+        else
+        {
+            printTestResultsSummary();
+        }
+        return true;
+    }
+
+    case 5: // "save"
+    {
+        char *format = strtok(NULL, " ");
+        bool binary = (format != NULL && strcmp(format, "bin") == 0);
+        if (!saveTestResultsToSD(binary))
+        {
+            Console.error(F("SAVE_FAILED"));
+            return false;
+        }
+        Console.acknowledge(binary ? F("TEST_RESULTS_SAVED_BIN") : F("TEST_RESULTS_SAVED_CSV"));
+        return true;
+    }
+
+    case 6: // "clear"
+        clearTestResults();
+        Console.acknowledge(F("TEST_RESULTS_CLEARED"));
+        return true;
+
+    case 7: // "help"
+    {
+        Console.acknowledge(F("TEST_HELP"));
+        Console.println(F(
+            "\n===== TEST HARNESS HELP =====\n"
+            "\nRUNNING TESTS:\n"
+            "  test,home     - Homing repeatability (home, move to 150mm, re-home)\n"
+            "  test,position - Position cycling (1 -> 3 -> 1 -> 2 -> 1)\n"
+            "  test,tray     - Tray handling with valve operations (needs a tray at position 1)\n"
+            "  > Type 'abort' to stop a running test\n"
+            "  > Every move time, position error, homing time, lock/unlock time and\n"
+            "    cycle time is recorded (up to 512 samples per run)\n"
+            "\n"
+            "RESULTS:\n"
+            "  test,results     - Mean, stddev, min, percentiles and max per metric\n"
+            "    > Tag column is the target position, or the tray number for valves (0 = shuttle)\n"
+            "  test,results,csv - Print every sample as CSV\n"
+            "  test,save[,csv]  - Write samples to TESTRES.CSV on the SD card\n"
+            "  test,save,bin    - Write header + raw 12-byte samples to TESTRES.BIN\n"
+            "  test,clear       - Discard recorded samples\n"
+            "-------------------------------------------"));
+        return true;
+    }
+
+    default:
+    {
+        char msg[60];
+        sprintf(msg, "Unknown test command: %s", subcommand);
+        Console.error(msg);
+        Console.error(F("Valid options: home | position | tray | results | save | clear | help"));
+        return false;
+    }
+    }
+}
+
 // Define the network subcommands lookup table (MUST BE SORTED ALPHABETICALLY)
 static const SubcommandInfo NETWORK_COMMANDS[] = {
     {"close", 2},
@@ -3154,6 +3384,125 @@ bool cmd_network(char *args, CommandCaller *caller)
     return false; // Should never reach here
 }
 
+// Define the subscribe subcommands lookup table (MUST BE SORTED ALPHABETICALLY)
+static const SubcommandInfo SUBSCRIBE_COMMANDS[] = {
+    {"all", 1},
+    {"fault", 1},
+    {"help", 4},
+    {"none", 2},
+    {"status", 3},
+    {"step", 1},
+    {"tray", 1}};
+
+static const size_t SUBSCRIBE_COMMAND_COUNT = sizeof(SUBSCRIBE_COMMANDS) / sizeof(SubcommandInfo);
+
+// Status event subscription for the Ethernet client issuing the command
+bool cmd_subscribe(char *args, CommandCaller *caller)
+{
+    // Create a local copy of arguments
+    char localArgs[COMMAND_SIZE];
+    strncpy(localArgs, args, COMMAND_SIZE);
+    localArgs[COMMAND_SIZE - 1] = '\0';
+
+    // Skip leading spaces
+    char *trimmed = trimLeadingSpaces(localArgs);
+
+    char msg[60];
+    char classes[20];
+    char *subcommand = strtok(trimmed, " ");
+    if (subcommand == nullptr)
+    {
+        Console.error(F("Missing subcommand. Usage: subscribe,<tray|step|fault|all|none|status|help>"));
+        return false;
+    }
+
+    int cmdCode = findSubcommandCode(subcommand, SUBSCRIBE_COMMANDS, SUBSCRIBE_COMMAND_COUNT);
+    int clientIndex = getCurrentClientIndex();
+
+    // Events are pushed over the client's own connection - serial can only inspect
+    if ((cmdCode == 1 || cmdCode == 2) && clientIndex < 0)
+    {
+        Console.error(F("SUBSCRIBE_REQUIRES_NETWORK"));
+        return false;
+    }
+
+    switch (cmdCode)
+    {
+    case 1: // "tray", "step", "fault", "all" - adds to the existing subscription
+    {
+        uint8_t mask = clientSubscriptions[clientIndex];
+        for (char *name = subcommand; name != NULL; name = strtok(NULL, " "))
+        {
+            uint8_t eventClass = parseStatusEventClass(name);
+            if (eventClass == 0)
+            {
+                sprintf(msg, "Unknown event class: %s", name);
+                Console.error(msg);
+                return false;
+            }
+            mask |= eventClass;
+        }
+
+        setClientSubscription(clientIndex, mask);
+        formatStatusEventClasses(mask, classes);
+        sprintf(msg, "SUBSCRIBED %s", classes);
+        Console.acknowledge(msg);
+        return true;
+    }
+
+    case 2: // "none"
+        clearClientSubscription(clientIndex);
+        Console.acknowledge(F("SUBSCRIBED NONE"));
+        return true;
+
+    case 3: // "status"
+        Console.acknowledge(F("SUBSCRIBE_STATUS"));
+        printStatusSubscriptions();
+        return true;
+
+    case 4: // "help"
+    {
+        Console.acknowledge(F("SUBSCRIBE_HELP"));
+        Console.println(F(
+            "\n===== STATUS SUBSCRIPTION HELP =====\n"
+            "\nOVERVIEW:\n"
+            "  Ethernet clients can subscribe to event classes instead of polling\n"
+            "  system,state or tray,status. The controller pushes a line only when\n"
+            "  a subscribed value changes, containing just the changed fields.\n"
+            "\n"
+            "COMMAND REFERENCE:\n"
+            "  subscribe,tray   - Tray presence/lock and shuttle lock changes\n"
+            "  subscribe,step   - Operation start, step transitions and completion\n"
+            "  subscribe,fault  - Motor fault, E-stop and air pressure changes\n"
+            "  subscribe,all    - All of the above\n"
+            "    > Classes add to the current subscription (subscribe,tray,fault)\n"
+            "    > A full snapshot of each new class is pushed first as a baseline\n"
+            "  subscribe,none   - Stop all pushed events for this client\n"
+            "  subscribe,status - Show each client's subscriptions and push counters\n"
+            "\n"
+            "EVENT FORMAT:\n"
+            "  [EVENT], TRAY POS1:1 LOCK1:1 SHUTTLE:0\n"
+            "  [EVENT], OP LOADING START | STEP:n | END SUCCESS | END FAILED:<reason>\n"
+            "  [EVENT], OP IDLE\n"
+            "  [EVENT], FAULT MOTOR:0 ESTOP:0 PRESSURE:1\n"
+            "\n"
+            "NOTES:\n"
+            "  • Subscriptions end when the client disconnects\n"
+            "  • Only network clients can subscribe; serial can use subscribe,status\n"
+            "-------------------------------------------"));
+        return true;
+    }
+
+    default:
+    {
+        sprintf(msg, "Unknown subscribe option: %s", subcommand);
+        Console.error(msg);
+        Console.error(F("Valid options: tray | step | fault | all | none | status | help"));
+        return false;
+    }
+    }
+}
+
 // Define the teach subcommands lookup table (MUST BE SORTED ALPHABETICALLY)
 static const SubcommandInfo TEACH_COMMANDS[] = {
     {"1", 1},
@@ -3356,6 +3705,7 @@ Commander::systemCommand_t API_tree[] = {
     // State command to display system state
     systemCommand("system", "System commands:\r\n"
                             "  system,state    - Display current system state (sensors, actuators, positions)\r\n"
+                            "  system,state,delta - Display only state lines changed since your last request\r\n"
                             "  system,safety   - Display comprehensive safety validation status\r\n"
                             "  system,trays    - Display tray tracking and statistics\r\n"
                             "  system,reset    - Reset system state after failure to retry operation\r\n"
@@ -3403,6 +3753,8 @@ Commander::systemCommand_t API_tree[] = {
                           "  tray,removed   - Notify tray has been removed (Mitsubishi)\r\n"
                           "  tray,released  - Notify tray has been released (Mitsubishi)\r\n"
                           "  tray,status    - Get tray system status (machine-readable)\r\n"
+                          "  tray,timing    - Show workflow step timing (tray,timing,reset to clear)\r\n"
+                          "  tray,pipeline  - Pipelined loading (on|off|status|plan[,MIX])\r\n"
                           "  tray,help      - Display detailed usage instructions",
                   cmd_tray),
 
@@ -3417,6 +3769,17 @@ Commander::systemCommand_t API_tree[] = {
     // Abort command
     systemCommand("abort", "Abort any running test", cmd_abort),
 
+    // Test harness command
+    systemCommand("test", "Test harness:\r\n"
+                          "  test,home      - Run homing repeatability test\r\n"
+                          "  test,position  - Run position cycling test\r\n"
+                          "  test,tray      - Run tray handling test\r\n"
+                          "  test,results   - Show result statistics (test,results,csv for raw samples)\r\n"
+                          "  test,save      - Save samples to SD (test,save,bin for binary)\r\n"
+                          "  test,clear     - Discard recorded samples\r\n"
+                          "  test,help      - Display detailed usage instructions",
+                  cmd_test),
+
     // Network management command
     systemCommand("network", "Network management:\r\n"
                              "  network,status   - Display current network status and connected clients\r\n"
@@ -3425,6 +3788,17 @@ Commander::systemCommand_t API_tree[] = {
                              "  network,help     - Display detailed network management instructions",
                   cmd_network),
 
+    // Status event subscription command
+    systemCommand("subscribe", "Status event push (Ethernet clients):\r\n"
+                               "  subscribe,tray   - Push tray presence/lock changes\r\n"
+                               "  subscribe,step   - Push operation step transitions\r\n"
+                               "  subscribe,fault  - Push motor fault, E-stop and pressure changes\r\n"
+                               "  subscribe,all    - Push all event classes\r\n"
+                               "  subscribe,none   - Stop pushed events\r\n"
+                               "  subscribe,status - Show subscriptions\r\n"
+                               "  subscribe,help   - Display detailed usage instructions",
+                  cmd_subscribe),
+
     // Teach position command
     systemCommand("teach", "Teach position commands:\r\n"
                            "  teach,1   - Teach position 1 (loading position)\r\n"
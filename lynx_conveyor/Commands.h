@@ -9,17 +9,22 @@
 #include "Logging.h"
 #include "CommandController.h"
 #include "Utils.h"
+#include "TrayWorkflow.h"
+#include "TrayPipeline.h"
 #include "EncoderController.h"
 #include "EthernetController.h"
 #include "LogHistory.h"
 #include "PositionConfig.h" // Include PositionConfig for position management
+#include "Tests.h"
 
 //=============================================================================
 // COMMAND CONSTANTS
 //=============================================================================
 
 // Command tree size
-#define COMMAND_SIZE 15
+#define COMMAND_SIZE 17
+#define TRAY_COMMAND_SIZE (COMMAND_SIZE + TRAY_PLAN_MAX_REQUESTS + 1) // tray,pipeline,plan carries a request mix
+#define TRAY_CMD_UNLOAD_REQUEST 4 // TRAY_COMMANDS code for tray,unload,request
 
 // Structure for subcommand lookup
 struct SubcommandInfo
@@ -30,6 +35,11 @@ struct SubcommandInfo
 
 int findSubcommandCode(const char *subcommand, const SubcommandInfo *commandTable, size_t tableSize);
 
+// Tray command safety checks (also run for queued unloads at dispatch)
+struct SystemState; // Utils.h includes this header
+bool checkTrayCommandSafety(int cmdCode);
+bool checkTrayUnloadMotorReady(const SystemState &state);
+
 //=============================================================================
 // EXTERNAL REFERENCES
 //=============================================================================
@@ -87,4 +97,16 @@ bool cmd_encoder(char *args, CommandCaller *caller);
 //-----------------------------------------------------------------------------
 bool cmd_teach(char *args, CommandCaller *caller);
 
+//-----------------------------------------------------------------------------
+// Test Commands
+// Functions for running tests and reporting their recorded results
+//-----------------------------------------------------------------------------
+bool cmd_test(char *args, CommandCaller *caller);
+
+//-----------------------------------------------------------------------------
+// Status Event Commands
+// Functions for managing pushed status events on Ethernet clients
+//-----------------------------------------------------------------------------
+bool cmd_subscribe(char *args, CommandCaller *caller);
+
 #endif // COMMANDS_H
\ No newline at end of file
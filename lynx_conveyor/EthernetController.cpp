@@ -1,4 +1,5 @@
 #include "EthernetController.h"
+#include "StatusEvents.h"
 
 // Global variables
 EthernetServer server(ETHERNET_PORT);
@@ -184,6 +185,8 @@ void processEthernetConnections()
                 // Replace client in this slot
                 clients[i] = newClient;
                 clientLastActivityTime[i] = millis(); // Initialize activity timestamp
+                clearClientSubscription(i);           // Subscriptions never carry over to a new client
+                resetSystemStateRender(i);
                 clientAdded = true;
 
                 // Send welcome message
@@ -213,6 +216,7 @@ void processEthernetConnections()
             Console.serialDiagnostic(msg);
             opLogHistory.addEntry(msg, LogEntry::INFO);
             clients[i].stop();
+            clearClientSubscription(i);
         }
     }
 }
@@ -294,6 +298,20 @@ int getConnectedClientCount()
     return count;
 }
 
+// Slot of the Ethernet client whose command is being processed, -1 for serial
+int getCurrentClientIndex()
+{
+    Stream *client = Console.getCurrentClient();
+    for (int i = 0; i < MAX_ETHERNET_CLIENTS; i++)
+    {
+        if (client == &clients[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
 // Call this whenever data is received from a client
 void updateClientActivity(int clientIndex)
 {
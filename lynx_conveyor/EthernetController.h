@@ -45,5 +45,6 @@ bool closeAllConnections();                 // Close all client connections
 // Communication
 bool sendToAllClients(const char *message); // Send message to all connected clients
 int getConnectedClientCount();              // Get count of currently connected clients
+int getCurrentClientIndex();                // Client whose command is running, -1 for serial
 
 #endif // ETHERNET_CONTROLLER_H
\ No newline at end of file
@@ -400,7 +400,7 @@ bool moveToPosition(PositionTarget position)
 
     // Apply velocity scaling based on move distance using optimized integer math
     // Check if shuttle is retracted (empty) - use higher speed
-    SystemState currentState = captureSystemState();
+    const SystemState &currentState = getSystemState();
     sprintf(msg, "Shuttle locked state: %s", currentState.shuttleLocked ? "TRUE (not empty)" : "FALSE (empty)");
     Console.serialDiagnostic(msg);
 
@@ -512,7 +512,7 @@ bool moveToPositionMm(double positionMm)
 
     // Apply velocity scaling based on move distance using optimized integer math
     // Check if shuttle is retracted (empty) - use higher speed
-    SystemState currentState = captureSystemState();
+    const SystemState &currentState = getSystemState();
     sprintf(msg, "Shuttle locked state: %s", currentState.shuttleLocked ? "TRUE (not empty)" : "FALSE (empty)");
     Console.serialDiagnostic(msg);
 
@@ -626,7 +626,7 @@ bool moveRelative(double relativeMm)
 
     // Apply velocity scaling based on move distance using optimized integer math
     // Check if shuttle is retracted (empty) - use higher speed
-    SystemState currentState = captureSystemState();
+    const SystemState &currentState = getSystemState();
     sprintf(msg, "Shuttle locked state: %s", currentState.shuttleLocked ? "TRUE (not empty)" : "FALSE (empty)");
     Console.serialDiagnostic(msg);
 
@@ -1508,8 +1508,8 @@ void checkMoveProgress()
         // Apply deceleration when approaching target
         if (hasCurrentTarget && motorDecelConfig.enableDeceleration)
         {
-            // Get current shuttle state
-            SystemState currentState = captureSystemState();
+            // Get current shuttle state from this scan's snapshot
+            const SystemState &currentState = getSystemState();
             bool shuttleEmpty = !currentState.shuttleLocked;
 
             // Only apply deceleration if shuttle is NOT empty
@@ -0,0 +1,322 @@
+#include "StatusEvents.h"
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+uint8_t clientSubscriptions[MAX_ETHERNET_CLIENTS] = {0};
+StatusEventStats statusEventStats = {0, 0};
+
+// Classes each client still needs a full baseline for (set on subscribe)
+static uint8_t pendingBaseline[MAX_ETHERNET_CLIENTS] = {0};
+
+// Values last pushed to subscribers, per class
+static StatusEventSnapshot published;
+static uint8_t publishedClasses = 0;
+
+static const char *const EVENT_CLASS_NAMES[] = {"TRAY", "STEP", "FAULT"};
+
+//=============================================================================
+// SUBSCRIPTION MANAGEMENT
+//=============================================================================
+
+void setClientSubscription(int clientIndex, uint8_t mask)
+{
+    if (clientIndex < 0 || clientIndex >= MAX_ETHERNET_CLIENTS)
+    {
+        return;
+    }
+
+    // Newly added classes start with a full snapshot so the client has a baseline
+    pendingBaseline[clientIndex] = mask & ~clientSubscriptions[clientIndex];
+    clientSubscriptions[clientIndex] = mask;
+}
+
+void clearClientSubscription(int clientIndex)
+{
+    if (clientIndex >= 0 && clientIndex < MAX_ETHERNET_CLIENTS)
+    {
+        clientSubscriptions[clientIndex] = 0;
+        pendingBaseline[clientIndex] = 0;
+    }
+}
+
+uint8_t parseStatusEventClass(const char *name)
+{
+    if (strcmp(name, "tray") == 0)
+        return STATUS_EVENT_TRAY;
+    if (strcmp(name, "step") == 0)
+        return STATUS_EVENT_STEP;
+    if (strcmp(name, "fault") == 0)
+        return STATUS_EVENT_FAULT;
+    if (strcmp(name, "all") == 0)
+        return STATUS_EVENT_ALL;
+    return 0;
+}
+
+//=============================================================================
+// EVENT RENDERING
+//=============================================================================
+
+static const char *getEventOperationName(OperationType type)
+{
+    switch (type)
+    {
+    case OPERATION_LOADING:
+        return "LOADING";
+    case OPERATION_UNLOADING:
+        return "UNLOADING";
+    case OPERATION_MOVING:
+        return "MOVING";
+    case OPERATION_TRAY_ADVANCE:
+        return "ADVANCE";
+    default:
+        return "NONE";
+    }
+}
+
+static void captureSnapshot(const SystemState &state, uint8_t classes, StatusEventSnapshot &snapshot)
+{
+    if (classes & STATUS_EVENT_TRAY)
+    {
+        snapshot.trayPresent[0] = state.tray1Present;
+        snapshot.trayPresent[1] = state.tray2Present;
+        snapshot.trayPresent[2] = state.tray3Present;
+        snapshot.trayLocked[0] = state.tray1Locked;
+        snapshot.trayLocked[1] = state.tray2Locked;
+        snapshot.trayLocked[2] = state.tray3Locked;
+        snapshot.shuttleLocked = state.shuttleLocked;
+    }
+
+    if (classes & STATUS_EVENT_STEP)
+    {
+        snapshot.operationActive = currentOperation.inProgress;
+        snapshot.operationType = currentOperation.type;
+        snapshot.operationStartTime = currentOperation.startTime;
+        snapshot.operationStep = currentOperationStep;
+    }
+
+    if (classes & STATUS_EVENT_FAULT)
+    {
+        snapshot.motorFaulted = (state.motorState == MOTOR_STATE_FAULTED);
+        snapshot.eStopActive = state.eStopActive;
+        snapshot.pressureOk = isPressureSufficient(); // Only read while someone subscribes to faults
+    }
+}
+
+static void appendField(char *line, const char *name, int index, int value)
+{
+    size_t length = strlen(line);
+    if (index > 0)
+        snprintf(line + length, STATUS_EVENT_LINE_LENGTH - length, " %s%d:%d", name, index, value);
+    else
+        snprintf(line + length, STATUS_EVENT_LINE_LENGTH - length, " %s:%d", name, value);
+}
+
+// Write a line to every connected client subscribed to eventClass (or just onlyClient)
+static void pushEvent(uint8_t eventClass, const char *line, int onlyClient)
+{
+    size_t length = strlen(line);
+
+    for (int i = 0; i < MAX_ETHERNET_CLIENTS; i++)
+    {
+        if ((onlyClient >= 0 && i != onlyClient) || !(clientSubscriptions[i] & eventClass))
+            continue;
+        // A client waiting for its baseline skips deltas of that class
+        if (onlyClient < 0 && (pendingBaseline[i] & eventClass))
+            continue;
+        if (!clients[i] || !clients[i].connected())
+            continue;
+
+        // Single buffered write instead of Console's per-byte fan-out
+        clients[i].write((const uint8_t *)line, length);
+        clients[i].write((const uint8_t *)"\r\n", 2);
+        statusEventStats.eventsPushed++;
+        statusEventStats.bytesPushed += length + 2;
+    }
+}
+
+// Tray and fault events carry only the fields that changed (all fields when previous is NULL)
+static void publishTrayEvent(const StatusEventSnapshot &current, const StatusEventSnapshot *previous, int onlyClient)
+{
+    char line[STATUS_EVENT_LINE_LENGTH] = "[EVENT], TRAY";
+    size_t baseLength = strlen(line);
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (!previous || previous->trayPresent[i] != current.trayPresent[i])
+            appendField(line, "POS", i + 1, current.trayPresent[i]);
+        if (!previous || previous->trayLocked[i] != current.trayLocked[i])
+            appendField(line, "LOCK", i + 1, current.trayLocked[i]);
+    }
+    if (!previous || previous->shuttleLocked != current.shuttleLocked)
+        appendField(line, "SHUTTLE", 0, current.shuttleLocked);
+
+    if (strlen(line) > baseLength)
+        pushEvent(STATUS_EVENT_TRAY, line, onlyClient);
+}
+
+static void publishFaultEvent(const StatusEventSnapshot &current, const StatusEventSnapshot *previous, int onlyClient)
+{
+    char line[STATUS_EVENT_LINE_LENGTH] = "[EVENT], FAULT";
+    size_t baseLength = strlen(line);
+
+    if (!previous || previous->motorFaulted != current.motorFaulted)
+        appendField(line, "MOTOR", 0, current.motorFaulted);
+    if (!previous || previous->eStopActive != current.eStopActive)
+        appendField(line, "ESTOP", 0, current.eStopActive);
+    if (!previous || previous->pressureOk != current.pressureOk)
+        appendField(line, "PRESSURE", 0, current.pressureOk);
+
+    if (strlen(line) > baseLength)
+        pushEvent(STATUS_EVENT_FAULT, line, onlyClient);
+}
+
+static void publishStepEvent(const StatusEventSnapshot &current, const StatusEventSnapshot *previous, int onlyClient)
+{
+    char line[STATUS_EVENT_LINE_LENGTH];
+
+    if (!previous)
+    {
+        if (current.operationActive)
+            sprintf(line, "[EVENT], OP %s STEP:%d", getEventOperationName(current.operationType), current.operationStep);
+        else
+            strcpy(line, "[EVENT], OP IDLE");
+        pushEvent(STATUS_EVENT_STEP, line, onlyClient);
+        return;
+    }
+
+    bool restarted = current.operationActive && previous->operationActive &&
+                     current.operationStartTime != previous->operationStartTime;
+
+    // Previous operation finished (a chained operation only starts after a successful one)
+    if (previous->operationActive && (!current.operationActive || restarted))
+    {
+        if (restarted || currentOperation.success)
+            sprintf(line, "[EVENT], OP %s END SUCCESS", getEventOperationName(previous->operationType));
+        else
+            snprintf(line, sizeof(line), "[EVENT], OP %s END FAILED:%s",
+                     getEventOperationName(previous->operationType), currentOperation.message);
+        pushEvent(STATUS_EVENT_STEP, line, onlyClient);
+    }
+
+    if (!current.operationActive)
+        return;
+
+    if (!previous->operationActive || restarted)
+    {
+        sprintf(line, "[EVENT], OP %s START", getEventOperationName(current.operationType));
+        pushEvent(STATUS_EVENT_STEP, line, onlyClient);
+    }
+
+    if (!previous->operationActive || restarted || previous->operationStep != current.operationStep)
+    {
+        sprintf(line, "[EVENT], OP %s STEP:%d", getEventOperationName(current.operationType), current.operationStep);
+        pushEvent(STATUS_EVENT_STEP, line, onlyClient);
+    }
+}
+
+static void publishClass(uint8_t eventClass, const StatusEventSnapshot &current,
+                         const StatusEventSnapshot *previous, int onlyClient)
+{
+    switch (eventClass)
+    {
+    case STATUS_EVENT_TRAY:
+        publishTrayEvent(current, previous, onlyClient);
+        break;
+    case STATUS_EVENT_STEP:
+        publishStepEvent(current, previous, onlyClient);
+        break;
+    case STATUS_EVENT_FAULT:
+        publishFaultEvent(current, previous, onlyClient);
+        break;
+    }
+}
+
+//=============================================================================
+// PUBLISHING
+//=============================================================================
+
+void publishStatusEvents(const SystemState &state)
+{
+    // Classes anyone connected is subscribed to
+    uint8_t subscribedClasses = 0;
+    for (int i = 0; i < MAX_ETHERNET_CLIENTS; i++)
+    {
+        if (clientSubscriptions[i] && clients[i] && clients[i].connected())
+            subscribedClasses |= clientSubscriptions[i];
+    }
+
+    if (subscribedClasses == 0)
+    {
+        publishedClasses = 0;
+        return;
+    }
+
+    StatusEventSnapshot current = published;
+    captureSnapshot(state, subscribedClasses, current);
+
+    for (uint8_t eventClass = STATUS_EVENT_TRAY; eventClass <= STATUS_EVENT_FAULT; eventClass <<= 1)
+    {
+        if (!(subscribedClasses & eventClass))
+            continue;
+
+        // Deltas to established subscribers
+        if (publishedClasses & eventClass)
+            publishClass(eventClass, current, &published, -1);
+
+        // Full snapshot to new subscribers
+        for (int i = 0; i < MAX_ETHERNET_CLIENTS; i++)
+        {
+            if (pendingBaseline[i] & eventClass)
+            {
+                publishClass(eventClass, current, NULL, i);
+                pendingBaseline[i] &= ~eventClass;
+            }
+        }
+    }
+
+    published = current;
+    publishedClasses = subscribedClasses;
+}
+
+//=============================================================================
+// REPORTING
+//=============================================================================
+
+void formatStatusEventClasses(uint8_t mask, char *buffer)
+{
+    buffer[0] = '\0';
+    for (int i = 0; i < 3; i++)
+    {
+        if (mask & (1 << i))
+        {
+            if (buffer[0] != '\0')
+                strcat(buffer, ",");
+            strcat(buffer, EVENT_CLASS_NAMES[i]);
+        }
+    }
+    if (buffer[0] == '\0')
+        strcpy(buffer, "NONE");
+}
+
+void printStatusSubscriptions()
+{
+    char msg[100];
+    char classes[20];
+
+    for (int i = 0; i < MAX_ETHERNET_CLIENTS; i++)
+    {
+        if (clients[i] && clients[i].connected())
+        {
+            formatStatusEventClasses(clientSubscriptions[i], classes);
+            IPAddress ip = clients[i].remoteIP();
+            sprintf(msg, "CLIENT%d:%d.%d.%d.%d %s", i + 1, ip[0], ip[1], ip[2], ip[3], classes);
+            Console.println(msg);
+        }
+    }
+
+    sprintf(msg, "EVENTS_PUSHED:%lu", (unsigned long)statusEventStats.eventsPushed);
+    Console.println(msg);
+    sprintf(msg, "BYTES_PUSHED:%lu", (unsigned long)statusEventStats.bytesPushed);
+    Console.println(msg);
+}
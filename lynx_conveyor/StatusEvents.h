@@ -0,0 +1,75 @@
+#ifndef STATUS_EVENTS_H
+#define STATUS_EVENTS_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "ClearCore.h"
+#include "EthernetController.h"
+#include "ValveController.h"
+#include "Utils.h"
+
+//=============================================================================
+// STATUS EVENT CONFIGURATION
+//=============================================================================
+// Event classes a client can subscribe to (bitmask)
+#define STATUS_EVENT_TRAY 0x01  // Tray presence, lock and shuttle changes
+#define STATUS_EVENT_STEP 0x02  // Operation start, step transitions and completion
+#define STATUS_EVENT_FAULT 0x04 // Motor fault, E-stop and pressure changes
+#define STATUS_EVENT_ALL (STATUS_EVENT_TRAY | STATUS_EVENT_STEP | STATUS_EVENT_FAULT)
+
+#define STATUS_EVENT_LINE_LENGTH 120 // Longest pushed event line
+
+//=============================================================================
+// STATUS EVENT STRUCTURES
+//=============================================================================
+
+// Last published value of every field that can generate an event
+struct StatusEventSnapshot
+{
+    // Tray class
+    bool trayPresent[3];
+    bool trayLocked[3];
+    bool shuttleLocked;
+
+    // Step class
+    bool operationActive;
+    OperationType operationType;
+    unsigned long operationStartTime;
+    int operationStep;
+
+    // Fault class
+    bool motorFaulted;
+    bool eStopActive;
+    bool pressureOk;
+};
+
+struct StatusEventStats
+{
+    uint32_t eventsPushed; // Lines written to clients
+    uint32_t bytesPushed;
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+extern uint8_t clientSubscriptions[MAX_ETHERNET_CLIENTS];
+extern StatusEventStats statusEventStats;
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+// Subscription management
+void setClientSubscription(int clientIndex, uint8_t mask);
+void clearClientSubscription(int clientIndex); // Call when a client slot connects or disconnects
+uint8_t parseStatusEventClass(const char *name); // 0 if unknown
+
+// Publishing (call once per loop after state has been updated)
+void publishStatusEvents(const SystemState &state);
+
+// Reporting
+void formatStatusEventClasses(uint8_t mask, char *buffer);
+void printStatusSubscriptions();
+
+#endif // STATUS_EVENTS_H
@@ -0,0 +1,319 @@
+#include "TestResults.h"
+#include "PositionConfig.h"
+#include <SD.h>
+#include <stdlib.h>
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+TestRun testRun = {NULL, 0, 0, 0, 0, 0, 0, false, false, false};
+TestSample testSamples[TEST_RESULTS_MAX_SAMPLES];
+
+// Sorted copy of one metric's values for percentiles
+static float sortedValues[TEST_RESULTS_MAX_SAMPLES];
+
+static const char *const TEST_METRIC_NAMES[TEST_METRIC_COUNT] = {
+    "move_time_ms",
+    "position_error_mm",
+    "homing_time_ms",
+    "home_position_mm",
+    "lock_time_ms",
+    "unlock_time_ms",
+    "cycle_time_ms"};
+
+//=============================================================================
+// RUN CONTROL
+//=============================================================================
+
+void clearTestResults()
+{
+    memset(&testRun, 0, sizeof(testRun));
+}
+
+bool runRecordedTest(const char *testName, bool (*test)())
+{
+    clearTestResults();
+    testRun.testName = testName;
+    testRun.startTime = millis();
+    testRun.active = true;
+
+    bool result = test();
+
+    testRun.active = false;
+    testRun.completed = result;
+    testRun.durationMs = timeDiff(millis(), testRun.startTime);
+
+    printTestResultsSummary();
+    return result;
+}
+
+//=============================================================================
+// RECORDING HOOKS
+//=============================================================================
+
+void beginTestCycle(uint16_t cycle)
+{
+    testRun.currentCycle = cycle;
+    testRun.cycleStartTime = millis();
+}
+
+void completeTestCycle()
+{
+    recordTestSample(TEST_METRIC_CYCLE_TIME_MS, 0, timeDiff(millis(), testRun.cycleStartTime));
+    testRun.cyclesCompleted++;
+}
+
+void recordTestSample(TestMetric metric, uint8_t tag, float value)
+{
+    if (!testRun.active)
+    {
+        return;
+    }
+
+    if (testRun.sampleCount >= TEST_RESULTS_MAX_SAMPLES)
+    {
+        if (!testRun.overflow)
+        {
+            Console.serialWarning(F("Test results table full - further samples dropped"));
+            testRun.overflow = true;
+        }
+        return;
+    }
+
+    TestSample &sample = testSamples[testRun.sampleCount++];
+    sample.timeMs = timeDiff(millis(), testRun.startTime);
+    sample.cycle = testRun.currentCycle;
+    sample.metric = metric;
+    sample.tag = tag;
+    sample.value = value;
+}
+
+void recordTestMove(uint8_t position, double targetMm, unsigned long moveStartTime)
+{
+    recordTestSample(TEST_METRIC_MOVE_TIME_MS, position, timeDiff(millis(), moveStartTime));
+    recordTestSample(TEST_METRIC_POSITION_ERROR_MM, position, getMotorPositionMm() - targetMm);
+}
+
+// safeValveOperation() with the actuation time recorded against the tray number
+bool recordedValveOperation(DoubleSolenoidValve &valve, CylinderSensor &sensor,
+                            ValvePosition position, unsigned long timeoutMs)
+{
+    uint8_t tag = 0; // Shuttle
+    if (&valve == getTray1Valve())
+        tag = 1;
+    else if (&valve == getTray2Valve())
+        tag = 2;
+    else if (&valve == getTray3Valve())
+        tag = 3;
+
+    unsigned long startTime = millis();
+    bool success = safeValveOperation(valve, sensor, position, timeoutMs);
+
+    if (success)
+    {
+        recordTestSample(position == VALVE_POSITION_LOCK ? TEST_METRIC_LOCK_TIME_MS : TEST_METRIC_UNLOCK_TIME_MS,
+                         tag, timeDiff(millis(), startTime));
+    }
+    return success;
+}
+
+//=============================================================================
+// STATISTICS
+//=============================================================================
+
+static int compareFloats(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Linear interpolation between closest ranks
+static float getPercentile(const float *sorted, uint16_t count, float percent)
+{
+    float rank = percent / 100.0f * (count - 1);
+    uint16_t lower = (uint16_t)rank;
+    if (lower + 1 >= count)
+    {
+        return sorted[count - 1];
+    }
+    return sorted[lower] + (rank - lower) * (sorted[lower + 1] - sorted[lower]);
+}
+
+bool computeTestMetricStats(TestMetric metric, uint8_t tag, TestMetricStats &stats)
+{
+    memset(&stats, 0, sizeof(stats));
+
+    // Welford's running mean/variance while collecting values to sort
+    double mean = 0.0;
+    double m2 = 0.0;
+    for (uint16_t i = 0; i < testRun.sampleCount; i++)
+    {
+        const TestSample &sample = testSamples[i];
+        if (sample.metric != metric || (tag != TEST_TAG_ANY && sample.tag != tag))
+        {
+            continue;
+        }
+
+        sortedValues[stats.count++] = sample.value;
+        double delta = sample.value - mean;
+        mean += delta / stats.count;
+        m2 += delta * (sample.value - mean);
+    }
+
+    if (stats.count == 0)
+    {
+        return false;
+    }
+
+    qsort(sortedValues, stats.count, sizeof(float), compareFloats);
+
+    stats.mean = mean;
+    stats.stddev = (stats.count > 1) ? sqrt(m2 / (stats.count - 1)) : 0.0f;
+    stats.min = sortedValues[0];
+    stats.max = sortedValues[stats.count - 1];
+    stats.p50 = getPercentile(sortedValues, stats.count, 50.0f);
+    stats.p90 = getPercentile(sortedValues, stats.count, 90.0f);
+    stats.p95 = getPercentile(sortedValues, stats.count, 95.0f);
+    stats.p99 = getPercentile(sortedValues, stats.count, 99.0f);
+    return true;
+}
+
+const char *getTestMetricName(TestMetric metric)
+{
+    return (metric < TEST_METRIC_COUNT) ? TEST_METRIC_NAMES[metric] : "unknown";
+}
+
+//=============================================================================
+// REPORTING AND EXPORT
+//=============================================================================
+
+void printTestResultsSummary()
+{
+    char msg[160];
+
+    if (testRun.testName == NULL)
+    {
+        Console.serialInfo(F("No test results recorded"));
+        return;
+    }
+
+    sprintf(msg, "Test '%s' %s: %u cycles, %u samples in %lu ms%s",
+            testRun.testName,
+            testRun.active ? "RUNNING" : (testRun.completed ? "PASSED" : "FAILED"),
+            testRun.cyclesCompleted, testRun.sampleCount, (unsigned long)testRun.durationMs,
+            testRun.overflow ? " (table full - samples dropped)" : "");
+    Console.println(msg);
+
+    Console.println(F("  Metric              Tag     N       Mean     StdDev        Min        P50        P90        P95        P99        Max"));
+
+    // One row per metric/tag combination present in the table
+    for (int metric = 0; metric < TEST_METRIC_COUNT; metric++)
+    {
+        uint16_t tagsSeen = 0; // Bitmask of tags 0-15 already reported
+        for (uint16_t i = 0; i < testRun.sampleCount; i++)
+        {
+            const TestSample &sample = testSamples[i];
+            if (sample.metric != metric || sample.tag >= 16 || (tagsSeen & (1 << sample.tag)))
+            {
+                continue;
+            }
+            tagsSeen |= (1 << sample.tag);
+
+            TestMetricStats stats;
+            computeTestMetricStats((TestMetric)metric, sample.tag, stats);
+            sprintf(msg, "  %-18s %4u %5u %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f",
+                    getTestMetricName((TestMetric)metric), sample.tag, stats.count, stats.mean, stats.stddev,
+                    stats.min, stats.p50, stats.p90, stats.p95, stats.p99, stats.max);
+            Console.println(msg);
+        }
+    }
+}
+
+static void formatCsvRow(const TestSample &sample, char *buffer)
+{
+    sprintf(buffer, "%lu,%u,%s,%u,%.3f", (unsigned long)sample.timeMs, sample.cycle,
+            getTestMetricName((TestMetric)sample.metric), sample.tag, sample.value);
+}
+
+void printTestResultsCsv()
+{
+    char row[80];
+
+    Console.println(F("time_ms,cycle,metric,tag,value"));
+    for (uint16_t i = 0; i < testRun.sampleCount; i++)
+    {
+        formatCsvRow(testSamples[i], row);
+        Console.println(row);
+    }
+}
+
+bool saveTestResultsToSD(bool binary)
+{
+    const char *fileName = binary ? TEST_RESULTS_BIN_FILE : TEST_RESULTS_CSV_FILE;
+
+    if (!isSDCardAvailable())
+    {
+        Console.serialError(F("SD card not available"));
+        return false;
+    }
+
+    if (testRun.testName == NULL)
+    {
+        Console.serialError(F("No test results to save"));
+        return false;
+    }
+
+    // FILE_WRITE appends - start from an empty file
+    if (SD.exists(fileName))
+    {
+        SD.remove(fileName);
+    }
+
+    File file = SD.open(fileName, FILE_WRITE);
+    if (!file)
+    {
+        Console.serialError(F("Failed to open test results file for writing"));
+        return false;
+    }
+
+    if (binary)
+    {
+        TestResultsFileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = TEST_RESULTS_FILE_MAGIC;
+        header.version = TEST_RESULTS_FILE_VERSION;
+        header.sampleCount = testRun.sampleCount;
+        header.durationMs = testRun.durationMs;
+        header.cyclesCompleted = testRun.cyclesCompleted;
+        header.completed = testRun.completed ? 1 : 0;
+        strncpy(header.testName, testRun.testName, sizeof(header.testName) - 1);
+
+        file.write((const uint8_t *)&header, sizeof(header));
+        file.write((const uint8_t *)testSamples, testRun.sampleCount * sizeof(TestSample));
+    }
+    else
+    {
+        char row[80];
+        file.print("# test=");
+        file.print(testRun.testName);
+        file.print(" completed=");
+        file.print(testRun.completed ? 1 : 0);
+        file.print(" cycles=");
+        file.println(testRun.cyclesCompleted);
+        file.println("time_ms,cycle,metric,tag,value");
+        for (uint16_t i = 0; i < testRun.sampleCount; i++)
+        {
+            formatCsvRow(testSamples[i], row);
+            file.println(row);
+        }
+    }
+
+    file.flush();
+    file.close();
+
+    char msg[80];
+    sprintf(msg, "Saved %u test samples to %s", testRun.sampleCount, fileName);
+    Console.serialInfo(msg);
+    return true;
+}
@@ -0,0 +1,122 @@
+#ifndef TEST_RESULTS_H
+#define TEST_RESULTS_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "ClearCore.h"
+#include "MotorController.h"
+#include "ValveController.h"
+#include "Utils.h"
+
+//=============================================================================
+// TEST RESULTS CONFIGURATION
+//=============================================================================
+#define TEST_RESULTS_MAX_SAMPLES 512           // Preallocated samples per run (12 bytes each)
+#define TEST_RESULTS_CSV_FILE "TESTRES.CSV"    // SD card export files
+#define TEST_RESULTS_BIN_FILE "TESTRES.BIN"
+#define TEST_RESULTS_FILE_MAGIC 0x5352544CUL   // "LTRS" little-endian
+#define TEST_RESULTS_FILE_VERSION 1
+#define TEST_TAG_ANY 0xFF                      // Stats across all tags of a metric
+
+//=============================================================================
+// TEST RESULTS ENUMS AND STRUCTURES
+//=============================================================================
+
+// What a sample measures
+enum TestMetric
+{
+    TEST_METRIC_MOVE_TIME_MS,       // tag = target position (0 = test position)
+    TEST_METRIC_POSITION_ERROR_MM,  // Signed actual - target, tag = target position
+    TEST_METRIC_HOMING_TIME_MS,
+    TEST_METRIC_HOME_POSITION_MM,   // Position reported right after homing
+    TEST_METRIC_LOCK_TIME_MS,       // tag = tray number (0 = shuttle)
+    TEST_METRIC_UNLOCK_TIME_MS,     // tag = tray number (0 = shuttle)
+    TEST_METRIC_CYCLE_TIME_MS,
+    TEST_METRIC_COUNT
+};
+
+// Single recorded sample (written to SD as-is)
+struct TestSample
+{
+    uint32_t timeMs;  // Milliseconds since the run started
+    uint16_t cycle;   // 1-based test cycle
+    uint8_t metric;   // TestMetric
+    uint8_t tag;      // Position or tray number
+    float value;
+};
+
+// Current/last test run
+struct TestRun
+{
+    const char *testName;
+    unsigned long startTime;
+    uint32_t durationMs;
+    uint16_t sampleCount;
+    uint16_t currentCycle;
+    uint16_t cyclesCompleted;
+    unsigned long cycleStartTime;
+    bool active;
+    bool completed;   // Test returned success
+    bool overflow;    // Samples dropped because the table filled
+};
+
+// Summary statistics for one metric
+struct TestMetricStats
+{
+    uint16_t count;
+    float mean;
+    float stddev;     // Sample standard deviation
+    float min;
+    float max;
+    float p50;
+    float p90;
+    float p95;
+    float p99;
+};
+
+// SD card binary file header (followed by sampleCount TestSample records)
+struct TestResultsFileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sampleCount;
+    uint32_t durationMs;
+    uint16_t cyclesCompleted;
+    uint8_t completed;
+    uint8_t reserved;
+    char testName[16];
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+extern TestRun testRun;
+extern TestSample testSamples[TEST_RESULTS_MAX_SAMPLES];
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+// Run a test function with sample recording around it
+bool runRecordedTest(const char *testName, bool (*test)());
+void clearTestResults();
+
+// Recording hooks (called from the tests)
+void beginTestCycle(uint16_t cycle);
+void completeTestCycle();
+void recordTestSample(TestMetric metric, uint8_t tag, float value);
+void recordTestMove(uint8_t position, double targetMm, unsigned long moveStartTime);
+bool recordedValveOperation(DoubleSolenoidValve &valve, CylinderSensor &sensor,
+                            ValvePosition position, unsigned long timeoutMs);
+
+// Statistics
+bool computeTestMetricStats(TestMetric metric, uint8_t tag, TestMetricStats &stats);
+const char *getTestMetricName(TestMetric metric);
+
+// Reporting and export
+void printTestResultsSummary();
+void printTestResultsCsv();
+bool saveTestResultsToSD(bool binary);
+
+#endif // TEST_RESULTS_H
@@ -1,5 +1,8 @@
 #include "Tests.h"
 
+bool testInProgress = false;
+volatile bool testAbortRequested = false;
+
 void requestTestAbort(const char *source)
 {
     // Only set the flag if not already set
@@ -204,6 +207,7 @@ bool testHomingRepeatability()
         case PHASE_START:
         {
             sprintf(messageBuffer, "Starting cycle %d of %d", cyclesCompleted + 1, NUM_CYCLES);
+            beginTestCycle(cyclesCompleted + 1);
             Console.serialInfo(messageBuffer);
             currentPhase = PHASE_INITIAL_HOMING;
             lastActionTime = currentTime;
@@ -271,6 +275,8 @@ bool testHomingRepeatability()
             // Wait for homing to complete successfully
             if (motorState == MOTOR_STATE_IDLE && isHomed)
             {
+                recordTestSample(TEST_METRIC_HOMING_TIME_MS, 0, timeDiff(currentTime, lastActionTime));
+                recordTestSample(TEST_METRIC_HOME_POSITION_MM, 0, getMotorPositionMm());
                 Console.serialInfo(F("Homing complete. Waiting..."));
                 lastActionTime = currentTime;
                 currentPhase = PHASE_PAUSE_AFTER_HOMING; // Use explicit state
@@ -387,6 +393,7 @@ bool testHomingRepeatability()
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
                 // This is a more reliable way to check for move completion
+                recordTestMove(0, TEST_POSITION_MM, lastActionTime);
                 sprintf(messageBuffer, "Position reached: %.1fmm. Waiting...", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 motorState = MOTOR_STATE_IDLE; // Force the state update if needed
@@ -485,6 +492,9 @@ bool testHomingRepeatability()
             // Wait for homing to complete successfully
             if (motorState == MOTOR_STATE_IDLE && isHomed)
             {
+                recordTestSample(TEST_METRIC_HOMING_TIME_MS, 0, timeDiff(currentTime, lastActionTime));
+                recordTestSample(TEST_METRIC_HOME_POSITION_MM, 0, getMotorPositionMm());
+                completeTestCycle();
                 cyclesCompleted++;
                 sprintf(messageBuffer, "Cycle %d completed. Position after homing: %.1fmm",
                         cyclesCompleted, getMotorPositionMm());
@@ -641,6 +651,7 @@ bool testPositionCycling()
         case PHASE_START:
         {
             sprintf(messageBuffer, "Starting cycle %d of %d", cyclesCompleted + 1, NUM_CYCLES);
+            beginTestCycle(cyclesCompleted + 1);
             Console.serialInfo(messageBuffer);
 
             if (handleTestAbort())
@@ -731,6 +742,7 @@ bool testPositionCycling()
             // Wait for move to complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(3, POSITION_3_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 3: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 lastActionTime = currentTime;
@@ -836,6 +848,7 @@ bool testPositionCycling()
             // Wait for move to complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(1, POSITION_1_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 1: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 lastActionTime = currentTime;
@@ -941,6 +954,7 @@ bool testPositionCycling()
             // Wait for move to complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(2, POSITION_2_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 2: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 lastActionTime = currentTime;
@@ -1045,10 +1059,12 @@ bool testPositionCycling()
             // Wait for move to complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(1, POSITION_1_MM, lastActionTime);
                 sprintf(messageBuffer, "Back at Position 1: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
 
                 // Cycle complete
+                completeTestCycle();
                 cyclesCompleted++;
                 lastActionTime = currentTime;
 
@@ -1318,6 +1334,7 @@ bool testTrayHandling()
 
             {
                 sprintf(messageBuffer, "Starting tray handling cycle %d of %d", cyclesCompleted + 1, NUM_CYCLES);
+                beginTestCycle(cyclesCompleted + 1);
                 Console.serialInfo(messageBuffer);
                 currentPhase = PHASE_CHECK_POSITION_1;
                 lastActionTime = currentTime;
@@ -1395,6 +1412,7 @@ bool testTrayHandling()
             // Check if move is complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(1, POSITION_1_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 1: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 currentPhase = PHASE_CHECK_TRAY_AT_POS1;
@@ -1479,7 +1497,7 @@ bool testTrayHandling()
 
             if (valve1 && sensor1)
             {
-                if (safeValveOperation(*valve1, *sensor1, VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
+                if (recordedValveOperation(*valve1, *sensor1, VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
                 {
                     Console.serialInfo(F("Tray locked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_TRAY_POS1;
@@ -1532,7 +1550,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle locked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_SHUTTLE_POS1;
@@ -1585,7 +1603,7 @@ bool testTrayHandling()
 
             if (valve1 && sensor1)
             {
-                if (safeValveOperation(*valve1, *sensor1, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*valve1, *sensor1, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Tray unlocked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_TRAY_POS1;
@@ -1742,6 +1760,7 @@ bool testTrayHandling()
             // Check if move is complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(3, POSITION_3_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 3: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 currentPhase = PHASE_VERIFY_TRAY_AT_POS3;
@@ -1826,7 +1845,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle unlocked at Position 3."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_SHUTTLE_POS3;
@@ -1879,7 +1898,7 @@ bool testTrayHandling()
 
             if (valve3 && sensor3)
             {
-                if (safeValveOperation(*valve3, *sensor3, VALVE_POSITION_LOCK, 1000))
+                if (recordedValveOperation(*valve3, *sensor3, VALVE_POSITION_LOCK, 1000))
                 {
                     Console.serialInfo(F("Tray locked at Position 3."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_TRAY_POS3;
@@ -2159,7 +2178,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle locked at Position 3."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_SHUTTLE_POS3;
@@ -2212,7 +2231,7 @@ bool testTrayHandling()
 
             if (valve3 && sensor3)
             {
-                if (safeValveOperation(*valve3, *sensor3, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*valve3, *sensor3, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Tray unlocked at Position 3."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_TRAY_POS3;
@@ -2348,6 +2367,7 @@ bool testTrayHandling()
             // Check if move is complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(1, POSITION_1_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 1 from Position 3: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 currentPhase = PHASE_VERIFY_TRAY_AT_POS1_FROM_3;
@@ -2431,7 +2451,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle unlocked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_SHUTTLE_POS1_FROM_3;
@@ -2484,7 +2504,7 @@ bool testTrayHandling()
 
             if (valve1 && sensor1)
             {
-                if (safeValveOperation(*valve1, *sensor1, VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
+                if (recordedValveOperation(*valve1, *sensor1, VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
                 {
                     Console.serialInfo(F("Tray locked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_TRAY_POS1_FROM_3;
@@ -2561,7 +2581,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle locked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_SHUTTLE_POS1_FROM_3;
@@ -2614,7 +2634,7 @@ bool testTrayHandling()
 
             if (valve1 && sensor1)
             {
-                if (safeValveOperation(*valve1, *sensor1, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*valve1, *sensor1, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Tray unlocked at Position 1."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_TRAY_POS1_AGAIN;
@@ -2772,6 +2792,7 @@ bool testTrayHandling()
             // Check if move is complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(2, POSITION_2_MM, lastActionTime);
                 sprintf(messageBuffer, "Reached Position 2: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
                 currentPhase = PHASE_VERIFY_TRAY_AT_POS2;
@@ -2856,7 +2877,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle unlocked at Position 2."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_SHUTTLE_POS2;
@@ -2909,7 +2930,7 @@ bool testTrayHandling()
 
             if (valve2 && sensor2)
             {
-                if (safeValveOperation(*valve2, *sensor2, VALVE_POSITION_LOCK, 1000))
+                if (recordedValveOperation(*valve2, *sensor2, VALVE_POSITION_LOCK, 1000))
                 {
                     Console.serialInfo(F("Tray locked at Position 2."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_TRAY_POS2;
@@ -3188,7 +3209,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_LOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle locked at Position 2."));
                     currentPhase = PHASE_DELAY_AFTER_LOCK_SHUTTLE_POS2;
@@ -3241,7 +3262,7 @@ bool testTrayHandling()
 
             if (valve2 && sensor2)
             {
-                if (safeValveOperation(*valve2, *sensor2, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*valve2, *sensor2, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Tray unlocked at Position 2."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_TRAY_POS2;
@@ -3377,6 +3398,7 @@ bool testTrayHandling()
             // Check if move is complete
             if (MOTOR_CONNECTOR.StepsComplete() && motorState != MOTOR_STATE_FAULTED)
             {
+                recordTestMove(1, POSITION_1_MM, lastActionTime);
                 sprintf(messageBuffer, "Back at Position 1: %.1fmm", getMotorPositionMm());
                 Console.serialInfo(messageBuffer);
 
@@ -3457,6 +3479,7 @@ bool testTrayHandling()
                 Console.serialInfo(F("Tray settling complete at Position 1."));
 
                 // NOW increment cycle count after tray has fully settled
+                completeTestCycle();
                 cyclesCompleted++;
 
                 // Report cycle status
@@ -3490,7 +3513,7 @@ bool testTrayHandling()
 
             if (shuttleValve && shuttleSensor)
             {
-                if (safeValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
+                if (recordedValveOperation(*shuttleValve, *shuttleSensor, VALVE_POSITION_UNLOCK, 1000))
                 {
                     Console.serialInfo(F("Shuttle unlocked at end of cycle."));
                     currentPhase = PHASE_DELAY_AFTER_UNLOCK_SHUTTLE_END_OF_CYCLE;
@@ -8,6 +8,7 @@
 #include "Utils.h"
 #include "ValveController.h"
 #include "OutputManager.h"
+#include "TestResults.h"
 
 //=============================================================================
 // FUNCTION DECLARATIONS
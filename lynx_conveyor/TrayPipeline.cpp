@@ -0,0 +1,338 @@
+#include "TrayPipeline.h"
+#include "Commands.h"
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+TrayPipeline trayPipeline = {false, 0, 0, 0.0};
+
+// Request mixes reported by printTrayRoutePlan(NULL)
+static const char *const REPRESENTATIVE_MIXES[] = {
+    "LLLUUU",  // Fill, then drain
+    "LULULU",  // Alternating load/unload
+    "LLULUU",  // Mixed
+    "LLUULLUU" // Two trays at a time
+};
+
+//=============================================================================
+// REQUEST QUEUE
+//=============================================================================
+
+void setTrayPipelineEnabled(bool enabled)
+{
+    trayPipeline.enabled = enabled;
+    if (!enabled)
+    {
+        cancelQueuedTrayUnloads("pipeline disabled");
+    }
+}
+
+bool queueTrayUnload()
+{
+    if (trayPipeline.queuedUnloads >= TRAY_PIPELINE_MAX_QUEUED_UNLOADS)
+    {
+        return false;
+    }
+
+    trayPipeline.queuedUnloads++;
+    return true;
+}
+
+bool hasQueuedTrayUnload()
+{
+    return trayPipeline.enabled && trayPipeline.queuedUnloads > 0;
+}
+
+void dispatchQueuedTrayUnload()
+{
+    if (!hasQueuedTrayUnload())
+    {
+        return;
+    }
+    trayPipeline.queuedUnloads--;
+
+    char msg[100];
+    SystemState state = getSystemState();
+    updateTrayTrackingFromSensors(state);
+
+    // Same checks as tray,unload,request - the state may have changed while queued
+    if (!checkTrayCommandSafety(TRAY_CMD_UNLOAD_REQUEST) || !checkTrayUnloadMotorReady(state))
+    {
+        Console.serialWarning(F("Queued unload not started"));
+        return;
+    }
+
+    if (trayTracking.totalTraysInSystem == 0)
+    {
+        Console.error(F("NO_TRAYS_TO_UNLOAD"));
+        return;
+    }
+
+    if (state.tray1Present)
+    {
+        Console.acknowledge(F("TRAY_READY_FOR_GRIP"));
+        Console.serialInfo(F("Queued unload: tray at position 1 is locked and ready for gripping"));
+        return;
+    }
+
+    int sourcePosition = state.tray2Present ? 2 : 3;
+    double sourceMm = (sourcePosition == 2) ? POSITION_2_MM : POSITION_3_MM;
+
+    // Starting away from position 1 means the empty return and the empty trip out were merged
+    if (!isAtPosition(state.currentPositionMm, POSITION_1_MM))
+    {
+        trayPipeline.chainedUnloads++;
+        trayPipeline.emptyTravelSavedMm += abs(state.currentPositionMm - POSITION_1_MM) +
+                                           abs(sourceMm - POSITION_1_MM) -
+                                           abs(sourceMm - state.currentPositionMm);
+    }
+
+    sprintf(msg, "Queued unload: moving tray from position %d to position 1", sourcePosition);
+    Console.serialInfo(msg);
+
+    beginOperation();
+    currentOperation.inProgress = true;
+    currentOperation.type = OPERATION_UNLOADING;
+    currentOperation.startTime = millis();
+
+    Console.acknowledge(F("PREPARING_TRAY"));
+}
+
+void cancelQueuedTrayUnloads(const char *reason)
+{
+    if (trayPipeline.queuedUnloads == 0)
+    {
+        return;
+    }
+
+    char msg[100];
+    sprintf(msg, "Dropped %d queued unload request(s): %s", trayPipeline.queuedUnloads, reason);
+    Console.serialWarning(msg);
+    trayPipeline.queuedUnloads = 0;
+}
+
+//=============================================================================
+// ROUTE PLANNING
+//=============================================================================
+
+// Trapezoidal move time using the same velocity selection as moveToPositionMm()
+unsigned long estimateShuttleMoveMs(double distanceMm, bool shuttleEmpty)
+{
+    if (distanceMm <= 0.0)
+    {
+        return 0;
+    }
+
+    int velocityRpm = getVelocityForDistance_i((int32_t)(distanceMm * MM_SCALE_FACTOR), shuttleEmpty);
+    double velocityMmPerSec = velocityRpm / 60.0 * MM_PER_REV;
+    double accelMmPerSec2 = MAX_ACCEL_RPM_PER_SEC / 60.0 * MM_PER_REV;
+
+    // Distance spent accelerating and decelerating at full velocity
+    double rampMm = velocityMmPerSec * velocityMmPerSec / accelMmPerSec2;
+    double seconds;
+    if (distanceMm < rampMm)
+        seconds = 2.0 * sqrt(distanceMm / accelMmPerSec2); // Triangular profile
+    else
+        seconds = distanceMm / velocityMmPerSec + velocityMmPerSec / accelMmPerSec2;
+
+    return (unsigned long)(seconds * 1000.0);
+}
+
+static void addShuttleLeg(TrayRoutePlan &plan, double fromMm, double toMm, bool shuttleEmpty)
+{
+    double distanceMm = abs(toMm - fromMm);
+    if (distanceMm < POSITION_TOLERANCE_MM)
+    {
+        return;
+    }
+
+    plan.totalMs += estimateShuttleMoveMs(distanceMm, shuttleEmpty);
+    if (shuttleEmpty)
+    {
+        plan.emptyTrips++;
+        plan.emptyTravelMm += distanceMm;
+    }
+    else
+    {
+        plan.loadedTravelMm += distanceMm;
+    }
+}
+
+static double getPositionMm(int position)
+{
+    return (position == 3) ? POSITION_3_MM : (position == 2) ? POSITION_2_MM
+                                                            : POSITION_1_MM;
+}
+
+// Simulate a mix of 'L' (load) and 'U' (unload) requests starting from an empty system.
+// Pipelined mode skips the empty return after a load when the next request is an unload.
+bool planTrayRoute(const char *mix, bool pipelined, TrayRoutePlan &plan)
+{
+    memset(&plan, 0, sizeof(plan));
+
+    size_t length = strlen(mix);
+    if (length == 0 || length > TRAY_PLAN_MAX_REQUESTS)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        char request = toupper(mix[i]);
+        if (request != 'L' && request != 'U')
+        {
+            return false;
+        }
+    }
+
+    bool occupied[4] = {false, false, false, false}; // Index 1-3
+    double shuttleMm = POSITION_1_MM;
+    bool shuttleChained = false;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (toupper(mix[i]) == 'L')
+        {
+            if (occupied[1])
+            {
+                plan.requestsSkipped++; // System full
+                continue;
+            }
+
+            // tray,load,request brings the shuttle to position 1
+            addShuttleLeg(plan, shuttleMm, POSITION_1_MM, true);
+            shuttleMm = POSITION_1_MM;
+
+            int target = !occupied[3] ? 3 : !occupied[2] ? 2
+                                                          : 1;
+            bool trayMoves = (target != 1);
+            bool chain = pipelined && trayMoves && i + 1 < length && toupper(mix[i + 1]) == 'U';
+
+            plan.totalMs += TRAY_PLAN_ROBOT_HANDOFF_MS +
+                            estimateWorkflowDwellMs(TRAY_LOADING_WORKFLOW, trayLoadingTiming, trayMoves, chain);
+            if (trayMoves)
+            {
+                addShuttleLeg(plan, POSITION_1_MM, getPositionMm(target), false);
+                shuttleMm = getPositionMm(target);
+                if (!chain)
+                {
+                    addShuttleLeg(plan, shuttleMm, POSITION_1_MM, true);
+                    shuttleMm = POSITION_1_MM;
+                }
+            }
+
+            occupied[target] = true;
+            plan.traysMoved++;
+            shuttleChained = chain;
+        }
+        else
+        {
+            int source = occupied[1] ? 1 : occupied[2] ? 2
+                                       : occupied[3]   ? 3
+                                                       : 0;
+            if (source == 0)
+            {
+                plan.requestsSkipped++; // Nothing to unload
+                shuttleChained = false;
+                continue;
+            }
+
+            bool trayMoves = (source != 1);
+            if (trayMoves)
+            {
+                addShuttleLeg(plan, shuttleMm, getPositionMm(source), true);
+                addShuttleLeg(plan, getPositionMm(source), POSITION_1_MM, false);
+                shuttleMm = POSITION_1_MM;
+                if (shuttleChained)
+                    plan.chainedUnloads++;
+            }
+
+            plan.totalMs += TRAY_PLAN_ROBOT_HANDOFF_MS +
+                            estimateWorkflowDwellMs(TRAY_UNLOADING_WORKFLOW, trayUnloadingTiming, trayMoves, false);
+
+            occupied[source] = false;
+            plan.traysMoved++;
+            shuttleChained = false;
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================
+// REPORTING
+//=============================================================================
+
+void printTrayPipelineStatus()
+{
+    char msg[100];
+
+    sprintf(msg, "PIPELINE:%d", trayPipeline.enabled ? 1 : 0);
+    Console.println(msg);
+    sprintf(msg, "QUEUED_UNLOADS:%d", trayPipeline.queuedUnloads);
+    Console.println(msg);
+    sprintf(msg, "CHAINED_UNLOADS:%u", trayPipeline.chainedUnloads);
+    Console.println(msg);
+    sprintf(msg, "EMPTY_TRAVEL_SAVED_MM:%.1f", trayPipeline.emptyTravelSavedMm);
+    Console.println(msg);
+}
+
+static void printPlanLine(const char *mode, const TrayRoutePlan &plan)
+{
+    char msg[120];
+    double traysPerHour = plan.totalMs > 0 ? plan.traysMoved * 3600000.0 / plan.totalMs : 0.0;
+
+    sprintf(msg, "  %-10s %2d trays %7.1f s %6.1f trays/h  empty: %2d trips %7.1f mm  loaded: %7.1f mm",
+            mode, plan.traysMoved, plan.totalMs / 1000.0, traysPerHour,
+            plan.emptyTrips, plan.emptyTravelMm, plan.loadedTravelMm);
+    Console.println(msg);
+}
+
+static void printMixPlan(const char *mix)
+{
+    TrayRoutePlan sequential;
+    TrayRoutePlan pipelined;
+    char msg[100];
+
+    if (!planTrayRoute(mix, false, sequential) || !planTrayRoute(mix, true, pipelined))
+    {
+        sprintf(msg, "Invalid request mix '%s' - use up to %d of L (load) / U (unload)", mix, TRAY_PLAN_MAX_REQUESTS);
+        Console.error(msg);
+        return;
+    }
+
+    sprintf(msg, "Mix %s:", mix);
+    Console.println(msg);
+    printPlanLine("sequential", sequential);
+    printPlanLine("pipelined", pipelined);
+
+    if (pipelined.totalMs > 0 && sequential.totalMs > pipelined.totalMs)
+    {
+        sprintf(msg, "  %d unload(s) chained, %.1f s saved (%.1f%%)", pipelined.chainedUnloads,
+                (sequential.totalMs - pipelined.totalMs) / 1000.0,
+                100.0 * (sequential.totalMs - pipelined.totalMs) / sequential.totalMs);
+        Console.println(msg);
+    }
+    if (sequential.requestsSkipped > 0)
+    {
+        sprintf(msg, "  %d request(s) skipped (system full or empty)", sequential.requestsSkipped);
+        Console.println(msg);
+    }
+}
+
+void printTrayRoutePlan(const char *mix)
+{
+    char msg[100];
+    sprintf(msg, "Route estimate (robot handoff %lu ms per tray, starting empty):", (unsigned long)TRAY_PLAN_ROBOT_HANDOFF_MS);
+    Console.println(msg);
+
+    if (mix != NULL)
+    {
+        printMixPlan(mix);
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(REPRESENTATIVE_MIXES) / sizeof(REPRESENTATIVE_MIXES[0]); i++)
+    {
+        printMixPlan(REPRESENTATIVE_MIXES[i]);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef TRAY_PIPELINE_H
+#define TRAY_PIPELINE_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "ClearCore.h"
+#include "MotorController.h"
+#include "Utils.h"
+#include "TrayWorkflow.h"
+
+//=============================================================================
+// PIPELINE CONFIGURATION
+//=============================================================================
+#define TRAY_PIPELINE_MAX_QUEUED_UNLOADS 2 // Unload requests held while a load is running
+#define TRAY_PLAN_ROBOT_HANDOFF_MS 6000    // Assumed robot place or grip/remove time at position 1
+#define TRAY_PLAN_MAX_REQUESTS 24          // Requests per simulated mix
+
+//=============================================================================
+// PIPELINE STRUCTURES
+//=============================================================================
+
+// Pipelined loading state
+struct TrayPipeline
+{
+    bool enabled;
+    uint8_t queuedUnloads;      // Unload requests waiting for the running load
+    uint16_t chainedUnloads;    // Unloads started from a load's drop-off position
+    double emptyTravelSavedMm;  // Empty shuttle travel avoided by chaining
+};
+
+// Result of simulating a request mix
+struct TrayRoutePlan
+{
+    uint8_t traysMoved;         // Loads and unloads completed
+    uint8_t requestsSkipped;    // Infeasible for the occupancy at that point (full/empty)
+    uint8_t emptyTrips;         // Legs driven at EMPTY_SHUTTLE_VELOCITY_RPM
+    uint8_t chainedUnloads;
+    double emptyTravelMm;
+    double loadedTravelMm;
+    unsigned long totalMs;
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+extern TrayPipeline trayPipeline;
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+// Request queue (loading workflow hooks)
+void setTrayPipelineEnabled(bool enabled);
+bool queueTrayUnload(); // False if the queue is full
+bool hasQueuedTrayUnload();
+void dispatchQueuedTrayUnload(); // Start the next queued unload from wherever the shuttle is
+void cancelQueuedTrayUnloads(const char *reason);
+
+// Route planning
+unsigned long estimateShuttleMoveMs(double distanceMm, bool shuttleEmpty);
+bool planTrayRoute(const char *mix, bool pipelined, TrayRoutePlan &plan);
+
+// Reporting
+void printTrayPipelineStatus();
+void printTrayRoutePlan(const char *mix); // NULL = representative mixes
+
+#endif // TRAY_PIPELINE_H
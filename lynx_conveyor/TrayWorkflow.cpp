@@ -0,0 +1,872 @@
+#include "TrayWorkflow.h"
+#include "TrayPipeline.h"
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+WorkflowTimingStats trayLoadingTiming;
+WorkflowTimingStats trayUnloadingTiming;
+
+static TrayWorkflowRunner runner = {NULL};
+
+// Valve step phases
+#define WF_VALVE_PHASE_CONFIRM 0 // Waiting for the cylinder sensor
+#define WF_VALVE_PHASE_SETTLE 1  // Sensor confirmed, waiting VALVE_ACTUATION_TIME_MS before verifying
+
+// Step results
+enum WorkflowStepResult
+{
+    WF_RESULT_WAITING,
+    WF_RESULT_DONE,
+    WF_RESULT_FAILED
+};
+
+//=============================================================================
+// LOADING WORKFLOW CHECKS
+//=============================================================================
+
+// Verify the tray at position 1 and choose its destination
+static bool planTrayLoading(WorkflowContext &ctx)
+{
+    SystemState state = getSystemState();
+
+    Console.serialInfo(F("Starting tray loading process - initial checks"));
+
+    if (!state.tray1Present)
+    {
+        Console.serialError(F("No tray detected at position 1"));
+        ctx.failureCode = "NO_TRAY";
+        return false;
+    }
+
+    if (!state.tray1Locked)
+    {
+        Console.serialError(F("Tray at position 1 not locked"));
+        ctx.failureCode = "TRAY_NOT_LOCKED";
+        return false;
+    }
+
+    // Determine target position based on occupied positions
+    int workflow = determineLoadingWorkflow();
+    if (workflow == 1)
+    {
+        ctx.workPosition = 3;
+        ctx.workPositionMm = POSITION_3_MM;
+        ctx.trayMoves = true;
+        Console.serialInfo(F("First tray - target is position 3"));
+    }
+    else if (workflow == 2)
+    {
+        ctx.workPosition = 2;
+        ctx.workPositionMm = POSITION_2_MM;
+        ctx.trayMoves = true;
+        Console.serialInfo(F("Second tray - target is position 2"));
+    }
+    else
+    {
+        ctx.workPosition = 1;
+        ctx.workPositionMm = POSITION_1_MM;
+        ctx.trayMoves = false;
+        Console.serialInfo(F("Third tray - keeping at position 1"));
+        return true;
+    }
+
+    if ((ctx.workPosition == 2 && state.tray2Present) || (ctx.workPosition == 3 && state.tray3Present))
+    {
+        Console.serialError(F("Target position already occupied"));
+        ctx.failureCode = "TARGET_POSITION_OCCUPIED";
+        return false;
+    }
+
+    if (!isPathClearForLoading(state.currentPositionMm, ctx.workPositionMm, state))
+    {
+        Console.serialError(F("Path to target position is blocked"));
+        ctx.failureCode = "PATH_BLOCKED";
+        return false;
+    }
+
+    Console.serialInfo(F("Initial checks passed, starting tray advancement sequence"));
+    return true;
+}
+
+// Re-check tray 1 after the sensor stabilization delay
+static bool verifyTray1Secured(WorkflowContext &ctx)
+{
+    SystemState state = getSystemState();
+
+    if (!state.tray1Present)
+    {
+        Console.serialError(F("Tray at position 1 disappeared during verification"));
+        ctx.failureCode = "TRAY1_VERIFICATION_FAILED";
+        return false;
+    }
+
+    if (!state.tray1Locked)
+    {
+        Console.serialError(F("Tray 1 lock status changed during verification"));
+        ctx.failureCode = "TRAY1_LOCK_VERIFICATION_FAILED";
+        return false;
+    }
+
+    Console.serialInfo(F("Sensor verification complete"));
+    return true;
+}
+
+static bool recordTrayLoad(WorkflowContext &ctx)
+{
+    if (!ctx.trayMoves)
+    {
+        Console.serialInfo(F("Updating tray tracking for position 1"));
+        loadThirdTray();
+    }
+    else if (ctx.workPosition == 2)
+    {
+        Console.serialInfo(F("Updating tray tracking: position 1 -> position 2"));
+        loadSecondTray();
+    }
+    else
+    {
+        Console.serialInfo(F("Updating tray tracking: position 1 -> position 3"));
+        loadFirstTray();
+    }
+    return true;
+}
+
+// Decide whether the shuttle returns empty or a queued unload starts from the drop-off position
+static bool planReturnRoute(WorkflowContext &ctx)
+{
+    ctx.chainUnload = hasQueuedTrayUnload();
+    if (ctx.chainUnload)
+    {
+        Console.serialInfo(F("Unload queued - skipping empty return to position 1"));
+    }
+    return true;
+}
+
+static bool completeTrayLoading(WorkflowContext &ctx)
+{
+    char msg[64];
+
+    if (!ctx.trayMoves)
+    {
+        Console.serialInfo(F("Tray loading at position 1 completed successfully"));
+        currentOperation.inProgress = false;
+        currentOperation.success = true;
+        strncpy(currentOperation.message, "SUCCESS", sizeof(currentOperation.message));
+        endOperation();
+        dispatchQueuedTrayUnload();
+        return true;
+    }
+
+    Console.acknowledge(F("TRAY LOADING COMPLETE"));
+    currentOperation.inProgress = false;
+    currentOperation.success = true;
+    strncpy(currentOperation.message,
+            ctx.positionWarning ? "[INFO] SUCCESS_WITH_POSITION_WARNING" : "[INFO] SUCCESS",
+            sizeof(currentOperation.message));
+
+    sprintf(msg, "Total loads completed: %d", trayTracking.totalLoadsCompleted);
+    Console.serialInfo(msg);
+
+    // Ensure tray tracking matches sensor readings
+    SystemState state = getSystemState();
+    updateTrayTrackingFromSensors(state);
+
+    endOperation();
+
+    // Pipelined mode: the shuttle is already on its way to the next job
+    dispatchQueuedTrayUnload();
+    return true;
+}
+
+//=============================================================================
+// UNLOADING WORKFLOW CHECKS
+//=============================================================================
+
+// Find the tray to unload and verify the path to position 1
+static bool planTrayUnloading(WorkflowContext &ctx)
+{
+    SystemState state = getSystemState();
+
+    Console.serialInfo(F("Starting tray unloading process - initial checks"));
+
+    int workflow = determineUnloadingWorkflow();
+    if (workflow == 0 || (!state.tray1Present && !state.tray2Present && !state.tray3Present))
+    {
+        Console.serialError(F("No trays in system to unload"));
+        ctx.failureCode = "NO_TRAYS";
+        return false;
+    }
+
+    if (workflow == 1)
+    {
+        // Tray already at position 1, it only needs to be locked
+        ctx.workPosition = 1;
+        ctx.workPositionMm = POSITION_1_MM;
+        ctx.trayMoves = false;
+        Console.serialInfo(F("Tray at position 1 ready for unloading"));
+
+        if (!state.tray1Locked)
+        {
+            Console.serialError(F("Tray at position 1 not locked"));
+            ctx.failureCode = "TRAY_NOT_LOCKED";
+            return false;
+        }
+        return true;
+    }
+
+    ctx.workPosition = (workflow == 2) ? 2 : 3;
+    ctx.workPositionMm = (workflow == 2) ? POSITION_2_MM : POSITION_3_MM;
+    ctx.trayMoves = true;
+
+    char msg[80];
+    sprintf(msg, "Will move tray from position %d to position 1 for unloading", ctx.workPosition);
+    Console.serialInfo(msg);
+
+    if (!isPathClearForUnloading(state.currentPositionMm, ctx.workPositionMm, state) ||
+        !isPathClearForUnloading(ctx.workPositionMm, POSITION_1_MM, state))
+    {
+        Console.serialError(F("Path to source or target position is blocked"));
+        ctx.failureCode = "PATH_BLOCKED";
+        return false;
+    }
+
+    return true;
+}
+
+// Re-check the source tray and position 1 after the sensor stabilization delay
+static bool verifyUnloadSource(WorkflowContext &ctx)
+{
+    SystemState state = getSystemState();
+
+    if (ctx.workPosition == 2 && !state.tray2Present)
+    {
+        Console.serialError(F("Tray at position 2 disappeared during verification"));
+        ctx.failureCode = "TRAY2_VERIFICATION_FAILED";
+        return false;
+    }
+    else if (ctx.workPosition == 3 && !state.tray3Present)
+    {
+        Console.serialError(F("Tray at position 3 disappeared during verification"));
+        ctx.failureCode = "TRAY3_VERIFICATION_FAILED";
+        return false;
+    }
+
+    if (state.tray1Present)
+    {
+        Console.serialError(F("Position 1 unexpectedly occupied during verification"));
+        ctx.failureCode = "POSITION1_OCCUPIED";
+        return false;
+    }
+
+    Console.serialInfo(F("Sensor verification complete"));
+    return true;
+}
+
+static bool recordTrayUnload(WorkflowContext &ctx)
+{
+    if (ctx.workPosition == 2)
+    {
+        unloadSecondTray();
+    }
+    else if (ctx.workPosition == 3)
+    {
+        unloadThirdTray();
+    }
+    return true;
+}
+
+// Tray locked at position 1 with the shuttle retracted - hand over to the robot
+static bool completeTrayUnloading(WorkflowContext &ctx)
+{
+    SystemState state = getSystemState();
+
+    if (!state.tray1Locked)
+    {
+        Console.serialError(F("Tray at position 1 not properly locked"));
+        ctx.failureCode = "TRAY_NOT_LOCKED";
+        return false;
+    }
+
+    if (state.shuttleLocked)
+    {
+        Console.serialError(F("Shuttle unexpectedly locked - must be retracted for robot access"));
+        ctx.failureCode = "SHUTTLE_NOT_RETRACTED";
+        return false;
+    }
+
+    Console.acknowledge(F("TRAY_READY_FOR_GRIP"));
+    Console.serialInfo(F("Tray locked at position 1 and ready for robot to grip"));
+
+    // Operation complete - Mitsubishi will need to send tray,gripped command before removing
+    currentOperation.inProgress = false;
+    currentOperation.success = true;
+    strncpy(currentOperation.message, "TRAY_READY_FOR_GRIP", sizeof(currentOperation.message));
+
+    updateTrayTrackingFromSensors(state);
+    endOperation();
+    return true;
+}
+
+//=============================================================================
+// WORKFLOW TABLES
+//=============================================================================
+// operationStep keeps the numbering the safety validator expects (e.g. shuttle
+// locking at loading steps 2-3, tray movement at loading step 8).
+// Verifications and safety dwells run on their own, in order. A group only
+// overlaps a valve's settle time with the next valve's stroke, and only where
+// the old sequence had no dwell between them (shuttle unlock, then tray 1 lock
+// at the end of an unload); each member reports its step as it starts.
+
+static const WorkflowStep LOADING_STEPS[] = {
+    // name                                step grp action           condition         target                   valve                  duration                         timeout                               check                failure
+    {"Initial checks",                       0, 0, WF_ACTION_CHECK, WF_ALWAYS,        WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    planTrayLoading,     "CHECK_FAILED"},
+    {"Sensor verification",                  1, 0, WF_ACTION_CHECK, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SENSOR_VERIFICATION_DELAY_MS,    0,                                    verifyTray1Secured,  "VERIFICATION_FAILED"},
+    {"Lock shuttle",                         3, 0, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_SHUTTLE,       VALVE_POSITION_LOCK,   0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                "SHUTTLE_LOCK_FAILURE"},
+    {"Unlock tray 1",                        5, 0, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_POSITION_1,    VALVE_POSITION_UNLOCK, 0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                "UNLOCK_FAILURE"},
+    {"Safety delay after unlock",            6, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_AFTER_UNLOCK_MS,    0,                                    NULL,                ""},
+    {"Safety delay before movement",         7, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_BEFORE_MOVEMENT_MS, 0,                                    NULL,                ""},
+    {"Move tray to target",                  8, 0, WF_ACTION_MOVE,  WF_IF_TRAY_MOVES, WF_TARGET_WORK_POSITION, VALVE_POSITION_LOCK,   0,                               0,                                    NULL,                "TARGET_POSITION_ERROR"},
+    {"Safety delay after movement",          9, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_AFTER_MOVEMENT_MS,  0,                                    NULL,                ""},
+    {"Unlock shuttle",                      10, 0, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_SHUTTLE,       VALVE_POSITION_UNLOCK, 0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                "SHUTTLE_UNLOCK_FAILURE"},
+    {"Safety delay after shuttle unlock",   11, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_AFTER_UNLOCK_MS,    0,                                    NULL,                ""},
+    {"Lock tray at target",                 12, 0, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_WORK_POSITION, VALVE_POSITION_LOCK,   0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                "LOCK_FAILURE"},
+    {"Safety delay before return movement", 13, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_BEFORE_MOVEMENT_MS, 0,                                    NULL,                ""},
+    {"Update tray tracking",                13, 0, WF_ACTION_CHECK, WF_ALWAYS,        WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    recordTrayLoad,      "TRACKING_FAILURE"},
+    {"Plan return route",                   13, 0, WF_ACTION_CHECK, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    planReturnRoute,     "PLAN_FAILURE"},
+    {"Return to position 1",                14, 0, WF_ACTION_MOVE,  WF_IF_SHUTTLE_RETURNS, WF_TARGET_POSITION_1,    VALVE_POSITION_LOCK,   0,                               0,                                    NULL,                "POSITION_ERROR"},
+    {"Complete loading",                    14, 0, WF_ACTION_CHECK, WF_ALWAYS,        WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    completeTrayLoading, "COMPLETION_FAILURE"},
+};
+
+static const WorkflowStep UNLOADING_STEPS[] = {
+    // name                                step grp action           condition         target                   valve                  duration                         timeout                               check                  failure
+    {"Initial checks",                       0, 0, WF_ACTION_CHECK, WF_ALWAYS,        WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    planTrayUnloading,     "CHECK_FAILED"},
+    {"Sensor verification",                  1, 0, WF_ACTION_CHECK, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SENSOR_VERIFICATION_DELAY_MS,    0,                                    verifyUnloadSource,    "VERIFICATION_FAILED"},
+    {"Move to source position",              3, 0, WF_ACTION_MOVE,  WF_IF_TRAY_MOVES, WF_TARGET_WORK_POSITION, VALVE_POSITION_LOCK,   0,                               0,                                    NULL,                  "SOURCE_POSITION_ERROR"},
+    {"Safety delay after movement",          4, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_AFTER_MOVEMENT_MS,  0,                                    NULL,                  ""},
+    {"Lock shuttle",                         5, 0, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_SHUTTLE,       VALVE_POSITION_LOCK,   0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                  "SHUTTLE_LOCK_FAILURE"},
+    {"Unlock source tray",                   6, 0, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_WORK_POSITION, VALVE_POSITION_UNLOCK, 0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                  "UNLOCK_FAILURE"},
+    {"Safety delay after unlock",            7, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_AFTER_UNLOCK_MS,    0,                                    NULL,                  ""},
+    {"Safety delay before movement",         8, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_BEFORE_MOVEMENT_MS, 0,                                    NULL,                  ""},
+    {"Move tray to position 1",              9, 0, WF_ACTION_MOVE,  WF_IF_TRAY_MOVES, WF_TARGET_POSITION_1,    VALVE_POSITION_LOCK,   0,                               0,                                    NULL,                  "POSITION_ERROR"},
+    {"Safety delay after movement",         10, 0, WF_ACTION_DELAY, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   SAFETY_DELAY_AFTER_MOVEMENT_MS,  0,                                    NULL,                  ""},
+    {"Unlock shuttle",                      11, 1, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_SHUTTLE,       VALVE_POSITION_UNLOCK, 0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                  "SHUTTLE_UNLOCK_FAILURE"},
+    {"Lock tray 1",                         12, 1, WF_ACTION_VALVE, WF_IF_TRAY_MOVES, WF_TARGET_POSITION_1,    VALVE_POSITION_LOCK,   0,                               VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS, NULL,                  "LOCK_FAILURE"},
+    {"Update tray tracking",                12, 0, WF_ACTION_CHECK, WF_IF_TRAY_MOVES, WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    recordTrayUnload,      "TRACKING_FAILURE"},
+    {"Ready for grip",                      13, 0, WF_ACTION_CHECK, WF_ALWAYS,        WF_TARGET_NONE,          VALVE_POSITION_LOCK,   0,                               0,                                    completeTrayUnloading, "COMPLETION_FAILURE"},
+};
+
+const TrayWorkflow TRAY_LOADING_WORKFLOW = {
+    "LOADING", LOADING_STEPS, sizeof(LOADING_STEPS) / sizeof(LOADING_STEPS[0])};
+
+const TrayWorkflow TRAY_UNLOADING_WORKFLOW = {
+    "UNLOADING", UNLOADING_STEPS, sizeof(UNLOADING_STEPS) / sizeof(UNLOADING_STEPS[0])};
+
+//=============================================================================
+// STEP EXECUTION
+//=============================================================================
+
+static bool isStepApplicable(const WorkflowStep &step, const WorkflowContext &ctx)
+{
+    switch (step.condition)
+    {
+    case WF_IF_TRAY_MOVES:
+        return ctx.trayMoves;
+    case WF_IF_TRAY_STAYS:
+        return !ctx.trayMoves;
+    case WF_IF_SHUTTLE_RETURNS:
+        return ctx.trayMoves && !ctx.chainUnload;
+    default:
+        return true;
+    }
+}
+
+static int getTargetPosition(WorkflowTarget target, const WorkflowContext &ctx)
+{
+    return (target == WF_TARGET_WORK_POSITION) ? ctx.workPosition : 1;
+}
+
+static double getTargetPositionMm(WorkflowTarget target, const WorkflowContext &ctx)
+{
+    return (target == WF_TARGET_WORK_POSITION) ? ctx.workPositionMm : POSITION_1_MM;
+}
+
+static void getValveForTarget(WorkflowTarget target, const WorkflowContext &ctx,
+                              DoubleSolenoidValve *&valve, CylinderSensor *&sensor)
+{
+    if (target == WF_TARGET_SHUTTLE)
+    {
+        valve = getShuttleValve();
+        sensor = getShuttleSensor();
+        return;
+    }
+
+    switch (getTargetPosition(target, ctx))
+    {
+    case 1:
+        valve = getTray1Valve();
+        sensor = getTray1Sensor();
+        break;
+    case 2:
+        valve = getTray2Valve();
+        sensor = getTray2Sensor();
+        break;
+    case 3:
+        valve = getTray3Valve();
+        sensor = getTray3Sensor();
+        break;
+    default:
+        valve = NULL;
+        sensor = NULL;
+        break;
+    }
+}
+
+static bool isTargetLocked(WorkflowTarget target, const WorkflowContext &ctx, const SystemState &state)
+{
+    if (target == WF_TARGET_SHUTTLE)
+        return state.shuttleLocked;
+
+    switch (getTargetPosition(target, ctx))
+    {
+    case 1:
+        return state.tray1Locked;
+    case 2:
+        return state.tray2Locked;
+    default:
+        return state.tray3Locked;
+    }
+}
+
+static void formatTargetName(WorkflowTarget target, const WorkflowContext &ctx, char *buffer)
+{
+    if (target == WF_TARGET_SHUTTLE)
+        strcpy(buffer, "shuttle");
+    else
+        sprintf(buffer, "tray at position %d", getTargetPosition(target, ctx));
+}
+
+static WorkflowStepResult runValveStep(int index, const WorkflowStep &step, unsigned long now, bool starting)
+{
+    WorkflowContext &ctx = runner.context;
+    DoubleSolenoidValve *valve = NULL;
+    CylinderSensor *sensor = NULL;
+    char targetName[24];
+    char msg[100];
+    const char *verb = (step.valvePosition == VALVE_POSITION_LOCK) ? "lock" : "unlock";
+
+    getValveForTarget(step.target, ctx, valve, sensor);
+    formatTargetName(step.target, ctx, targetName);
+
+    if (!valve || !sensor)
+    {
+        sprintf(msg, "Failed to access %s valve or sensor", targetName);
+        Console.serialError(msg);
+        ctx.failureCode = "VALVE_ACCESS_ERROR";
+        return WF_RESULT_FAILED;
+    }
+
+    if (starting)
+    {
+        sprintf(msg, "Attempting to %s %s", verb, targetName);
+        Console.serialInfo(msg);
+        valveSetPosition(*valve, step.valvePosition);
+        runner.phase[index] = WF_VALVE_PHASE_CONFIRM;
+        runner.phaseStartTime[index] = now;
+    }
+
+    if (runner.phase[index] == WF_VALVE_PHASE_CONFIRM)
+    {
+        // Sensor is active when the cylinder is unlocked
+        bool expectedSensorState = (step.valvePosition == VALVE_POSITION_UNLOCK);
+        if (sensorRead(*sensor) != expectedSensorState)
+        {
+            if (step.timeoutMs > 0 && timeoutElapsed(now, runner.phaseStartTime[index], step.timeoutMs))
+            {
+                recordValveFailure(*valve, step.valvePosition);
+                sprintf(msg, "Failed to %s %s - sensor didn't confirm", verb, targetName);
+                Console.serialError(msg);
+                return WF_RESULT_FAILED;
+            }
+            return WF_RESULT_WAITING;
+        }
+
+        runner.phase[index] = WF_VALVE_PHASE_SETTLE;
+        runner.phaseStartTime[index] = now;
+    }
+
+    // Let the cylinder settle before the final verification
+    if (!timeoutElapsed(now, runner.phaseStartTime[index], VALVE_ACTUATION_TIME_MS))
+    {
+        return WF_RESULT_WAITING;
+    }
+
+    SystemState state = getSystemState();
+    if (isTargetLocked(step.target, ctx, state) != (step.valvePosition == VALVE_POSITION_LOCK))
+    {
+        sprintf(msg, "Failed to %s %s - verification failed", verb, targetName);
+        Console.serialError(msg);
+        return WF_RESULT_FAILED;
+    }
+
+    sprintf(msg, "%s %s confirmed successful", verb, targetName);
+    msg[0] = toupper(msg[0]);
+    Console.serialInfo(msg);
+    return WF_RESULT_DONE;
+}
+
+static WorkflowStepResult runMoveStep(const WorkflowStep &step, bool starting)
+{
+    WorkflowContext &ctx = runner.context;
+    char msg[100];
+    double targetMm = getTargetPositionMm(step.target, ctx);
+
+    if (starting)
+    {
+        // A chained unload can begin at its source position
+        if (isAtPosition(getSystemState().currentPositionMm, targetMm))
+        {
+            sprintf(msg, "Already at position %d", getTargetPosition(step.target, ctx));
+            Console.serialInfo(msg);
+            return WF_RESULT_DONE;
+        }
+
+        if (!moveToPositionMm(targetMm))
+        {
+            sprintf(msg, "Failed to start movement to position %d", getTargetPosition(step.target, ctx));
+            Console.serialError(msg);
+            ctx.failureCode = "MOVE_FAILURE";
+            return WF_RESULT_FAILED;
+        }
+
+        sprintf(msg, "Moving to position %d", getTargetPosition(step.target, ctx));
+        Console.serialInfo(msg);
+
+        // Motor state is refreshed at the top of the next loop
+        return WF_RESULT_WAITING;
+    }
+
+    if (motorState == MOTOR_STATE_MOVING)
+    {
+        return WF_RESULT_WAITING;
+    }
+
+    SystemState state = getSystemState();
+    if (isAtPosition(state.currentPositionMm, targetMm))
+    {
+        sprintf(msg, "Reached position %d", getTargetPosition(step.target, ctx));
+        Console.serialInfo(msg);
+        return WF_RESULT_DONE;
+    }
+
+    Console.serialError(F("Motor did not reach target position"));
+    double positionError = abs(state.currentPositionMm - targetMm);
+
+    if (positionError <= WORKFLOW_POSITION_WARNING_MM)
+    {
+        sprintf(msg, "Position error of %.2fmm is within tolerance - continuing", positionError);
+        Console.serialWarning(msg);
+        ctx.positionWarning = true;
+        return WF_RESULT_DONE;
+    }
+
+    Console.error(step.failureCode);
+    sprintf(msg, "Position error of %.2fmm exceeds tolerance", positionError);
+    Console.serialError(msg);
+
+    // Always end the operation so the system doesn't remain busy
+    endOperation();
+    return WF_RESULT_FAILED;
+}
+
+static WorkflowStepResult runStep(int index, unsigned long now, bool starting)
+{
+    const WorkflowStep &step = runner.workflow->steps[index];
+
+    switch (step.action)
+    {
+    case WF_ACTION_CHECK:
+        if (!timeoutElapsed(now, runner.stepStartTime[index], step.durationMs))
+            return WF_RESULT_WAITING;
+        return step.check(runner.context) ? WF_RESULT_DONE : WF_RESULT_FAILED;
+
+    case WF_ACTION_DELAY:
+        if (!timeoutElapsed(now, runner.stepStartTime[index], step.durationMs))
+            return WF_RESULT_WAITING;
+        {
+            char msg[64];
+            sprintf(msg, "%s completed", step.name);
+            Console.serialInfo(msg);
+        }
+        return WF_RESULT_DONE;
+
+    case WF_ACTION_VALVE:
+        return runValveStep(index, step, now, starting);
+
+    case WF_ACTION_MOVE:
+        return runMoveStep(step, starting);
+    }
+
+    return WF_RESULT_FAILED;
+}
+
+//=============================================================================
+// WORKFLOW ENGINE
+//=============================================================================
+
+// Mark the steps of the group starting at runner.groupStart
+static void enterGroup()
+{
+    const TrayWorkflow &workflow = *runner.workflow;
+    uint8_t group = workflow.steps[runner.groupStart].group;
+
+    runner.groupEnd = runner.groupStart + 1;
+    if (group != 0)
+    {
+        while (runner.groupEnd < workflow.stepCount && workflow.steps[runner.groupEnd].group == group)
+            runner.groupEnd++;
+    }
+
+    for (int i = runner.groupStart; i < runner.groupEnd; i++)
+    {
+        runner.status[i] = isStepApplicable(workflow.steps[i], runner.context) ? WF_STEP_PENDING : WF_STEP_SKIPPED;
+    }
+}
+
+// Group members start in table order, each once the one before it has finished
+// or, for a valve, once its sensor has confirmed - only the settle time overlaps
+static bool isPreviousMemberConfirmed(int index)
+{
+    if (index == runner.groupStart)
+        return true;
+
+    int previous = index - 1;
+    if (runner.status[previous] == WF_STEP_DONE || runner.status[previous] == WF_STEP_SKIPPED)
+        return true;
+
+    return runner.status[previous] == WF_STEP_RUNNING &&
+           runner.workflow->steps[previous].action == WF_ACTION_VALVE &&
+           runner.phase[previous] == WF_VALVE_PHASE_SETTLE;
+}
+
+static void recordStepTiming(int index, unsigned long now)
+{
+    WorkflowStepTiming &timing = runner.timing->steps[index];
+    uint32_t elapsed = timeDiff(now, runner.stepStartTime[index]);
+
+    timing.lastMs = elapsed;
+    timing.totalMs += elapsed;
+    if (elapsed > timing.maxMs)
+        timing.maxMs = elapsed;
+    timing.count++;
+}
+
+static void failWorkflow(int index)
+{
+    const WorkflowStep &step = runner.workflow->steps[index];
+    const char *code = runner.context.failureCode ? runner.context.failureCode : step.failureCode;
+
+    char msg[100];
+    sprintf(msg, "%s workflow failed at step '%s': %s", runner.workflow->name, step.name, code);
+    Console.serialDiagnostic(msg);
+
+    runner.status[index] = WF_STEP_FAILED;
+
+    // Don't leave a concurrent move from the same group running
+    for (int i = runner.groupStart; i < runner.groupEnd; i++)
+    {
+        if (i != index && runner.status[i] == WF_STEP_RUNNING &&
+            runner.workflow->steps[i].action == WF_ACTION_MOVE && motorState == MOTOR_STATE_MOVING)
+        {
+            Console.serialWarning(F("Stopping concurrent movement"));
+            stopMotion();
+        }
+    }
+
+    currentOperation.inProgress = false;
+    currentOperation.success = false;
+    strncpy(currentOperation.message, code, sizeof(currentOperation.message));
+
+    runner.workflow = NULL;
+    cancelQueuedTrayUnloads("operation failed");
+}
+
+static void startWorkflow(const TrayWorkflow &workflow, WorkflowTimingStats &timing, unsigned long now)
+{
+    runner.workflow = &workflow;
+    runner.timing = &timing;
+    runner.operationStartTime = currentOperation.startTime;
+    runner.runStartTime = now;
+    runner.groupStart = 0;
+    memset(&runner.context, 0, sizeof(runner.context));
+
+    enterGroup();
+}
+
+void processTrayWorkflow(const TrayWorkflow &workflow, WorkflowTimingStats &timing)
+{
+    unsigned long now = millis();
+
+    // A new operation (or a different workflow) starts from the first step
+    if (runner.workflow != &workflow || runner.operationStartTime != currentOperation.startTime)
+    {
+        startWorkflow(workflow, timing, now);
+    }
+
+    // Run the active group; chain straight into the next group once it completes
+    for (int pass = 0; pass < workflow.stepCount; pass++)
+    {
+        bool groupComplete = true;
+
+        for (int i = runner.groupStart; i < runner.groupEnd; i++)
+        {
+            bool starting = false;
+            if (runner.status[i] == WF_STEP_PENDING)
+            {
+                if (!isPreviousMemberConfirmed(i))
+                {
+                    groupComplete = false;
+                    continue;
+                }
+
+                if (workflow.steps[i].operationStep != currentOperationStep)
+                    updateOperationStep(workflow.steps[i].operationStep);
+
+                runner.status[i] = WF_STEP_RUNNING;
+                runner.stepStartTime[i] = now;
+                runner.context.failureCode = NULL;
+                starting = true;
+            }
+
+            if (runner.status[i] != WF_STEP_RUNNING)
+                continue;
+
+            WorkflowStepResult result = runStep(i, now, starting);
+            if (result == WF_RESULT_FAILED)
+            {
+                failWorkflow(i);
+                return;
+            }
+
+            if (result == WF_RESULT_DONE)
+            {
+                runner.status[i] = WF_STEP_DONE;
+                recordStepTiming(i, now);
+            }
+            else
+            {
+                groupComplete = false;
+            }
+        }
+
+        if (!groupComplete)
+            return;
+
+        runner.groupStart = runner.groupEnd;
+        if (runner.groupStart >= workflow.stepCount || !currentOperation.inProgress)
+        {
+            // Completion step finished the operation
+            if (currentOperation.success)
+            {
+                runner.timing->cycles++;
+                runner.timing->lastCycleMs = timeDiff(now, runner.runStartTime);
+                runner.timing->totalCycleMs += runner.timing->lastCycleMs;
+            }
+            runner.workflow = NULL;
+            return;
+        }
+
+        enterGroup();
+    }
+}
+
+void resetTrayWorkflow()
+{
+    runner.workflow = NULL;
+}
+
+//=============================================================================
+// REPORTING
+//=============================================================================
+
+void printWorkflowTiming(const TrayWorkflow &workflow, const WorkflowTimingStats &timing)
+{
+    char msg[120];
+
+    if (timing.cycles > 0)
+    {
+        sprintf(msg, "%s workflow: %u cycles, last %lu ms, mean %lu ms", workflow.name, timing.cycles,
+                (unsigned long)timing.lastCycleMs, (unsigned long)(timing.totalCycleMs / timing.cycles));
+    }
+    else
+    {
+        sprintf(msg, "%s workflow: no completed cycles", workflow.name);
+    }
+    Console.println(msg);
+
+    Console.println(F("  Step                                 Grp  Last ms  Mean ms   Max ms  Runs"));
+    for (int i = 0; i < workflow.stepCount; i++)
+    {
+        const WorkflowStep &step = workflow.steps[i];
+        const WorkflowStepTiming &stepTiming = timing.steps[i];
+        char group[4] = "-";
+        if (step.group != 0)
+            sprintf(group, "%u", step.group);
+
+        sprintf(msg, "  %-2d %-34s %3s %8lu %8lu %8lu %5u", step.operationStep, step.name, group,
+                (unsigned long)stepTiming.lastMs,
+                stepTiming.count > 0 ? (unsigned long)(stepTiming.totalMs / stepTiming.count) : 0UL,
+                (unsigned long)stepTiming.maxMs, stepTiming.count);
+        Console.println(msg);
+    }
+}
+
+void resetWorkflowTiming()
+{
+    memset(&trayLoadingTiming, 0, sizeof(trayLoadingTiming));
+    memset(&trayUnloadingTiming, 0, sizeof(trayUnloadingTiming));
+}
+
+unsigned long estimateWorkflowDwellMs(const TrayWorkflow &workflow, const WorkflowTimingStats &timing,
+                                      bool trayMoves, bool chainUnload)
+{
+    WorkflowContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.trayMoves = trayMoves;
+    ctx.chainUnload = chainUnload;
+
+    unsigned long totalMs = 0;
+    unsigned long groupMs = 0;
+
+    for (int i = 0; i < workflow.stepCount; i++)
+    {
+        const WorkflowStep &step = workflow.steps[i];
+        unsigned long stepMs = 0;
+
+        // Motion is estimated per leg by the caller
+        if (step.action != WF_ACTION_MOVE && isStepApplicable(step, ctx))
+        {
+            if (timing.steps[i].count > 0)
+                stepMs = timing.steps[i].totalMs / timing.steps[i].count;
+            else if (step.action == WF_ACTION_VALVE)
+                stepMs = WORKFLOW_VALVE_STROKE_ESTIMATE_MS + VALVE_ACTUATION_TIME_MS;
+            else
+                stepMs = step.durationMs;
+        }
+
+        // A group member starts about a settle time before the one before it ends
+        unsigned long startMs = (groupMs > VALVE_ACTUATION_TIME_MS) ? groupMs - VALVE_ACTUATION_TIME_MS : 0;
+        if (startMs + stepMs > groupMs)
+            groupMs = startMs + stepMs;
+
+        bool groupEnds = (step.group == 0 || i + 1 >= workflow.stepCount ||
+                          workflow.steps[i + 1].group != step.group);
+        if (groupEnds)
+        {
+            totalMs += groupMs;
+            groupMs = 0;
+        }
+    }
+
+    return totalMs;
+}
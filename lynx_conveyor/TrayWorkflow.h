@@ -0,0 +1,153 @@
+#ifndef TRAY_WORKFLOW_H
+#define TRAY_WORKFLOW_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "ClearCore.h"
+#include "ValveController.h"
+#include "MotorController.h"
+#include "Utils.h"
+
+//=============================================================================
+// WORKFLOW CONFIGURATION
+//=============================================================================
+#define TRAY_WORKFLOW_MAX_STEPS 20            // Steps per workflow table
+#define WORKFLOW_POSITION_WARNING_MM 2.0      // Move error below this warns instead of failing
+#define WORKFLOW_VALVE_STROKE_ESTIMATE_MS 150 // Nominal sensor confirmation time used for estimates
+
+//=============================================================================
+// WORKFLOW ENUMS AND STRUCTURES
+//=============================================================================
+
+// What a step does
+enum WorkflowAction
+{
+    WF_ACTION_CHECK, // Call check() after durationMs has elapsed (0 = immediately)
+    WF_ACTION_DELAY, // Wait durationMs
+    WF_ACTION_VALVE, // Actuate target valve to param, wait for sensor, settle, verify
+    WF_ACTION_MOVE   // Move to target position and wait for the motor to stop
+};
+
+// When a step applies (decided by the plan step)
+enum WorkflowCondition
+{
+    WF_ALWAYS,
+    WF_IF_TRAY_MOVES, // Tray travels between position 1 and the work position
+    WF_IF_TRAY_STAYS, // Tray is already where it needs to be
+    WF_IF_SHUTTLE_RETURNS // Tray moved and no queued unload picks up the shuttle where it is
+};
+
+// Valve or position a step acts on
+enum WorkflowTarget
+{
+    WF_TARGET_NONE,
+    WF_TARGET_SHUTTLE,
+    WF_TARGET_POSITION_1,
+    WF_TARGET_WORK_POSITION // Destination when loading, source when unloading
+};
+
+// Per-step run status
+enum WorkflowStepStatus
+{
+    WF_STEP_PENDING,
+    WF_STEP_RUNNING,
+    WF_STEP_DONE,
+    WF_STEP_SKIPPED,
+    WF_STEP_FAILED
+};
+
+// Values decided at run time by the plan step
+struct WorkflowContext
+{
+    bool trayMoves;           // Selects WF_IF_TRAY_MOVES / WF_IF_TRAY_STAYS steps
+    int workPosition;         // 1-3
+    double workPositionMm;
+    bool positionWarning;     // A move finished within warning tolerance
+    bool chainUnload;         // Skip the empty return - a queued unload starts from here
+    const char *failureCode;  // Set by check functions that fail
+};
+
+typedef bool (*WorkflowCheckFunction)(WorkflowContext &ctx);
+
+// One row of a workflow table
+struct WorkflowStep
+{
+    const char *name;
+    uint8_t operationStep;   // Reported via updateOperationStep - safety validation keys on these numbers
+    uint8_t group;           // Adjacent steps with the same non-zero group overlap (see processTrayWorkflow)
+    WorkflowAction action;
+    WorkflowCondition condition;
+    WorkflowTarget target;
+    ValvePosition valvePosition;   // WF_ACTION_VALVE only
+    unsigned long durationMs;      // Delay, or settle time before a check
+    unsigned long timeoutMs;       // Max wait for sensor confirmation (0 = operation timeout only)
+    WorkflowCheckFunction check;   // WF_ACTION_CHECK only
+    const char *failureCode;       // currentOperation.message when the step fails
+};
+
+struct TrayWorkflow
+{
+    const char *name;
+    const WorkflowStep *steps;
+    uint8_t stepCount;
+};
+
+// Automatically recorded step durations
+struct WorkflowStepTiming
+{
+    uint32_t lastMs;
+    uint32_t maxMs;
+    uint32_t totalMs;
+    uint16_t count;
+};
+
+struct WorkflowTimingStats
+{
+    uint16_t cycles;             // Completed runs
+    uint32_t lastCycleMs;
+    uint32_t totalCycleMs;
+    WorkflowStepTiming steps[TRAY_WORKFLOW_MAX_STEPS];
+};
+
+// Engine state for the running workflow
+struct TrayWorkflowRunner
+{
+    const TrayWorkflow *workflow;     // NULL when idle
+    WorkflowTimingStats *timing;
+    unsigned long operationStartTime; // currentOperation.startTime this run belongs to
+    unsigned long runStartTime;
+    uint8_t groupStart;               // First step of the active group
+    uint8_t groupEnd;                 // One past the last step of the active group
+    WorkflowContext context;
+    WorkflowStepStatus status[TRAY_WORKFLOW_MAX_STEPS];
+    uint8_t phase[TRAY_WORKFLOW_MAX_STEPS];
+    unsigned long stepStartTime[TRAY_WORKFLOW_MAX_STEPS];
+    unsigned long phaseStartTime[TRAY_WORKFLOW_MAX_STEPS];
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+extern const TrayWorkflow TRAY_LOADING_WORKFLOW;
+extern const TrayWorkflow TRAY_UNLOADING_WORKFLOW;
+extern WorkflowTimingStats trayLoadingTiming;
+extern WorkflowTimingStats trayUnloadingTiming;
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+// Advance a workflow for the current operation (call every loop while it is in progress)
+void processTrayWorkflow(const TrayWorkflow &workflow, WorkflowTimingStats &timing);
+void resetTrayWorkflow(); // Drop any partially run workflow
+
+// Reporting
+void printWorkflowTiming(const TrayWorkflow &workflow, const WorkflowTimingStats &timing);
+void resetWorkflowTiming();
+
+// Nominal non-motion time for one run (recorded means where available, table values otherwise)
+unsigned long estimateWorkflowDwellMs(const TrayWorkflow &workflow, const WorkflowTimingStats &timing,
+                                      bool trayMoves, bool chainUnload);
+
+#endif // TRAY_WORKFLOW_H
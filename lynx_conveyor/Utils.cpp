@@ -1,4 +1,6 @@
 #include "Utils.h"
+#include "TrayWorkflow.h"
+#include "TrayPipeline.h"
 
 // Define variables that were declared in Utils.h
 // Position tracking
@@ -24,11 +26,6 @@ int currentOperationStep = 0;
 int expectedOperationStep = 0;
 bool operationEncoderState = false;
 
-// State machine timing variables and substep tracking
-unsigned long valveActuationStartTime = 0;
-unsigned long safetyDelayStartTime = 0;
-unsigned long sensorVerificationStartTime = 0;
-
 // Valve actuation and safety delay constants
 const unsigned long VALVE_ACTUATION_TIME_MS = 500;         // Increased from 500ms for more reliable actuation (previosly 750ms)
 const unsigned long SAFETY_DELAY_AFTER_UNLOCK_MS = 500;    // Safety delay after unlocking a tray (previously 1000ms)
@@ -45,6 +42,10 @@ OperationStatus currentOperation = {false, OPERATION_NONE, 0, 0, false, ""};
 // Add this variable definition near your other global variables:
 SystemState previousState;
 
+// Scan snapshot cache (see getSystemState)
+static SystemState scanSystemState;
+static bool scanSystemStateValid = false;
+
 // Add these near your other global variables
 bool lastLockOperationFailed = false;
 bool lastUnlockOperationFailed = false;
@@ -209,7 +210,7 @@ bool loadFirstTray()
     if (!moveResult)
     {
         // Only update system count if it was actually a new tray
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         if (state.tray3Present && !trayTracking.position3Occupied)
         {
             trayTracking.position1Occupied = false;
@@ -240,7 +241,7 @@ bool loadSecondTray()
     if (!moveResult)
     {
         // Only update system count if it was actually a new tray
-        SystemState state = captureSystemState();
+        SystemState state = getSystemState();
         if (state.tray2Present && !trayTracking.position2Occupied)
         {
             trayTracking.position1Occupied = false;
@@ -265,7 +266,7 @@ bool loadThirdTray()
     trayTracking.totalLoadsCompleted++;
 
     // Only increment tray count if position 1 wasn't already occupied
-    SystemState state = captureSystemState();
+    SystemState state = getSystemState();
     if (state.tray1Present && !trayTracking.position1Occupied)
     {
         trayTracking.position1Occupied = true;
@@ -352,15 +353,26 @@ void updateTrayTrackingFromSensors(const SystemState &state)
     }
 }
 
+// Copy the software-owned fields (no I/O) into a state struct
+static void copySoftwareState(SystemState &state)
+{
+    state.motorState = motorState;
+    state.isHomed = isHomed;
+    state.currentPositionMm = currentPositionMm;
+    state.ccioBoardPresent = hasCCIO;
+    state.totalTraysInSystem = trayTracking.totalTraysInSystem;
+    state.position1Occupied = trayTracking.position1Occupied;
+    state.position2Occupied = trayTracking.position2Occupied;
+    state.position3Occupied = trayTracking.position3Occupied;
+}
+
 // Capture the current system state
 SystemState captureSystemState()
 {
     SystemState state;
 
-    // Capture motor state
-    state.motorState = motorState;
-    state.isHomed = isHomed;
-    state.currentPositionMm = currentPositionMm;
+    // Capture motor state, hardware status and tray tracking
+    copySoftwareState(state);
     state.hlfbStatus = MOTOR_CONNECTOR.HlfbState();
 
     // Capture cylinder sensor states
@@ -384,24 +396,152 @@ SystemState captureSystemState()
     // Capture E-stop status
     state.eStopActive = isEStopActive();
 
-    // Capture hardware status
-    state.ccioBoardPresent = hasCCIO;
+    return state;
+}
 
-    // Capture tray tracking state
-    state.totalTraysInSystem = trayTracking.totalTraysInSystem;
-    state.position1Occupied = trayTracking.position1Occupied;
-    state.position2Occupied = trayTracking.position2Occupied;
-    state.position3Occupied = trayTracking.position3Occupied;
+// Start a new scan - the next getSystemState() re-reads the hardware
+void beginSystemStateScan()
+{
+    scanSystemStateValid = false;
+}
 
-    return state;
+// Return the snapshot for this scan, reading sensors only on first use.
+// Motor and tray tracking fields are refreshed on every call since they are
+// plain variables that handlers update mid-scan.
+const SystemState &getSystemState()
+{
+    if (!scanSystemStateValid)
+    {
+        scanSystemState = captureSystemState();
+        scanSystemStateValid = true;
+    }
+    else
+    {
+        copySoftwareState(scanSystemState);
+    }
+
+    return scanSystemState;
+}
+
+void invalidateSystemState()
+{
+    scanSystemStateValid = false;
+}
+
+//=============================================================================
+// SYSTEM STATE RENDERING
+//=============================================================================
+// printSystemState() emits a fixed sequence of lines. For each caller (serial
+// and every Ethernet slot) a hash of every line it was last shown is kept, so
+// a delta request prints only the lines whose text changed since then.
+
+struct StateRenderRecord
+{
+    uint32_t lineHashes[STATE_RENDER_MAX_LINES];
+    uint8_t deltasSinceKeyframe;
+    unsigned long lastKeyframeTime;
+    bool valid;
+};
+
+struct StateRender
+{
+    StateRenderRecord *record;
+    bool full;
+    uint8_t line;                              // Slot of the next line
+    uint8_t changedLines;
+    const __FlashStringHelper *pendingHeader; // Section header not yet printed in delta mode
+};
+
+// Index 0 is serial, 1..MAX_ETHERNET_CLIENTS are Ethernet slots
+static StateRenderRecord stateRenderRecords[MAX_ETHERNET_CLIENTS + 1];
+
+static StateRenderRecord &getStateRenderRecord()
+{
+    return stateRenderRecords[getCurrentClientIndex() + 1];
+}
+
+void resetSystemStateRender(int clientIndex)
+{
+    if (clientIndex >= -1 && clientIndex < MAX_ETHERNET_CLIENTS)
+    {
+        stateRenderRecords[clientIndex + 1].valid = false;
+    }
+}
+
+// FNV-1a; 0 is reserved for "line not shown"
+static uint32_t hashStateLine(const char *text)
+{
+    uint32_t hash = 2166136261UL;
+    while (*text)
+    {
+        hash ^= (uint8_t)*text++;
+        hash *= 16777619UL;
+    }
+    return hash ? hash : 1;
+}
+
+static void renderSection(StateRender &render, const __FlashStringHelper *header)
+{
+    if (render.full)
+        Console.println(header);
+    else
+        render.pendingHeader = header;
+}
+
+// Emit one line of the state report (NULL keeps the slot but shows nothing)
+static void renderLine(StateRender &render, const char *text)
+{
+    uint32_t hash = text ? hashStateLine(text) : 0;
+    bool changed = true;
+
+    if (render.line < STATE_RENDER_MAX_LINES)
+    {
+        changed = render.record->lineHashes[render.line] != hash;
+        render.record->lineHashes[render.line] = hash;
+    }
+    render.line++;
+
+    if (text == NULL || (!render.full && !changed))
+        return;
+
+    if (!render.full)
+    {
+        render.changedLines++;
+        if (render.pendingHeader)
+        {
+            Console.println(render.pendingHeader);
+            render.pendingHeader = NULL;
+        }
+    }
+    Console.println(text);
 }
 
-// Print the current system state for diagnostics
-void printSystemState(const SystemState &state)
+// Print the current system state for diagnostics (deltaOnly: only lines changed since this caller's last report)
+void printSystemState(const SystemState &state, bool deltaOnly)
 {
     char msg[200];
 
-    Console.println(F("[DIAGNOSTIC] System State:"));
+    StateRenderRecord &record = getStateRenderRecord();
+    unsigned long now = millis();
+
+    // Periodic keyframe so a client that missed a delta resynchronises
+    bool full = !deltaOnly || !record.valid ||
+                record.deltasSinceKeyframe >= STATE_RENDER_KEYFRAME_INTERVAL ||
+                timeoutElapsed(now, record.lastKeyframeTime, STATE_RENDER_KEYFRAME_MS);
+
+    StateRender render = {&record, full, 0, 0, NULL};
+    if (full)
+    {
+        record.deltasSinceKeyframe = 0;
+        record.lastKeyframeTime = now;
+        record.valid = true;
+        Console.println(F("[DIAGNOSTIC] System State:"));
+    }
+    else
+    {
+        record.deltasSinceKeyframe++;
+        Console.println(F("[DIAGNOSTIC] System State (changes):"));
+    }
 
     // Motor
     const char *motorStateStr;
@@ -427,19 +567,19 @@ void printSystemState(const SystemState &state)
         break;
     }
     sprintf(msg, "  Motor: %s", motorStateStr);
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "  Homed: %s", state.isHomed ? "YES" : "NO");
-    Console.println(msg);
+    renderLine(render, msg);
 
     if (state.isHomed)
     {
         sprintf(msg, "  Position: %.2f mm", state.currentPositionMm);
-        Console.println(msg);
+        renderLine(render, msg);
     }
     else
     {
-        Console.println(F("  Position: UNKNOWN"));
+        renderLine(render, "  Position: UNKNOWN");
     }
 
     const char *hlfbStatusStr;
@@ -457,10 +597,10 @@ void printSystemState(const SystemState &state)
         break;
     }
     sprintf(msg, "  HLFB Status: %s", hlfbStatusStr);
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Enhanced Valve States with Position Verification
-    Console.println(F("\n  Valve States (with position verification):"));
+    renderSection(render, F("\n  Valve States (with position verification):"));
     
     // Array of valve/sensor pairs for easy iteration
     const char *valveNames[4] = {"Tray 1", "Tray 2", "Tray 3", "Shuttle"};
@@ -487,7 +627,7 @@ void printSystemState(const SystemState &state)
             const char *verificationStatus = positionVerified ? "" : " [MISMATCH!]";
             
             sprintf(msg, "    %s: %s%s", valveNames[i], valveStatus, verificationStatus);
-            Console.println(msg);
+            renderLine(render, msg);
             
             // If there's a mismatch, provide additional detail
             if (!positionVerified)
@@ -495,89 +635,94 @@ void printSystemState(const SystemState &state)
                 sprintf(msg, "      WARNING: Valve set to %s but sensor reads %s", 
                         valveStatus, 
                         sensorState ? "ACTIVATED (unlocked)" : "NOT ACTIVATED (locked)");
-                Console.println(msg);
+                renderLine(render, msg);
+            }
+            else
+            {
+                renderLine(render, NULL);
             }
         }
         else
         {
             sprintf(msg, "    %s: VALVE/SENSOR ACCESS ERROR", valveNames[i]);
-            Console.println(msg);
+            renderLine(render, msg);
+            renderLine(render, NULL);
         }
     }
 
     // Cylinder sensors (raw readings) - Keep this for reference
-    Console.println(F("\n  Cylinder Sensors (raw readings):"));
+    renderSection(render, F("\n  Cylinder Sensors (raw readings):"));
     sprintf(msg, "    Tray 1: %s", state.tray1CylinderActivated ? "ACTIVATED (UNLOCKED)" : "NOT ACTIVATED (LOCKED)");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Tray 2: %s", state.tray2CylinderActivated ? "ACTIVATED (UNLOCKED)" : "NOT ACTIVATED (LOCKED)");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Tray 3: %s", state.tray3CylinderActivated ? "ACTIVATED (UNLOCKED)" : "NOT ACTIVATED (LOCKED)");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Shuttle: %s", state.shuttleCylinderActivated ? "ACTIVATED (UNLOCKED)" : "NOT ACTIVATED (LOCKED)");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Lock states (derived from sensor readings) - Keep this but note it's sensor-based
-    Console.println(F("\n  Lock States (sensor-derived):"));
+    renderSection(render, F("\n  Lock States (sensor-derived):"));
     sprintf(msg, "    Tray 1: %s", state.tray1Locked ? "LOCKED" : "UNLOCKED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Tray 2: %s", state.tray2Locked ? "LOCKED" : "UNLOCKED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Tray 3: %s", state.tray3Locked ? "LOCKED" : "UNLOCKED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Shuttle: %s", state.shuttleLocked ? "LOCKED" : "UNLOCKED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Tray presence detection
-    Console.println(F("\n  Tray Detection:"));
+    renderSection(render, F("\n  Tray Detection:"));
     sprintf(msg, "    Position 1: %s", state.tray1Present ? "TRAY PRESENT" : "NO TRAY");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Position 2: %s", state.tray2Present ? "TRAY PRESENT" : "NO TRAY");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Position 3: %s", state.tray3Present ? "TRAY PRESENT" : "NO TRAY");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Safety systems
-    Console.println(F("\n  Safety Systems:"));
+    renderSection(render, F("\n  Safety Systems:"));
     sprintf(msg, "    E-Stop: %s", state.eStopActive ? "ACTIVE (Emergency Stop)" : "INACTIVE (Normal Operation)");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Hardware status
-    Console.println(F("\n  Hardware Status:"));
+    renderSection(render, F("\n  Hardware Status:"));
     sprintf(msg, "    CCIO Board: %s", state.ccioBoardPresent ? "PRESENT" : "NOT DETECTED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     sprintf(msg, "    Network Clients: %d connected", getConnectedClientCount());
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Pneumatic system status
     float pressure = getPressurePsi();
     sprintf(msg, "    Pneumatic System: %.1f PSI %s", pressure,
             (pressure < MIN_SAFE_PRESSURE) ? "(INSUFFICIENT)" : "(OK)");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Enhanced Safety Summary - now includes valve/sensor mismatches
-    Console.println(F("\n  Safety Summary:"));
+    renderSection(render, F("\n  Safety Summary:"));
 
     // Check if any tray is locked while motor is moving
     bool unsafeMotion = state.motorState == MOTOR_STATE_MOVING &&
                         (state.tray1Locked || state.tray2Locked || state.tray3Locked);
     sprintf(msg, "    Safe Motion: %s", unsafeMotion ? "NO - TRAYS LOCKED DURING MOTION" : "YES");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Check for missing trays that are locked
     bool missingTraysLocked = (state.tray1Locked && !state.tray1Present) ||
                               (state.tray2Locked && !state.tray2Present) ||
                               (state.tray3Locked && !state.tray3Present);
     sprintf(msg, "    Tray/Lock Mismatch: %s", missingTraysLocked ? "YES - LOCK WITHOUT TRAY" : "NO");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // NEW: Check for valve/sensor mismatches
     bool valveSensorMismatch = false;
@@ -597,778 +742,826 @@ void printSystemState(const SystemState &state)
         }
     }
     sprintf(msg, "    Valve/Sensor Alignment: %s", valveSensorMismatch ? "MISMATCH DETECTED [!]" : "VERIFIED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     // Encoder status
-    Console.println(F("\n  MPG Handwheel:"));
+    renderSection(render, F("\n  MPG Handwheel:"));
     sprintf(msg, "    Status: %s", encoderControlActive ? "ENABLED" : "DISABLED");
-    Console.println(msg);
+    renderLine(render, msg);
 
     if (encoderControlActive)
     {
         // Calculate how much one full rotation moves (100 pulses typical for MPG handwheels)
         double mmPerRotation = 100 * currentMultiplier / PULSES_PER_MM;
         sprintf(msg, "    Multiplier: x%s (%.2f mm/rotation)", getMultiplierName(currentMultiplier), mmPerRotation);
-        Console.println(msg);
+        renderLine(render, msg);
+    }
+    else
+    {
+        renderLine(render, NULL);
+    }
+
+    if (!full && render.changedLines == 0)
+    {
+        Console.println(F("  No changes"));
     }
 
     Console.println(F("-------------------------------------------"));
 }
 
-// Validate safety conditions based on the current system state
-// Returns a SafetyValidationResult with all validation checks and their results
-SafetyValidationResult validateSafety(const SystemState &state)
+//=============================================================================
+// SAFETY RULE TABLE
+//=============================================================================
+// validateSafety() runs every loop, but most inputs only change on a sensor
+// edge or a step transition. Each rule below declares the inputs it reads and
+// the checks it owns; a rule is re-run only when one of its inputs changed
+// since the previous call, otherwise its cached verdicts are reused.
+
+// Input fields a rule can depend on
+#define SAFETY_IN_MOTOR_STATE (1U << 0)
+#define SAFETY_IN_HOMED (1U << 1)
+#define SAFETY_IN_POSITION (1U << 2)
+#define SAFETY_IN_TRAY_LOCKS (1U << 3)
+#define SAFETY_IN_SHUTTLE (1U << 4)
+#define SAFETY_IN_TRAY_PRESENCE (1U << 5)
+#define SAFETY_IN_ESTOP (1U << 6)
+#define SAFETY_IN_CCIO (1U << 7)
+#define SAFETY_IN_PRESSURE (1U << 8)
+#define SAFETY_IN_OPERATION (1U << 9)  // In progress, type, current and expected step
+#define SAFETY_IN_PREVIOUS (1U << 10)  // previousState motor/shuttle
+#define SAFETY_IN_LOCK_FAILURES (1U << 11)
+#define SAFETY_IN_COMMANDED (1U << 12)
+#define SAFETY_IN_TARGET (1U << 13)
+#define SAFETY_IN_NEW_COMMAND (1U << 14)
+#define SAFETY_IN_TIMEOUT (1U << 15)
+#define SAFETY_IN_ALL 0xFFFFU
+
+#define SAFETY_BIT(check) (1UL << (check))
+
+// Everything the rules read, captured once per call
+struct SafetyInputs
 {
-    SafetyValidationResult result;
-
-    // Initialize all safety flags to safe by default
-    // Each will be set to false if a safety condition is not met
-    result.safeToMove = true;
-    result.pneumaticPressureSufficient = true;
-    result.safeToLockTray1 = true;
-    result.safeToLockTray2 = true;
-    result.safeToLockTray3 = true;
-    result.safeToLockShuttle = true;
-    result.safeToUnlockShuttle = true;
-    result.safeToLoadTrayToPos1 = true;
-    result.safeToLoadTrayToPos2 = true;
-    result.safeToLoadTrayToPos3 = true;
-    result.safeToUnloadTrayFromPos1 = true;
-    result.safeToUnloadTrayFromPos2 = true;
-    result.safeToUnloadTrayFromPos3 = true;
-    result.safeToUnlockGrippedTray = true;
-    result.lockOperationSuccessful = true;
-    result.unlockOperationSuccessful = true;
-    result.commandStateValid = true;
-    result.trayPositionValid = true;
-    result.targetPositionValid = true;
-    result.safeToAcceptNewCommand = true;
-    result.operationWithinTimeout = true;
-    result.operationSequenceValid = true;
-    result.failureReason = ABORT_REASON_UNKNOWN;
+    MotorState motorState;
+    bool isHomed;
+    double positionMm;
+    bool tray1Locked, tray2Locked, tray3Locked;
+    bool shuttleLocked;
+    bool tray1Present, tray2Present, tray3Present;
+    bool eStopActive;
+    bool ccioBoardPresent;
+    bool pressureSufficient;
+    bool operationActive;
+    OperationType operationType;
+    int operationStep;
+    int expectedStep;
+    MotorState previousMotorState;
+    bool previousShuttleLocked;
+    bool lockFailed, unlockFailed;
+    double commandedMm;
+    bool hasTarget;
+    double targetMm;
+    bool newCommand;
+    bool timedOut;
+};
+
+// What a rule reported against the operation as a whole. Applied in table
+// order so the last rule to report wins, as the message/abort reason did
+// when the checks were evaluated top to bottom.
+struct SafetyRuleOutcome
+{
+    uint8_t sequenceReason; // SAFETY_REASON_NONE = nothing reported
+    bool breaksSequence;    // Marks the operation sequence invalid
+    bool setsAbort;
+    AbortReason abortReason;
+};
 
-    //=============================================================================
-    // PNEUMATIC SYSTEM VALIDATION
-    //=============================================================================
-    // Validates that pneumatic pressure is sufficient for safe valve operations
-    // This is critical for all pneumatic actions including locking/unlocking trays
+typedef void (*SafetyRuleFunction)(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome);
 
-    // Check if pressure is sufficient for valve actuation
-    if (!isPressureSufficient())
-    {
-        result.pneumaticPressureSufficient = false;
-        strcpy_P(result.pressureUnsafeReason, PSTR("Pneumatic pressure below minimum threshold"));
+struct SafetyRule
+{
+    uint16_t inputs;         // SAFETY_IN_* fields that trigger re-evaluation
+    uint32_t checks;         // SAFETY_BIT() of every check this rule owns
+    SafetyRuleFunction evaluate;
+};
 
-        // Set abort reason during operations requiring pneumatics
-        // This will cause active operations to abort if pressure is lost
-        if (operationInProgress &&
-            (currentOperation.type == OPERATION_LOADING || currentOperation.type == OPERATION_UNLOADING))
-        {
-            result.failureReason = ABORT_REASON_PNEUMATIC_FAILURE;
-        }
-    }
+SafetyEvaluatorStats safetyEvaluatorStats = {0, 0, 0, 0, 0};
 
-    //=============================================================================
-    // MOTOR MOVEMENT SAFETY
-    //=============================================================================
-    // Validates conditions that must be met before motor movement is allowed
-    // Movement is blocked if any of these conditions are not satisfied
+static void markUnsafe(SafetyValidationResult &result, SafetyCheck check, SafetyReason reason)
+{
+    result.unsafeMask |= SAFETY_BIT(check);
+    result.reasons[check] = reason;
+}
 
-    // Mechanical Safety Constraints
-    // Check which specific position has a locked tray that's blocking movement
-    if (isAtPosition(state.currentPositionMm, POSITION_1_MM) && state.tray1Locked)
-    {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("Cannot move - Tray at position 1 is locked"));
-    }
-    else if (isAtPosition(state.currentPositionMm, POSITION_2_MM) && state.tray2Locked)
-    {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("Cannot move - Tray at position 2 is locked"));
-    }
-    else if (isAtPosition(state.currentPositionMm, POSITION_3_MM) && state.tray3Locked)
-    {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("Cannot move - Tray at position 3 is locked"));
-    }
+static void reportSequence(SafetyRuleOutcome &outcome, SafetyReason reason, bool breaksSequence)
+{
+    outcome.sequenceReason = reason;
+    if (breaksSequence)
+        outcome.breaksSequence = true;
+}
 
-    // System State Requirements
-    // Motor must be homed before movement to ensure position accuracy
-    if (!state.isHomed)
-    {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("Motor not homed"));
-        // This is a prerequisite safety check, not an abort condition
-    }
+static void reportAbort(SafetyRuleOutcome &outcome, AbortReason reason)
+{
+    outcome.setsAbort = true;
+    outcome.abortReason = reason;
+}
 
-    // Emergency Conditions
-    // E-stop immediately prevents all movement and triggers abort
-    if (state.eStopActive)
+// Pneumatic pressure must be sufficient for all valve actuation
+static void evaluatePressureRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (!in.pressureSufficient)
     {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("E-stop active"));
-        result.failureReason = ABORT_REASON_ESTOP; // E-stop is an immediate abort condition
-    }
+        markUnsafe(result, SAFETY_CHECK_PRESSURE, SAFETY_REASON_PRESSURE_LOW);
 
-    // Hardware Presence Verification
-    // CCIO board must be present for safe I/O operations
-    if (!state.ccioBoardPresent)
-    {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("CCIO board not detected"));
-        // No abort reason - this is a hardware presence check
+        // Active loading/unloading aborts if pressure is lost
+        if (in.operationActive &&
+            (in.operationType == OPERATION_LOADING || in.operationType == OPERATION_UNLOADING))
+        {
+            reportAbort(outcome, ABORT_REASON_PNEUMATIC_FAILURE);
+        }
     }
+}
 
-    // Motor Fault Detection
-    // Prevents movement when motor is in fault state
-    if (state.motorState == MOTOR_STATE_FAULTED)
-    {
-        result.safeToMove = false;
-        strcpy_P(result.moveUnsafeReason, PSTR("Motor in fault state"));
-        // No abort reason - motor already in fault state
-    }
+// Motor movement prerequisites (later checks take precedence for the reason)
+static void evaluateMoveRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    // A locked tray at the current position blocks movement
+    if (isAtPosition(in.positionMm, POSITION_1_MM) && in.tray1Locked)
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_TRAY1_LOCKED_AT_POSITION);
+    else if (isAtPosition(in.positionMm, POSITION_2_MM) && in.tray2Locked)
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_TRAY2_LOCKED_AT_POSITION);
+    else if (isAtPosition(in.positionMm, POSITION_3_MM) && in.tray3Locked)
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_TRAY3_LOCKED_AT_POSITION);
 
-    //=============================================================================
-    // CYLINDER LOCK/UNLOCK SAFETY
-    //=============================================================================
-    // Validates conditions for safely locking and unlocking tray cylinders
-    // Prevents valve actuation in unsafe conditions
+    if (!in.isHomed)
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_NOT_HOMED);
 
-    // Tray Presence Verification
-    // Cannot lock cylinders if no tray is present at position
-    if (!state.tray1Present)
+    // E-stop is an immediate abort condition
+    if (in.eStopActive)
     {
-        result.safeToLockTray1 = false;
-        strcpy_P(result.tray1LockUnsafeReason, PSTR("No tray detected"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_ESTOP_ACTIVE);
+        reportAbort(outcome, ABORT_REASON_ESTOP);
     }
 
-    if (!state.tray2Present)
-    {
-        result.safeToLockTray2 = false;
-        strcpy_P(result.tray2LockUnsafeReason, PSTR("No tray detected"));
-        // No abort reason - this is a prerequisite check
-    }
+    if (!in.ccioBoardPresent)
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_CCIO_NOT_DETECTED);
 
-    if (!state.tray3Present)
-    {
-        result.safeToLockTray3 = false;
-        strcpy_P(result.tray3LockUnsafeReason, PSTR("No tray detected"));
-        // No abort reason - this is a prerequisite check
-    }
+    if (in.motorState == MOTOR_STATE_FAULTED)
+        markUnsafe(result, SAFETY_CHECK_MOVE, SAFETY_REASON_MOTOR_FAULTED);
+}
+
+// Tray cylinder locking, plus detection of movement or shuttle locking at
+// steps where the operation sequence does not expect it
+static void evaluateTrayLockRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (!in.tray1Present)
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY1, SAFETY_REASON_NO_TRAY);
+    if (!in.tray2Present)
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY2, SAFETY_REASON_NO_TRAY);
+    if (!in.tray3Present)
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY3, SAFETY_REASON_NO_TRAY);
 
-    // Movement Status Safety
-    // Cannot lock trays while motor is moving
-    if (state.motorState == MOTOR_STATE_MOVING)
+    if (in.motorState == MOTOR_STATE_MOVING)
     {
-        result.safeToLockTray1 = false;
-        result.safeToLockTray2 = false;
-        result.safeToLockTray3 = false;
-        strcpy_P(result.tray1LockUnsafeReason, PSTR("Motor is moving"));
-        strcpy_P(result.tray2LockUnsafeReason, PSTR("Motor is moving"));
-        strcpy_P(result.tray3LockUnsafeReason, PSTR("Motor is moving"));
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY1, SAFETY_REASON_MOTOR_MOVING);
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY2, SAFETY_REASON_MOTOR_MOVING);
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY3, SAFETY_REASON_MOTOR_MOVING);
 
-        // Sequence validation: Detect unexpected movement during lock/unlock steps
-        // For tray loading, steps 0-7 involve lock/unlock ops, while 8+ are for movement
-        if (operationInProgress &&
-            (previousState.motorState != MOTOR_STATE_MOVING) &&
-            ((currentOperation.type == OPERATION_LOADING && currentOperationStep < 8) ||
-             (currentOperation.type == OPERATION_UNLOADING && currentOperationStep < 3)))
+        // Loading steps 0-7 and unloading steps 0-2 are lock/unlock steps
+        if (in.operationActive && in.previousMotorState != MOTOR_STATE_MOVING &&
+            ((in.operationType == OPERATION_LOADING && in.operationStep < 8) ||
+             (in.operationType == OPERATION_UNLOADING && in.operationStep < 3)))
         {
-            // This means movement started during a lock/unlock operation - sequence violation
-            result.operationSequenceValid = false;
-
-            // Build detailed error message with operation-specific context
-            const char* stepDescription = "";
-            
-            // Add specific step information for clearer diagnostics
-            if (currentOperation.type == OPERATION_LOADING)
-            {
-                switch (currentOperationStep)
-                {
-                case 0:
-                    stepDescription = "initial tray load preparation";
-                    break;
-                case 1:
-                    stepDescription = "tray detection verification";
-                    break;
-                case 2:
-                    stepDescription = "shuttle locking";
-                    break;
-                case 3:
-                    stepDescription = "shuttle lock verification";
-                    break;
-                case 4:
-                    stepDescription = "shuttle unlocking";
-                    break;
-                case 5:
-                    stepDescription = "tray locking";
-                    break;
-                case 6:
-                    stepDescription = "tray lock verification";
-                    break;
-                case 7:
-                    stepDescription = "pre-movement preparation";
-                    break;
-                default:
-                    stepDescription = "lock operation";
-                    break;
-                }
-            }
-            else
-            {
-                switch (currentOperationStep)
-                {
-                case 0:
-                    stepDescription = "tray unload preparation";
-                    break;
-                case 1:
-                    stepDescription = "sensor verification";
-                    break;
-                case 2:
-                    stepDescription = "movement to source position";
-                    break;
-                case 3:
-                    stepDescription = "movement monitoring";
-                    break;
-                case 4:
-                    stepDescription = "shuttle locking";
-                    break;
-                default:
-                    stepDescription = "lock operation";
-                    break;
-                }
-            }
-
-            snprintf(result.operationSequenceMessage, sizeof(result.operationSequenceMessage),
-                     "Motor unexpectedly started moving during %s (step %d)", 
-                     stepDescription, currentOperationStep);
-
-            result.failureReason = ABORT_REASON_SENSOR_MISMATCH;
+            reportSequence(outcome, SAFETY_REASON_UNEXPECTED_MOVEMENT, true);
+            reportAbort(outcome, ABORT_REASON_SENSOR_MISMATCH);
         }
     }
 
-    // Shuttle/Tray Lock Exclusivity
-    // Cannot lock trays when shuttle is locked (mechanical interference)
-    if (state.shuttleLocked)
+    // Cannot lock trays when the shuttle is locked (mechanical interference)
+    if (in.shuttleLocked)
     {
-        result.safeToLockTray1 = false;
-        result.safeToLockTray2 = false;
-        result.safeToLockTray3 = false;
-        strcpy_P(result.tray1LockUnsafeReason, PSTR("Shuttle is locked"));
-        strcpy_P(result.tray2LockUnsafeReason, PSTR("Shuttle is locked"));
-        strcpy_P(result.tray3LockUnsafeReason, PSTR("Shuttle is locked"));
-
-        // Sequence validation: Detect unexpected shuttle locking
-        // We expect the shuttle to lock during specific operation steps only
-        if (operationInProgress &&
-            !previousState.shuttleLocked && state.shuttleLocked &&
-            (currentOperation.type != OPERATION_LOADING ||
-             (currentOperationStep != 2 && currentOperationStep != 3)))
-        {
-            // This means shuttle was locked unexpectedly outside the expected step
-            result.operationSequenceValid = false;
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY1, SAFETY_REASON_SHUTTLE_LOCKED);
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY2, SAFETY_REASON_SHUTTLE_LOCKED);
+        markUnsafe(result, SAFETY_CHECK_LOCK_TRAY3, SAFETY_REASON_SHUTTLE_LOCKED);
 
-            // Build detailed error message with operation context
-            if (currentOperation.type == OPERATION_LOADING)
-            {
-                snprintf(result.operationSequenceMessage, sizeof(result.operationSequenceMessage),
-                         "Shuttle unexpectedly locked during tray loading operation at step %d (expected at steps 2-3)",
-                         currentOperationStep);
-            }
-            else if (currentOperation.type == OPERATION_UNLOADING)
-            {
-                // Provide specific guidance about when shuttle should be locked during unloading
-                if (currentOperationStep < 3)
-                {
-                    snprintf(result.operationSequenceMessage, sizeof(result.operationSequenceMessage),
-                             "Shuttle unexpectedly locked during tray unloading operation at step %d (expected at steps 4-5)",
-                             currentOperationStep);
-                }
-                else if (currentOperationStep == 4 || currentOperationStep == 5)
-                {
-                    // This is a valid step for shuttle locking during unloading
-                    result.operationSequenceValid = true; // Override the error
-                    return result;                        // Skip setting failure reason
-                }
-                else
-                {
-                    snprintf(result.operationSequenceMessage, sizeof(result.operationSequenceMessage),
-                             "Shuttle unexpectedly locked during tray unloading operation at step %d (unexpected at this step)",
-                             currentOperationStep);
-                }
-            }
-            else
-            {
-                strcpy(result.operationSequenceMessage, "Shuttle unexpectedly locked during operation at unexpected step");
-            }
+        // The shuttle is expected to lock at loading steps 2-3 and unloading steps 4-5 only
+        bool expectedLock = (in.operationType == OPERATION_LOADING &&
+                             (in.operationStep == 2 || in.operationStep == 3)) ||
+                            (in.operationType == OPERATION_UNLOADING &&
+                             (in.operationStep == 4 || in.operationStep == 5));
 
-            result.failureReason = ABORT_REASON_SENSOR_MISMATCH;
+        if (in.operationActive && !in.previousShuttleLocked && !expectedLock)
+        {
+            reportSequence(outcome, SAFETY_REASON_UNEXPECTED_SHUTTLE_LOCK, true);
+            reportAbort(outcome, ABORT_REASON_SENSOR_MISMATCH);
         }
     }
+}
 
-    //=============================================================================
-    // TRAY LOADING VALIDATION
-    //=============================================================================
-    // Validates conditions required for safely loading new trays
-    // Prevents loading trays into occupied positions or exceeding capacity
+// Loading requires a free position and spare capacity
+static void evaluateLoadRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (in.tray1Present)
+        markUnsafe(result, SAFETY_CHECK_LOAD_POS1, SAFETY_REASON_POSITION_OCCUPIED);
+    if (in.tray2Present)
+        markUnsafe(result, SAFETY_CHECK_LOAD_POS2, SAFETY_REASON_POSITION_OCCUPIED);
+    if (in.tray3Present)
+        markUnsafe(result, SAFETY_CHECK_LOAD_POS3, SAFETY_REASON_POSITION_OCCUPIED);
 
-    // Position Occupancy Checks
-    // Cannot load trays into already occupied positions
-    if (state.tray1Present)
+    if (in.tray1Present && in.tray2Present && in.tray3Present)
     {
-        result.safeToLoadTrayToPos1 = false;
-        strcpy_P(result.loadTrayPos1UnsafeReason, PSTR("Position already occupied"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_LOAD_POS1, SAFETY_REASON_ALL_POSITIONS_OCCUPIED);
+        markUnsafe(result, SAFETY_CHECK_LOAD_POS2, SAFETY_REASON_ALL_POSITIONS_OCCUPIED);
+        markUnsafe(result, SAFETY_CHECK_LOAD_POS3, SAFETY_REASON_ALL_POSITIONS_OCCUPIED);
     }
+}
 
-    if (state.tray2Present)
-    {
-        result.safeToLoadTrayToPos2 = false;
-        strcpy_P(result.loadTrayPos2UnsafeReason, PSTR("Position already occupied"));
-        // No abort reason - this is a prerequisite check
-    }
+// Unloading requires a tray and enforces FILO order (position 1 first)
+static void evaluateUnloadRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (!in.tray1Present)
+        markUnsafe(result, SAFETY_CHECK_UNLOAD_POS1, SAFETY_REASON_NO_TRAY);
+    if (!in.tray2Present)
+        markUnsafe(result, SAFETY_CHECK_UNLOAD_POS2, SAFETY_REASON_NO_TRAY);
+    if (!in.tray3Present)
+        markUnsafe(result, SAFETY_CHECK_UNLOAD_POS3, SAFETY_REASON_NO_TRAY);
 
-    if (state.tray3Present)
+    if (in.tray1Present)
     {
-        result.safeToLoadTrayToPos3 = false;
-        strcpy_P(result.loadTrayPos3UnsafeReason, PSTR("Position already occupied"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_UNLOAD_POS2, SAFETY_REASON_UNLOAD_TRAY1_FIRST);
+        markUnsafe(result, SAFETY_CHECK_UNLOAD_POS3, SAFETY_REASON_UNLOAD_TRAY1_FIRST);
     }
-
-    // System Capacity Constraint
-    // Cannot load more than 3 trays into the system
-    if (state.tray1Present && state.tray2Present && state.tray3Present)
+    else if (in.tray2Present)
     {
-        result.safeToLoadTrayToPos1 = false;
-        result.safeToLoadTrayToPos2 = false;
-        result.safeToLoadTrayToPos3 = false;
-        strcpy_P(result.loadTrayPos1UnsafeReason, PSTR("All positions occupied"));
-        strcpy_P(result.loadTrayPos2UnsafeReason, PSTR("All positions occupied"));
-        strcpy_P(result.loadTrayPos3UnsafeReason, PSTR("All positions occupied"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_UNLOAD_POS3, SAFETY_REASON_UNLOAD_TRAY2_FIRST);
     }
+}
 
-    //=============================================================================
-    // TRAY UNLOADING VALIDATION
-    //=============================================================================
-    // Validates conditions required for safely unloading trays
-    // Enforces FILO (First-In-Last-Out) sequence for tray removal
+// Releasing a tray held by the Mitsubishi robot gripper at position 1
+static void evaluateGrippedUnlockRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (!in.tray1Present)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_NO_TRAY_AT_POS1);
+    if (!in.tray1Locked)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_TRAY_NOT_LOCKED);
+    if (in.shuttleLocked)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_SHUTTLE_NOT_RETRACTED);
+    if (in.operationActive)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_OPERATION_IN_PROGRESS);
+    if (in.motorState == MOTOR_STATE_MOVING)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_MOTOR_MOVING);
+    if (in.eStopActive)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_ESTOP_ACTIVE);
+    if (!in.pressureSufficient)
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_GRIPPED_TRAY, SAFETY_REASON_PRESSURE_INSUFFICIENT);
+}
 
-    // Tray Presence Requirement
-    // Cannot unload from empty positions
-    if (!state.tray1Present)
+// Recent lock/unlock failures invalidate an operation in progress
+static void evaluateLockFailureRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (in.lockFailed)
     {
-        result.safeToUnloadTrayFromPos1 = false;
-        strcpy_P(result.unloadTrayPos1UnsafeReason, PSTR("No tray detected"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_LOCK_OPERATION, SAFETY_REASON_LOCK_FAILED);
+        if (in.operationActive)
+        {
+            reportSequence(outcome, SAFETY_REASON_LOCK_FAILED, true);
+            reportAbort(outcome, ABORT_REASON_SENSOR_MISMATCH);
+        }
     }
 
-    if (!state.tray2Present)
+    if (in.unlockFailed)
     {
-        result.safeToUnloadTrayFromPos2 = false;
-        strcpy_P(result.unloadTrayPos2UnsafeReason, PSTR("No tray detected"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_UNLOCK_OPERATION, SAFETY_REASON_UNLOCK_FAILED);
+        if (in.operationActive)
+        {
+            reportSequence(outcome, SAFETY_REASON_UNLOCK_FAILED, true);
+            reportAbort(outcome, ABORT_REASON_SENSOR_MISMATCH);
+        }
     }
+}
 
-    if (!state.tray3Present)
+// Motor must reach the commanded position within tolerance
+static void evaluateCommandStateRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (in.commandedMm >= 0 && abs(in.positionMm - in.commandedMm) > POSITION_TOLERANCE_MM)
     {
-        result.safeToUnloadTrayFromPos3 = false;
-        strcpy_P(result.unloadTrayPos3UnsafeReason, PSTR("No tray detected"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_COMMAND_STATE, SAFETY_REASON_POSITION_MISMATCH);
+
+        // During operations this is a motor timeout or blockage
+        if (in.operationActive)
+        {
+            reportSequence(outcome, SAFETY_REASON_POSITION_MISMATCH, true);
+            reportAbort(outcome, ABORT_REASON_MOTOR_TIMEOUT);
+        }
     }
+}
 
-    // FILO (First-In-Last-Out) Sequence Enforcement
-    // Trays must be unloaded in reverse order of loading
+// Trays must be present where the motor position says they should be.
+// Only enforced during operations, and skipped while a tray is in transit or
+// an unload is still preparing.
+static void evaluateTrayPositionRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (!in.operationActive)
+        return;
 
-    // Position 1 must be unloaded first (most recently loaded)
-    if (state.tray1Present)
-    {
-        result.safeToUnloadTrayFromPos2 = false;
-        result.safeToUnloadTrayFromPos3 = false;
-        strcpy_P(result.unloadTrayPos2UnsafeReason, PSTR("Tray 1 must be unloaded first"));
-        strcpy_P(result.unloadTrayPos3UnsafeReason, PSTR("Tray 1 must be unloaded first"));
-        // No abort reason - this is a prerequisite check
-    }
+    bool inTrayMovementOperation = ((in.operationType == OPERATION_LOADING &&
+                                     (in.operationStep == 8 || in.operationStep == 14)) ||
+                                    (in.operationType == OPERATION_UNLOADING && in.operationStep == 9)) &&
+                                   in.motorState == MOTOR_STATE_MOVING;
+    bool startingUnloadOperation = in.operationType == OPERATION_UNLOADING && in.operationStep <= 3;
 
-    // Position 2 must be unloaded before position 3
-    if (state.tray2Present && !state.tray1Present)
+    if (!inTrayMovementOperation && !startingUnloadOperation &&
+        isAtPosition(in.positionMm, POSITION_1_MM) && !in.tray1Present)
     {
-        result.safeToUnloadTrayFromPos3 = false;
-        strcpy_P(result.unloadTrayPos3UnsafeReason, PSTR("Tray 2 must be unloaded first"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_TRAY_POSITION, SAFETY_REASON_TRAY1_MISSING);
+        reportSequence(outcome, SAFETY_REASON_TRAY1_MISSING, true);
+        reportAbort(outcome, ABORT_REASON_SENSOR_MISMATCH);
     }
+}
 
-    //=============================================================================
-    // GRIPPED TRAY UNLOCK VALIDATION
-    //=============================================================================
-    // Validates conditions required for safely unlocking a tray that is being gripped
-    // by the Mitsubishi robot during the unloading process
+// Target must be in range, and set during operations (except unloading steps 4-10)
+static void evaluateTargetRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    bool skipTargetValidation = in.operationActive && in.operationType == OPERATION_UNLOADING &&
+                                in.operationStep >= 4 && in.operationStep <= 10;
 
-    // Tray presence check - can only unlock at position 1
-    if (!state.tray1Present)
+    if (in.hasTarget)
     {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("No tray at position 1"));
-        // No abort reason - this is a prerequisite check
+        if (in.targetMm < 0 || in.targetMm > MAX_TRAVEL_MM)
+        {
+            markUnsafe(result, SAFETY_CHECK_TARGET_POSITION, SAFETY_REASON_TARGET_OUT_OF_RANGE);
+            reportSequence(outcome, SAFETY_REASON_TARGET_OUT_OF_RANGE, false);
+        }
     }
-
-    // Tray lock check - must be locked before unlocking
-    if (!state.tray1Locked)
+    else if (in.operationActive && !skipTargetValidation)
     {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("Tray not locked"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_TARGET_POSITION, SAFETY_REASON_NO_TARGET);
+        reportSequence(outcome, SAFETY_REASON_NO_TARGET, false);
     }
+}
 
-    // Shuttle retraction check - shuttle must be retracted for robot access
-    if (state.shuttleLocked)
+// No new commands while an operation is running
+static void evaluateCommandExclusivityRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (in.operationActive && in.newCommand)
     {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("Shuttle must be retracted"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_ACCEPT_COMMAND, SAFETY_REASON_COMMAND_REJECTED);
+        reportSequence(outcome, SAFETY_REASON_COMMAND_REJECTED, false);
     }
+}
 
-    // Operation state check - can't unlock during active operations
-    if (operationInProgress)
+static void evaluateTimeoutRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (in.timedOut)
     {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("Operation in progress"));
-        // No abort reason - this is a prerequisite check
+        markUnsafe(result, SAFETY_CHECK_OPERATION_TIMEOUT, SAFETY_REASON_OPERATION_TIMEOUT);
+        reportSequence(outcome, SAFETY_REASON_OPERATION_TIMEOUT, false);
+        reportAbort(outcome, ABORT_REASON_OPERATION_TIMEOUT);
     }
+}
 
-    // Motor movement check - can't unlock while motor is moving
-    if (state.motorState == MOTOR_STATE_MOVING)
+static void evaluateStepSequenceRule(const SafetyInputs &in, SafetyValidationResult &result, SafetyRuleOutcome &outcome)
+{
+    if (in.operationActive && in.operationStep != in.expectedStep)
     {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("Motor is moving"));
-        // No abort reason - this is a prerequisite check
+        reportSequence(outcome, SAFETY_REASON_STEP_MISMATCH, true);
+        reportAbort(outcome, ABORT_REASON_SENSOR_MISMATCH);
     }
+}
 
-    // E-Stop check - can't unlock when E-Stop is active
-    if (state.eStopActive)
-    {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("E-stop active"));
-        // This is consistent with other E-stop handling
-    }
+// Rule table - order matters: later rules override the sequence message and
+// abort reason reported by earlier ones
+static const SafetyRule SAFETY_RULES[] = {
+    {SAFETY_IN_PRESSURE | SAFETY_IN_OPERATION,
+     SAFETY_BIT(SAFETY_CHECK_PRESSURE), evaluatePressureRule},
+    {SAFETY_IN_POSITION | SAFETY_IN_TRAY_LOCKS | SAFETY_IN_HOMED | SAFETY_IN_ESTOP | SAFETY_IN_CCIO | SAFETY_IN_MOTOR_STATE,
+     SAFETY_BIT(SAFETY_CHECK_MOVE), evaluateMoveRule},
+    {SAFETY_IN_TRAY_PRESENCE | SAFETY_IN_MOTOR_STATE | SAFETY_IN_SHUTTLE | SAFETY_IN_OPERATION | SAFETY_IN_PREVIOUS,
+     SAFETY_BIT(SAFETY_CHECK_LOCK_TRAY1) | SAFETY_BIT(SAFETY_CHECK_LOCK_TRAY2) | SAFETY_BIT(SAFETY_CHECK_LOCK_TRAY3),
+     evaluateTrayLockRule},
+    {SAFETY_IN_TRAY_PRESENCE,
+     SAFETY_BIT(SAFETY_CHECK_LOAD_POS1) | SAFETY_BIT(SAFETY_CHECK_LOAD_POS2) | SAFETY_BIT(SAFETY_CHECK_LOAD_POS3),
+     evaluateLoadRule},
+    {SAFETY_IN_TRAY_PRESENCE,
+     SAFETY_BIT(SAFETY_CHECK_UNLOAD_POS1) | SAFETY_BIT(SAFETY_CHECK_UNLOAD_POS2) | SAFETY_BIT(SAFETY_CHECK_UNLOAD_POS3),
+     evaluateUnloadRule},
+    {SAFETY_IN_TRAY_PRESENCE | SAFETY_IN_TRAY_LOCKS | SAFETY_IN_SHUTTLE | SAFETY_IN_OPERATION | SAFETY_IN_MOTOR_STATE |
+         SAFETY_IN_ESTOP | SAFETY_IN_PRESSURE,
+     SAFETY_BIT(SAFETY_CHECK_UNLOCK_GRIPPED_TRAY), evaluateGrippedUnlockRule},
+    {SAFETY_IN_LOCK_FAILURES | SAFETY_IN_OPERATION,
+     SAFETY_BIT(SAFETY_CHECK_LOCK_OPERATION) | SAFETY_BIT(SAFETY_CHECK_UNLOCK_OPERATION), evaluateLockFailureRule},
+    {SAFETY_IN_POSITION | SAFETY_IN_COMMANDED | SAFETY_IN_OPERATION,
+     SAFETY_BIT(SAFETY_CHECK_COMMAND_STATE), evaluateCommandStateRule},
+    {SAFETY_IN_POSITION | SAFETY_IN_TRAY_PRESENCE | SAFETY_IN_OPERATION | SAFETY_IN_MOTOR_STATE,
+     SAFETY_BIT(SAFETY_CHECK_TRAY_POSITION), evaluateTrayPositionRule},
+    {SAFETY_IN_TARGET | SAFETY_IN_OPERATION,
+     SAFETY_BIT(SAFETY_CHECK_TARGET_POSITION), evaluateTargetRule},
+    {SAFETY_IN_OPERATION | SAFETY_IN_NEW_COMMAND,
+     SAFETY_BIT(SAFETY_CHECK_ACCEPT_COMMAND), evaluateCommandExclusivityRule},
+    {SAFETY_IN_TIMEOUT,
+     SAFETY_BIT(SAFETY_CHECK_OPERATION_TIMEOUT), evaluateTimeoutRule},
+    {SAFETY_IN_OPERATION,
+     0, evaluateStepSequenceRule},
+};
+
+static const int SAFETY_RULE_COUNT = sizeof(SAFETY_RULES) / sizeof(SAFETY_RULES[0]);
+
+// Evaluator cache
+static SafetyInputs cachedSafetyInputs;
+static SafetyValidationResult cachedSafetyResult;
+static SafetyRuleOutcome cachedRuleOutcomes[SAFETY_RULE_COUNT];
+static bool safetyCacheValid = false;
+
+static void captureSafetyInputs(const SystemState &state, SafetyInputs &in)
+{
+    in.motorState = state.motorState;
+    in.isHomed = state.isHomed;
+    in.positionMm = state.currentPositionMm;
+    in.tray1Locked = state.tray1Locked;
+    in.tray2Locked = state.tray2Locked;
+    in.tray3Locked = state.tray3Locked;
+    in.shuttleLocked = state.shuttleLocked;
+    in.tray1Present = state.tray1Present;
+    in.tray2Present = state.tray2Present;
+    in.tray3Present = state.tray3Present;
+    in.eStopActive = state.eStopActive;
+    in.ccioBoardPresent = state.ccioBoardPresent;
+    in.pressureSufficient = isPressureSufficient();
+    in.operationActive = operationInProgress;
+    in.operationType = currentOperation.type;
+    in.operationStep = currentOperationStep;
+    in.expectedStep = expectedOperationStep;
+    in.previousMotorState = previousState.motorState;
+    in.previousShuttleLocked = previousState.shuttleLocked;
+    in.lockFailed = lastLockOperationFailed;
+    in.unlockFailed = lastUnlockOperationFailed;
+    in.commandedMm = commandedPositionMm;
+    in.hasTarget = hasCurrentTarget;
+    in.targetMm = currentTargetPositionMm;
+    in.newCommand = newCommandReceived;
+    in.timedOut = operationInProgress && timeoutElapsed(millis(), operationStartTime, operationTimeoutMs);
+}
 
-    // Pneumatic pressure check - can't unlock without sufficient pressure
-    if (!result.pneumaticPressureSufficient)
-    {
-        result.safeToUnlockGrippedTray = false;
-        strcpy_P(result.grippedTrayUnlockUnsafeReason, PSTR("Insufficient pneumatic pressure"));
-        // This uses the existing pneumatic pressure validation
-    }
+// Bitmask of SAFETY_IN_* fields that differ between two input snapshots
+static uint16_t diffSafetyInputs(const SafetyInputs &a, const SafetyInputs &b)
+{
+    uint16_t changed = 0;
+
+    if (a.motorState != b.motorState)
+        changed |= SAFETY_IN_MOTOR_STATE;
+    if (a.isHomed != b.isHomed)
+        changed |= SAFETY_IN_HOMED;
+    if (a.positionMm != b.positionMm)
+        changed |= SAFETY_IN_POSITION;
+    if (a.tray1Locked != b.tray1Locked || a.tray2Locked != b.tray2Locked || a.tray3Locked != b.tray3Locked)
+        changed |= SAFETY_IN_TRAY_LOCKS;
+    if (a.shuttleLocked != b.shuttleLocked)
+        changed |= SAFETY_IN_SHUTTLE;
+    if (a.tray1Present != b.tray1Present || a.tray2Present != b.tray2Present || a.tray3Present != b.tray3Present)
+        changed |= SAFETY_IN_TRAY_PRESENCE;
+    if (a.eStopActive != b.eStopActive)
+        changed |= SAFETY_IN_ESTOP;
+    if (a.ccioBoardPresent != b.ccioBoardPresent)
+        changed |= SAFETY_IN_CCIO;
+    if (a.pressureSufficient != b.pressureSufficient)
+        changed |= SAFETY_IN_PRESSURE;
+    if (a.operationActive != b.operationActive || a.operationType != b.operationType ||
+        a.operationStep != b.operationStep || a.expectedStep != b.expectedStep)
+        changed |= SAFETY_IN_OPERATION;
+    if (a.previousMotorState != b.previousMotorState || a.previousShuttleLocked != b.previousShuttleLocked)
+        changed |= SAFETY_IN_PREVIOUS;
+    if (a.lockFailed != b.lockFailed || a.unlockFailed != b.unlockFailed)
+        changed |= SAFETY_IN_LOCK_FAILURES;
+    if (a.commandedMm != b.commandedMm)
+        changed |= SAFETY_IN_COMMANDED;
+    if (a.hasTarget != b.hasTarget || a.targetMm != b.targetMm)
+        changed |= SAFETY_IN_TARGET;
+    if (a.newCommand != b.newCommand)
+        changed |= SAFETY_IN_NEW_COMMAND;
+    if (a.timedOut != b.timedOut)
+        changed |= SAFETY_IN_TIMEOUT;
+
+    return changed;
+}
 
-    //=============================================================================
-    // LOCK/UNLOCK OPERATION VALIDATION
-    //=============================================================================
-    // Validates that recent lock/unlock operations succeeded
-    // Triggers safety violations when lock/unlock operations fail during automated operations
+void invalidateSafetyRules()
+{
+    safetyCacheValid = false;
+}
 
-    // Check for recent lock operation failures
-    if (lastLockOperationFailed)
-    {
-        result.lockOperationSuccessful = false;
-        strcpy(result.lockFailureDetails, lastLockFailureDetails);
+// Validate safety conditions based on the current system state
+// Only rules whose inputs changed since the previous call are re-evaluated
+SafetyValidationResult validateSafety(const SystemState &state)
+{
+    unsigned long startMicros = micros();
 
-        // If we're in an operation, mark the sequence as invalid
-        if (operationInProgress)
-        {
-            result.operationSequenceValid = false;
-            strcpy_P(result.operationSequenceMessage, PSTR("Lock operation failed: "));
-            strcat(result.operationSequenceMessage, lastLockFailureDetails);
-            result.failureReason = ABORT_REASON_SENSOR_MISMATCH;
+    SafetyInputs in;
+    captureSafetyInputs(state, in);
 
-            // Add operation context for better diagnostics
-            if (currentOperation.type == OPERATION_LOADING)
-            {
-                strcat_P(result.operationSequenceMessage, PSTR(" during loading operation step "));
-                char stepStr[10];
-                itoa(currentOperationStep, stepStr, 10);
-                strcat(result.operationSequenceMessage, stepStr);
-            }
-            else if (currentOperation.type == OPERATION_UNLOADING)
-            {
-                strcat_P(result.operationSequenceMessage, PSTR(" during unloading operation step "));
-                char stepStr[10];
-                itoa(currentOperationStep, stepStr, 10);
-                strcat(result.operationSequenceMessage, stepStr);
-            }
-        }
+    uint16_t changed = SAFETY_IN_ALL;
+    if (safetyCacheValid)
+    {
+        changed = diffSafetyInputs(in, cachedSafetyInputs);
     }
-
-    // Check for recent unlock operation failures
-    if (lastUnlockOperationFailed)
+    else
     {
-        result.unlockOperationSuccessful = false;
-        strcpy(result.unlockFailureDetails, lastUnlockFailureDetails);
-
-        // If we're in an operation, mark the sequence as invalid
-        if (operationInProgress)
-        {
-            result.operationSequenceValid = false;
-            strcpy_P(result.operationSequenceMessage, PSTR("Unlock operation failed: "));
-            strcat(result.operationSequenceMessage, lastUnlockFailureDetails);
-            result.failureReason = ABORT_REASON_SENSOR_MISMATCH;
-
-            // Add operation context for better diagnostics
-            if (currentOperation.type == OPERATION_LOADING)
-            {
-                strcat_P(result.operationSequenceMessage, PSTR(" during loading operation step "));
-                char stepStr[10];
-                itoa(currentOperationStep, stepStr, 10);
-                strcat(result.operationSequenceMessage, stepStr);
-            }
-            else if (currentOperation.type == OPERATION_UNLOADING)
-            {
-                strcat_P(result.operationSequenceMessage, PSTR(" during unloading operation step "));
-                char stepStr[10];
-                itoa(currentOperationStep, stepStr, 10);
-                strcat(result.operationSequenceMessage, stepStr);
-            }
-        }
+        memset(&cachedSafetyResult, 0, sizeof(cachedSafetyResult));
     }
 
-    //=============================================================================
-    // POSITION AND STATE VALIDATION
-    //=============================================================================
-    // Validates that motor position and system state match expectations
-    // Detects position errors and unexpected conditions
+    SafetyValidationResult &result = cachedSafetyResult;
 
-    // Motor Position Accuracy Validation
-    // Verifies that motor has reached commanded position within tolerance
-    if (commandedPositionMm >= 0)
+    for (int i = 0; i < SAFETY_RULE_COUNT; i++)
     {
-        if (abs(state.currentPositionMm - commandedPositionMm) > POSITION_TOLERANCE_MM)
+        const SafetyRule &rule = SAFETY_RULES[i];
+        if ((rule.inputs & changed) == 0)
         {
-            result.commandStateValid = false;
+            safetyEvaluatorStats.rulesSkipped++;
+            continue;
+        }
 
-            // Create detailed error message with position values
-            snprintf_P(result.stateValidationMessage, sizeof(result.stateValidationMessage),
-                      PSTR("Position mismatch: current position %d mm vs. commanded %d mm (diff: %d mm)"),
-                      state.currentPositionMm, commandedPositionMm, 
-                      abs(state.currentPositionMm - commandedPositionMm));
+        // Clear the checks this rule owns before re-running it
+        result.unsafeMask &= ~rule.checks;
+        for (int check = 0; check < SAFETY_CHECK_COUNT; check++)
+        {
+            if (rule.checks & SAFETY_BIT(check))
+                result.reasons[check] = SAFETY_REASON_NONE;
+        }
 
-            // Add motor state context for better diagnostics
-            if (state.motorState == MOTOR_STATE_MOVING)
-            {
-                strcat_P(result.stateValidationMessage, PSTR(" - Motor still moving"));
-            }
-            else if (state.motorState == MOTOR_STATE_FAULTED)
-            {
-                strcat_P(result.stateValidationMessage, PSTR(" - Motor in FAULT state"));
-            }
-            else
-            {
-                strcat_P(result.stateValidationMessage, PSTR(" - Motor stopped before reaching target"));
-            }
+        SafetyRuleOutcome &outcome = cachedRuleOutcomes[i];
+        outcome.sequenceReason = SAFETY_REASON_NONE;
+        outcome.breaksSequence = false;
+        outcome.setsAbort = false;
 
-            // Set abort reason during operations - motor timeout or blockage
-            if (operationInProgress)
-            {
-                result.failureReason = ABORT_REASON_MOTOR_TIMEOUT;
-                result.operationSequenceValid = false;
-
-                // Add operation context for more detailed error reporting
-                strcat_P(result.stateValidationMessage, PSTR(" during "));
-                if (currentOperation.type == OPERATION_LOADING)
-                {
-                    strcat_P(result.stateValidationMessage, PSTR("loading operation"));
-                }
-                else if (currentOperation.type == OPERATION_UNLOADING)
-                {
-                    strcat_P(result.stateValidationMessage, PSTR("unloading operation"));
-                }
-                else
-                {
-                    strcat_P(result.stateValidationMessage, PSTR("operation"));
-                }
-                strcat_P(result.stateValidationMessage, PSTR(" step "));
-                char stepStr[10];
-                itoa(currentOperationStep, stepStr, 10);
-                strcat(result.stateValidationMessage, stepStr);
-
-                strcpy(result.operationSequenceMessage, result.stateValidationMessage);
-            }
-        }
+        rule.evaluate(in, result, outcome);
+        safetyEvaluatorStats.rulesEvaluated++;
     }
 
-    // Tray Position Validation
-    // Verifies that trays are present at expected positions based on motor position
-    bool tray1ExpectedPresent = isAtPosition(state.currentPositionMm, POSITION_1_MM);
-    bool tray2ExpectedPresent = isAtPosition(state.currentPositionMm, POSITION_2_MM);
-    bool tray3ExpectedPresent = isAtPosition(state.currentPositionMm, POSITION_3_MM);
+    // Combine operation-level reports in table order (last report wins)
+    result.unsafeMask &= ~SAFETY_BIT(SAFETY_CHECK_OPERATION_SEQUENCE);
+    result.reasons[SAFETY_CHECK_OPERATION_SEQUENCE] = SAFETY_REASON_NONE;
+    result.failureReason = ABORT_REASON_UNKNOWN;
 
-    // Skip validation during active tray movement operations
-    bool inTrayMovementOperation = (operationInProgress &&
-                                    ((currentOperation.type == OPERATION_LOADING &&
-                                      (currentOperationStep == 8 || currentOperationStep == 14)) ||
-                                     (currentOperation.type == OPERATION_UNLOADING &&
-                                      currentOperationStep == 9)) &&
-                                    state.motorState == MOTOR_STATE_MOVING);
+    for (int i = 0; i < SAFETY_RULE_COUNT; i++)
+    {
+        const SafetyRuleOutcome &outcome = cachedRuleOutcomes[i];
+        if (outcome.sequenceReason != SAFETY_REASON_NONE)
+            result.reasons[SAFETY_CHECK_OPERATION_SEQUENCE] = outcome.sequenceReason;
+        if (outcome.breaksSequence)
+            result.unsafeMask |= SAFETY_BIT(SAFETY_CHECK_OPERATION_SEQUENCE);
+        if (outcome.setsAbort)
+            result.failureReason = outcome.abortReason;
+    }
 
-    // Skip validation during unloading preparation steps
-    bool startingUnloadOperation = (operationInProgress &&
-                                    currentOperation.type == OPERATION_UNLOADING &&
-                                    currentOperationStep <= 3);
+    // Context for rendering reason text
+    result.operationType = in.operationType;
+    result.operationActive = in.operationActive;
+    result.operationStep = in.operationStep;
+    result.expectedStep = in.expectedStep;
+    result.motorState = in.motorState;
+    result.positionMm = in.positionMm;
+    result.commandedMm = in.commandedMm;
 
-    // Only validate when not in movement or special operations
-    if (!inTrayMovementOperation && !startingUnloadOperation)
-    {
-        // Safety critical: Verify expected trays are present
-        if (tray1ExpectedPresent && !state.tray1Present)
-        {
-            result.trayPositionValid = false;
+    cachedSafetyInputs = in;
+    safetyCacheValid = true;
 
-            // Detailed error message with position information
-            snprintf_P(result.stateValidationMessage, sizeof(result.stateValidationMessage),
-                      PSTR("ERROR: Expected tray at position 1 is missing (Motor at %d mm)"),
-                      state.currentPositionMm);
+    unsigned long elapsedMicros = micros() - startMicros;
+    safetyEvaluatorStats.calls++;
+    safetyEvaluatorStats.lastCallMicros = elapsedMicros;
+    if (elapsedMicros > safetyEvaluatorStats.maxCallMicros)
+        safetyEvaluatorStats.maxCallMicros = elapsedMicros;
 
-            // Add operation context and set failure reason
-            if (operationInProgress)
-            {
-                // Copy message to operation sequence for consistency
-                strcpy(result.operationSequenceMessage, result.stateValidationMessage);
-                result.operationSequenceValid = false;
-                result.failureReason = ABORT_REASON_SENSOR_MISMATCH;
-            }
+    return result;
+}
+
+// Description of the operation step a movement violation occurred in
+static const char *getSafetyStepDescription(OperationType type, int step)
+{
+    if (type == OPERATION_LOADING)
+    {
+        switch (step)
+        {
+        case 0:
+            return "initial tray load preparation";
+        case 1:
+            return "tray detection verification";
+        case 2:
+            return "shuttle locking";
+        case 3:
+            return "shuttle lock verification";
+        case 4:
+            return "shuttle unlocking";
+        case 5:
+            return "tray locking";
+        case 6:
+            return "tray lock verification";
+        case 7:
+            return "pre-movement preparation";
+        default:
+            return "lock operation";
         }
     }
 
-    // If not in an operation, tray position validation should pass
-    // This ensures the system doesn't block commands when idle
-    if (!operationInProgress)
+    switch (step)
     {
-        result.trayPositionValid = true;
-        strcpy_P(result.stateValidationMessage, PSTR("System idle - position validation not required"));
+    case 0:
+        return "tray unload preparation";
+    case 1:
+        return "sensor verification";
+    case 2:
+        return "movement to source position";
+    case 3:
+        return "movement monitoring";
+    case 4:
+        return "shuttle locking";
+    default:
+        return "lock operation";
     }
+}
 
-    // Target Position Validation
-    // Verifies that commanded target position is within allowed range
-    bool skipTargetValidation = (operationInProgress &&
-                                 currentOperation.type == OPERATION_UNLOADING &&
-                                 (currentOperationStep >= 4 && currentOperationStep <= 10));
-
-    if (hasCurrentTarget)
+// Text for reasons that need no run-time context
+static const char *getSafetyReasonText(SafetyReason reason)
+{
+    switch (reason)
     {
-        if (currentTargetPositionMm < 0 || currentTargetPositionMm > MAX_TRAVEL_MM)
-        {
-            result.targetPositionValid = false;
-            strcpy_P(result.stateValidationMessage, PSTR("Target position out of range"));
-            strcpy(result.operationSequenceMessage, result.stateValidationMessage);
-        }
+    case SAFETY_REASON_TRAY1_LOCKED_AT_POSITION:
+        return "Cannot move - Tray at position 1 is locked";
+    case SAFETY_REASON_TRAY2_LOCKED_AT_POSITION:
+        return "Cannot move - Tray at position 2 is locked";
+    case SAFETY_REASON_TRAY3_LOCKED_AT_POSITION:
+        return "Cannot move - Tray at position 3 is locked";
+    case SAFETY_REASON_NOT_HOMED:
+        return "Motor not homed";
+    case SAFETY_REASON_ESTOP_ACTIVE:
+        return "E-stop active";
+    case SAFETY_REASON_CCIO_NOT_DETECTED:
+        return "CCIO board not detected";
+    case SAFETY_REASON_MOTOR_FAULTED:
+        return "Motor in fault state";
+    case SAFETY_REASON_PRESSURE_LOW:
+        return "Pneumatic pressure below minimum threshold";
+    case SAFETY_REASON_PRESSURE_INSUFFICIENT:
+        return "Insufficient pneumatic pressure";
+    case SAFETY_REASON_NO_TRAY:
+        return "No tray detected";
+    case SAFETY_REASON_MOTOR_MOVING:
+        return "Motor is moving";
+    case SAFETY_REASON_SHUTTLE_LOCKED:
+        return "Shuttle is locked";
+    case SAFETY_REASON_POSITION_OCCUPIED:
+        return "Position already occupied";
+    case SAFETY_REASON_ALL_POSITIONS_OCCUPIED:
+        return "All positions occupied";
+    case SAFETY_REASON_UNLOAD_TRAY1_FIRST:
+        return "Tray 1 must be unloaded first";
+    case SAFETY_REASON_UNLOAD_TRAY2_FIRST:
+        return "Tray 2 must be unloaded first";
+    case SAFETY_REASON_NO_TRAY_AT_POS1:
+        return "No tray at position 1";
+    case SAFETY_REASON_TRAY_NOT_LOCKED:
+        return "Tray not locked";
+    case SAFETY_REASON_SHUTTLE_NOT_RETRACTED:
+        return "Shuttle must be retracted";
+    case SAFETY_REASON_OPERATION_IN_PROGRESS:
+        return "Operation in progress";
+    case SAFETY_REASON_TARGET_OUT_OF_RANGE:
+        return "Target position out of range";
+    case SAFETY_REASON_NO_TARGET:
+        return "No target position set during active operation";
+    case SAFETY_REASON_COMMAND_REJECTED:
+        return "Operation in progress, cannot accept new command (use 'system,reset' after failure)";
+    case SAFETY_REASON_OPERATION_TIMEOUT:
+        return "Operation exceeded timeout";
+    default:
+        return "Unknown reason";
     }
-    else if (operationInProgress && !skipTargetValidation)
+}
+
+// Append " during <type> operation step N" for reasons raised mid-operation
+static void appendSafetyOperationContext(const SafetyValidationResult &result, char *buffer, size_t bufferSize)
+{
+    size_t length = strlen(buffer);
+    const char *typeStr = result.operationType == OPERATION_LOADING     ? "loading "
+                          : result.operationType == OPERATION_UNLOADING ? "unloading "
+                                                                        : "";
+    snprintf(buffer + length, bufferSize - length, " during %soperation step %d", typeStr, result.operationStep);
+}
+
+// Render the reason a check failed. Returns buffer ("" when the check passed).
+const char *formatSafetyReason(const SafetyValidationResult &result, SafetyCheck check,
+                               char *buffer, size_t bufferSize)
+{
+    SafetyReason reason = (SafetyReason)result.reasons[check];
+    buffer[0] = '\0';
+
+    switch (reason)
     {
-        // Missing target is only a problem during active operations
-        result.targetPositionValid = false;
-        strcpy_P(result.stateValidationMessage, PSTR("No target position set during active operation"));
-        strcpy(result.operationSequenceMessage, result.stateValidationMessage);
-    }
-    else if (!hasCurrentTarget)
+    case SAFETY_REASON_NONE:
+        break;
+
+    case SAFETY_REASON_LOCK_FAILED:
+    case SAFETY_REASON_UNLOCK_FAILED:
     {
-        // No target position when system is idle is perfectly fine
-        result.targetPositionValid = true;
-        strcpy_P(result.stateValidationMessage, PSTR("System idle - no target needed"));
+        const char *details = (reason == SAFETY_REASON_LOCK_FAILED) ? lastLockFailureDetails : lastUnlockFailureDetails;
+        if (check == SAFETY_CHECK_OPERATION_SEQUENCE)
+        {
+            snprintf(buffer, bufferSize, "%s operation failed: %s",
+                     (reason == SAFETY_REASON_LOCK_FAILED) ? "Lock" : "Unlock", details);
+            if (result.operationType == OPERATION_LOADING || result.operationType == OPERATION_UNLOADING)
+                appendSafetyOperationContext(result, buffer, bufferSize);
+        }
+        else
+        {
+            snprintf(buffer, bufferSize, "%s", details);
+        }
+        break;
     }
 
-    //=============================================================================
-    // OPERATION SEQUENCE VALIDATION
-    //=============================================================================
-    // Validates that operations follow correct sequence and timing
-    // Prevents command conflicts and detects sequence errors
+    case SAFETY_REASON_UNEXPECTED_MOVEMENT:
+        snprintf(buffer, bufferSize, "Motor unexpectedly started moving during %s (step %d)",
+                 getSafetyStepDescription(result.operationType, result.operationStep), result.operationStep);
+        break;
 
-    // Command Exclusivity Check
-    // No new commands allowed during active operations
-    if (operationInProgress)
-    {
-        if (newCommandReceived)
+    case SAFETY_REASON_UNEXPECTED_SHUTTLE_LOCK:
+        if (result.operationType == OPERATION_LOADING)
         {
-            result.safeToAcceptNewCommand = false;
-            strcpy_P(result.operationSequenceMessage, PSTR("Operation in progress, cannot accept new command"));
-            strcat_P(result.operationSequenceMessage, PSTR(" (use 'system,reset' after failure)"));
+            snprintf(buffer, bufferSize,
+                     "Shuttle unexpectedly locked during tray loading operation at step %d (expected at steps 2-3)",
+                     result.operationStep);
         }
-    }
+        else if (result.operationType == OPERATION_UNLOADING)
+        {
+            snprintf(buffer, bufferSize,
+                     "Shuttle unexpectedly locked during tray unloading operation at step %d (%s)",
+                     result.operationStep,
+                     result.operationStep < 3 ? "expected at steps 4-5" : "unexpected at this step");
+        }
+        else
+        {
+            snprintf(buffer, bufferSize, "Shuttle unexpectedly locked during operation at unexpected step");
+        }
+        break;
 
-    // Operation Timeout Detection
-    // Detects and reports operations that exceed their timeout
-    if (operationInProgress && timeoutElapsed(millis(), operationStartTime, operationTimeoutMs))
+    case SAFETY_REASON_POSITION_MISMATCH:
     {
-        result.operationWithinTimeout = false;
-        strcpy_P(result.operationSequenceMessage, PSTR("Operation exceeded timeout"));
-        result.failureReason = ABORT_REASON_OPERATION_TIMEOUT;
+        const char *motorContext = result.motorState == MOTOR_STATE_MOVING    ? "Motor still moving"
+                                   : result.motorState == MOTOR_STATE_FAULTED ? "Motor in FAULT state"
+                                                                              : "Motor stopped before reaching target";
+        snprintf(buffer, bufferSize,
+                 "Position mismatch: current position %.2f mm vs. commanded %.2f mm (diff: %.2f mm) - %s",
+                 result.positionMm, result.commandedMm, abs(result.positionMm - result.commandedMm), motorContext);
+        if (result.operationActive)
+            appendSafetyOperationContext(result, buffer, bufferSize);
+        break;
     }
 
-    // Operation Step Sequence Validation
-    // Verifies that operation steps are executed in correct sequence
-    if (operationInProgress && currentOperationStep != expectedOperationStep)
-    {
-        result.operationSequenceValid = false;
-
-        // Create detailed error message with operation context
-        strcpy_P(result.operationSequenceMessage, PSTR("Operation sequence mismatch: "));
-
-        // Add operation-specific type information
-        switch (currentOperation.type)
-        {
-        case OPERATION_LOADING:
-            strcat_P(result.operationSequenceMessage, PSTR("Tray loading operation"));
-            break;
-        case OPERATION_UNLOADING:
-            strcat_P(result.operationSequenceMessage, PSTR("Tray unloading operation"));
-            break;
-        default:
-            strcat_P(result.operationSequenceMessage, PSTR("Current operation"));
-            break;
-        }
+    case SAFETY_REASON_TRAY1_MISSING:
+        snprintf(buffer, bufferSize, "ERROR: Expected tray at position 1 is missing (Motor at %.2f mm)",
+                 result.positionMm);
+        break;
 
-        // Add step information for debugging
-        strcat_P(result.operationSequenceMessage, PSTR(" at step "));
-        char stepStr[10];
-        itoa(currentOperationStep, stepStr, 10);
-        strcat(result.operationSequenceMessage, stepStr);
-        strcat_P(result.operationSequenceMessage, PSTR(" (expected: "));
-        char expectedStr[10];
-        itoa(expectedOperationStep, expectedStr, 10);
-        strcat(result.operationSequenceMessage, expectedStr);
-        strcat_P(result.operationSequenceMessage, PSTR(")"));
+    case SAFETY_REASON_STEP_MISMATCH:
+        snprintf(buffer, bufferSize, "Operation sequence mismatch: %s at step %d (expected: %d)",
+                 result.operationType == OPERATION_LOADING     ? "Tray loading operation"
+                 : result.operationType == OPERATION_UNLOADING ? "Tray unloading operation"
+                                                               : "Current operation",
+                 result.operationStep, result.expectedStep);
+        break;
 
-        result.failureReason = ABORT_REASON_SENSOR_MISMATCH;
+    default:
+        snprintf(buffer, bufferSize, "%s", getSafetyReasonText(reason));
+        break;
     }
 
-    return result;
+    return buffer;
 }
 
 // Function to print out safety validation results
 void printSafetyStatus(const SafetyValidationResult &result)
 {
     char msg[300];
+    char reason[160];
 
     Console.println(F("[SAFETY] Validation Results:"));
 
     // Movement safety
-    if (result.safeToMove)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_MOVE))
     {
         Console.println(F("  Motor Movement: SAFE - System ready for movement"));
     }
     else
     {
-        sprintf(msg, "  Motor Movement: UNSAFE - %s", result.moveUnsafeReason);
+        sprintf(msg, "  Motor Movement: UNSAFE - %s", formatSafetyReason(result, SAFETY_CHECK_MOVE, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Pneumatic pressure safety status
-    if (result.pneumaticPressureSufficient)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_PRESSURE))
     {
         sprintf(msg, "  Pneumatic System: SAFE - %.1f PSI (sufficient pressure for valve operations)", getPressurePsi());
         Console.println(msg);
     }
     else
     {
-        sprintf(msg, "  Pneumatic System: UNSAFE - %s", result.pressureUnsafeReason);
+        sprintf(msg, "  Pneumatic System: UNSAFE - %s", formatSafetyReason(result, SAFETY_CHECK_PRESSURE, reason, sizeof(reason)));
         Console.println(msg);
         sprintf(msg, "    Current pressure: %.1f PSI, Minimum required: %.1f", getPressurePsi(), MIN_SAFE_PRESSURE);
         Console.println(msg);
@@ -1390,43 +1583,43 @@ void printSafetyStatus(const SafetyValidationResult &result)
             return "SAFE TO LOCK - Tray present and system ready";
     };
 
-    if (result.safeToLockTray1)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOCK_TRAY1))
     {
         sprintf(msg, "    Tray 1: %s", getTrayLockMessage(true, operationInProgress, currentOperation.type));
         Console.println(msg);
     }
     else
     {
-        sprintf(msg, "    Tray 1: UNSAFE TO LOCK - %s", result.tray1LockUnsafeReason);
+        sprintf(msg, "    Tray 1: UNSAFE TO LOCK - %s", formatSafetyReason(result, SAFETY_CHECK_LOCK_TRAY1, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToLockTray2)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOCK_TRAY2))
     {
         sprintf(msg, "    Tray 2: %s", getTrayLockMessage(true, operationInProgress, currentOperation.type));
         Console.println(msg);
     }
     else
     {
-        sprintf(msg, "    Tray 2: UNSAFE TO LOCK - %s", result.tray2LockUnsafeReason);
+        sprintf(msg, "    Tray 2: UNSAFE TO LOCK - %s", formatSafetyReason(result, SAFETY_CHECK_LOCK_TRAY2, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToLockTray3)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOCK_TRAY3))
     {
         sprintf(msg, "    Tray 3: %s", getTrayLockMessage(true, operationInProgress, currentOperation.type));
         Console.println(msg);
     }
     else
     {
-        sprintf(msg, "    Tray 3: UNSAFE TO LOCK - %s", result.tray3LockUnsafeReason);
+        sprintf(msg, "    Tray 3: UNSAFE TO LOCK - %s", formatSafetyReason(result, SAFETY_CHECK_LOCK_TRAY3, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Shuttle actuation safety
     Console.println(F("  Shuttle Control:"));
 
-    if (result.safeToLockShuttle)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOCK_SHUTTLE))
     {
         if (operationInProgress && currentOperation.type == OPERATION_LOADING &&
             (currentOperationStep == 2 || currentOperationStep == 3))
@@ -1440,11 +1633,11 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Lock: UNSAFE - %s", result.shuttleLockUnsafeReason);
+        sprintf(msg, "    Lock: UNSAFE - %s", formatSafetyReason(result, SAFETY_CHECK_LOCK_SHUTTLE, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToUnlockShuttle)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_UNLOCK_SHUTTLE))
     {
         if (operationInProgress && currentOperation.type == OPERATION_LOADING &&
             (currentOperationStep == 4 || currentOperationStep == 5))
@@ -1458,20 +1651,20 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Unlock: UNSAFE - %s", result.shuttleUnlockUnsafeReason);
+        sprintf(msg, "    Unlock: UNSAFE - %s", formatSafetyReason(result, SAFETY_CHECK_UNLOCK_SHUTTLE, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Lock/unlock operation status
     Console.println(F("\n  Lock/Unlock Operations:"));
 
-    if (result.lockOperationSuccessful)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOCK_OPERATION))
     {
         Console.println(F("    Lock Operations: SUCCESSFUL - No recent lock failures"));
     }
     else
     {
-        sprintf(msg, "    Lock Operations: FAILED - %s", result.lockFailureDetails);
+        sprintf(msg, "    Lock Operations: FAILED - %s", formatSafetyReason(result, SAFETY_CHECK_LOCK_OPERATION, reason, sizeof(reason)));
         Console.println(msg);
 
         if (lockFailureTimestamp > 0)
@@ -1482,13 +1675,13 @@ void printSafetyStatus(const SafetyValidationResult &result)
         }
     }
 
-    if (result.unlockOperationSuccessful)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_UNLOCK_OPERATION))
     {
         Console.println(F("    Unlock Operations: SUCCESSFUL - No recent unlock failures"));
     }
     else
     {
-        sprintf(msg, "    Unlock Operations: FAILED - %s", result.unlockFailureDetails);
+        sprintf(msg, "    Unlock Operations: FAILED - %s", formatSafetyReason(result, SAFETY_CHECK_UNLOCK_OPERATION, reason, sizeof(reason)));
         Console.println(msg);
 
         if (unlockFailureTimestamp > 0)
@@ -1499,7 +1692,7 @@ void printSafetyStatus(const SafetyValidationResult &result)
         }
     }
 
-    if (!result.lockOperationSuccessful || !result.unlockOperationSuccessful)
+    if (!isSafetyCheckPassed(result, SAFETY_CHECK_LOCK_OPERATION) || !isSafetyCheckPassed(result, SAFETY_CHECK_UNLOCK_OPERATION))
     {
         Console.println(F("    Recovery: Use 'tray,released' or 'tray,gripped' to retry the operation, or 'system,reset' to clear the alert"));
     }
@@ -1508,29 +1701,29 @@ void printSafetyStatus(const SafetyValidationResult &result)
     Console.println(F("\n  System State Validation:"));
 
     // Command/Actual State
-    if (result.commandStateValid)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_COMMAND_STATE))
     {
         Console.println(F("    Command/Actual State: VALID - System position matches commanded position"));
     }
     else
     {
-        sprintf(msg, "    Command/Actual State: INVALID - %s", result.stateValidationMessage);
+        sprintf(msg, "    Command/Actual State: INVALID - %s", formatSafetyReason(result, SAFETY_CHECK_COMMAND_STATE, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Tray Positions
-    if (result.trayPositionValid)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_TRAY_POSITION))
     {
         Console.println(F("    Tray Positions: VALID - Tray presence matches expected positions"));
     }
     else
     {
-        sprintf(msg, "    Tray Positions: INVALID - %s", result.stateValidationMessage);
+        sprintf(msg, "    Tray Positions: INVALID - %s", formatSafetyReason(result, SAFETY_CHECK_TRAY_POSITION, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Target Position
-    if (result.targetPositionValid)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_TARGET_POSITION))
     {
         if (hasCurrentTarget)
         {
@@ -1544,14 +1737,14 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Target Position: INVALID - %s", result.stateValidationMessage);
+        sprintf(msg, "    Target Position: INVALID - %s", formatSafetyReason(result, SAFETY_CHECK_TARGET_POSITION, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Operational sequence validation
     Console.println(F("\n  Operational Sequence:"));
 
-    if (result.safeToAcceptNewCommand)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_ACCEPT_COMMAND))
     {
         if (operationInProgress)
         {
@@ -1578,11 +1771,11 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Accept New Commands: UNSAFE - %s", result.operationSequenceMessage);
+        sprintf(msg, "    Accept New Commands: UNSAFE - %s", formatSafetyReason(result, SAFETY_CHECK_ACCEPT_COMMAND, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.operationWithinTimeout)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_OPERATION_TIMEOUT))
     {
         if (operationInProgress)
         {
@@ -1598,11 +1791,11 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Operation Timing: TIMEOUT - %s", result.operationSequenceMessage);
+        sprintf(msg, "    Operation Timing: TIMEOUT - %s", formatSafetyReason(result, SAFETY_CHECK_OPERATION_TIMEOUT, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.operationSequenceValid)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_OPERATION_SEQUENCE))
     {
         if (operationInProgress)
         {
@@ -1625,10 +1818,10 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Operation Sequence: INVALID - %s", result.operationSequenceMessage);
+        sprintf(msg, "    Operation Sequence: INVALID - %s", formatSafetyReason(result, SAFETY_CHECK_OPERATION_SEQUENCE, reason, sizeof(reason)));
         Console.println(msg);
 
-        if (strstr_P(result.operationSequenceMessage, PSTR("sequence mismatch")) != NULL)
+        if (result.reasons[SAFETY_CHECK_OPERATION_SEQUENCE] == SAFETY_REASON_STEP_MISMATCH)
         {
             Console.println(F("            Use 'system,reset' to reset the system"));
         }
@@ -1637,7 +1830,7 @@ void printSafetyStatus(const SafetyValidationResult &result)
     // Tray loading operations
     Console.println(F("\n  Tray Loading Operations:"));
 
-    if (result.safeToLoadTrayToPos1)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOAD_POS1))
     {
         const char *loadContext;
         if (trayTracking.totalTraysInSystem == 0)
@@ -1654,68 +1847,68 @@ void printSafetyStatus(const SafetyValidationResult &result)
     }
     else
     {
-        sprintf(msg, "    Position 1: UNSAFE TO LOAD - %s", result.loadTrayPos1UnsafeReason);
+        sprintf(msg, "    Position 1: UNSAFE TO LOAD - %s", formatSafetyReason(result, SAFETY_CHECK_LOAD_POS1, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToLoadTrayToPos2)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOAD_POS2))
     {
         Console.println(F("    Position 2: SAFE TO LOAD - Direct loading possible"));
     }
     else
     {
-        sprintf(msg, "    Position 2: UNSAFE TO LOAD - %s", result.loadTrayPos2UnsafeReason);
+        sprintf(msg, "    Position 2: UNSAFE TO LOAD - %s", formatSafetyReason(result, SAFETY_CHECK_LOAD_POS2, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToLoadTrayToPos3)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_LOAD_POS3))
     {
         Console.println(F("    Position 3: SAFE TO LOAD - Direct loading possible"));
     }
     else
     {
-        sprintf(msg, "    Position 3: UNSAFE TO LOAD - %s", result.loadTrayPos3UnsafeReason);
+        sprintf(msg, "    Position 3: UNSAFE TO LOAD - %s", formatSafetyReason(result, SAFETY_CHECK_LOAD_POS3, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // Tray unloading operations
     Console.println(F("\n  Tray Unloading Operations:"));
 
-    if (result.safeToUnloadTrayFromPos1)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_UNLOAD_POS1))
     {
         Console.println(F("    Position 1: SAFE TO UNLOAD - Tray ready for removal"));
     }
     else
     {
-        sprintf(msg, "    Position 1: UNSAFE TO UNLOAD - %s", result.unloadTrayPos1UnsafeReason);
+        sprintf(msg, "    Position 1: UNSAFE TO UNLOAD - %s", formatSafetyReason(result, SAFETY_CHECK_UNLOAD_POS1, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToUnloadTrayFromPos2)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_UNLOAD_POS2))
     {
         Console.println(F("    Position 2: SAFE TO UNLOAD - Tray ready for removal"));
     }
     else
     {
-        sprintf(msg, "    Position 2: UNSAFE TO UNLOAD - %s", result.unloadTrayPos2UnsafeReason);
+        sprintf(msg, "    Position 2: UNSAFE TO UNLOAD - %s", formatSafetyReason(result, SAFETY_CHECK_UNLOAD_POS2, reason, sizeof(reason)));
         Console.println(msg);
     }
 
-    if (result.safeToUnloadTrayFromPos3)
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_UNLOAD_POS3))
     {
         Console.println(F("    Position 3: SAFE TO UNLOAD - Tray ready for removal"));
     }
     else
     {
-        sprintf(msg, "    Position 3: UNSAFE TO UNLOAD - %s", result.unloadTrayPos3UnsafeReason);
+        sprintf(msg, "    Position 3: UNSAFE TO UNLOAD - %s", formatSafetyReason(result, SAFETY_CHECK_UNLOAD_POS3, reason, sizeof(reason)));
         Console.println(msg);
     }
 
     // System Summary
     Console.println(F("\n  System Summary:"));
 
-    if (result.operationSequenceValid && result.trayPositionValid && result.commandStateValid &&
-        (result.targetPositionValid || !operationInProgress))
+    if (isSafetyCheckPassed(result, SAFETY_CHECK_OPERATION_SEQUENCE) && isSafetyCheckPassed(result, SAFETY_CHECK_TRAY_POSITION) && isSafetyCheckPassed(result, SAFETY_CHECK_COMMAND_STATE) &&
+        (isSafetyCheckPassed(result, SAFETY_CHECK_TARGET_POSITION) || !operationInProgress))
     {
         Console.println(F("    Status: NORMAL - System operating correctly"));
 
@@ -1742,33 +1935,44 @@ void printSafetyStatus(const SafetyValidationResult &result)
     {
         Console.println(F("    Status: ALERT - System requires attention"));
 
-        if (!result.operationSequenceValid)
+        if (!isSafetyCheckPassed(result, SAFETY_CHECK_OPERATION_SEQUENCE))
         {
             Console.println(F("    Reason: Operation sequence error detected"));
-            sprintf(msg, "            %s", result.operationSequenceMessage);
+            sprintf(msg, "            %s", formatSafetyReason(result, SAFETY_CHECK_OPERATION_SEQUENCE, reason, sizeof(reason)));
             Console.println(msg);
         }
-        else if (!result.trayPositionValid)
+        else if (!isSafetyCheckPassed(result, SAFETY_CHECK_TRAY_POSITION))
         {
             Console.println(F("    Reason: Tray position error detected"));
-            sprintf(msg, "            %s", result.stateValidationMessage);
+            sprintf(msg, "            %s", formatSafetyReason(result, SAFETY_CHECK_TRAY_POSITION, reason, sizeof(reason)));
             Console.println(msg);
         }
-        else if (!result.targetPositionValid && operationInProgress)
+        else if (!isSafetyCheckPassed(result, SAFETY_CHECK_TARGET_POSITION) && operationInProgress)
         {
             Console.println(F("    Reason: Target position error detected"));
-            sprintf(msg, "            %s", result.stateValidationMessage);
+            sprintf(msg, "            %s", formatSafetyReason(result, SAFETY_CHECK_TARGET_POSITION, reason, sizeof(reason)));
             Console.println(msg);
         }
-        else if (!result.commandStateValid)
+        else if (!isSafetyCheckPassed(result, SAFETY_CHECK_COMMAND_STATE))
         {
             Console.println(F("    Reason: Motor position error detected"));
-            sprintf(msg, "            %s", result.stateValidationMessage);
+            sprintf(msg, "            %s", formatSafetyReason(result, SAFETY_CHECK_COMMAND_STATE, reason, sizeof(reason)));
             Console.println(msg);
         }
 
         Console.println(F("    Recovery: Use 'system,reset' to reset system state and try again"));
     }
+
+    // Incremental evaluator cost
+    if (safetyEvaluatorStats.calls > 0)
+    {
+        unsigned long rulesTotal = safetyEvaluatorStats.rulesEvaluated + safetyEvaluatorStats.rulesSkipped;
+        sprintf(msg, "\n  Evaluator: %lu calls, %lu%% of rules re-evaluated, last %lu us, max %lu us",
+                (unsigned long)safetyEvaluatorStats.calls,
+                rulesTotal > 0 ? (unsigned long)(safetyEvaluatorStats.rulesEvaluated * 100ULL / rulesTotal) : 0UL,
+                safetyEvaluatorStats.lastCallMicros, safetyEvaluatorStats.maxCallMicros);
+        Console.println(msg);
+    }
 }
 
 // Motor position helper functions
@@ -1881,6 +2085,7 @@ void processTrayOperations()
         currentOperation.inProgress = false;
         currentOperation.success = false;
         strncpy(currentOperation.message, "TIMEOUT", sizeof(currentOperation.message));
+        cancelQueuedTrayUnloads("operation timeout");
         return;
     }
 
@@ -1906,1408 +2111,75 @@ void processTrayOperations()
     }
 }
 
-// Process the tray loading operation state machine
+// Process the tray loading operation (steps are defined in TrayWorkflow.cpp)
 void processTrayLoading()
 {
-    // Current time for non-blocking timing checks
-    unsigned long currentMillis = millis();
-
-    // Target position based on tray tracking
-    static double targetPosition = 0;
-    static bool isShuttleNeeded = false;
-
-    // Single message buffer for all sprintf operations in this function
-    char messageBuffer[150];
-
-    switch (currentOperationStep)
-    {
-    case 0: // Initial checks and determine destination
-    {
-        // Capture system state to get latest sensor readings
-        SystemState state = captureSystemState();
-
-        Console.serialInfo(F("Starting tray loading process - initial checks"));
-
-        // Verify tray is at position 1 and locked
-        if (!state.tray1Present)
-        {
-            Console.serialError(F("No tray detected at position 1"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "NO_TRAY", sizeof(currentOperation.message));
-            return;
-        }
-
-        if (!state.tray1Locked)
-        {
-            Console.serialError(F("Tray at position 1 not locked"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TRAY_NOT_LOCKED", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Determine target position based on occupied positions
-        int workflow = determineLoadingWorkflow();
-        if (workflow == 1)
-        {
-            // First tray - goes to position 3
-            targetPosition = POSITION_3_MM;
-            isShuttleNeeded = true;
-            Console.serialInfo(F("First tray - target is position 3"));
-        }
-        else if (workflow == 2)
-        {
-            // Second tray - goes to position 2
-            targetPosition = POSITION_2_MM;
-            isShuttleNeeded = true;
-            Console.serialInfo(F("Second tray - target is position 2"));
-        }
-        else
-        {
-            // Third tray - stays at position 1
-            isShuttleNeeded = false;
-            Console.serialInfo(F("Third tray - keeping at position 1"));
-            // Skip to the final step for position 1
-            updateOperationStep(12); // Special case - skip to completion
-            return;
-        }
-        // Check if target position is occupied
-        if ((targetPosition == POSITION_2_MM && state.tray2Present) ||
-            (targetPosition == POSITION_3_MM && state.tray3Present))
-        {
-            Console.serialError(F("Target position already occupied"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TARGET_POSITION_OCCUPIED", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Check if path is clear to target position
-        if (!isPathClearForLoading(state.currentPositionMm, targetPosition, state))
-        {
-            Console.serialError(F("Path to target position is blocked"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "PATH_BLOCKED", sizeof(currentOperation.message));
-            return;
-        }
-        // All checks pass, advance to next step
-        updateOperationStep(1);
-        Console.serialInfo(F("Initial checks passed, starting tray advancement sequence"));
-
-        // Start verification delay to ensure stable sensor readings
-        sensorVerificationStartTime = currentMillis;
-    }
-    break;
-
-    case 1: // Verify sensor readings after brief delay to ensure stability
-    {
-        // Wait for sensor verification delay
-        if (!timeoutElapsed(currentMillis, sensorVerificationStartTime, SENSOR_VERIFICATION_DELAY_MS))
-        {
-            return;
-        }
-
-        // Double-check sensor readings after stabilization delay
-        SystemState state = captureSystemState();
-
-        // Re-verify tray presence and lock state at position 1
-        if (!state.tray1Present)
-        {
-            Console.serialError(F("Tray at position 1 disappeared during verification"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TRAY1_VERIFICATION_FAILED", sizeof(currentOperation.message));
-            return;
-        }
-
-        if (!state.tray1Locked)
-        {
-            Console.serialError(F("Tray 1 lock status changed during verification"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TRAY1_LOCK_VERIFICATION_FAILED", sizeof(currentOperation.message));
-            return;
-        }
-        // Advance to next step - shuttle locking if needed
-        updateOperationStep(2);
-        Console.serialInfo(F("Sensor verification complete"));
-    }
-    break;
-
-    case 2: // Lock shuttle to grip tray (if needed)
-    {
-        if (!isShuttleNeeded)
-        {
-            // Skip shuttle locking if not moving the tray
-            updateOperationStep(4);
-            Console.serialInfo(F("Skipping shuttle operation (not needed for this move)"));
-            return;
-        }
-
-        // Start locking shuttle
-        DoubleSolenoidValve *shuttleValve = getShuttleValve();
-        if (shuttleValve)
-        {
-            Console.serialInfo(F("Attempting to lock shuttle to grip tray"));
-
-            if (!safeValveOperation(*shuttleValve, *getShuttleSensor(), VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to lock shuttle - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "SHUTTLE_LOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            Console.serialInfo(F("Initiated shuttle lock valve actuation"));
-        }
-        else
-        {
-            Console.serialError(F("Failed to access shuttle valve"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-        // Advance to next step
-        updateOperationStep(3);
-    }
-    break;
-
-    case 3: // Wait for shuttle lock valve actuation
-    {
-        // Wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
-
-        // Valve actuation time has elapsed, verify shuttle is locked
-        SystemState state = captureSystemState();
-        if (!state.shuttleLocked)
-        {
-            Console.serialError(F("Failed to lock shuttle - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "SHUTTLE_LOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-        Console.serialInfo(F("Shuttle lock confirmed successful"));
-
-        // Shuttle is locked, proceed to unlock tray at position 1
-        updateOperationStep(4);
-    }
-    break;
-
-    case 4: // Unlock tray at position 1
-    {
-        // Start unlocking tray 1
-        DoubleSolenoidValve *valve = getTray1Valve();
-        if (valve)
-        {
-            Console.serialInfo(F("Attempting to unlock tray at position 1"));
-
-            if (!safeValveOperation(*valve, *getTray1Sensor(), VALVE_POSITION_UNLOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to unlock tray 1 - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "UNLOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            Console.serialInfo(F("Initiated tray 1 unlock valve actuation"));
-        }
-        else
-        {
-            Console.serialError(F("Failed to access tray 1 valve"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-        // Advance to next step
-        updateOperationStep(5);
-    }
-    break;
-
-    case 5: // Wait for tray unlock valve actuation
-    {
-        // Wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
-
-        // Valve actuation time has elapsed, verify unlock
-        SystemState state = captureSystemState();
-        if (state.tray1Locked)
-        {
-            Console.serialError(F("Failed to unlock tray at position 1 - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "UNLOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        Console.serialInfo(F("Tray 1 unlock confirmed successful"));
-        // Add safety delay after unlocking tray before movement
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(6);
-    }
-    break;
-
-    case 6: // Safety delay after unlocking tray before movement
-    {
-        // Wait for safety delay to elapse
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_AFTER_UNLOCK_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay after unlock completed"));
-        // If we're not moving the tray, skip to completion
-        if (!isShuttleNeeded)
-        {
-            // No movement needed, skip to tray tracking update
-            updateOperationStep(12);
-            return;
-        }
-
-        // Add additional safety delay before movement
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(7);
-    }
-    break;
+    processTrayWorkflow(TRAY_LOADING_WORKFLOW, trayLoadingTiming);
+}
 
-    case 7: // Safety delay before starting motor movement
-    {
-        // Wait for safety delay before movement
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_BEFORE_MOVEMENT_MS))
-        {
-            return;
-        }
+// Process the tray unloading operation (steps are defined in TrayWorkflow.cpp)
+void processTrayUnloading()
+{
+    processTrayWorkflow(TRAY_UNLOADING_WORKFLOW, trayUnloadingTiming);
+}
 
-        Console.serialInfo(F("Safety delay before movement completed"));
+// Process the tray advancement operation state machine
+void processTrayAdvance()
+{
+    // Similar implementation to processTrayLoading
+    // Will be filled in later
 
-        // Start movement to target position
-        if (!moveToPositionMm(targetPosition))
-        {
-            Console.serialError(F("Failed to start movement to target position"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "MOVE_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
+    // For now, just finish immediately
+    currentOperation.inProgress = false;
+    currentOperation.success = true;
+    strncpy(currentOperation.message, "SUCCESS", sizeof(currentOperation.message));
+}
 
-        sprintf(messageBuffer, "Moving tray to position %d", targetPosition);
-        Console.serialInfo(messageBuffer);
-        // Advance to movement monitoring step
-        updateOperationStep(8);
-    }
-    break;
+// Begin an operation and track it
+void beginOperation()
+{
+    // Store previous encoder state if we need to restore it later
+    bool wasEncoderActive = encoderControlActive;
 
-    case 8: // Monitor motor movement and wait for completion
+    // Disable encoder control if it's active
+    if (encoderControlActive)
     {
-        // Check if motor is still moving
-        if (motorState == MOTOR_STATE_MOVING)
-        {
-            // Motor still moving, wait
-            return;
-        }
-
-        Console.serialInfo(F("Motor movement completed"));
-
-        // Motor has stopped, verify position with tolerance
-        SystemState state = captureSystemState();
-        const float POSITION_WARNING_TOLERANCE = 2.0; // 2mm tolerance for warnings vs errors
-        bool reachedTarget = false;
-        float targetPos = 0.0;
-
-        if (targetPosition == POSITION_2_MM)
-        {
-            reachedTarget = isAtPosition(state.currentPositionMm, POSITION_2_MM);
-            targetPos = POSITION_2_MM;
-        }
-        else if (targetPosition == POSITION_3_MM)
-        {
-            reachedTarget = isAtPosition(state.currentPositionMm, POSITION_3_MM);
-            targetPos = POSITION_3_MM;
-        }
-
-        if (!reachedTarget)
-        {
-            // Report the error
-            Console.serialError(F("Motor did not reach target position"));
-
-            // Calculate how far off we are from the target
-            float positionError = abs(state.currentPositionMm - targetPos);
-
-            if (positionError <= POSITION_WARNING_TOLERANCE)
-            {
-                // Close enough to continue - log warning but continue operation
-                sprintf(messageBuffer, "Position error of %.1fmm is within tolerance - continuing", positionError);
-                Console.serialWarning(messageBuffer);
-
-                // Continue with the loading sequence despite small position error
-                safetyDelayStartTime = currentMillis;
-                updateOperationStep(9);
-            }
-            else
-            {
-                // Major position error - mark as failure but still end the operation
-                Console.error(F("TARGET_POSITION_ERROR"));
-                sprintf(messageBuffer, "Position error of %.1fmm exceeds tolerance", positionError);
-                Console.serialError(messageBuffer);
-
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "TARGET_POSITION_FAILURE", sizeof(currentOperation.message));
-
-                // CRITICAL: Always call endOperation() to clean up state
-                // This ensures the system doesn't remain in "busy" state
-                endOperation();
-            }
-            return;
-        }
-
-        // Add safety delay after movement completion
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(9);
+        encoderControlActive = false;
+        Console.serialInfo(F("MPG handwheel control temporarily disabled during automated operation"));
     }
-    break;
-
-    case 9: // Safety delay after motor movement
-    {
-        // Wait for safety delay after movement
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_AFTER_MOVEMENT_MS))
-        {
-            return;
-        }
 
-        Console.serialInfo(F("Safety delay after movement completed"));
-
-        // Unlock shuttle now that we've reached the destination
-        DoubleSolenoidValve *shuttleValve = getShuttleValve();
-        if (shuttleValve)
-        {
-            Console.serialInfo(F("Attempting to unlock shuttle to release tray"));
-
-            if (!safeValveOperation(*shuttleValve, *getShuttleSensor(), VALVE_POSITION_UNLOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to unlock shuttle - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "SHUTTLE_UNLOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            Console.serialInfo(F("Initiated shuttle unlock valve actuation"));
-        }
-        else
-        {
-            Console.serialError(F("Failed to access shuttle valve"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-        // Advance to next step
-        updateOperationStep(10);
-    }
-    break;
+    // Store the encoder state so we can restore it if needed
+    operationEncoderState = wasEncoderActive;
 
-    case 10: // Wait for shuttle unlock valve actuation
-    {
-        // Wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
+    operationInProgress = true;
+    operationStartTime = millis();
+    // Use the updateOperationStep function to keep steps in sync
+    updateOperationStep(0);
+}
 
-        // Valve actuation time has elapsed, verify shuttle is unlocked
-        SystemState state = captureSystemState();
-        if (state.shuttleLocked)
-        {
-            Console.serialError(F("Failed to unlock shuttle - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "SHUTTLE_UNLOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
+// End an operation and update target tracking
+void endOperation()
+{
+    operationInProgress = false;
 
-        Console.serialInfo(F("Shuttle unlock confirmed successful"));
-        // Add safety delay after shuttle unlock
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(11);
-    }
-    break;
+    // Update target tracking in MotorController
+    lastTargetPositionMm = currentTargetPositionMm;
+    lastTargetPulses = currentTargetPulses;
+    hasLastTarget = true;
+    hasCurrentTarget = false; // Clear current target
 
-    case 11: // Safety delay after shuttle unlock, then lock tray at target
+    // Restore encoder control if it was active before
+    if (operationEncoderState)
     {
-        // Wait for safety delay to elapse
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_AFTER_UNLOCK_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay after shuttle unlock completed"));
-
-        // Lock tray at target position
-        DoubleSolenoidValve *valve = NULL;
-        CylinderSensor *sensor = NULL;
-
-        if (targetPosition == POSITION_2_MM)
-        {
-            valve = getTray2Valve();
-            sensor = getTray2Sensor();
-            Console.serialInfo(F("Attempting to lock tray at position 2"));
-        }
-        else if (targetPosition == POSITION_3_MM)
-        {
-            valve = getTray3Valve();
-            sensor = getTray3Sensor();
-            Console.serialInfo(F("Attempting to lock tray at position 3"));
-        }
-
-        if (valve && sensor)
-        {
-            if (!safeValveOperation(*valve, *sensor, VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to lock tray at target position - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "LOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            sprintf(messageBuffer, "Initiated tray lock valve actuation at position %d", targetPosition);
-            Console.serialInfo(messageBuffer);
-        }
-        else
-        {
-            Console.serialError(F("Failed to access target position valve or sensor"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-        // Advance to next step
-        updateOperationStep(12);
+        encoderControlActive = true;
+        Console.serialInfo(F("MPG handwheel control re-enabled after automated operation"));
     }
-    break;
-
-    case 12: // Wait for tray lock valve actuation at target and update tracking
-    {
-        // If we didn't move the tray (3rd tray case), skip lock verification
-        if (!isShuttleNeeded)
-        {
-            // Just update tray tracking for position 1
-            Console.serialInfo(F("Updating tray tracking for position 1"));
-            loadThirdTray();
-
-            // Operation complete
-            Console.serialInfo(F("Tray loading at position 1 completed successfully"));
-            currentOperation.inProgress = false;
-            currentOperation.success = true;
-            strncpy(currentOperation.message, "SUCCESS", sizeof(currentOperation.message));
-
-            // End operation and reset target tracking
-            endOperation();
-            return;
-        }
-
-        // For moved trays, wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
 
-        // Valve actuation time has elapsed, verify lock
-        SystemState state = captureSystemState();
-        bool lockSuccessful = false;
-
-        if (targetPosition == POSITION_2_MM)
-        {
-            lockSuccessful = state.tray2Locked;
-        }
-        else if (targetPosition == POSITION_3_MM)
-        {
-            lockSuccessful = state.tray3Locked;
-        }
-
-        if (!lockSuccessful)
-        {
-            Console.serialError(F("Failed to lock tray at target position - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "LOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        Console.serialInfo(F("Tray lock at target position confirmed successful"));
-
-        // Update tray tracking based on target position
-        if (targetPosition == POSITION_2_MM)
-        {
-            // Move from position 1 to 2
-            Console.serialInfo(F("Updating tray tracking: position 1 -> position 2"));
-            loadSecondTray();
-        }
-        else if (targetPosition == POSITION_3_MM)
-        {
-            // Move from position 1 to 3
-            Console.serialInfo(F("Updating tray tracking: position 1 -> position 3"));
-            loadFirstTray();
-        }
-        // Add safety delay before returning to position 1
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(13);
-    }
-    break;
-
-    case 13: // Safety delay before returning to position 1
-    {
-        // Wait for safety delay to elapse
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_BEFORE_MOVEMENT_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay before return movement completed"));
-
-        // Now return the conveyor to position 1
-        if (!moveToPositionMm(POSITION_1_MM))
-        {
-            Console.serialError(F("Failed to start movement to loading position"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "RETURN_MOVE_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-        // Advance to next step (watching for conveyor return)
-        updateOperationStep(14);
-        Console.serialInfo(F("Returning conveyor to loading position"));
-    }
-    break;
-
-    case 14: // Monitor return movement to position 1
-    {
-        // Wait for motor return to position 1
-        if (motorState == MOTOR_STATE_MOVING)
-        {
-            // Motor still moving, wait
-            return;
-        }
-
-        Console.serialInfo(F("Return movement completed"));
-
-        // Motor has stopped, verify position with tolerance
-        SystemState state = captureSystemState();
-        const float POSITION_WARNING_TOLERANCE = 2.0; // 2mm tolerance for warnings vs errors
-
-        if (!isAtPosition(state.currentPositionMm, POSITION_1_MM))
-        {
-            // Report the error
-            Console.serialError(F("Motor did not return to position 1"));
-
-            // Calculate how far off we are from the target
-            float positionError = abs(state.currentPositionMm - POSITION_1_MM);
-
-            if (positionError <= POSITION_WARNING_TOLERANCE)
-            {
-                // Close enough to continue - log warning but mark operation as successful
-                sprintf(messageBuffer, "Position error of %.1fmm is within tolerance - continuing", positionError);
-                Console.serialWarning(messageBuffer);
-
-                // Operation complete with warning
-                Console.acknowledge(F("TRAY LOADING COMPLETE"));
-                currentOperation.inProgress = false;
-                currentOperation.success = true;
-                strncpy(currentOperation.message, "[INFO] SUCCESS_WITH_POSITION_WARNING", sizeof(currentOperation.message));
-            }
-            else
-            {
-                // Major position error - mark as failure but still end the operation
-                Console.error(F("POSITION_ERROR"));
-                sprintf(messageBuffer, "Position error of %.1fmm exceeds tolerance", positionError);
-                Console.serialError(messageBuffer);
-
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "RETURN_FAILURE", sizeof(currentOperation.message));
-            }
-
-            // Always output load completed counter regardless of success/failure
-            sprintf(messageBuffer, "Total loads completed: %d", trayTracking.totalLoadsCompleted);
-            Console.serialInfo(messageBuffer);
-
-            // CRITICAL: Always call endOperation() to clean up state
-            // This ensures the system doesn't remain in "busy" state
-            endOperation();
-
-            return;
-        }
-
-        // Normal successful completion - no position error
-        Console.acknowledge(F("TRAY LOADING COMPLETE"));
-        currentOperation.inProgress = false;
-        currentOperation.success = true;
-        strncpy(currentOperation.message, "[INFO] SUCCESS", sizeof(currentOperation.message));
-
-        sprintf(messageBuffer, "Total loads completed: %d", trayTracking.totalLoadsCompleted);
-        Console.serialInfo(messageBuffer);
-
-        // Ensure tray tracking matches sensor readings
-        state = captureSystemState();
-        updateTrayTrackingFromSensors(state);
-
-        // End operation and reset target tracking
-        endOperation();
-    }
-    break;
-    }
-}
-
-// Process the tray unloading operation state machine
-void processTrayUnloading()
-{
-    // Current time for non-blocking timing checks
-    unsigned long currentMillis = millis();
-
-    // Variables to track which tray is being unloaded
-    static double sourcePosition = 0;
-    static bool needsMovementToPos1 = false;
-
-    // Single message buffer for all sprintf operations in this function
-    char messageBuffer[150];
-
-    switch (currentOperationStep)
-    {
-    case 0: // Initial checks and determine which tray to unload
-    {
-        // Capture system state to get latest sensor readings
-        SystemState state = captureSystemState();
-
-        Console.serialInfo(F("Starting tray unloading process - initial checks"));
-
-        // Check if there are any trays in the system
-        if (!state.tray1Present && !state.tray2Present && !state.tray3Present)
-        {
-            Console.serialError(F("No trays in system to unload"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "NO_TRAYS", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Determine which workflow to use for unloading
-        int workflow = determineUnloadingWorkflow();
-        if (workflow == 0)
-        {
-            // No trays to unload
-            Console.serialError(F("No trays in system to unload"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "NO_TRAYS", sizeof(currentOperation.message));
-            return;
-        }
-        else if (workflow == 1)
-        {
-            // Tray already at position 1, just need to unlock it
-            needsMovementToPos1 = false;
-            Console.serialInfo(F("Tray at position 1 ready for unloading"));
-            // Skip to tray unlocking step
-            updateOperationStep(11);
-            return;
-        }
-        else if (workflow == 2)
-        {
-            // Need to move tray from position 2 to position 1
-            sourcePosition = POSITION_2_MM;
-            needsMovementToPos1 = true;
-            Console.serialInfo(F("Will move tray from position 2 to position 1 for unloading"));
-        }
-        else if (workflow == 3)
-        {
-            // Need to move tray from position 3 to position 1
-            sourcePosition = POSITION_3_MM;
-            needsMovementToPos1 = true;
-            Console.serialInfo(F("Will move tray from position 3 to position 1 for unloading"));
-        }
-
-        // If we need to move a tray, check path clearance
-        if (needsMovementToPos1)
-        {
-            if (!isPathClearForUnloading(state.currentPositionMm, sourcePosition, state) ||
-                !isPathClearForUnloading(sourcePosition, POSITION_1_MM, state))
-            {
-                Console.serialError(F("Path to source or target position is blocked"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "PATH_BLOCKED", sizeof(currentOperation.message));
-                return;
-            }
-
-            // Start with sensor verification
-            updateOperationStep(1);
-            sensorVerificationStartTime = currentMillis;
-        }
-        else
-        {
-            // No movement needed, verify tray is locked at position 1
-            if (!state.tray1Locked)
-            {
-                Console.serialError(F("Tray at position 1 not locked"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "TRAY_NOT_LOCKED", sizeof(currentOperation.message));
-                return;
-            }
-
-            // Skip to tray unlocking (step 11)
-            updateOperationStep(11);
-        }
-    }
-    break;
-
-    case 1: // Verify sensor readings for stability
-    {
-        // Wait for sensor verification delay
-        if (!timeoutElapsed(currentMillis, sensorVerificationStartTime, SENSOR_VERIFICATION_DELAY_MS))
-        {
-            return;
-        }
-
-        // Double-check sensor readings after stabilization delay
-        SystemState state = captureSystemState();
-
-        // Verify that source position still has a tray
-        if (sourcePosition == POSITION_2_MM && !state.tray2Present)
-        {
-            Console.serialError(F("Tray at position 2 disappeared during verification"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TRAY2_VERIFICATION_FAILED", sizeof(currentOperation.message));
-            return;
-        }
-        else if (sourcePosition == POSITION_3_MM && !state.tray3Present)
-        {
-            Console.serialError(F("Tray at position 3 disappeared during verification"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TRAY3_VERIFICATION_FAILED", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Verify position 1 is still clear
-        if (state.tray1Present)
-        {
-            Console.serialError(F("Position 1 unexpectedly occupied during verification"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "POSITION1_OCCUPIED", sizeof(currentOperation.message));
-            return;
-        }
-
-        // All verified, move to next step
-        updateOperationStep(2);
-        Console.serialInfo(F("Sensor verification complete"));
-    }
-    break;
-
-    case 2: // Move to source position (2 or 3)
-    {
-        // Start movement to source position
-        if (!moveToPositionMm(sourcePosition))
-        {
-            Console.serialError(F("Failed to start movement to source position"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "MOVE_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        sprintf(messageBuffer, "Moving to position %d", sourcePosition);
-        Console.serialInfo(messageBuffer);
-
-        // Advance to movement monitoring step
-        updateOperationStep(3);
-    }
-    break;
-
-    case 3: // Monitor motor movement to source position
-    {
-        // Check if motor is still moving
-        if (motorState == MOTOR_STATE_MOVING)
-        {
-            // Motor still moving, wait
-            return;
-        }
-
-        Console.serialInfo(F("Reached source position"));
-
-        // Motor has stopped, verify position with tolerance
-        SystemState state = captureSystemState();
-        const float POSITION_WARNING_TOLERANCE = 2.0; // 2mm tolerance for warnings vs errors
-        bool reachedSource = false;
-        float targetPosition = 0.0;
-
-        if (sourcePosition == POSITION_2_MM)
-        {
-            reachedSource = isAtPosition(state.currentPositionMm, POSITION_2_MM);
-            targetPosition = POSITION_2_MM;
-        }
-        else if (sourcePosition == POSITION_3_MM)
-        {
-            reachedSource = isAtPosition(state.currentPositionMm, POSITION_3_MM);
-            targetPosition = POSITION_3_MM;
-        }
-
-        if (!reachedSource)
-        {
-            // Report the error
-            Console.serialError(F("Motor did not reach source position"));
-
-            // Calculate how far off we are from the target
-            float positionError = abs(state.currentPositionMm - targetPosition);
-
-            if (positionError <= POSITION_WARNING_TOLERANCE)
-            {
-                // Close enough to continue - log warning but continue operation
-                sprintf(messageBuffer, "Position error of %.2fmm is within tolerance - continuing", positionError);
-                Console.serialWarning(messageBuffer);
-
-                // Continue with the unloading sequence despite small position error
-                safetyDelayStartTime = currentMillis;
-                updateOperationStep(4);
-            }
-            else
-            {
-                // Major position error - mark as failure but still end the operation
-                Console.error(F("SOURCE_POSITION_ERROR"));
-                sprintf(messageBuffer, "Position error of %.2fmm exceeds tolerance", positionError);
-                Console.serialError(messageBuffer);
-
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "SOURCE_POSITION_FAILURE", sizeof(currentOperation.message));
-
-                // CRITICAL: Always call endOperation() to clean up state
-                endOperation();
-            }
-            return;
-        }
-
-        // Add safety delay after movement
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(4);
-    }
-    break;
-
-    case 4: // Safety delay after reaching source position
-    {
-        // Wait for safety delay to elapse
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_AFTER_MOVEMENT_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay after movement completed"));
-
-        // Start locking shuttle to grip tray
-        DoubleSolenoidValve *shuttleValve = getShuttleValve();
-        if (shuttleValve)
-        {
-            Console.serialInfo(F("Attempting to lock shuttle to grip tray"));
-
-            if (!safeValveOperation(*shuttleValve, *getShuttleSensor(), VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to lock shuttle - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "SHUTTLE_LOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            Console.serialInfo(F("Initiated shuttle lock valve actuation"));
-        }
-        else
-        {
-            Console.serialError(F("Failed to access shuttle valve"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Advance to next step
-        updateOperationStep(5);
-    }
-    break;
-
-    case 5: // Wait for shuttle lock valve actuation
-    {
-        // Wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
-
-        // Valve actuation time has elapsed, verify shuttle is locked
-        SystemState state = captureSystemState();
-        if (!state.shuttleLocked)
-        {
-            Console.serialError(F("Failed to lock shuttle - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "SHUTTLE_LOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        Console.serialInfo(F("Shuttle lock confirmed successful"));
-
-        // Determine which valve to unlock based on source position
-        DoubleSolenoidValve *valve = NULL;
-        CylinderSensor *sensor = NULL;
-
-        if (sourcePosition == POSITION_2_MM)
-        {
-            valve = getTray2Valve();
-            sensor = getTray2Sensor();
-            Console.serialInfo(F("Attempting to unlock tray at position 2"));
-        }
-        else
-        {
-            valve = getTray3Valve();
-            sensor = getTray3Sensor();
-            Console.serialInfo(F("Attempting to unlock tray at position 3"));
-        }
-
-        if (valve && sensor)
-        {
-            if (!safeValveOperation(*valve, *sensor, VALVE_POSITION_UNLOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to unlock tray - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "UNLOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            Console.serialInfo(F("Initiated tray unlock valve actuation"));
-        }
-        else
-        {
-            Console.serialError(F("Failed to access valve or sensor"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Advance to next step
-        updateOperationStep(6);
-    }
-    break;
-
-    case 6: // Wait for tray unlock valve actuation
-    {
-        // Wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
-
-        // Valve actuation time has elapsed, verify unlock
-        SystemState state = captureSystemState();
-        bool unlockSuccessful = false;
-
-        if (sourcePosition == POSITION_2_MM)
-        {
-            unlockSuccessful = !state.tray2Locked;
-        }
-        else if (sourcePosition == POSITION_3_MM)
-        {
-            unlockSuccessful = !state.tray3Locked;
-        }
-
-        if (!unlockSuccessful)
-        {
-            Console.serialError(F("Failed to unlock tray - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "UNLOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        Console.serialInfo(F("Tray unlock confirmed successful"));
-
-        // Add safety delay after unlocking
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(7);
-    }
-    break;
-
-    case 7: // Safety delay after tray unlock
-    {
-        // Wait for safety delay to elapse
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_AFTER_UNLOCK_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay after unlock completed"));
-
-        // Add additional safety delay before movement
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(8);
-    }
-    break;
-
-    case 8: // Move to position 1 with the tray
-    {
-        // Wait for safety delay before movement
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_BEFORE_MOVEMENT_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay before movement completed"));
-
-        // Start movement to position 1
-        if (!moveToPositionMm(POSITION_1_MM))
-        {
-            Console.serialError(F("Failed to start movement to position 1"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "MOVE_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        Console.serialInfo(F("Moving tray to position 1 for unloading"));
-
-        // Advance to movement monitoring step
-        updateOperationStep(9);
-    }
-    break;
-
-    case 9: // Monitor motor movement to position 1
-    {
-        // Check if motor is still moving
-        if (motorState == MOTOR_STATE_MOVING)
-        {
-            // Motor still moving, wait
-            return;
-        }
-
-        Console.serialInfo(F("Reached position 1"));
-
-        // Motor has stopped, verify position with tolerance
-        SystemState state = captureSystemState();
-        const float POSITION_WARNING_TOLERANCE = 2.0; // 2mm tolerance for warnings vs errors
-
-        if (!isAtPosition(state.currentPositionMm, POSITION_1_MM))
-        {
-            // Report the error
-            Console.serialError(F("Motor did not reach position 1"));
-
-            // Calculate how far off we are from the target
-            float positionError = abs(state.currentPositionMm - POSITION_1_MM);
-
-            if (positionError <= POSITION_WARNING_TOLERANCE)
-            {
-                // Close enough to continue - log warning but mark operation as successful
-                sprintf(messageBuffer, "Position error of %.2fmm is within tolerance - continuing", positionError);
-                Console.serialWarning(messageBuffer);
-
-                // Continue with the unloading sequence despite small position error
-                safetyDelayStartTime = currentMillis;
-                updateOperationStep(10);
-            }
-            else
-            {
-                // Major position error - mark as failure but still end the operation
-                Console.error(F("POSITION_ERROR"));
-                sprintf(messageBuffer, "Position error of %.2fmm exceeds tolerance", positionError);
-                Console.serialError(messageBuffer);
-
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "POSITION_FAILURE", sizeof(currentOperation.message));
-
-                // CRITICAL: Always call endOperation() to clean up state
-                // This ensures the system doesn't remain in "busy" state
-                endOperation();
-            }
-            return;
-        }
-
-        // Add safety delay after movement
-        safetyDelayStartTime = currentMillis;
-        updateOperationStep(10);
-    }
-    break;
-
-    case 10: // Safety delay after movement to position 1, unlock shuttle, lock tray
-    {
-        // Wait for safety delay after movement
-        if (!timeoutElapsed(currentMillis, safetyDelayStartTime, SAFETY_DELAY_AFTER_MOVEMENT_MS))
-        {
-            return;
-        }
-
-        Console.serialInfo(F("Safety delay after movement completed"));
-
-        // Unlock shuttle to release tray
-        DoubleSolenoidValve *shuttleValve = getShuttleValve();
-        if (shuttleValve)
-        {
-            Console.serialInfo(F("Attempting to unlock shuttle to release tray"));
-
-            if (!safeValveOperation(*shuttleValve, *getShuttleSensor(), VALVE_POSITION_UNLOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-            {
-                Console.serialError(F("Failed to unlock shuttle - sensor didn't confirm"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "SHUTTLE_UNLOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-            valveActuationStartTime = currentMillis;
-            Console.serialInfo(F("Initiated shuttle unlock valve actuation"));
-        }
-        else
-        {
-            Console.serialError(F("Failed to access shuttle valve"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Wait for shuttle unlock and then proceed to next step
-        updateOperationStep(11);
-    }
-    break;
-
-    case 11: // Wait for shuttle unlock, then lock tray at position 1
-    {
-        if (needsMovementToPos1)
-        {
-            // For trays that were moved, wait for shuttle unlock to complete
-            if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-            {
-                // Not enough time has elapsed, check again next cycle
-                return;
-            }
-
-            // Verify shuttle is unlocked
-            SystemState state = captureSystemState();
-            if (state.shuttleLocked)
-            {
-                Console.serialError(F("Failed to unlock shuttle - verification failed"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "SHUTTLE_UNLOCK_FAILURE", sizeof(currentOperation.message));
-                return;
-            }
-
-            Console.serialInfo(F("Shuttle unlock confirmed successful"));
-
-            // Lock tray at position 1
-            DoubleSolenoidValve *valve = getTray1Valve();
-            CylinderSensor *sensor = getTray1Sensor();
-
-            if (valve && sensor)
-            {
-                Console.serialInfo(F("Attempting to lock tray at position 1"));
-
-                if (!safeValveOperation(*valve, *sensor, VALVE_POSITION_LOCK, VALVE_SENSOR_CONFIRMATION_TIMEOUT_MS))
-                {
-                    Console.serialError(F("Failed to lock tray at position 1 - sensor didn't confirm"));
-                    currentOperation.inProgress = false;
-                    currentOperation.success = false;
-                    strncpy(currentOperation.message, "LOCK_FAILURE", sizeof(currentOperation.message));
-                    return;
-                }
-                valveActuationStartTime = currentMillis;
-                Console.serialInfo(F("Initiated tray lock valve actuation at position 1"));
-            }
-            else
-            {
-                Console.serialError(F("Failed to access tray 1 valve or sensor"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "VALVE_ACCESS_ERROR", sizeof(currentOperation.message));
-                return;
-            }
-
-            // Advance to next step to wait for lock confirmation
-            updateOperationStep(12);
-        }
-        else
-        {
-            // For trays already at position 1, just verify it's locked
-            SystemState state = captureSystemState();
-            if (!state.tray1Locked)
-            {
-                Console.serialError(F("Tray at position 1 not locked"));
-                currentOperation.inProgress = false;
-                currentOperation.success = false;
-                strncpy(currentOperation.message, "TRAY_NOT_LOCKED", sizeof(currentOperation.message));
-                return;
-            }
-
-            // Skip ahead to unlock tray for removal
-            updateOperationStep(13);
-        }
-    }
-    break;
-
-    case 12: // Wait for tray lock at position 1, update tracking
-    {
-        // Wait for valve actuation time to elapse
-        if (!timeoutElapsed(currentMillis, valveActuationStartTime, VALVE_ACTUATION_TIME_MS))
-        {
-            // Not enough time has elapsed, check again next cycle
-            return;
-        }
-
-        // Verify lock
-        SystemState state = captureSystemState();
-        if (!state.tray1Locked)
-        {
-            Console.serialError(F("Failed to lock tray at position 1 - verification failed"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "LOCK_FAILURE", sizeof(currentOperation.message));
-            return;
-        }
-
-        Console.serialInfo(F("Tray lock at position 1 confirmed successful"));
-
-        // Update tray tracking based on source position
-        if (sourcePosition == POSITION_2_MM)
-        {
-            unloadSecondTray();
-        }
-        else if (sourcePosition == POSITION_3_MM)
-        {
-            unloadThirdTray();
-        }
-
-        // Now proceed to final unlock for removal
-        updateOperationStep(13);
-    }
-    break;
-
-    case 13: // NEW STEP: Notify that tray is ready for gripping (but keep it locked)
-    {
-        // Verify again that the tray is locked
-        SystemState state = captureSystemState();
-        if (!state.tray1Locked)
-        {
-            Console.serialError(F("Tray at position 1 not properly locked"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "TRAY_NOT_LOCKED", sizeof(currentOperation.message));
-            return;
-        }
-
-        // Verify shuttle retraction
-        if (state.shuttleLocked)
-        {
-            Console.serialError(F("Shuttle unexpectedly locked - must be retracted for robot access"));
-            currentOperation.inProgress = false;
-            currentOperation.success = false;
-            strncpy(currentOperation.message, "SHUTTLE_NOT_RETRACTED", sizeof(currentOperation.message));
-            return;
-        }
-
-        // All good - tray is at position 1, locked, and shuttle is retracted
-        Console.acknowledge(F("TRAY_READY_FOR_GRIP"));
-        Console.serialInfo(F("Tray locked at position 1 and ready for robot to grip"));
-
-        // Operation complete - Mitsubishi will need to send tray,gripped command before removing
-        currentOperation.inProgress = false;
-        currentOperation.success = true;
-        strncpy(currentOperation.message, "TRAY_READY_FOR_GRIP", sizeof(currentOperation.message));
-
-        // Ensure tray tracking matches sensor readings
-        updateTrayTrackingFromSensors(state);
-
-        // End operation
-        endOperation();
-    }
-    break;
-    }
-}
-
-// Process the tray advancement operation state machine
-void processTrayAdvance()
-{
-    // Similar implementation to processTrayLoading
-    // Will be filled in later
-
-    // For now, just finish immediately
-    currentOperation.inProgress = false;
-    currentOperation.success = true;
-    strncpy(currentOperation.message, "SUCCESS", sizeof(currentOperation.message));
-}
-
-// Begin an operation and track it
-void beginOperation()
-{
-    // Store previous encoder state if we need to restore it later
-    bool wasEncoderActive = encoderControlActive;
-
-    // Disable encoder control if it's active
-    if (encoderControlActive)
-    {
-        encoderControlActive = false;
-        Console.serialInfo(F("MPG handwheel control temporarily disabled during automated operation"));
-    }
-
-    // Store the encoder state so we can restore it if needed
-    operationEncoderState = wasEncoderActive;
-
-    operationInProgress = true;
-    operationStartTime = millis();
-    // Use the updateOperationStep function to keep steps in sync
-    updateOperationStep(0);
-}
-
-// End an operation and update target tracking
-void endOperation()
-{
-    operationInProgress = false;
-
-    // Update target tracking in MotorController
-    lastTargetPositionMm = currentTargetPositionMm;
-    lastTargetPulses = currentTargetPulses;
-    hasLastTarget = true;
-    hasCurrentTarget = false; // Clear current target
-
-    // Restore encoder control if it was active before
-    if (operationEncoderState)
-    {
-        encoderControlActive = true;
-        Console.serialInfo(F("MPG handwheel control re-enabled after automated operation"));
-    }
-
-    // Clear any pending new command flag
-    newCommandReceived = false;
+    // Clear any pending new command flag
+    newCommandReceived = false;
 
     // Synchronize tray tracking with physical sensors
-    SystemState state = captureSystemState();
+    SystemState state = getSystemState();
     updateTrayTrackingFromSensors(state);
 }
 
@@ -3438,6 +2310,8 @@ void resetSystemState()
 
     // End operation to update target tracking (if needed beyond what init does)
     endOperation();
+    resetTrayWorkflow();
+    cancelQueuedTrayUnloads("system reset");
 
     // Reset operation counters
     trayTracking.totalLoadsCompleted = 0;
@@ -3527,6 +2401,8 @@ void resetSystemState()
     // Always update tray tracking regardless of motor state
     SystemState state = captureSystemState();
     updateTrayTrackingFromSensors(state);
+    invalidateSystemState(); // Later readers in this scan see the post-reset state
+    invalidateSafetyRules(); // Re-run every safety rule against the post-reset state
     Console.serialInfo(F("Tray tracking synchronized with sensors"));
 
     // Log the reset action with appropriate status
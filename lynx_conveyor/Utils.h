@@ -128,68 +128,109 @@ struct OperationStatus
     char message[32];
 };
 
+// Safety checks - each check owns one bit of SafetyValidationResult::unsafeMask
+enum SafetyCheck
+{
+    SAFETY_CHECK_MOVE = 0,
+    SAFETY_CHECK_PRESSURE,
+    SAFETY_CHECK_LOCK_TRAY1,
+    SAFETY_CHECK_LOCK_TRAY2,
+    SAFETY_CHECK_LOCK_TRAY3,
+    SAFETY_CHECK_LOCK_SHUTTLE,
+    SAFETY_CHECK_UNLOCK_SHUTTLE,
+    SAFETY_CHECK_LOAD_POS1,
+    SAFETY_CHECK_LOAD_POS2,
+    SAFETY_CHECK_LOAD_POS3,
+    SAFETY_CHECK_UNLOAD_POS1,
+    SAFETY_CHECK_UNLOAD_POS2,
+    SAFETY_CHECK_UNLOAD_POS3,
+    SAFETY_CHECK_UNLOCK_GRIPPED_TRAY,
+    SAFETY_CHECK_LOCK_OPERATION,     // A recent lock operation failed
+    SAFETY_CHECK_UNLOCK_OPERATION,   // A recent unlock operation failed
+    SAFETY_CHECK_COMMAND_STATE,      // Position matches commanded position
+    SAFETY_CHECK_TRAY_POSITION,      // Tray presence matches motor position
+    SAFETY_CHECK_TARGET_POSITION,
+    SAFETY_CHECK_ACCEPT_COMMAND,
+    SAFETY_CHECK_OPERATION_TIMEOUT,
+    SAFETY_CHECK_OPERATION_SEQUENCE,
+    SAFETY_CHECK_COUNT
+};
+
+// Reason codes - rendered to text only when printed (see formatSafetyReason)
+enum SafetyReason
+{
+    SAFETY_REASON_NONE = 0,
+
+    // Movement
+    SAFETY_REASON_TRAY1_LOCKED_AT_POSITION,
+    SAFETY_REASON_TRAY2_LOCKED_AT_POSITION,
+    SAFETY_REASON_TRAY3_LOCKED_AT_POSITION,
+    SAFETY_REASON_NOT_HOMED,
+    SAFETY_REASON_ESTOP_ACTIVE,
+    SAFETY_REASON_CCIO_NOT_DETECTED,
+    SAFETY_REASON_MOTOR_FAULTED,
+
+    // Pneumatics
+    SAFETY_REASON_PRESSURE_LOW,
+    SAFETY_REASON_PRESSURE_INSUFFICIENT,
+
+    // Locking, loading and unloading
+    SAFETY_REASON_NO_TRAY,
+    SAFETY_REASON_MOTOR_MOVING,
+    SAFETY_REASON_SHUTTLE_LOCKED,
+    SAFETY_REASON_POSITION_OCCUPIED,
+    SAFETY_REASON_ALL_POSITIONS_OCCUPIED,
+    SAFETY_REASON_UNLOAD_TRAY1_FIRST,
+    SAFETY_REASON_UNLOAD_TRAY2_FIRST,
+    SAFETY_REASON_NO_TRAY_AT_POS1,
+    SAFETY_REASON_TRAY_NOT_LOCKED,
+    SAFETY_REASON_SHUTTLE_NOT_RETRACTED,
+    SAFETY_REASON_OPERATION_IN_PROGRESS,
+
+    // Lock/unlock operation failures (details come from lastLock/UnlockFailureDetails)
+    SAFETY_REASON_LOCK_FAILED,
+    SAFETY_REASON_UNLOCK_FAILED,
+
+    // State and sequence validation
+    SAFETY_REASON_UNEXPECTED_MOVEMENT,
+    SAFETY_REASON_UNEXPECTED_SHUTTLE_LOCK,
+    SAFETY_REASON_POSITION_MISMATCH,
+    SAFETY_REASON_TRAY1_MISSING,
+    SAFETY_REASON_TARGET_OUT_OF_RANGE,
+    SAFETY_REASON_NO_TARGET,
+    SAFETY_REASON_COMMAND_REJECTED,
+    SAFETY_REASON_OPERATION_TIMEOUT,
+    SAFETY_REASON_STEP_MISMATCH
+};
+
 // Safety validation results structure
 struct SafetyValidationResult
 {
-    // Motor movement safety flags
-    bool safeToMove;
-    char moveUnsafeReason[64];
-
-    // Tray locking safety flags
-    bool safeToLockTray1;
-    bool safeToLockTray2;
-    bool safeToLockTray3;
-    char tray1LockUnsafeReason[64];
-    char tray2LockUnsafeReason[64];
-    char tray3LockUnsafeReason[64];
-
-    // Shuttle actuation safety flags
-    bool safeToLockShuttle;
-    bool safeToUnlockShuttle;
-    char shuttleLockUnsafeReason[64];
-    char shuttleUnlockUnsafeReason[64];
-
-    bool pneumaticPressureSufficient;
-    char pressureUnsafeReason[64];
-
-    // Tray loading safety flags
-    bool safeToLoadTrayToPos1;
-    bool safeToLoadTrayToPos2;
-    bool safeToLoadTrayToPos3;
-    char loadTrayPos1UnsafeReason[64];
-    char loadTrayPos2UnsafeReason[64];
-    char loadTrayPos3UnsafeReason[64];
-
-    // Tray unloading safety flags
-    bool safeToUnloadTrayFromPos1;
-    bool safeToUnloadTrayFromPos2;
-    bool safeToUnloadTrayFromPos3;
-    char unloadTrayPos1UnsafeReason[64];
-    char unloadTrayPos2UnsafeReason[64];
-    char unloadTrayPos3UnsafeReason[64];
-    bool safeToUnlockGrippedTray;
-    char grippedTrayUnlockUnsafeReason[64];
-
-    // System state validation
-    bool commandStateValid;
-    bool trayPositionValid;
-    bool targetPositionValid;
-    char stateValidationMessage[128];
-
-    // Operational sequence validation
-    bool safeToAcceptNewCommand;
-    bool operationWithinTimeout;
-    bool operationSequenceValid;
-    char operationSequenceMessage[128];
+    // Verdicts: bit N set means SafetyCheck N failed
+    uint32_t unsafeMask;
+    uint8_t reasons[SAFETY_CHECK_COUNT]; // SafetyReason per check
 
     // Abort reason - directly indicates what type of abort should be triggered
     AbortReason failureReason;
 
-    // Lock/unlock operation status
-    bool lockOperationSuccessful;   // Set to false if a lock operation recently failed
-    bool unlockOperationSuccessful; // Set to false if an unlock operation recently failed
-    char lockFailureDetails[128];      // Details about which lock operation failed
-    char unlockFailureDetails[128];    // Details about which unlock operation failed
+    // Context captured at evaluation, used only to render reason text
+    OperationType operationType;
+    bool operationActive;
+    int operationStep;
+    int expectedStep;
+    MotorState motorState;
+    double positionMm;
+    double commandedMm;
+};
+
+// Incremental evaluator statistics (shown by 'system,safety')
+struct SafetyEvaluatorStats
+{
+    uint32_t calls;
+    uint32_t rulesEvaluated;          // Rules re-run because an input changed
+    uint32_t rulesSkipped;            // Rules whose cached verdicts were reused
+    unsigned long lastCallMicros;
+    unsigned long maxCallMicros;
 };
 
 //=============================================================================
@@ -201,6 +242,11 @@ extern const unsigned long SAFETY_DELAY_BEFORE_MOVEMENT_MS;
 extern const unsigned long SAFETY_DELAY_AFTER_MOVEMENT_MS;
 extern const unsigned long SENSOR_VERIFICATION_DELAY_MS;
 
+// Delta system,state rendering
+#define STATE_RENDER_MAX_LINES 40         // Lines tracked per caller (report has 32)
+#define STATE_RENDER_KEYFRAME_INTERVAL 10 // Full report after this many delta reports
+#define STATE_RENDER_KEYFRAME_MS 60000    // ... or when the last full report is older than this
+
 //=============================================================================
 // SYSTEM STATE TRACKING
 //=============================================================================
@@ -218,9 +264,6 @@ extern int expectedOperationStep;        // Expected step at this point
 extern bool operationEncoderState;       // True if encoder control is active during operation
 extern bool homingEncoderState;          // Stores the encoder control state before homing begins
 
-// Timing and state machine variables
-extern unsigned long valveActuationStartTime;
-
 // Lock/unlock operation status tracking
 extern bool lastLockOperationFailed;
 extern bool lastUnlockOperationFailed;
@@ -233,6 +276,7 @@ extern unsigned long unlockFailureTimestamp;
 extern TrayTracking trayTracking;
 extern TrayStatus trayStatus;
 extern OperationStatus currentOperation;
+extern SafetyEvaluatorStats safetyEvaluatorStats;
 
 //=============================================================================
 // TIME HANDLING FUNCTIONS
@@ -256,17 +300,32 @@ void formatAbsoluteTime(unsigned long timeMs, char *buffer);
 // SYSTEM STATE FUNCTIONS
 //=============================================================================
 // System state tracking functions
-SystemState captureSystemState();
-void printSystemState(const SystemState &state);
+SystemState captureSystemState();       // Fresh hardware read (use for before/after comparisons)
+void printSystemState(const SystemState &state, bool deltaOnly = false);
+void resetSystemStateRender(int clientIndex); // Next delta report for this caller is a full one (-1 = serial)
 void initSystemStateVariables();
 void resetSystemState(); // Function to reset the system state after a failure
 
+// Scan-coherent snapshot: sensors, E-stop and HLFB are read at most once per
+// loop iteration; motor/tray tracking fields always mirror the live variables
+void beginSystemStateScan();             // Call once at the top of loop()
+const SystemState &getSystemState();     // Snapshot for the current scan
+void invalidateSystemState();            // Force a re-read on the next getSystemState()
+
 //=============================================================================
 // SAFETY FUNCTIONS
 //=============================================================================
 // Safety validation functions
 SafetyValidationResult validateSafety(const SystemState &state);
 void printSafetyStatus(const SafetyValidationResult &result);
+void invalidateSafetyRules(); // Force every rule to re-evaluate on the next call
+const char *formatSafetyReason(const SafetyValidationResult &result, SafetyCheck check,
+                               char *buffer, size_t bufferSize);
+
+inline bool isSafetyCheckPassed(const SafetyValidationResult &result, SafetyCheck check)
+{
+    return (result.unsafeMask & (1UL << check)) == 0;
+}
 void abortOperation(AbortReason reason);
 const char *getAbortReasonString(AbortReason reason);
 
@@ -389,59 +389,66 @@ bool safeValveOperation(DoubleSolenoidValve &valve, CylinderSensor &sensor,
     // If operation failed, record it with valve type and position info
     if (!success)
     {
-        // Determine valve type and position
-        const char *valveType = "unknown";
-        int valvePosition = 0;
+        recordValveFailure(valve, targetPosition);
+    }
 
-        // Compare valve address to determine which valve it is
-        if (&valve == getTray1Valve())
-        {
-            valveType = "tray";
-            valvePosition = 1;
-        }
-        else if (&valve == getTray2Valve())
-        {
-            valveType = "tray";
-            valvePosition = 2;
-        }
-        else if (&valve == getTray3Valve())
-        {
-            valveType = "tray";
-            valvePosition = 3;
-        }
-        else if (&valve == getShuttleValve())
-        {
-            valveType = "shuttle";
-            valvePosition = 0;
-        }
+    return success;
+}
 
-        // Record the failure based on operation type
-        if (targetPosition == VALVE_POSITION_LOCK)
-        {
-            // Call the function to record a lock failure
-            lastLockOperationFailed = true;
-            snprintf_P(lastLockFailureDetails, sizeof(lastLockFailureDetails),
-                      PSTR("Failed to lock %s at position %d - sensor didn't confirm"),
-                      valveType, valvePosition);
-            lockFailureTimestamp = millis(); // Record the timestamp
-        }
-        else
-        {
-            // Call the function to record an unlock failure
-            lastUnlockOperationFailed = true;
-            snprintf_P(lastUnlockFailureDetails, sizeof(lastUnlockFailureDetails),
-                      PSTR("Failed to unlock %s at position %d - sensor didn't confirm"),
-                      valveType, valvePosition);
-            unlockFailureTimestamp = millis(); // Record the timestamp
-        }
+// Record a lock/unlock failure (sensor didn't confirm) for safety validation
+// Shared by safeValveOperation and non-blocking callers that poll the sensor themselves
+void recordValveFailure(DoubleSolenoidValve &valve, ValvePosition targetPosition)
+{
+    // Determine valve type and position
+    const char *valveType = "unknown";
+    int valvePosition = 0;
 
-        char msg[200];
-        sprintf(msg, "Valve operation failed: %s",
-                targetPosition == VALVE_POSITION_LOCK ? lastLockFailureDetails : lastUnlockFailureDetails);
-        Console.serialError(msg);
+    // Compare valve address to determine which valve it is
+    if (&valve == getTray1Valve())
+    {
+        valveType = "tray";
+        valvePosition = 1;
+    }
+    else if (&valve == getTray2Valve())
+    {
+        valveType = "tray";
+        valvePosition = 2;
+    }
+    else if (&valve == getTray3Valve())
+    {
+        valveType = "tray";
+        valvePosition = 3;
+    }
+    else if (&valve == getShuttleValve())
+    {
+        valveType = "shuttle";
+        valvePosition = 0;
     }
 
-    return success;
+    // Record the failure based on operation type
+    if (targetPosition == VALVE_POSITION_LOCK)
+    {
+        // Call the function to record a lock failure
+        lastLockOperationFailed = true;
+        snprintf_P(lastLockFailureDetails, sizeof(lastLockFailureDetails),
+                  PSTR("Failed to lock %s at position %d - sensor didn't confirm"),
+                  valveType, valvePosition);
+        lockFailureTimestamp = millis(); // Record the timestamp
+    }
+    else
+    {
+        // Call the function to record an unlock failure
+        lastUnlockOperationFailed = true;
+        snprintf_P(lastUnlockFailureDetails, sizeof(lastUnlockFailureDetails),
+                  PSTR("Failed to unlock %s at position %d - sensor didn't confirm"),
+                  valveType, valvePosition);
+        unlockFailureTimestamp = millis(); // Record the timestamp
+    }
+
+    char msg[200];
+    sprintf(msg, "Valve operation failed: %s",
+            targetPosition == VALVE_POSITION_LOCK ? lastLockFailureDetails : lastUnlockFailureDetails);
+    Console.serialError(msg);
 }
 
 // ----------------- Convenience functions -----------------
@@ -169,6 +169,7 @@ void withAllValves(void (*operation)(DoubleSolenoidValve &));
 bool waitForSensor(CylinderSensor &sensor, bool expectedState, unsigned long timeoutMs);
 bool safeValveOperation(DoubleSolenoidValve &valve, CylinderSensor &sensor,
                         ValvePosition targetPosition, unsigned long timeoutMs);
+void recordValveFailure(DoubleSolenoidValve &valve, ValvePosition targetPosition);
 
 //-----------------------------------------------------------------------------
 // Accessor Functions
@@ -222,6 +222,7 @@ modifications or reflashing firmware.
 #include "OutputManager.h"
 #include "EthernetController.h"
 #include "PositionConfig.h"
+#include "StatusEvents.h"
 
 // Specify which ClearCore serial COM port is connected to the CCIO-8 board
 #define CcioPort ConnectorCOM0
@@ -293,7 +294,9 @@ void loop()
     handleEStop();
 
     // Always capture current system state - it's the foundation of safety
-    SystemState currentState = captureSystemState();
+    // Sensors are read once here and shared by every consumer in this scan
+    beginSystemStateScan();
+    SystemState currentState = getSystemState();
 
     // Update tray tracking from physical sensors each cycle
     updateTrayTrackingFromSensors(currentState);
@@ -334,10 +337,13 @@ void loop()
 
     // Check for safety violations that require immediate action
     if (operationInProgress &&
-        (!safety.operationWithinTimeout || !safety.operationSequenceValid))
+        (!isSafetyCheckPassed(safety, SAFETY_CHECK_OPERATION_TIMEOUT) ||
+         !isSafetyCheckPassed(safety, SAFETY_CHECK_OPERATION_SEQUENCE)))
     {
+        char reason[160];
         char errorMsg[200];
-        sprintf(errorMsg, "SAFETY VIOLATION: %s", safety.operationSequenceMessage);
+        sprintf(errorMsg, "SAFETY VIOLATION: %s",
+                formatSafetyReason(safety, SAFETY_CHECK_OPERATION_SEQUENCE, reason, sizeof(reason)));
         Console.error(errorMsg);
 
         // Emergency stop or other recovery action
@@ -348,6 +354,9 @@ void loop()
     // Process tray operations if any are in progress
     processTrayOperations();
 
+    // Push changes to subscribed Ethernet clients
+    publishStatusEvents(currentState);
+
     // Store current state as previous for next cycle
     previousState = currentState;
 
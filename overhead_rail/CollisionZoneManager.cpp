@@ -0,0 +1,330 @@
+#include "CollisionZoneManager.h"
+#include "MotorController.h"
+#include "ValveController.h"
+#include "RailAutomation.h"
+#include "Logging.h"
+
+//=============================================================================
+// CONSOLE OUTPUT FORMAT STRINGS
+//=============================================================================
+
+const char FMT_ZONE_BLOCKED[] PROGMEM = "Rail %d: Shared zone busy - Rail %d %s";
+const char FMT_ZONE_QUEUED[] PROGMEM = "Rail %d: Move to %.1fmm queued until shared zone clears";
+const char FMT_ZONE_DISPATCH[] PROGMEM = "Rail %d: Shared zone clear - starting queued move to %.1fmm";
+const char FMT_ZONE_QUEUE_EXPIRED[] PROGMEM = "Rail %d: Queued move to %.1fmm expired waiting for shared zone";
+const char FMT_ZONE_RESERVATION[] PROGMEM = "  Rail %d: %s %.1f-%.1fmm%s";
+const char FMT_ZONE_QUEUE_ENTRY[] PROGMEM = "  Rail %d queued: %.1fmm (%s, waiting %lums)";
+const char FMT_ZONE_STATS[] PROGMEM = "  Granted: %lu  Blocked: %lu  Concurrent: %lu  Queued dispatched: %lu";
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+
+ZoneReservation railReservations[2] = {{0}, {0}};
+QueuedRailMove queuedRailMoves[2] = {{0}, {0}};
+ZoneReservationStats zoneStats = {0};
+
+//=============================================================================
+// INTERNAL HELPERS
+//=============================================================================
+
+static bool isValidZoneRail(int rail)
+{
+    return rail == 1 || rail == 2;
+}
+
+static int otherRail(int rail)
+{
+    return (rail == 1) ? 2 : 1;
+}
+
+// Check the other rail against a requested sweep. Returns true when safe and
+// fills reason with a short description of the conflict otherwise.
+static bool isSweepClearOfOtherRail(int rail, double fromMm, double toMm, const char **reason)
+{
+    if (!doesSweepTouchSharedZone(rail, fromMm, toMm)) {
+        return true; // Outside the shared space - never conflicts
+    }
+
+    int other = otherRail(rail);
+    ZoneReservation &otherReservation = railReservations[other - 1];
+
+    // Other rail is moving: conflict only if its sweep also uses the shared space
+    if (otherReservation.active) {
+        if (otherReservation.touchesSharedZone) {
+            *reason = "moving through shared zone";
+            return false;
+        }
+        return true;
+    }
+
+    // Other rail is parked: a parked carriage in the shared zone is only a hazard
+    // when the Rail 2 cylinder is not retracted (same rule as executeRailHome).
+    // An unhomed rail has no trustworthy position, so assume it may be in the zone.
+    bool otherParkedInZone = true;
+    if (isHomingComplete(other)) {
+        double otherPos = getMotorPositionMm(other);
+        otherParkedInZone = doesSweepTouchSharedZone(other, otherPos, otherPos);
+    }
+
+    if (otherParkedInZone && !isCylinderActuallyRetracted()) {
+        *reason = "in shared zone with cylinder not retracted";
+        return false;
+    }
+
+    return true;
+}
+
+//=============================================================================
+// INITIALIZATION AND PERIODIC UPDATE
+//=============================================================================
+
+void initCollisionZoneManager()
+{
+    releaseAllRailTravel();
+    cancelQueuedRailMoves();
+    zoneStats = {0};
+}
+
+void updateCollisionZones()
+{
+    unsigned long currentTime = millis();
+
+    // Release reservations once their move has finished
+    for (int rail = 1; rail <= 2; rail++) {
+        ZoneReservation &reservation = railReservations[rail - 1];
+        if (!reservation.active) {
+            continue;
+        }
+
+        if (!timeoutElapsed(currentTime, reservation.grantedTime, ZONE_RESERVATION_MIN_HOLD_MS)) {
+            continue; // Give the drive time to report motion after the move command
+        }
+
+        if (!isMotorMoving(rail) && !isHomingInProgress(rail)) {
+            releaseRailTravel(rail);
+        }
+    }
+
+    // Dispatch queued moves whose path is now clear
+    for (int rail = 1; rail <= 2; rail++) {
+        QueuedRailMove &queued = queuedRailMoves[rail - 1];
+        if (!queued.pending) {
+            continue;
+        }
+
+        char msg[MEDIUM_MSG_SIZE];
+
+        if (isEStopActive() || timeoutElapsed(currentTime, queued.queuedTime, ZONE_QUEUED_MOVE_TIMEOUT_MS)) {
+            queued.pending = false;
+            sprintf_P(msg, FMT_ZONE_QUEUE_EXPIRED, rail, queued.targetMm);
+            Console.serialWarning(msg);
+            continue;
+        }
+
+        if (hasActiveReservation(rail)) {
+            continue; // This rail is still finishing its previous move
+        }
+
+        double currentPos = getMotorPositionMm(rail);
+        const char *reason = "";
+        if (!isSweepClearOfOtherRail(rail, currentPos, queued.targetMm, &reason)) {
+            continue;
+        }
+
+        queued.pending = false;
+        zoneStats.queuedDispatchCount++;
+        sprintf_P(msg, FMT_ZONE_DISPATCH, rail, queued.targetMm);
+        Console.serialInfo(msg);
+        executeRailMoveToPosition(rail, queued.targetMm, queued.carriageLoaded);
+    }
+}
+
+//=============================================================================
+// INTERVAL HELPERS
+//=============================================================================
+
+bool sweptIntervalOverlaps(double fromMm, double toMm, double zoneStartMm, double zoneEndMm)
+{
+    double lowMm = min(fromMm, toMm);
+    double highMm = max(fromMm, toMm);
+    return lowMm <= zoneEndMm && highMm >= zoneStartMm;
+}
+
+bool doesSweepTouchSharedZone(int rail, double fromMm, double toMm)
+{
+    if (rail == 1) {
+        return sweptIntervalOverlaps(fromMm, toMm, RAIL1_HOME_POSITION, RAIL1_SHARED_ZONE_END_MM);
+    }
+    return sweptIntervalOverlaps(fromMm, toMm, RAIL2_COLLISION_ZONE_START, RAIL2_MAX_TRAVEL_MM);
+}
+
+//=============================================================================
+// RESERVATION MANAGEMENT
+//=============================================================================
+
+bool canReserveRailTravel(int rail, double fromMm, double toMm)
+{
+    if (!isValidZoneRail(rail)) {
+        return false;
+    }
+
+    const char *reason = "";
+    return isSweepClearOfOtherRail(rail, fromMm, toMm, &reason);
+}
+
+ZoneReservationResult reserveRailTravel(int rail, double fromMm, double toMm, bool reportConflict)
+{
+    if (!isValidZoneRail(rail)) {
+        return ZONE_RESERVATION_INVALID_RAIL;
+    }
+
+    const char *reason = "";
+    if (!isSweepClearOfOtherRail(rail, fromMm, toMm, &reason)) {
+        zoneStats.blockedCount++;
+        if (reportConflict) {
+            char msg[MEDIUM_MSG_SIZE];
+            sprintf_P(msg, FMT_ZONE_BLOCKED, rail, otherRail(rail), reason);
+            Console.serialError(msg);
+        }
+        return ZONE_RESERVATION_BLOCKED;
+    }
+
+    // A new move replaces this rail's previous reservation
+    ZoneReservation &reservation = railReservations[rail - 1];
+    reservation.active = true;
+    reservation.fromMm = min(fromMm, toMm);
+    reservation.toMm = max(fromMm, toMm);
+    reservation.touchesSharedZone = doesSweepTouchSharedZone(rail, fromMm, toMm);
+    reservation.grantedTime = millis();
+
+    zoneStats.grantedCount++;
+    if (railReservations[otherRail(rail) - 1].active) {
+        zoneStats.concurrentCount++;
+    }
+
+    return ZONE_RESERVATION_GRANTED;
+}
+
+ZoneReservationResult reserveFullRailTravel(int rail)
+{
+    double maxTravelMm = (rail == 1) ? RAIL1_MAX_TRAVEL_MM : RAIL2_MAX_TRAVEL_MM;
+    return reserveRailTravel(rail, 0, maxTravelMm);
+}
+
+void releaseRailTravel(int rail)
+{
+    if (!isValidZoneRail(rail)) {
+        return;
+    }
+    railReservations[rail - 1].active = false;
+    railReservations[rail - 1].touchesSharedZone = false;
+}
+
+void releaseAllRailTravel()
+{
+    releaseRailTravel(1);
+    releaseRailTravel(2);
+}
+
+bool hasActiveReservation(int rail)
+{
+    return isValidZoneRail(rail) && railReservations[rail - 1].active;
+}
+
+bool isRailTravelReserved(int rail, double fromMm, double toMm)
+{
+    if (!hasActiveReservation(rail)) {
+        return false;
+    }
+    const ZoneReservation &reservation = railReservations[rail - 1];
+    return min(fromMm, toMm) >= reservation.fromMm && max(fromMm, toMm) <= reservation.toMm;
+}
+
+//=============================================================================
+// QUEUED MOVES
+//=============================================================================
+
+bool queueRailMove(int rail, double targetMm, bool carriageLoaded)
+{
+    if (!isValidZoneRail(rail)) {
+        return false;
+    }
+
+    QueuedRailMove &queued = queuedRailMoves[rail - 1];
+    if (queued.pending) {
+        Console.serialError(F("MOVE_QUEUE_FULL: Rail already has a queued move"));
+        return false;
+    }
+
+    queued.pending = true;
+    queued.targetMm = targetMm;
+    queued.carriageLoaded = carriageLoaded;
+    queued.queuedTime = millis();
+
+    char msg[MEDIUM_MSG_SIZE];
+    sprintf_P(msg, FMT_ZONE_QUEUED, rail, targetMm);
+    Console.serialInfo(msg);
+    return true;
+}
+
+bool hasQueuedRailMove(int rail)
+{
+    return isValidZoneRail(rail) && queuedRailMoves[rail - 1].pending;
+}
+
+void cancelQueuedRailMoves()
+{
+    queuedRailMoves[0].pending = false;
+    queuedRailMoves[1].pending = false;
+}
+
+//=============================================================================
+// STATUS AND DIAGNOSTICS
+//=============================================================================
+
+void printCollisionZoneStatus()
+{
+    char msg[MEDIUM_MSG_SIZE];
+    unsigned long currentTime = millis();
+
+    Console.println(F("[INFO] Collision Zone Reservations:"));
+    sprintf_P(msg, PSTR("  Shared zones: Rail 1 %d-%dmm, Rail 2 %d-%dmm"),
+              RAIL1_HOME_POSITION, RAIL1_SHARED_ZONE_END_MM,
+              RAIL2_COLLISION_ZONE_START, RAIL2_MAX_TRAVEL_MM);
+    Console.println(msg);
+
+    for (int rail = 1; rail <= 2; rail++) {
+        ZoneReservation &reservation = railReservations[rail - 1];
+        if (reservation.active) {
+            sprintf_P(msg, FMT_ZONE_RESERVATION, rail, "reserved", reservation.fromMm, reservation.toMm,
+                      reservation.touchesSharedZone ? " (shared zone)" : "");
+        } else {
+            double position = getMotorPositionMm(rail);
+            sprintf_P(msg, FMT_ZONE_RESERVATION, rail, "parked", position, position, "");
+        }
+        Console.println(msg);
+
+        QueuedRailMove &queued = queuedRailMoves[rail - 1];
+        if (queued.pending) {
+            sprintf_P(msg, FMT_ZONE_QUEUE_ENTRY, rail, queued.targetMm,
+                      queued.carriageLoaded ? "loaded" : "empty",
+                      timeDiff(currentTime, queued.queuedTime));
+            Console.println(msg);
+        }
+    }
+
+    sprintf_P(msg, FMT_ZONE_STATS, zoneStats.grantedCount, zoneStats.blockedCount,
+              zoneStats.concurrentCount, zoneStats.queuedDispatchCount);
+    Console.println(msg);
+}
+
+const char *getZoneReservationResultName(ZoneReservationResult result)
+{
+    switch (result) {
+        case ZONE_RESERVATION_GRANTED:      return "GRANTED";
+        case ZONE_RESERVATION_BLOCKED:      return "BLOCKED_BY_OTHER_RAIL";
+        case ZONE_RESERVATION_INVALID_RAIL: return "INVALID_RAIL";
+        default:                            return "UNKNOWN";
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef COLLISION_ZONE_MANAGER_H
+#define COLLISION_ZONE_MANAGER_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "Utils.h"
+
+//=============================================================================
+// COLLISION ZONE CONSTANTS
+//=============================================================================
+// Shared space between the two rails, expressed in each rail's own coordinates.
+// A move only needs to be serialized against the other rail when BOTH rails
+// sweep through their part of the shared space at the same time.
+//
+//   Rail 1 shared zone: RAIL1_HOME_POSITION .. RAIL1_SHARED_ZONE_END_MM
+//                       (home/handoff end of Rail 1, staging position is outside)
+//   Rail 2 shared zone: RAIL2_COLLISION_ZONE_START .. RAIL2_MAX_TRAVEL_MM
+//                       (collision zone plus the handoff end of Rail 2)
+//
+// Reservations outside the shared space never conflict, so Rail 1 can run
+// WC1/WC2/staging moves while Rail 2 works at WC3 (and vice versa).
+#define RAIL1_SHARED_ZONE_END_MM 100            // Last Rail 1 position that can interfere with Rail 2 (mm)
+
+// Reservation management
+#define ZONE_RESERVATION_MIN_HOLD_MS 50         // Hold a new reservation at least this long (motion start latency)
+#define ZONE_QUEUED_MOVE_TIMEOUT_MS 30000       // Discard queued moves that could not start within 30 seconds
+
+//=============================================================================
+// COLLISION ZONE ENUMS AND STRUCTURES
+//=============================================================================
+
+// Result of a reservation request
+enum ZoneReservationResult
+{
+    ZONE_RESERVATION_GRANTED,              // Swept interval reserved, move may start
+    ZONE_RESERVATION_BLOCKED,              // Conflicts with the other rail's reservation
+    ZONE_RESERVATION_INVALID_RAIL          // Rail number out of range
+};
+
+// Swept interval reserved by one rail for one move
+struct ZoneReservation
+{
+    bool active;                           // Reservation currently held
+    bool touchesSharedZone;                // Swept interval intersects this rail's shared zone
+    double fromMm;                         // Lower bound of swept interval (mm)
+    double toMm;                           // Upper bound of swept interval (mm)
+    unsigned long grantedTime;             // When the reservation was granted
+};
+
+// Move waiting for the other rail to clear the shared zone
+struct QueuedRailMove
+{
+    bool pending;                          // Move waiting for dispatch
+    double targetMm;                       // Absolute target position (mm)
+    bool carriageLoaded;                   // Carriage state for velocity selection
+    unsigned long queuedTime;              // When the move was queued
+};
+
+// Reservation statistics for diagnostics
+struct ZoneReservationStats
+{
+    uint32_t grantedCount;                 // Reservations granted
+    uint32_t blockedCount;                 // Reservations refused due to conflict
+    uint32_t concurrentCount;              // Grants made while the other rail was also moving
+    uint32_t queuedDispatchCount;          // Queued moves started after the zone cleared
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+
+extern ZoneReservation railReservations[2];  // Index 0 = Rail 1, index 1 = Rail 2
+extern QueuedRailMove queuedRailMoves[2];
+extern ZoneReservationStats zoneStats;
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+
+// Initialization and periodic update (call every loop)
+void initCollisionZoneManager();
+void updateCollisionZones();
+
+// Interval helpers
+bool sweptIntervalOverlaps(double fromMm, double toMm, double zoneStartMm, double zoneEndMm);
+bool doesSweepTouchSharedZone(int rail, double fromMm, double toMm);
+
+// Reservation management
+bool canReserveRailTravel(int rail, double fromMm, double toMm);
+ZoneReservationResult reserveRailTravel(int rail, double fromMm, double toMm, bool reportConflict = true);
+ZoneReservationResult reserveFullRailTravel(int rail);  // Homing / unknown position
+void releaseRailTravel(int rail);
+void releaseAllRailTravel();
+bool hasActiveReservation(int rail);
+bool isRailTravelReserved(int rail, double fromMm, double toMm);  // Held reservation already covers the sweep
+
+// Queued moves (dispatched automatically from updateCollisionZones)
+bool queueRailMove(int rail, double targetMm, bool carriageLoaded);
+bool hasQueuedRailMove(int rail);
+void cancelQueuedRailMoves();
+
+// Status and diagnostics
+void printCollisionZoneStatus();
+const char *getZoneReservationResultName(ZoneReservationResult result);
+
+#endif // COLLISION_ZONE_MANAGER_H
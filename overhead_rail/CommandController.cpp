@@ -2,6 +2,7 @@
 #include "Commands.h"
 #include "Utils.h"
 #include "SystemState.h"
+#include "TraceRecorder.h"
 #include <Ethernet.h>
 
 //=============================================================================
@@ -40,7 +41,8 @@ const CommandInfo COMMAND_TABLE[] = {
     {"rail1", CMD_AUTOMATED, CMD_FLAG_ASYNC},
     {"rail2", CMD_AUTOMATED, CMD_FLAG_ASYNC},
     {"system", CMD_READ_ONLY, CMD_FLAG_NO_HISTORY},
-    {"teach", CMD_MANUAL, 0}
+    {"teach", CMD_MANUAL, 0},
+    {"trace", CMD_MANUAL, CMD_FLAG_NO_HISTORY}
 };
 
 // Number of commands in the table
@@ -202,6 +204,9 @@ bool processCommand(const char *rawCommand, Stream *output, const char *sourceTa
 {
     Console.setCurrentClient(output);
 
+    // Capture inbound commands for later replay (no-op unless recording)
+    recordTraceCommand(rawCommand, output);
+
     // Extract first word (command name)
     char firstWord[16] = {0};
     int i = 0;
@@ -272,7 +277,11 @@ bool executeCommand(const char *command, Stream *output)
     lastExecutedCommand[MAX_COMMAND_LENGTH - 1] = '\0';
     lastCommandTime = millis();
     lastCommandType = getCommandType(command);
-    strcpy(lastCommandSource, (output == &Serial) ? "SERIAL" : "NETWORK");
+    if (traceRecorder.issuingReplayCommand) {
+        strcpy(lastCommandSource, "REPLAY");
+    } else {
+        strcpy(lastCommandSource, (output == &Serial) ? "SERIAL" : "NETWORK");
+    }
     
     char firstWord[16] = {0};
     int i = 0;
@@ -543,6 +552,42 @@ CommandType getCommandType(const char *originalCommand)
             return CMD_MANUAL;
         }
 
+        // Special handling for trace commands (replay drives the rails)
+        if (strcmp(firstWord, "trace") == 0)
+        {
+            // Emergency subcommands (always allowed - stops an active replay)
+            if (strstr(originalCommand, ",stop") != nullptr)
+            {
+                return CMD_EMERGENCY;
+            }
+
+            // Read-only subcommands (allowed during operations)
+            if (strstr(originalCommand, ",status") != nullptr ||
+                strstr(originalCommand, ",dump") != nullptr ||
+                strstr(originalCommand, ",help") != nullptr)
+            {
+                return CMD_READ_ONLY;
+            }
+
+            // Automated subcommands (block everything except emergency/read-only)
+            if (strstr(originalCommand, ",replay") != nullptr)
+            {
+                return CMD_AUTOMATED;
+            }
+
+            // Manual subcommands (blocked during automation)
+            if (strstr(originalCommand, ",start") != nullptr ||
+                strstr(originalCommand, ",clear") != nullptr ||
+                strstr(originalCommand, ",save") != nullptr ||
+                strstr(originalCommand, ",load") != nullptr)
+            {
+                return CMD_MANUAL;
+            }
+
+            // Default to manual for unknown trace subcommands
+            return CMD_MANUAL;
+        }
+
         // Special handling for jog commands (manual control)
         if (strcmp(firstWord, "jog") == 0)
         {
@@ -49,7 +49,7 @@ extern char lastExecutedCommand[MAX_COMMAND_LENGTH];
 extern unsigned long lastCommandTime;
 extern bool lastCommandSuccess;
 extern CommandType lastCommandType;
-extern char lastCommandSource[16]; // "SERIAL" or "NETWORK"
+extern char lastCommandSource[16]; // "SERIAL", "NETWORK" or "REPLAY"
 extern unsigned long systemStartTime;
 
 // Client tracking for async operations
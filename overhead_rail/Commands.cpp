@@ -4,6 +4,9 @@
 #include "RailAutomation.h"
 #include "HandoffController.h"
 #include "LabwareAutomation.h"
+#include "CollisionZoneManager.h"
+#include "MotionTelemetry.h"
+#include "TraceRecorder.h"
 
 /*
 =============================================================================
@@ -12,6 +15,7 @@ COMMAND FUNCTION LOCATIONS
 SYSTEM LEVEL:
   cmd_system()     - Line 407   (state, home, reset)
   cmd_log()        - Line 215   (monitoring, history)
+  cmd_trace()      - Line 486   (record and replay)
   cmd_network()    - Line 1692  (connectivity)
 
 HARDWARE CONTROL:
@@ -83,6 +87,7 @@ bool cmd_print_help(char *args, CommandCaller *caller)
         Console.println(F("SYSTEM COMMANDS:"));
         Console.println(F("  help           - Display this comprehensive help information"));
         Console.println(F("  system,state   - Display comprehensive system status with readiness assessment"));
+        Console.println(F("  system,zones   - Display cross-rail shared zone reservations and queued moves"));
         Console.println(F("  system,home    - Home both rails sequentially (Rail 1 first, then Rail 2)"));
         Console.println(F("  system,init    - Initialize all motor systems"));
         Console.println(F("  system,clear   - Clear motor faults for system readiness"));
@@ -110,6 +115,7 @@ bool cmd_print_help(char *args, CommandCaller *caller)
         Console.println(F("  rail1,move-staging,no-labware  - Move empty carriage to staging"));
         Console.println(F("  rail1,move-handoff,with-labware - Move carriage with labware to handoff"));
         Console.println(F("  rail1,status            - Show comprehensive Rail 1 diagnostics"));
+        Console.println(F("  rail1,telemetry         - Show Rail 1 drive effort telemetry"));
         Console.println(F("  rail1,help              - Display detailed Rail 1 instructions"));
         Console.println();
         Console.println(F("  rail2,init              - Initialize Rail 2 motor system"));
@@ -119,6 +125,7 @@ bool cmd_print_help(char *args, CommandCaller *caller)
         Console.println(F("  rail2,move-wc3,no-labware      - Move empty carriage to WC3"));
         Console.println(F("  rail2,move-handoff,with-labware - Move carriage with labware to handoff"));
         Console.println(F("  rail2,status            - Show comprehensive Rail 2 diagnostics"));
+        Console.println(F("  rail2,telemetry         - Show Rail 2 drive effort telemetry"));
         Console.println(F("  rail2,help              - Display detailed Rail 2 instructions"));
         Console.println();
         
@@ -150,6 +157,9 @@ bool cmd_print_help(char *args, CommandCaller *caller)
         Console.println(F("  log,history        - Show complete operation log history"));
         Console.println(F("  log,errors         - Show only errors and warnings"));
         Console.println(F("  log,help           - Display detailed logging instructions"));
+        Console.println(F("  trace,start        - Record commands, sensor edges and motor status"));
+        Console.println(F("  trace,replay       - Replay the recorded trace and report divergence"));
+        Console.println(F("  trace,help         - Display detailed trace instructions"));
         Console.println();
         
         Console.println(F("NETWORK:"));
@@ -360,7 +370,8 @@ static const SubcommandInfo SYSTEM_COMMANDS[] = {
     {"home", 2},
     {"init", 3},
     {"reset", 4},
-    {"state", 5}};
+    {"state", 5},
+    {"zones", 6}};
 
 static const size_t SYSTEM_COMMAND_COUNT = sizeof(SYSTEM_COMMANDS) / sizeof(SubcommandInfo);
 
@@ -401,6 +412,9 @@ bool cmd_system(char *args, CommandCaller *caller)
         Console.println(F("  system,state        - Display comprehensive system status"));
         Console.println(F("                        (motors, sensors, pneumatics, network, safety)"));
         Console.println(F("                        Includes overall readiness assessment and error summary"));
+        Console.println(F("  system,zones        - Display cross-rail shared zone reservations"));
+        Console.println(F("                        Rails move concurrently unless both sweep the shared zone"));
+        Console.println(F("                        Conflicting rail moves are queued until the zone clears"));
         Console.println(F(""));
         Console.println(F("INITIALIZATION COMMANDS:"));
         Console.println(F("  system,init         - Initialize all motor systems"));
@@ -443,8 +457,155 @@ bool cmd_system(char *args, CommandCaller *caller)
         printSystemState();
         return true;
 
+    case 6: // zones
+        Console.acknowledge(F("DISPLAYING_ZONE_RESERVATIONS: Shared zone status follows:"));
+        printCollisionZoneStatus();
+        return true;
+
     default:
-        Console.error(F("Unknown system command. Available: state, clear, init, home, reset, help"));
+        Console.error(F("Unknown system command. Available: state, zones, clear, init, home, reset, help"));
+        return false;
+    }
+}
+
+// ============================================================
+// Trace Record/Replay Command Implementation
+// ============================================================
+
+// Define the trace subcommands lookup table (MUST BE SORTED ALPHABETICALLY)
+static const SubcommandInfo TRACE_COMMANDS[] = {
+    {"clear", 0},
+    {"dump", 1},
+    {"help", 2},
+    {"load", 3},
+    {"replay", 4},
+    {"save", 5},
+    {"start", 6},
+    {"status", 7},
+    {"stop", 8}};
+
+static const size_t TRACE_COMMAND_COUNT = sizeof(TRACE_COMMANDS) / sizeof(SubcommandInfo);
+
+bool cmd_trace(char *args, CommandCaller *caller)
+{
+    // Create a local copy of arguments
+    char localArgs[COMMAND_SIZE];
+    strncpy(localArgs, args, COMMAND_SIZE);
+    localArgs[COMMAND_SIZE - 1] = '\0';
+
+    // Skip leading spaces
+    char *trimmed = trimLeadingSpaces(localArgs);
+
+    // Check for empty argument
+    if (strlen(trimmed) == 0)
+    {
+        Console.error(F("Missing parameter. Usage: trace,<action>"));
+        return false;
+    }
+
+    // Parse the argument - use spaces as separators
+    char *action = strtok(trimmed, " ");
+    char *param1 = strtok(nullptr, " ");
+
+    // Find the command code
+    int commandCode = findSubcommandCode(action, TRACE_COMMANDS, TRACE_COMMAND_COUNT);
+
+    switch (commandCode)
+    {
+    case 0: // clear
+        clearTrace();
+        Console.acknowledge(F("TRACE_CLEARED: Trace buffer emptied"));
+        return true;
+
+    case 1: // dump
+        Console.acknowledge(F("DISPLAYING_TRACE: Recorded events follow:"));
+        printTraceEvents();
+        return true;
+
+    case 2: // help
+        Console.acknowledge(F("DISPLAYING_TRACE_HELP: Trace command guide follows:"));
+        Console.println(F("============================================"));
+        Console.println(F("Trace Record and Replay Commands"));
+        Console.println(F("============================================"));
+        Console.println(F("RECORDING:"));
+        Console.println(F("  trace,start         - Start recording commands, sensor edges and motor status"));
+        Console.println(F("                        Captures starting sensor/motor state first"));
+        Console.println(F("  trace,stop          - Stop recording (or stop an active replay)"));
+        Console.println(F("  trace,clear         - Discard the trace in memory"));
+        Console.println(F(""));
+        Console.println(F("STORAGE:"));
+        Console.println(F("  trace,save          - Write the binary trace to SD card (TRACE.BIN)"));
+        Console.println(F("  trace,load          - Read a binary trace from SD card"));
+        Console.println(F(""));
+        Console.println(F("REPLAY:"));
+        Console.println(F("  trace,replay        - Re-issue recorded commands at their recorded time offsets"));
+        Console.println(F("  trace,replay,synced - Issue each command once the sensor/motor events before it occur"));
+        Console.println(F("                        Observed events are compared with the recording and"));
+        Console.println(F("                        missing/unexpected events and timing drift are reported"));
+        Console.println(F(""));
+        Console.println(F("DIAGNOSTICS:"));
+        Console.println(F("  trace,status        - Show buffer usage and last replay comparison"));
+        Console.println(F("  trace,dump          - List recorded events with timestamps"));
+        Console.println(F(""));
+        Console.println(F("NOTES:"));
+        Console.println(F("- Replay drives the real rails - clear the work area first"));
+        Console.println(F("- Sensor inputs are observed, not simulated, during replay"));
+        Console.println(F("- Recording stops automatically when the buffer fills"));
+        Console.println(F("============================================"));
+        return true;
+
+    case 3: // load
+        return loadTraceFromSD();
+
+    case 4: // replay
+        if (param1 != NULL && strcmp(param1, "synced") != 0)
+        {
+            Console.error(F("Invalid option. Usage: trace,replay[,synced]"));
+            return false;
+        }
+        if (!startTraceReplay(param1 != NULL ? TRACE_REPLAY_SYNCED : TRACE_REPLAY_TIMED))
+        {
+            return false;
+        }
+        Console.acknowledge(F("TRACE_REPLAY_STARTED: Recorded commands will be re-issued"));
+        return true;
+
+    case 5: // save
+        if (!saveTraceToSD())
+        {
+            return false;
+        }
+        Console.acknowledge(F("TRACE_SAVED: Trace written to SD card"));
+        return true;
+
+    case 6: // start
+        if (!startTraceRecording())
+        {
+            return false;
+        }
+        Console.acknowledge(F("TRACE_RECORDING_STARTED: Commands, sensor edges and motor status are being recorded"));
+        return true;
+
+    case 7: // status
+        Console.acknowledge(F("DISPLAYING_TRACE_STATUS: Trace recorder status follows:"));
+        printTraceStatus();
+        return true;
+
+    case 8: // stop
+        if (isTraceReplayActive())
+        {
+            stopTraceReplay();
+        }
+        else
+        {
+            stopTraceRecording();
+        }
+        Console.acknowledge(F("TRACE_STOPPED: Recorder idle"));
+        printTraceStatus();
+        return true;
+
+    default:
+        Console.error(F("Unknown trace command. Available: start, stop, clear, save, load, replay, status, dump, help"));
         return false;
     }
 }
@@ -676,7 +837,8 @@ static const SubcommandInfo RAIL2_COMMANDS[] = {
     {"move-wc3", 9},
     {"retract", 10},
     {"status", 11},
-    {"stop", 12}};
+    {"stop", 12},
+    {"telemetry", 13}};
 
 static const size_t RAIL2_COMMAND_COUNT = sizeof(RAIL2_COMMANDS) / sizeof(SubcommandInfo);
 
@@ -802,6 +964,9 @@ bool cmd_rail2(char *args, CommandCaller *caller)
         Console.println(F(""));
         Console.println(F("STATUS AND DIAGNOSTICS:"));
         Console.println(F("  rail2,status        - Show comprehensive system status"));
+        Console.println(F("  rail2,telemetry     - Show last move torque/settle summary and per-segment trends"));
+        Console.println(F("  rail2,telemetry,trace - Dump last move trace as CSV (ms,pos_mm,torque_pct,hlfb)"));
+        Console.println(F("  rail2,telemetry,reset - Clear per-segment telemetry statistics"));
         Console.println(F(""));
         Console.println(F("SAFETY NOTES:"));
         Console.println(F("- Always specify labware status for movement commands"));
@@ -1008,11 +1173,33 @@ bool cmd_rail2(char *args, CommandCaller *caller)
         Console.serialInfo(F("============================================"));
         return true;
 
+    case 13: // "telemetry" - Per-move torque and settle telemetry
+        if (param1 == NULL)
+        {
+            Console.acknowledge(F("DISPLAYING_RAIL2_TELEMETRY: Motion telemetry follows:"));
+            printMotionTelemetry(2);
+            return true;
+        }
+        if (strcmp(param1, "trace") == 0)
+        {
+            Console.acknowledge(F("DISPLAYING_RAIL2_TRACE: Last move trace follows:"));
+            printLastMoveTrace(2);
+            return true;
+        }
+        if (strcmp(param1, "reset") == 0)
+        {
+            resetSegmentTelemetry(2);
+            Console.acknowledge(F("RAIL2_TELEMETRY_RESET: Segment statistics cleared"));
+            return true;
+        }
+        Console.error(F("Invalid option. Usage: rail2,telemetry[,trace|reset]"));
+        return false;
+
     case 12: // "stop" - Emergency stop motor movement
         return executeRailStop(2);
 
     default: // Unknown command
-        Console.error(F("Unknown action. Available: init, clear-fault, abort, stop, extend, retract, home, move-wc3, move-handoff, move-mm-to, move-rel, status, and help"));
+        Console.error(F("Unknown action. Available: init, clear-fault, abort, stop, extend, retract, home, move-wc3, move-handoff, move-mm-to, move-rel, status, telemetry, and help"));
         return false;
     }
 
@@ -1037,7 +1224,8 @@ static const SubcommandInfo RAIL1_COMMANDS[] = {
     {"move-wc1", 9},
     {"move-wc2", 10},
     {"status", 11},
-    {"stop", 12}};
+    {"stop", 12},
+    {"telemetry", 13}};
 
 static const size_t RAIL1_COMMAND_COUNT = sizeof(RAIL1_COMMANDS) / sizeof(SubcommandInfo);
 
@@ -1134,6 +1322,9 @@ bool cmd_rail1(char *args, CommandCaller *caller)
         Console.println(F(""));
         Console.println(F("STATUS AND DIAGNOSTICS:"));
         Console.println(F("  rail1,status        - Show comprehensive system status"));
+        Console.println(F("  rail1,telemetry     - Show last move torque/settle summary and per-segment trends"));
+        Console.println(F("  rail1,telemetry,trace - Dump last move trace as CSV (ms,pos_mm,torque_pct,hlfb)"));
+        Console.println(F("  rail1,telemetry,reset - Clear per-segment telemetry statistics"));
         Console.println(F(""));
         Console.println(F("POSITION REFERENCE:"));
         Console.print(F("- Home: "));
@@ -1305,11 +1496,33 @@ bool cmd_rail1(char *args, CommandCaller *caller)
         Console.serialInfo(F("============================================"));
         return true;
 
+    case 13: // "telemetry" - Per-move torque and settle telemetry
+        if (param1 == NULL)
+        {
+            Console.acknowledge(F("DISPLAYING_RAIL1_TELEMETRY: Motion telemetry follows:"));
+            printMotionTelemetry(1);
+            return true;
+        }
+        if (strcmp(param1, "trace") == 0)
+        {
+            Console.acknowledge(F("DISPLAYING_RAIL1_TRACE: Last move trace follows:"));
+            printLastMoveTrace(1);
+            return true;
+        }
+        if (strcmp(param1, "reset") == 0)
+        {
+            resetSegmentTelemetry(1);
+            Console.acknowledge(F("RAIL1_TELEMETRY_RESET: Segment statistics cleared"));
+            return true;
+        }
+        Console.error(F("Invalid option. Usage: rail1,telemetry[,trace|reset]"));
+        return false;
+
     case 12: // "stop" - Emergency stop motor movement
         return executeRailStop(1);
 
     default: // Unknown command
-        Console.error(F("Unknown action. Available: init, clear-fault, abort, stop, home, move-wc1, move-wc2, move-staging, move-handoff, move-mm-to, move-rel, status, and help"));
+        Console.error(F("Unknown action. Available: init, clear-fault, abort, stop, home, move-wc1, move-wc2, move-staging, move-handoff, move-mm-to, move-rel, status, telemetry, and help"));
         return false;
     }
 
@@ -2243,6 +2456,19 @@ Commander::systemCommand_t API_tree[] = {
                          "  log,help          - Display detailed logging information",
                   cmd_log),
 
+    // Trace record/replay command
+    systemCommand("trace", "Record and replay command/sensor traces:\r\n"
+                           "  trace,start         - Start recording commands, sensor edges and motor status\r\n"
+                           "  trace,stop          - Stop recording or replay\r\n"
+                           "  trace,clear         - Discard the trace in memory\r\n"
+                           "  trace,save          - Write binary trace to SD card\r\n"
+                           "  trace,load          - Read binary trace from SD card\r\n"
+                           "  trace,replay,[synced] - Re-issue recorded commands and compare observed events\r\n"
+                           "  trace,status        - Show buffer usage and replay comparison\r\n"
+                           "  trace,dump          - List recorded events\r\n"
+                           "  trace,help          - Display detailed trace information",
+                  cmd_trace),
+
     // Labware automation command
     systemCommand("labware", "Labware automation and state management:\r\n"
                              "  labware,status      - Display current labware tracking state and operation history\r\n"
@@ -2266,6 +2492,7 @@ Commander::systemCommand_t API_tree[] = {
     // System state command to display comprehensive system status
     systemCommand("system", "System commands:\r\n"
                             "  system,state    - Display comprehensive system status with readiness assessment\r\n"
+                            "  system,zones    - Display cross-rail shared zone reservations and queued moves\r\n"
                             "  system,home     - Home both rails sequentially (Rail 1 first, then Rail 2)\r\n"
                             "  system,reset    - Clear operational state for clean automation (motor faults, encoder, etc.)\r\n"
                             "  system,help     - Display detailed instructions for system commands\r\n"
@@ -2338,6 +2565,7 @@ Commander::systemCommand_t API_tree[] = {
                            "  rail1,move-rel,X,no-labware   - Move empty carriage X mm relative to current position\r\n"
                            "  rail1,move-rel,X,with-labware - Move carriage with labware X mm relative to current position\r\n"
                            "  rail1,status        - Show comprehensive system status and diagnostics\r\n"
+                           "  rail1,telemetry[,trace|reset] - Show per-move torque telemetry\r\n"
                            "  rail1,help          - Display detailed usage instructions",
                   cmd_rail1),
 
@@ -2359,6 +2587,7 @@ Commander::systemCommand_t API_tree[] = {
                            "  rail2,move-rel,X,no-labware   - Move empty carriage X mm relative to current position\r\n"
                            "  rail2,move-rel,X,with-labware - Move carriage with labware X mm relative to current position\r\n"
                            "  rail2,status        - Show comprehensive system status and diagnostics\r\n"
+                           "  rail2,telemetry[,trace|reset] - Show per-move torque telemetry\r\n"
                            "  rail2,help          - Display detailed usage instructions\r\n"
                            "  SAFETY: Cylinder auto-retracts for ANY movement involving collision zone (500-700mm)",
                   cmd_rail2),
@@ -58,6 +58,7 @@ bool cmd_print_help(char *args, CommandCaller *caller);
 //-----------------------------------------------------------------------------
 bool cmd_system(char *args, CommandCaller *caller);
 bool cmd_log(char *args, CommandCaller *caller);
+bool cmd_trace(char *args, CommandCaller *caller);
 bool cmd_network(char *args, CommandCaller *caller);
 
 //-----------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 #include "OutputManager.h"
 #include "ValveController.h"  // For cylinder safety checks
 #include "RailAutomation.h"   // For collision zone constants
+#include "CollisionZoneManager.h" // For cross-rail zone reservations
 
 //=============================================================================
 // CONSOLE OUTPUT FORMAT STRINGS
@@ -356,6 +357,25 @@ void processEncoderInput()
         }
     }
     
+    // **SHARED ZONE RESERVATION**
+    // Hold position while the other rail is sweeping the shared handoff space
+    {
+        double currentPos = getMotorPositionMm(activeEncoderRail);
+        double targetPositionMm = scaledToMm(targetPositionScaled);
+        
+        // Jogging back within the sweep already reserved needs no new grant
+        if (!isRailTravelReserved(activeEncoderRail, currentPos, targetPositionMm) &&
+            reserveRailTravel(activeEncoderRail, currentPos, targetPositionMm, false) != ZONE_RESERVATION_GRANTED) {
+            static unsigned long lastZoneWarning = 0;
+            unsigned long currentTime = millis();
+            if (waitTimeReached(currentTime, lastZoneWarning, 1000)) {
+                Console.serialWarning(F("Shared zone in use by other rail - MPG move held"));
+                lastZoneWarning = currentTime;
+            }
+            return; // Block the movement
+        }
+    }
+    
     // Get motor reference for this rail
     MotorDriver& motor = getMotorByRail(activeEncoderRail);
     
@@ -6,6 +6,7 @@
 #include "Sensors.h"
 #include "ValveController.h"
 #include "Utils.h"
+#include "CollisionZoneManager.h"
 
 //=============================================================================
 // CONSOLE OUTPUT FORMAT STRINGS
@@ -507,6 +508,13 @@ bool checkHandoffCollisionSafety(HandoffDirection dir, HandoffDestination dest)
 }
 
 bool moveSourceRailToHandoffPosition() {
+    // Wait (bounded by the phase timeout) while the other rail sweeps the shared zone
+    int sourceRail = (handoffState.direction == HANDOFF_RAIL1_TO_RAIL2) ? 1 : 2;
+    double handoffMm = (sourceRail == 1) ? RAIL1_HANDOFF : RAIL2_HANDOFF;
+    if (!canReserveRailTravel(sourceRail, getMotorPositionMm(sourceRail), handoffMm)) {
+        return false;
+    }
+    
     if (handoffState.direction == HANDOFF_RAIL1_TO_RAIL2) {
         // Moving Rail 1 to handoff - check if labware is present
         bool hasLabware = isLabwarePresentAtWC1() || isLabwarePresentAtWC2();
@@ -519,6 +527,14 @@ bool moveSourceRailToHandoffPosition() {
 }
 
 bool moveDestinationRailToTargetPosition() {
+    // Wait (bounded by the phase timeout) while the other rail sweeps the shared zone
+    int destRail = (handoffState.direction == HANDOFF_RAIL1_TO_RAIL2) ? 2 : 1;
+    double targetMm = (handoffState.destination == DEST_WC1) ? RAIL1_WC1_PICKUP_DROPOFF :
+                      (handoffState.destination == DEST_WC2) ? RAIL1_WC2_PICKUP_DROPOFF : RAIL2_WC3_PICKUP_DROPOFF;
+    if (!canReserveRailTravel(destRail, getMotorPositionMm(destRail), targetMm)) {
+        return false;
+    }
+    
     if (handoffState.direction == HANDOFF_RAIL1_TO_RAIL2) {
         // Moving Rail 2 to WC3 (collision already checked in startHandoff)
         return moveRail2CarriageToWC3(true); // Labware should be present after transfer
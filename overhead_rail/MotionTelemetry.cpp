@@ -0,0 +1,400 @@
+#include "MotionTelemetry.h"
+#include "MotorController.h"
+#include "Logging.h"
+
+//=============================================================================
+// CONSOLE OUTPUT FORMAT STRINGS
+//=============================================================================
+
+const char FMT_TELEMETRY_MOVE[] PROGMEM = "  Last move: %.1f->%.1fmm in %lums, settle %lums%s, peak %d.%d%%, mean %d.%d%%, dropouts %u";
+const char FMT_TELEMETRY_NO_MOVE[] PROGMEM = "  Last move: none recorded";
+const char FMT_TELEMETRY_SEGMENT[] PROGMEM = "  %5d-%5dmm %6u %3d.%d%% %3d.%d%% %3d.%d%% %6lums %5u%s";
+const char FMT_TELEMETRY_RISE_WARN[] PROGMEM = "Rail %d: Drive effort rising at %d-%dmm - peak torque %d.%d%% vs baseline %d.%d%%";
+const char FMT_TELEMETRY_DROPOUT[] PROGMEM = "Rail %d: HLFB dropped out during move at %.1fmm";
+const char FMT_TELEMETRY_SETTLE_TIMEOUT[] PROGMEM = "Rail %d: HLFB not in position %lums after steps complete";
+const char FMT_TELEMETRY_TRACE_HEADER[] PROGMEM = "[INFO] Rail %d trace: %u samples @ %ums (ms,pos_mm,torque_pct,hlfb)";
+const char FMT_TELEMETRY_TRACE_ROW[] PROGMEM = "%lu,%.2f,%d.%d,%u";
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+
+MotionTraceState rail1Trace;
+MotionTraceState rail2Trace;
+MoveTraceSummary lastMoveSummary[2] = {{0}, {0}};
+SegmentTelemetryStats segmentStats[2][TELEMETRY_SEGMENTS_PER_RAIL];
+
+//=============================================================================
+// INTERNAL HELPERS
+//=============================================================================
+
+static MotionTraceState &getTraceState(int rail)
+{
+    return (rail == 1) ? rail1Trace : rail2Trace;
+}
+
+// Format helpers for tenths without pulling float printing into every line
+static int wholePart(int16_t tenths)
+{
+    return tenths / TELEMETRY_TORQUE_SCALE;
+}
+
+static int fractionPart(int16_t tenths)
+{
+    return abs(tenths % TELEMETRY_TORQUE_SCALE);
+}
+
+static int16_t readTorqueTenths(MotorDriver &motor, MotorDriver::HlfbStates state)
+{
+    if (state != MotorDriver::HLFB_HAS_MEASUREMENT) {
+        return TELEMETRY_TORQUE_UNKNOWN;
+    }
+    return (int16_t)(motor.HlfbPercent() * TELEMETRY_TORQUE_SCALE);
+}
+
+// Keep every other sample and double the interval so long moves still fit
+static void decimateTrace(MotionTraceState &trace)
+{
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < trace.sampleCount; i += 2) {
+        trace.samples[kept++] = trace.samples[i];
+    }
+    trace.sampleCount = kept;
+    trace.sampleIntervalMs *= 2;
+}
+
+static void recordSample(int rail, MotionTraceState &trace, unsigned long currentTime)
+{
+    MotorDriver &motor = getMotorByRail(rail);
+    MotorDriver::HlfbStates hlfbState = motor.HlfbState();
+    int32_t positionPulses = motor.PositionRefCommanded();
+    int16_t torque = readTorqueTenths(motor, hlfbState);
+    int segment = getTelemetrySegment(rail, pulsesToMm(positionPulses, rail));
+
+    // Summary statistics use every sample, not just the ones retained after decimation
+    if (torque != TELEMETRY_TORQUE_UNKNOWN) {
+        int16_t magnitude = abs(torque);
+        trace.torqueSumTenths += magnitude;
+        trace.measuredCount++;
+        if (magnitude > trace.current.peakTorqueTenths) {
+            trace.current.peakTorqueTenths = magnitude;
+        }
+        if (magnitude > trace.segmentPeakTenths[segment]) {
+            trace.segmentPeakTenths[segment] = magnitude;
+        }
+    } else if (trace.segmentPeakTenths[segment] < 0) {
+        trace.segmentPeakTenths[segment] = 0; // Visited, but no measurement yet
+    }
+
+    // A deasserted HLFB while steps are active means the drive stopped tracking
+    if (trace.phase == TRACE_MOVING &&
+        hlfbState == MotorDriver::HLFB_DEASSERTED &&
+        trace.previousHlfbState != MotorDriver::HLFB_DEASSERTED) {
+        trace.current.hlfbDropouts++;
+        trace.segmentDropouts[segment]++;
+
+        char msg[MEDIUM_MSG_SIZE];
+        sprintf_P(msg, FMT_TELEMETRY_DROPOUT, rail, pulsesToMm(positionPulses, rail));
+        Console.serialWarning(msg);
+    }
+    trace.previousHlfbState = hlfbState;
+
+    if (trace.sampleCount >= MOTION_TRACE_MAX_SAMPLES) {
+        decimateTrace(trace);
+    }
+
+    // After decimation only keep samples that land on the new interval
+    unsigned long elapsed = timeDiff(currentTime, trace.moveStartTime);
+    if (trace.sampleCount > 0 &&
+        elapsed - trace.samples[trace.sampleCount - 1].elapsedMs < trace.sampleIntervalMs) {
+        return;
+    }
+
+    MotionTraceSample &sample = trace.samples[trace.sampleCount++];
+    sample.elapsedMs = elapsed;
+    sample.positionPulses = positionPulses;
+    sample.torqueTenths = torque;
+    sample.hlfbState = (uint8_t)hlfbState;
+    sample.reserved = 0;
+}
+
+static void updateSegmentStats(int rail, MotionTraceState &trace)
+{
+    SegmentTelemetryStats *stats = segmentStats[rail - 1];
+    int targetSegment = getTelemetrySegment(rail, pulsesToMm(trace.current.targetPulses, rail));
+    int segmentLengthMm = (int)getTelemetrySegmentLengthMm(rail);
+
+    for (int i = 0; i < TELEMETRY_SEGMENTS_PER_RAIL; i++) {
+        int16_t peak = trace.segmentPeakTenths[i];
+        if (peak < 0) {
+            continue; // Segment not swept by this move
+        }
+
+        SegmentTelemetryStats &segment = stats[i];
+        segment.hlfbDropouts += trace.segmentDropouts[i];
+
+        if (peak > segment.maxPeakTenths) {
+            segment.maxPeakTenths = peak;
+        }
+
+        if (segment.moveCount == 0) {
+            segment.ewmaPeakTenths = peak;
+        } else {
+            segment.ewmaPeakTenths += (peak - segment.ewmaPeakTenths) >> TELEMETRY_EWMA_SHIFT;
+        }
+
+        if (i == targetSegment && trace.current.settled) {
+            if (segment.ewmaSettleMs == 0) {
+                segment.ewmaSettleMs = trace.current.settleTimeMs;
+            } else {
+                int32_t delta = (int32_t)trace.current.settleTimeMs - (int32_t)segment.ewmaSettleMs;
+                segment.ewmaSettleMs += delta >> TELEMETRY_EWMA_SHIFT;
+            }
+        }
+
+        segment.moveCount++;
+
+        // Baseline is the mean peak of the first moves through the segment
+        if (segment.moveCount <= TELEMETRY_BASELINE_MOVES) {
+            segment.baselineAccumulator += peak;
+            if (segment.moveCount == TELEMETRY_BASELINE_MOVES) {
+                segment.baselinePeakTenths = segment.baselineAccumulator / TELEMETRY_BASELINE_MOVES;
+            }
+            continue;
+        }
+
+        // Rising drive effort: warn once, re-arm when it falls back
+        bool rising = segment.ewmaPeakTenths > segment.baselinePeakTenths + TELEMETRY_TORQUE_RISE_WARN;
+        if (rising && !segment.riseWarningIssued) {
+            char msg[MEDIUM_MSG_SIZE];
+            sprintf_P(msg, FMT_TELEMETRY_RISE_WARN, rail,
+                      i * segmentLengthMm, (i + 1) * segmentLengthMm,
+                      wholePart(segment.ewmaPeakTenths), fractionPart(segment.ewmaPeakTenths),
+                      wholePart(segment.baselinePeakTenths), fractionPart(segment.baselinePeakTenths));
+            Console.serialWarning(msg);
+            segment.riseWarningIssued = true;
+        } else if (!rising) {
+            segment.riseWarningIssued = false;
+        }
+    }
+}
+
+static void finishMoveTrace(int rail, MotionTraceState &trace, bool settled, unsigned long currentTime)
+{
+    trace.current.settled = settled;
+    trace.current.settleTimeMs = timeDiff(currentTime, trace.stepsCompleteTime);
+    trace.current.sampleCount = trace.sampleCount;
+    trace.current.sampleIntervalMs = trace.sampleIntervalMs;
+    trace.current.meanTorqueTenths = (trace.measuredCount > 0)
+        ? (int16_t)(trace.torqueSumTenths / trace.measuredCount) : 0;
+    trace.current.valid = true;
+
+    if (!settled) {
+        char msg[MEDIUM_MSG_SIZE];
+        sprintf_P(msg, FMT_TELEMETRY_SETTLE_TIMEOUT, rail, trace.current.settleTimeMs);
+        Console.serialWarning(msg);
+    }
+
+    lastMoveSummary[rail - 1] = trace.current;
+    updateSegmentStats(rail, trace);
+    trace.phase = TRACE_IDLE;
+}
+
+static void updateRailTrace(int rail)
+{
+    MotionTraceState &trace = getTraceState(rail);
+    if (trace.phase == TRACE_IDLE) {
+        return;
+    }
+
+    unsigned long currentTime = millis();
+    MotorDriver &motor = getMotorByRail(rail);
+
+    // E-stop or fault mid-move: keep what was captured but mark it unsettled
+    if (isEStopActive() || hasMotorFault(rail)) {
+        if (trace.phase == TRACE_MOVING) {
+            trace.stepsCompleteTime = currentTime;
+            trace.current.moveDurationMs = timeDiff(currentTime, trace.moveStartTime);
+        }
+        recordSample(rail, trace, currentTime);
+        finishMoveTrace(rail, trace, false, currentTime);
+        return;
+    }
+
+    if (waitTimeReached(currentTime, trace.lastSampleTime, trace.sampleIntervalMs)) {
+        trace.lastSampleTime = currentTime;
+        recordSample(rail, trace, currentTime);
+    }
+
+    if (trace.phase == TRACE_MOVING && motor.StepsComplete()) {
+        trace.phase = TRACE_SETTLING;
+        trace.stepsCompleteTime = currentTime;
+        trace.current.moveDurationMs = timeDiff(currentTime, trace.moveStartTime);
+    }
+
+    if (trace.phase == TRACE_SETTLING) {
+        if (motor.HlfbState() == MotorDriver::HLFB_ASSERTED) {
+            recordSample(rail, trace, currentTime);
+            finishMoveTrace(rail, trace, true, currentTime);
+        } else if (timeoutElapsed(currentTime, trace.stepsCompleteTime, MOTION_TRACE_SETTLE_TIMEOUT_MS)) {
+            finishMoveTrace(rail, trace, false, currentTime);
+        }
+    }
+}
+
+//=============================================================================
+// INITIALIZATION AND PERIODIC UPDATE
+//=============================================================================
+
+void initMotionTelemetry()
+{
+    rail1Trace.phase = TRACE_IDLE;
+    rail2Trace.phase = TRACE_IDLE;
+    lastMoveSummary[0].valid = false;
+    lastMoveSummary[1].valid = false;
+    resetSegmentTelemetry(1);
+    resetSegmentTelemetry(2);
+}
+
+void updateMotionTelemetry()
+{
+    updateRailTrace(1);
+    updateRailTrace(2);
+}
+
+//=============================================================================
+// MOVE LIFECYCLE
+//=============================================================================
+
+void beginMoveTrace(int rail, int32_t startPulses, int32_t targetPulses)
+{
+    if (rail != 1 && rail != 2) {
+        return;
+    }
+
+    MotionTraceState &trace = getTraceState(rail);
+
+    // A new move that interrupts an unfinished trace still closes it out,
+    // so the previous move's statistics are not lost
+    if (trace.phase != TRACE_IDLE) {
+        unsigned long currentTime = millis();
+        if (trace.phase == TRACE_MOVING) {
+            trace.stepsCompleteTime = currentTime;
+            trace.current.moveDurationMs = timeDiff(currentTime, trace.moveStartTime);
+        }
+        finishMoveTrace(rail, trace, false, currentTime);
+    }
+
+    trace.moveStartTime = millis();
+    trace.lastSampleTime = trace.moveStartTime;
+    trace.stepsCompleteTime = 0;
+    trace.sampleIntervalMs = MOTION_TRACE_SAMPLE_INTERVAL_MS;
+    trace.sampleCount = 0;
+    trace.previousHlfbState = MotorDriver::HLFB_ASSERTED;
+    trace.torqueSumTenths = 0;
+    trace.measuredCount = 0;
+    for (int i = 0; i < TELEMETRY_SEGMENTS_PER_RAIL; i++) {
+        trace.segmentPeakTenths[i] = -1;
+        trace.segmentDropouts[i] = 0;
+    }
+
+    trace.current = {0};
+    trace.current.startTime = trace.moveStartTime;
+    trace.current.startPulses = startPulses;
+    trace.current.targetPulses = targetPulses;
+
+    trace.phase = TRACE_MOVING;
+    recordSample(rail, trace, trace.moveStartTime);
+}
+
+//=============================================================================
+// SEGMENT HELPERS
+//=============================================================================
+
+double getTelemetrySegmentLengthMm(int rail)
+{
+    double maxTravelMm = (rail == 1) ? RAIL1_MAX_TRAVEL_MM : RAIL2_MAX_TRAVEL_MM;
+    return maxTravelMm / TELEMETRY_SEGMENTS_PER_RAIL;
+}
+
+int getTelemetrySegment(int rail, double positionMm)
+{
+    int segment = (int)(positionMm / getTelemetrySegmentLengthMm(rail));
+    return constrain(segment, 0, TELEMETRY_SEGMENTS_PER_RAIL - 1);
+}
+
+void resetSegmentTelemetry(int rail)
+{
+    if (rail != 1 && rail != 2) {
+        return;
+    }
+    for (int i = 0; i < TELEMETRY_SEGMENTS_PER_RAIL; i++) {
+        segmentStats[rail - 1][i] = {0};
+    }
+}
+
+//=============================================================================
+// REPORTING
+//=============================================================================
+
+void printMotionTelemetry(int rail)
+{
+    char msg[LARGE_MSG_SIZE];
+    MoveTraceSummary &summary = lastMoveSummary[rail - 1];
+
+    sprintf_P(msg, PSTR("[INFO] Rail %d Motion Telemetry:"), rail);
+    Console.println(msg);
+
+    if (summary.valid) {
+        sprintf_P(msg, FMT_TELEMETRY_MOVE,
+                  pulsesToMm(summary.startPulses, rail), pulsesToMm(summary.targetPulses, rail),
+                  summary.moveDurationMs, summary.settleTimeMs, summary.settled ? "" : " (NOT SETTLED)",
+                  wholePart(summary.peakTorqueTenths), fractionPart(summary.peakTorqueTenths),
+                  wholePart(summary.meanTorqueTenths), fractionPart(summary.meanTorqueTenths),
+                  summary.hlfbDropouts);
+    } else {
+        strcpy_P(msg, FMT_TELEMETRY_NO_MOVE);
+    }
+    Console.println(msg);
+
+    Console.println(F("  Segment (mm)   Moves   Base    EWMA    Max   Settle Drops"));
+    int segmentLengthMm = (int)getTelemetrySegmentLengthMm(rail);
+    for (int i = 0; i < TELEMETRY_SEGMENTS_PER_RAIL; i++) {
+        SegmentTelemetryStats &segment = segmentStats[rail - 1][i];
+        if (segment.moveCount == 0) {
+            continue;
+        }
+        sprintf_P(msg, FMT_TELEMETRY_SEGMENT,
+                  i * segmentLengthMm, (i + 1) * segmentLengthMm, segment.moveCount,
+                  wholePart(segment.baselinePeakTenths), fractionPart(segment.baselinePeakTenths),
+                  wholePart(segment.ewmaPeakTenths), fractionPart(segment.ewmaPeakTenths),
+                  wholePart(segment.maxPeakTenths), fractionPart(segment.maxPeakTenths),
+                  segment.ewmaSettleMs, segment.hlfbDropouts,
+                  segment.riseWarningIssued ? " RISING" : "");
+        Console.println(msg);
+    }
+}
+
+void printLastMoveTrace(int rail)
+{
+    MotionTraceState &trace = getTraceState(rail);
+    char msg[MEDIUM_MSG_SIZE];
+
+    if (trace.sampleCount == 0) {
+        sprintf_P(msg, PSTR("[INFO] Rail %d trace: no samples recorded"), rail);
+        Console.println(msg);
+        return;
+    }
+
+    sprintf_P(msg, FMT_TELEMETRY_TRACE_HEADER, rail, trace.sampleCount, trace.sampleIntervalMs);
+    Console.println(msg);
+
+    for (uint16_t i = 0; i < trace.sampleCount; i++) {
+        MotionTraceSample &sample = trace.samples[i];
+        int16_t torque = (sample.torqueTenths == TELEMETRY_TORQUE_UNKNOWN) ? 0 : sample.torqueTenths;
+        sprintf_P(msg, FMT_TELEMETRY_TRACE_ROW, sample.elapsedMs,
+                  pulsesToMm(sample.positionPulses, rail),
+                  wholePart(torque), fractionPart(torque), sample.hlfbState);
+        Console.println(msg);
+    }
+}
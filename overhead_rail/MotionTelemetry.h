@@ -0,0 +1,128 @@
+#ifndef MOTION_TELEMETRY_H
+#define MOTION_TELEMETRY_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "ClearCore.h"
+#include "Utils.h"
+
+//=============================================================================
+// TELEMETRY CONFIGURATION
+//=============================================================================
+// Trace buffer (preallocated per rail - no dynamic allocation)
+#define MOTION_TRACE_MAX_SAMPLES 200           // Samples kept for the most recent move per rail
+#define MOTION_TRACE_SAMPLE_INTERVAL_MS 10     // Base sampling period (doubles when a long move fills the buffer)
+#define MOTION_TRACE_SETTLE_TIMEOUT_MS 2000    // Give up waiting for HLFB in-position after steps complete
+
+// Torque values are stored as tenths of a percent (HlfbPercent() * 10)
+#define TELEMETRY_TORQUE_SCALE 10
+#define TELEMETRY_TORQUE_UNKNOWN INT16_MIN     // HLFB had no PWM measurement for this sample
+
+// Rolling per-segment statistics
+#define TELEMETRY_SEGMENTS_PER_RAIL 8          // Each rail's travel is split into equal segments
+#define TELEMETRY_BASELINE_MOVES 10            // Moves averaged into a segment's baseline peak torque
+#define TELEMETRY_EWMA_SHIFT 3                 // EWMA weight 1/8 for new moves (integer math)
+#define TELEMETRY_TORQUE_RISE_WARN 100         // Warn when EWMA peak exceeds baseline by 10.0% torque
+
+//=============================================================================
+// TELEMETRY STRUCTURES
+//=============================================================================
+
+// Trace recorder phases
+enum MotionTracePhase
+{
+    TRACE_IDLE,                            // No move being recorded
+    TRACE_MOVING,                          // Steps being generated
+    TRACE_SETTLING                         // Steps complete, waiting for HLFB in-position
+};
+
+// Single trace sample (12 bytes)
+struct MotionTraceSample
+{
+    uint32_t elapsedMs;                    // Time since move start
+    int32_t positionPulses;                // PositionRefCommanded() at sample time
+    int16_t torqueTenths;                  // HLFB duty as measured torque (0.1% units)
+    uint8_t hlfbState;                     // MotorDriver::HlfbStates
+    uint8_t reserved;
+};
+
+// Summary of one completed move
+struct MoveTraceSummary
+{
+    bool valid;                            // Summary holds a completed move
+    bool settled;                          // HLFB asserted before settle timeout
+    unsigned long startTime;               // millis() at move start
+    uint32_t moveDurationMs;               // Move start to steps complete
+    uint32_t settleTimeMs;                 // Steps complete to HLFB asserted
+    int32_t startPulses;                   // Commanded position at start
+    int32_t targetPulses;                  // Commanded target
+    int16_t peakTorqueTenths;              // Largest |torque| observed
+    int16_t meanTorqueTenths;              // Mean |torque| over measured samples
+    uint16_t hlfbDropouts;                 // HLFB deasserted while moving
+    uint16_t sampleCount;                  // Samples retained in the trace buffer
+    uint16_t sampleIntervalMs;             // Effective interval after decimation
+};
+
+// Rolling statistics for one segment of a rail
+struct SegmentTelemetryStats
+{
+    uint16_t moveCount;                    // Moves that swept this segment
+    int16_t baselinePeakTenths;            // Mean peak torque of the first baseline moves
+    int16_t ewmaPeakTenths;                // Exponentially weighted peak torque
+    int16_t maxPeakTenths;                 // Highest peak ever seen
+    uint32_t ewmaSettleMs;                 // Exponentially weighted settle time
+    uint16_t hlfbDropouts;                 // Total dropouts while in this segment
+    bool riseWarningIssued;                // Avoid repeating the drive effort warning
+    int32_t baselineAccumulator;           // Sum of peaks while the baseline is forming
+};
+
+// Per-rail recorder state
+struct MotionTraceState
+{
+    MotionTracePhase phase;
+    unsigned long moveStartTime;
+    unsigned long lastSampleTime;
+    unsigned long stepsCompleteTime;
+    uint16_t sampleIntervalMs;
+    uint16_t sampleCount;
+    uint8_t previousHlfbState;
+    int32_t torqueSumTenths;               // Running |torque| sum for the mean (independent of decimation)
+    uint16_t measuredCount;                // Samples that carried a torque measurement
+    int16_t segmentPeakTenths[TELEMETRY_SEGMENTS_PER_RAIL];  // Peak per segment for this move (-1 = not visited)
+    uint16_t segmentDropouts[TELEMETRY_SEGMENTS_PER_RAIL];
+    MoveTraceSummary current;              // Summary being built for the active move
+    MotionTraceSample samples[MOTION_TRACE_MAX_SAMPLES];
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+
+extern MotionTraceState rail1Trace;
+extern MotionTraceState rail2Trace;
+extern MoveTraceSummary lastMoveSummary[2];     // Index 0 = Rail 1, index 1 = Rail 2
+extern SegmentTelemetryStats segmentStats[2][TELEMETRY_SEGMENTS_PER_RAIL];
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+
+// Initialization and periodic sampling (call every loop)
+void initMotionTelemetry();
+void updateMotionTelemetry();
+
+// Move lifecycle hooks (called from MotorController when a move is commanded)
+void beginMoveTrace(int rail, int32_t startPulses, int32_t targetPulses);
+
+// Segment helpers
+int getTelemetrySegment(int rail, double positionMm);
+double getTelemetrySegmentLengthMm(int rail);
+
+// Reporting
+void printMotionTelemetry(int rail);
+void printLastMoveTrace(int rail);     // CSV dump of the most recent trace
+void resetSegmentTelemetry(int rail);
+
+#endif // MOTION_TELEMETRY_H
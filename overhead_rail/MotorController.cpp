@@ -2,6 +2,8 @@
 #include "CommandController.h"
 #include "Utils.h"
 #include "LabwareAutomation.h"
+#include "CollisionZoneManager.h"
+#include "MotionTelemetry.h"
 
 //=============================================================================
 // PROGMEM STRING CONSTANTS
@@ -1116,6 +1118,11 @@ bool initiateHomingSequence(int rail) {
         return false;
     }
 
+    // Homing sweeps toward an unknown hardstop - reserve the full rail
+    if (reserveFullRailTravel(rail) != ZONE_RESERVATION_GRANTED) {
+        return false;
+    }
+
     // Reset homing state
     resetHomingState(rail);
     
@@ -1469,6 +1476,11 @@ bool initiateSmartHomingSequence(int rail) {
         return initiateHomingSequence(rail);
     }
     
+    // Homing sweeps toward an unknown hardstop - reserve the full rail
+    if (reserveFullRailTravel(rail) != ZONE_RESERVATION_GRANTED) {
+        return false;
+    }
+    
     // Reset homing state for smart sequence
     resetHomingState(rail);
     
@@ -1670,6 +1682,11 @@ bool moveToPositionFromCurrent(int rail, PositionTarget target, bool carriageLoa
         return true;
     }
     
+    // Reserve the swept interval against the other rail
+    if (reserveRailTravel(rail, pulsesToMm(currentPulses, rail), pulsesToMm(targetPulses, rail)) != ZONE_RESERVATION_GRANTED) {
+        return false;
+    }
+    
     // Calculate movement distance and select velocity
     double moveDistanceMm = abs(pulsesToMm(movePulses, rail));
     int32_t velocityRpm = selectMoveVelocityByDistance(rail, moveDistanceMm, carriageLoaded);
@@ -1678,6 +1695,7 @@ bool moveToPositionFromCurrent(int rail, PositionTarget target, bool carriageLoa
     // Set velocity and initiate move
     setMotorVelocity(rail, velocityPps);
     motor.Move(movePulses);
+    beginMoveTrace(rail, currentPulses, targetPulses);
     
     // Initialize movement tracking with carriage state
     MotorTargetState& targetState = getTargetState(rail);
@@ -1725,6 +1743,11 @@ bool moveToPositionMm(int rail, double targetMm, bool carriageLoaded) {
         return true;
     }
     
+    // Reserve the swept interval against the other rail
+    if (reserveRailTravel(rail, pulsesToMm(currentPulses, rail), pulsesToMm(targetPulses, rail)) != ZONE_RESERVATION_GRANTED) {
+        return false;
+    }
+    
     // Calculate movement distance and select velocity
     double moveDistanceMm = abs(pulsesToMm(movePulses, rail));
     int32_t velocityRpm = selectMoveVelocityByDistance(rail, moveDistanceMm, carriageLoaded);
@@ -1733,6 +1756,7 @@ bool moveToPositionMm(int rail, double targetMm, bool carriageLoaded) {
     // Set velocity and initiate move
     setMotorVelocity(rail, velocityPps);
     motor.Move(movePulses);
+    beginMoveTrace(rail, currentPulses, targetPulses);
     
     // Initialize movement tracking with carriage state
     MotorTargetState& targetState = getTargetState(rail);
@@ -1783,6 +1807,11 @@ bool moveRelativeMm(int rail, double distanceMm, bool carriageLoaded) {
         return true;
     }
     
+    // Reserve the swept interval against the other rail
+    if (reserveRailTravel(rail, currentMm, targetMm) != ZONE_RESERVATION_GRANTED) {
+        return false;
+    }
+    
     // Calculate movement distance and select velocity
     double moveDistanceMm = abs(distanceMm);
     int32_t velocityRpm = selectMoveVelocityByDistance(rail, moveDistanceMm, carriageLoaded);
@@ -1791,6 +1820,7 @@ bool moveRelativeMm(int rail, double distanceMm, bool carriageLoaded) {
     // Set velocity and initiate move
     setMotorVelocity(rail, velocityPps);
     motor.Move(movePulses);
+    beginMoveTrace(rail, mmToPulses(currentMm, rail), mmToPulses(targetMm, rail));
     
     // Initialize movement tracking with carriage state
     MotorTargetState& targetState = getTargetState(rail);
@@ -1855,6 +1885,11 @@ bool jogMotor(int rail, bool direction, double customIncrement, bool carriageLoa
         return false;
     }
     
+    // Reserve the swept interval against the other rail
+    if (reserveRailTravel(rail, currentMm, targetMm) != ZONE_RESERVATION_GRANTED) {
+        return false;
+    }
+    
     // Apply speed capping based on jog distance (silently for common operations)
     int cappedSpeedRpm = jogSpeedRpm;
     if (jogIncrementMm <= JOG_VERY_SHORT_THRESHOLD_MM) { // Very short jog
@@ -1873,6 +1908,7 @@ bool jogMotor(int rail, bool direction, double customIncrement, bool carriageLoa
     
     setMotorVelocity(rail, jogVelocityPps);
     motor.Move(jogPulses);
+    beginMoveTrace(rail, mmToPulses(currentMm, rail), mmToPulses(targetMm, rail));
     
     // Log the jog operation with speed capping info included if relevant
     const char* speedNote = "";
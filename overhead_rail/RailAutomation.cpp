@@ -2,6 +2,7 @@
 #include "HandoffController.h"
 #include "LabwareAutomation.h"
 #include "Logging.h"
+#include "CollisionZoneManager.h"
 
 //=============================================================================
 // CONSOLE OUTPUT FORMAT STRINGS
@@ -586,40 +587,29 @@ bool executeRailMoveToPosition(int railNumber, double positionMm, bool carriageL
     // Use helper functions for common validation
     if (!checkRailMovementReadiness(railNumber)) return false;
     
+    double currentPos = getMotorPositionMm(railNumber);
+    
     // Rail 2 specific collision zone safety logic
     if (railNumber == 2) {
         // CRITICAL SAFETY: Check if any part of the movement path requires cylinder retraction to prevent Rail 1 collision
-        // Collision zone is between RAIL2_COLLISION_ZONE_START and RAIL2_COLLISION_ZONE_END
-        // We must check current position, target position, and the entire movement path
-        double currentPos = getMotorPositionMm(2);
-        bool movementInCollisionZone = false;
-        
-        // Check if current position is in collision zone
-        if (currentPos >= RAIL2_COLLISION_ZONE_START && currentPos <= RAIL2_COLLISION_ZONE_END) {
-            movementInCollisionZone = true;
-        }
-        
-        // Check if target position is in collision zone
-        if (positionMm >= RAIL2_COLLISION_ZONE_START && positionMm <= RAIL2_COLLISION_ZONE_END) {
-            movementInCollisionZone = true;
-        }
-        
-        // Check if movement path crosses collision zone (even if start/end are outside zone)
-        if (currentPos < RAIL2_COLLISION_ZONE_START && positionMm >= RAIL2_COLLISION_ZONE_START) {
-            movementInCollisionZone = true; // Entering collision zone
-        }
-        if (currentPos > RAIL2_COLLISION_ZONE_END && positionMm <= RAIL2_COLLISION_ZONE_END) {
-            movementInCollisionZone = true; // Entering collision zone from far side
-        }
-        if ((currentPos >= RAIL2_COLLISION_ZONE_START && currentPos <= RAIL2_COLLISION_ZONE_END) && 
-            (positionMm < RAIL2_COLLISION_ZONE_START || positionMm > RAIL2_COLLISION_ZONE_END)) {
-            movementInCollisionZone = true; // Exiting collision zone
-        }
+        // Entering, exiting, crossing or moving within RAIL2_COLLISION_ZONE_START..END all count
+        bool movementInCollisionZone = sweptIntervalOverlaps(currentPos, positionMm,
+                                                             RAIL2_COLLISION_ZONE_START, RAIL2_COLLISION_ZONE_END);
         
         // Use helper function for cylinder safety
         if (!ensureCylinderRetractedForSafeMovement(movementInCollisionZone)) return false;
     }
     
+    // Queue instead of failing when the other rail is sweeping the shared zone
+    if (!canReserveRailTravel(railNumber, currentPos, positionMm)) {
+        if (queueRailMove(railNumber, positionMm, carriageLoaded)) {
+            Console.acknowledge(F("MOVE_QUEUED: Waiting for other rail to clear shared zone"));
+            return true;
+        }
+        Console.error(F("SHARED_ZONE_BUSY"));
+        return false;
+    }
+    
     Console.serialInfo(carriageLoaded ? 
         F("Moving carriage with labware to absolute position...") :
         F("Moving empty carriage to absolute position..."));
@@ -638,40 +628,29 @@ bool executeRailMoveRelative(int railNumber, double distanceMm, bool carriageLoa
     // Use helper functions for common validation
     if (!checkRailMovementReadiness(railNumber)) return false;
     
+    double currentPos = getMotorPositionMm(railNumber);
+    double calculatedTargetPos = currentPos + distanceMm;
+    
     // Rail 2 specific collision zone safety logic
     if (railNumber == 2) {
         // CRITICAL SAFETY: Check if any part of the movement path requires cylinder retraction to prevent Rail 1 collision
-        // Calculate target position and check if movement involves collision zone (500-700mm)
-        double currentPos = getMotorPositionMm(2);
-        double calculatedTargetPos = currentPos + distanceMm;
-        bool movementInCollisionZone = false;
-        
-        // Check if current position is in collision zone
-        if (currentPos >= RAIL2_COLLISION_ZONE_START && currentPos <= RAIL2_COLLISION_ZONE_END) {
-            movementInCollisionZone = true;
-        }
-        
-        // Check if target position is in collision zone
-        if (calculatedTargetPos >= RAIL2_COLLISION_ZONE_START && calculatedTargetPos <= RAIL2_COLLISION_ZONE_END) {
-            movementInCollisionZone = true;
-        }
-        
-        // Check if movement path crosses collision zone boundary
-        if (currentPos < RAIL2_COLLISION_ZONE_START && calculatedTargetPos >= RAIL2_COLLISION_ZONE_START) {
-            movementInCollisionZone = true; // Entering collision zone
-        }
-        if (currentPos > RAIL2_COLLISION_ZONE_END && calculatedTargetPos <= RAIL2_COLLISION_ZONE_END) {
-            movementInCollisionZone = true; // Entering collision zone from far side
-        }
-        if ((currentPos >= RAIL2_COLLISION_ZONE_START && currentPos <= RAIL2_COLLISION_ZONE_END) && 
-            (calculatedTargetPos < RAIL2_COLLISION_ZONE_START || calculatedTargetPos > RAIL2_COLLISION_ZONE_END)) {
-            movementInCollisionZone = true; // Exiting collision zone
-        }
+        bool movementInCollisionZone = sweptIntervalOverlaps(currentPos, calculatedTargetPos,
+                                                             RAIL2_COLLISION_ZONE_START, RAIL2_COLLISION_ZONE_END);
         
         // Use helper function for cylinder safety
         if (!ensureCylinderRetractedForSafeMovement(movementInCollisionZone)) return false;
     }
     
+    // Queue as an absolute move so the target doesn't drift while waiting
+    if (!canReserveRailTravel(railNumber, currentPos, calculatedTargetPos)) {
+        if (queueRailMove(railNumber, calculatedTargetPos, carriageLoaded)) {
+            Console.acknowledge(F("MOVE_QUEUED: Waiting for other rail to clear shared zone"));
+            return true;
+        }
+        Console.error(F("SHARED_ZONE_BUSY"));
+        return false;
+    }
+    
     Console.serialInfo(carriageLoaded ? 
         F("Moving carriage with labware relative distance...") :
         F("Moving empty carriage relative distance..."));
@@ -840,8 +819,8 @@ bool performGotoPreflightChecks(Location targetLocation, bool hasLabware) {
     if (targetLocation == LOCATION_WC3) {
         // Moving to WC3 requires Rail 2 collision zone safety
         double rail2Position = getMotorPositionMm(2);
-        bool inCollisionZone = (rail2Position >= RAIL2_COLLISION_ZONE_START && 
-                               rail2Position <= RAIL2_COLLISION_ZONE_END);
+        bool inCollisionZone = sweptIntervalOverlaps(rail2Position, rail2Position,
+                                                     RAIL2_COLLISION_ZONE_START, RAIL2_COLLISION_ZONE_END);
         
         if (inCollisionZone && !isCylinderActuallyRetracted()) {
             Console.error(F("PREFLIGHT_FAIL: Rail 2 cylinder extended in collision zone"));
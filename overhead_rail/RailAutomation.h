@@ -70,6 +70,8 @@ bool executeRailClearFault(int railNumber);
 bool executeRailAbort(int railNumber);
 bool executeRailStop(int railNumber);
 bool executeRailHome(int railNumber);
+// Also return true when the move was only queued behind the other rail's shared
+// zone reservation; callers that need the rail in position check hasQueuedRailMove()
 bool executeRailMoveToPosition(int railNumber, double positionMm, bool carriageLoaded);
 bool executeRailMoveRelative(int railNumber, double distanceMm, bool carriageLoaded);
 
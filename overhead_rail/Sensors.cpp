@@ -1,6 +1,7 @@
 #include "Sensors.h"
 #include "Utils.h"
 #include "LogHistory.h"
+#include "TraceRecorder.h"
 #include "ClearCore.h"
 
 //=============================================================================
@@ -200,6 +201,7 @@ void updateAllSensors()
 
     // Check for any sensor-related alerts
     logSensorChanges();
+    recordTraceSensorEdges();
     checkSensorAlerts();
 }
 
@@ -8,6 +8,8 @@
 #include "HandoffController.h"
 #include "LabwareAutomation.h"
 #include "RailAutomation.h"
+#include "CollisionZoneManager.h"
+#include "TraceRecorder.h"
 #include "Utils.h"
 
 // Global system state data
@@ -540,6 +542,8 @@ void resetSystemState()
     char msg[LARGE_MSG_SIZE];
     
     Console.serialInfo(F("SYSTEM RESET: Clearing operational state"));
+    cancelQueuedRailMoves();
+    stopTraceReplay();
     
     // 1. MOTOR FAULT RECOVERY
     // =======================
@@ -600,6 +604,7 @@ void resetSystemState()
     
     if (resetSuccessful && !isEStopActive()) {
         bool positioningSuccessful = true;
+        bool movesQueued = false;
         
         // Step 1: Retract cylinder
         Console.serialInfo(F("Rail 2: Retracting cylinder"));
@@ -615,6 +620,10 @@ void resetSystemState()
             if (!executeRailMoveToPosition(2, RAIL2_WC3_PICKUP_DROPOFF, false)) {
                 Console.serialWarning(F("Rail 2: Move to WC3 failed"));
                 positioningSuccessful = false;
+            } else if (hasQueuedRailMove(2)) {
+                // Not moving yet - Rail 1 leaving the shared zone in step 3 releases it
+                Console.serialWarning(F("Rail 2: Move to WC3 queued behind Rail 1 shared zone reservation"));
+                movesQueued = true;
             }
         }
         
@@ -624,12 +633,19 @@ void resetSystemState()
             if (!executeRailMoveToPosition(1, RAIL1_STAGING_POSITION, false)) {
                 Console.serialWarning(F("Rail 1: Move to Staging failed"));
                 positioningSuccessful = false;
+            } else if (hasQueuedRailMove(1)) {
+                Console.serialWarning(F("Rail 1: Move to Staging queued behind Rail 2 shared zone reservation"));
+                movesQueued = true;
             }
         }
         
         if (!positioningSuccessful) {
             Console.serialWarning(F("POSITIONING: Some moves failed - manual positioning required"));
             resetSuccessful = false;
+        } else if (movesQueued) {
+            // Reset positions not reached yet - check system,zones before starting automation
+            Console.serialWarning(F("POSITIONING: Queued moves start when the shared zone clears - check system,zones"));
+            resetSuccessful = false;
         }
     } else {
         Console.serialWarning(F("POSITIONING: Skipped due to faults/E-stop"));
@@ -0,0 +1,653 @@
+#include "TraceRecorder.h"
+#include "MotorController.h"
+#include "Sensors.h"
+#include "PositionConfig.h"
+#include <SD.h>
+
+//=============================================================================
+// CONSOLE OUTPUT FORMAT STRINGS
+//=============================================================================
+
+const char FMT_TRACE_STATUS[] PROGMEM = "  State: %s  Events: %u/%u  Commands: %u/%u  Duration: %lums%s";
+const char FMT_TRACE_REPLAY_PROGRESS[] PROGMEM = "  Replay (%s): %u/%u events issued, %u commands";
+const char FMT_TRACE_REPLAY_RESULT[] PROGMEM = "  Matched: %u  Missing: %u  Unexpected: %u  Drift max/mean: %lu/%lums";
+const char FMT_TRACE_EVENT_COMMAND[] PROGMEM = "%8lu CMD    %-7s %s";
+const char FMT_TRACE_EVENT_SENSOR[] PROGMEM = "%8lu SENSOR %s -> %s";
+const char FMT_TRACE_EVENT_MOTOR[] PROGMEM = "%8lu MOTOR  Rail %u 0x%02X%s%s%s%s%s%s";
+const char FMT_TRACE_EVENT_MARKER[] PROGMEM = "%8lu MARKER %u";
+const char FMT_TRACE_REPLAY_COMMAND[] PROGMEM = "[REPLAY COMMAND] %s";
+const char FMT_TRACE_DIVERGENCE[] PROGMEM = "Replay divergence @%lums: %s %s (recorded @%lums)";
+const char FMT_TRACE_LOADED[] PROGMEM = "Trace loaded: %u events, %u commands, %lums";
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+
+TraceRecorder traceRecorder;
+TraceEvent traceEvents[TRACE_MAX_EVENTS];
+char traceCommands[TRACE_MAX_COMMANDS][MAX_COMMAND_LENGTH];
+
+// Sensors tracked by the recorder - index is the event id, so only append
+static DigitalSensor *const TRACE_SENSORS[] = {
+    &carriageSensorWC1,
+    &carriageSensorWC2,
+    &carriageSensorWC3,
+    &labwareSensorWC1,
+    &labwareSensorWC2,
+    &carriageSensorRail1Handoff,
+    &carriageSensorRail2Handoff,
+    &labwareSensorRail2,
+    &labwareSensorHandoff,
+    &cylinderRetractedSensor,
+    &cylinderExtendedSensor};
+
+static const uint8_t TRACE_SENSOR_COUNT = sizeof(TRACE_SENSORS) / sizeof(TRACE_SENSORS[0]);
+static const uint8_t TRACE_MAIN_BOARD_SENSOR_COUNT = 5;  // Remaining sensors are on the CCIO board
+
+// Marker codes
+#define TRACE_MARKER_START 0
+#define TRACE_MARKER_OVERFLOW 1
+
+//=============================================================================
+// INTERNAL HELPERS
+//=============================================================================
+
+static const char *getTraceStateName(TraceRecorderState state)
+{
+    switch (state) {
+        case TRACE_STATE_RECORDING: return "RECORDING";
+        case TRACE_STATE_REPLAYING: return "REPLAYING";
+        default:                    return "IDLE";
+    }
+}
+
+static const char *getTraceSensorName(uint8_t id)
+{
+    if (id < TRACE_SENSOR_COUNT && TRACE_SENSORS[id]->name) {
+        return TRACE_SENSORS[id]->name;
+    }
+    return "UNKNOWN";
+}
+
+static uint16_t readMotorStatusBits(int rail)
+{
+    MotorDriver &motor = getMotorByRail(rail);
+    uint16_t bits = 0;
+
+    if (!motor.StepsComplete())                              bits |= TRACE_MOTOR_MOVING;
+    if (motor.HlfbState() == MotorDriver::HLFB_ASSERTED)     bits |= TRACE_MOTOR_HLFB_ASSERTED;
+    if (motor.StatusReg().bit.AlertsPresent)                 bits |= TRACE_MOTOR_ALERTS;
+    if (isHomingComplete(rail))                              bits |= TRACE_MOTOR_HOMED;
+    if (isHomingInProgress(rail))                            bits |= TRACE_MOTOR_HOMING;
+    if (motor.EnableRequest())                               bits |= TRACE_MOTOR_ENABLED;
+
+    return bits;
+}
+
+static uint32_t traceElapsed()
+{
+    return timeDiff(millis(), traceRecorder.startTime);
+}
+
+static bool appendTraceEvent(uint8_t type, uint8_t id, uint16_t value)
+{
+    if (traceRecorder.eventCount >= TRACE_MAX_EVENTS - 1) {
+        // Reserve the last slot for the overflow marker
+        TraceEvent &marker = traceEvents[traceRecorder.eventCount++];
+        marker.timeMs = traceElapsed();
+        marker.type = TRACE_EVENT_MARKER;
+        marker.id = TRACE_MARKER_OVERFLOW;
+        marker.value = 0;
+        traceRecorder.overflow = true;
+        stopTraceRecording();
+        Console.serialWarning(F("Trace buffer full - recording stopped"));
+        return false;
+    }
+
+    TraceEvent &event = traceEvents[traceRecorder.eventCount++];
+    event.timeMs = traceElapsed();
+    event.type = type;
+    event.id = id;
+    event.value = value;
+    return true;
+}
+
+static bool isExpectedEvent(const TraceEvent &event)
+{
+    return event.type == TRACE_EVENT_SENSOR || event.type == TRACE_EVENT_MOTOR;
+}
+
+static void describeEvent(char *buffer, uint8_t type, uint8_t id, uint16_t value)
+{
+    if (type == TRACE_EVENT_SENSOR) {
+        sprintf_P(buffer, PSTR("sensor %s=%u"), getTraceSensorName(id), value);
+    } else {
+        sprintf_P(buffer, PSTR("rail %u status=0x%02X"), id, value);
+    }
+}
+
+static void reportDivergence(const char *kind, uint8_t type, uint8_t id, uint16_t value, uint32_t recordedMs)
+{
+    TraceReplayStats &stats = traceRecorder.replayStats;
+    uint16_t reported = stats.eventsMissing + stats.eventsUnexpected;
+    if (reported > TRACE_REPLAY_MAX_REPORTED) {
+        return;
+    }
+
+    char eventText[SMALL_MSG_SIZE];
+    char msg[MEDIUM_MSG_SIZE];
+    describeEvent(eventText, type, id, value);
+    sprintf_P(msg, FMT_TRACE_DIVERGENCE, traceElapsed(), kind, eventText, recordedMs);
+    Console.serialWarning(msg);
+}
+
+// Mark recorded events in [from, to) as missing
+static void markEventsMissing(uint16_t from, uint16_t to)
+{
+    for (uint16_t k = from; k < to; k++) {
+        const TraceEvent &event = traceEvents[k];
+        if (isExpectedEvent(event)) {
+            traceRecorder.replayStats.eventsMissing++;
+            reportDivergence("missing", event.type, event.id, event.value, event.timeMs);
+        }
+    }
+}
+
+// Compare an observed event against the recording during replay
+static void matchReplayEvent(uint8_t type, uint8_t id, uint16_t value)
+{
+    TraceReplayStats &stats = traceRecorder.replayStats;
+    uint8_t scanned = 0;
+
+    for (uint16_t k = traceRecorder.expectedCursor;
+         k < traceRecorder.eventCount && scanned < TRACE_REPLAY_MATCH_WINDOW; k++) {
+        const TraceEvent &event = traceEvents[k];
+        if (!isExpectedEvent(event)) {
+            continue;
+        }
+        scanned++;
+
+        if (event.type == type && event.id == id && event.value == value) {
+            markEventsMissing(traceRecorder.expectedCursor, k);
+            traceRecorder.expectedCursor = k + 1;
+
+            uint32_t observedMs = traceElapsed();
+            uint32_t drift = (observedMs > event.timeMs) ? observedMs - event.timeMs : event.timeMs - observedMs;
+            stats.eventsMatched++;
+            stats.totalDriftMs += drift;
+            if (drift > stats.maxDriftMs) {
+                stats.maxDriftMs = drift;
+            }
+            return;
+        }
+    }
+
+    stats.eventsUnexpected++;
+    reportDivergence("unexpected", type, id, value, 0);
+}
+
+// Route an observed sensor/motor event to the recorder or the replay matcher
+static void observeTraceEvent(uint8_t type, uint8_t id, uint16_t value)
+{
+    if (traceRecorder.state == TRACE_STATE_RECORDING) {
+        appendTraceEvent(type, id, value);
+    } else if (traceRecorder.state == TRACE_STATE_REPLAYING) {
+        matchReplayEvent(type, id, value);
+    }
+}
+
+// Starting conditions are captured the same way for recording and replay,
+// so a replay started from a different machine state shows up as divergence
+static void observeInitialState()
+{
+    for (int rail = 1; rail <= 2; rail++) {
+        traceRecorder.lastMotorStatus[rail - 1] = readMotorStatusBits(rail);
+        observeTraceEvent(TRACE_EVENT_MOTOR, rail, traceRecorder.lastMotorStatus[rail - 1]);
+    }
+
+    uint8_t sensorCount = hasCCIO ? TRACE_SENSOR_COUNT : TRACE_MAIN_BOARD_SENSOR_COUNT;
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        observeTraceEvent(TRACE_EVENT_SENSOR, i, TRACE_SENSORS[i]->currentState ? 1 : 0);
+    }
+}
+
+static void finishTraceReplay()
+{
+    // Anything still expected at the end never happened
+    markEventsMissing(traceRecorder.expectedCursor, traceRecorder.eventCount);
+    traceRecorder.expectedCursor = traceRecorder.eventCount;
+    traceRecorder.state = TRACE_STATE_IDLE;
+
+    Console.serialInfo(F("Trace replay complete"));
+    printTraceStatus();
+}
+
+// True if recorded sensor/motor events before the given index are still unobserved
+static bool hasPendingExpectedBefore(uint16_t index)
+{
+    for (uint16_t k = traceRecorder.expectedCursor; k < index; k++) {
+        if (isExpectedEvent(traceEvents[k])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void updateTraceReplay()
+{
+    if (isEStopActive()) {
+        Console.serialError(F("E-stop active - trace replay aborted"));
+        stopTraceReplay();
+        return;
+    }
+
+    unsigned long currentTime = millis();
+    uint32_t elapsed = traceElapsed();
+
+    while (traceRecorder.replayCursor < traceRecorder.eventCount) {
+        const TraceEvent &event = traceEvents[traceRecorder.replayCursor];
+
+        if (event.type != TRACE_EVENT_COMMAND) {
+            traceRecorder.replayCursor++; // Observed, not issued
+            continue;
+        }
+
+        if (traceRecorder.replayMode == TRACE_REPLAY_TIMED) {
+            if (event.timeMs > elapsed) {
+                return;
+            }
+        } else if (hasPendingExpectedBefore(traceRecorder.replayCursor)) {
+            if (traceRecorder.replayWaitStart == 0) {
+                traceRecorder.replayWaitStart = currentTime;
+            }
+            if (!timeoutElapsed(currentTime, traceRecorder.replayWaitStart, TRACE_REPLAY_SYNC_TIMEOUT_MS)) {
+                return;
+            }
+            // Give up on the events the command was waiting for
+            markEventsMissing(traceRecorder.expectedCursor, traceRecorder.replayCursor);
+            traceRecorder.expectedCursor = traceRecorder.replayCursor;
+        }
+
+        if (event.value >= traceRecorder.commandCount) {
+            Console.serialError(F("Trace replay stopped: command event has no command slot"));
+            stopTraceReplay();
+            return;
+        }
+
+        char taggedCommand[MEDIUM_MSG_SIZE];
+        const char *command = traceCommands[event.value];
+        sprintf_P(taggedCommand, FMT_TRACE_REPLAY_COMMAND, command);
+        Console.serialInfo(taggedCommand);
+
+        traceRecorder.replayCursor++;
+        traceRecorder.replayWaitStart = 0;
+        traceRecorder.replayStats.commandsIssued++;
+
+        traceRecorder.issuingReplayCommand = true;
+        processCommand(command, &Serial, taggedCommand);
+        traceRecorder.issuingReplayCommand = false;
+
+        if (traceRecorder.state != TRACE_STATE_REPLAYING) {
+            return; // The command stopped the replay
+        }
+    }
+
+    // All commands issued - wait for the remaining recorded events or time out
+    if (traceRecorder.expectedCursor >= traceRecorder.eventCount ||
+        !hasPendingExpectedBefore(traceRecorder.eventCount) ||
+        elapsed > traceRecorder.durationMs + TRACE_REPLAY_SYNC_TIMEOUT_MS) {
+        finishTraceReplay();
+    }
+}
+
+//=============================================================================
+// INITIALIZATION AND PERIODIC UPDATE
+//=============================================================================
+
+void initTraceRecorder()
+{
+    traceRecorder.state = TRACE_STATE_IDLE;
+    traceRecorder.issuingReplayCommand = false;
+    clearTrace();
+}
+
+void updateTraceRecorder()
+{
+    if (traceRecorder.state == TRACE_STATE_IDLE) {
+        return;
+    }
+
+    // Motor status changes
+    for (int rail = 1; rail <= 2; rail++) {
+        uint16_t status = readMotorStatusBits(rail);
+        if (status != traceRecorder.lastMotorStatus[rail - 1]) {
+            traceRecorder.lastMotorStatus[rail - 1] = status;
+            observeTraceEvent(TRACE_EVENT_MOTOR, rail, status);
+        }
+    }
+
+    if (traceRecorder.state == TRACE_STATE_REPLAYING) {
+        updateTraceReplay();
+    }
+}
+
+//=============================================================================
+// RECORDING CONTROL
+//=============================================================================
+
+bool startTraceRecording()
+{
+    if (traceRecorder.state == TRACE_STATE_REPLAYING) {
+        Console.serialError(F("Cannot record while a trace is replaying"));
+        return false;
+    }
+
+    clearTrace();
+    traceRecorder.startTime = millis();
+    traceRecorder.state = TRACE_STATE_RECORDING;
+    appendTraceEvent(TRACE_EVENT_MARKER, TRACE_MARKER_START, 0);
+    observeInitialState();
+    return true;
+}
+
+void stopTraceRecording()
+{
+    if (traceRecorder.state != TRACE_STATE_RECORDING) {
+        return;
+    }
+    traceRecorder.durationMs = traceElapsed();
+    traceRecorder.state = TRACE_STATE_IDLE;
+}
+
+void clearTrace()
+{
+    if (traceRecorder.state == TRACE_STATE_REPLAYING) {
+        stopTraceReplay();
+    }
+    traceRecorder.state = TRACE_STATE_IDLE;
+    traceRecorder.eventCount = 0;
+    traceRecorder.commandCount = 0;
+    traceRecorder.durationMs = 0;
+    traceRecorder.overflow = false;
+    traceRecorder.replayStats = {0};
+}
+
+bool isTraceRecording()
+{
+    return traceRecorder.state == TRACE_STATE_RECORDING;
+}
+
+//=============================================================================
+// RECORDING HOOKS
+//=============================================================================
+
+void recordTraceCommand(const char *command, Stream *output)
+{
+    if (traceRecorder.state != TRACE_STATE_RECORDING) {
+        return;
+    }
+
+    // Trace control commands are not part of the trace (replay would recurse)
+    if (strncmp(command, "trace", 5) == 0) {
+        return;
+    }
+
+    // Reuse the slot of an identical command to stretch the string pool
+    uint16_t slot = 0;
+    while (slot < traceRecorder.commandCount && strcmp(traceCommands[slot], command) != 0) {
+        slot++;
+    }
+
+    if (slot == traceRecorder.commandCount) {
+        if (traceRecorder.commandCount >= TRACE_MAX_COMMANDS) {
+            traceRecorder.overflow = true;
+            stopTraceRecording();
+            Console.serialWarning(F("Trace command pool full - recording stopped"));
+            return;
+        }
+        strncpy(traceCommands[slot], command, MAX_COMMAND_LENGTH - 1);
+        traceCommands[slot][MAX_COMMAND_LENGTH - 1] = '\0';
+        traceRecorder.commandCount++;
+    }
+
+    uint8_t source = (output == &Serial) ? TRACE_SOURCE_SERIAL : TRACE_SOURCE_NETWORK;
+    appendTraceEvent(TRACE_EVENT_COMMAND, source, slot);
+}
+
+void recordTraceSensorEdges()
+{
+    if (traceRecorder.state == TRACE_STATE_IDLE) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < TRACE_SENSOR_COUNT; i++) {
+        if (TRACE_SENSORS[i]->stateChanged) {
+            observeTraceEvent(TRACE_EVENT_SENSOR, i, TRACE_SENSORS[i]->currentState ? 1 : 0);
+        }
+    }
+}
+
+//=============================================================================
+// REPLAY DRIVER
+//=============================================================================
+
+bool startTraceReplay(TraceReplayMode mode)
+{
+    if (traceRecorder.state != TRACE_STATE_IDLE) {
+        Console.serialError(F("Trace recorder busy - stop recording first"));
+        return false;
+    }
+
+    if (traceRecorder.eventCount == 0) {
+        Console.serialError(F("No trace loaded - record or load a trace first"));
+        return false;
+    }
+
+    if (isMotorMoving(1) || isMotorMoving(2) || isHomingInProgress(1) || isHomingInProgress(2)) {
+        Console.serialError(F("Rails must be idle before replaying a trace"));
+        return false;
+    }
+
+    traceRecorder.replayMode = mode;
+    traceRecorder.replayCursor = 0;
+    traceRecorder.expectedCursor = 0;
+    traceRecorder.replayWaitStart = 0;
+    traceRecorder.replayStats = {0};
+    traceRecorder.startTime = millis();
+    traceRecorder.state = TRACE_STATE_REPLAYING;
+
+    observeInitialState();
+    return true;
+}
+
+void stopTraceReplay()
+{
+    if (traceRecorder.state != TRACE_STATE_REPLAYING) {
+        return;
+    }
+    traceRecorder.state = TRACE_STATE_IDLE;
+    Console.serialInfo(F("Trace replay stopped"));
+}
+
+bool isTraceReplayActive()
+{
+    return traceRecorder.state == TRACE_STATE_REPLAYING;
+}
+
+//=============================================================================
+// SD CARD PERSISTENCE
+//=============================================================================
+
+bool saveTraceToSD()
+{
+    if (!isSDCardAvailable()) {
+        Console.serialError(F("SD card not available"));
+        return false;
+    }
+
+    if (traceRecorder.eventCount == 0) {
+        Console.serialError(F("No trace to save"));
+        return false;
+    }
+
+    if (SD.exists(TRACE_FILE_NAME)) {
+        SD.remove(TRACE_FILE_NAME);
+    }
+
+    File traceFile = SD.open(TRACE_FILE_NAME, FILE_WRITE);
+    if (!traceFile) {
+        Console.serialError(F("Failed to open trace file for writing"));
+        return false;
+    }
+
+    TraceFileHeader header;
+    header.magic = TRACE_FILE_MAGIC;
+    header.version = TRACE_FILE_VERSION;
+    header.eventCount = traceRecorder.eventCount;
+    header.commandCount = traceRecorder.commandCount;
+    header.commandLength = MAX_COMMAND_LENGTH;
+    header.durationMs = traceRecorder.durationMs;
+
+    traceFile.write((const uint8_t *)&header, sizeof(header));
+    traceFile.write((const uint8_t *)traceEvents, sizeof(TraceEvent) * traceRecorder.eventCount);
+    traceFile.write((const uint8_t *)traceCommands, MAX_COMMAND_LENGTH * traceRecorder.commandCount);
+    traceFile.flush();
+    traceFile.close();
+
+    return true;
+}
+
+bool loadTraceFromSD()
+{
+    if (traceRecorder.state != TRACE_STATE_IDLE) {
+        Console.serialError(F("Trace recorder busy"));
+        return false;
+    }
+
+    if (!isSDCardAvailable() || !SD.exists(TRACE_FILE_NAME)) {
+        Console.serialError(F("No trace file on SD card"));
+        return false;
+    }
+
+    File traceFile = SD.open(TRACE_FILE_NAME);
+    if (!traceFile) {
+        Console.serialError(F("Failed to open trace file"));
+        return false;
+    }
+
+    TraceFileHeader header;
+    bool valid = traceFile.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == TRACE_FILE_MAGIC &&
+                 header.version == TRACE_FILE_VERSION &&
+                 header.commandLength == MAX_COMMAND_LENGTH &&
+                 header.eventCount <= TRACE_MAX_EVENTS &&
+                 header.commandCount <= TRACE_MAX_COMMANDS;
+
+    if (valid) {
+        size_t eventBytes = sizeof(TraceEvent) * header.eventCount;
+        size_t commandBytes = MAX_COMMAND_LENGTH * header.commandCount;
+        valid = traceFile.read((uint8_t *)traceEvents, eventBytes) == (int)eventBytes &&
+                traceFile.read((uint8_t *)traceCommands, commandBytes) == (int)commandBytes;
+    }
+    traceFile.close();
+
+    // Every command event must name a loaded command slot
+    for (uint16_t i = 0; valid && i < header.eventCount; i++) {
+        if (traceEvents[i].type == TRACE_EVENT_COMMAND && traceEvents[i].value >= header.commandCount) {
+            valid = false;
+        }
+    }
+    for (uint16_t slot = 0; valid && slot < header.commandCount; slot++) {
+        traceCommands[slot][MAX_COMMAND_LENGTH - 1] = '\0';
+    }
+
+    if (!valid) {
+        clearTrace();
+        Console.serialError(F("Trace file invalid or from an incompatible build"));
+        return false;
+    }
+
+    traceRecorder.eventCount = header.eventCount;
+    traceRecorder.commandCount = header.commandCount;
+    traceRecorder.durationMs = header.durationMs;
+    traceRecorder.overflow = false;
+
+    char msg[MEDIUM_MSG_SIZE];
+    sprintf_P(msg, FMT_TRACE_LOADED, traceRecorder.eventCount, traceRecorder.commandCount, traceRecorder.durationMs);
+    Console.serialInfo(msg);
+    return true;
+}
+
+//=============================================================================
+// REPORTING
+//=============================================================================
+
+const char *getTraceSourceName(uint8_t source)
+{
+    switch (source) {
+        case TRACE_SOURCE_SERIAL:  return "SERIAL";
+        case TRACE_SOURCE_NETWORK: return "NETWORK";
+        case TRACE_SOURCE_REPLAY:  return "REPLAY";
+        default:                   return "UNKNOWN";
+    }
+}
+
+void printTraceStatus()
+{
+    char msg[MEDIUM_MSG_SIZE];
+    uint32_t duration = isTraceRecording() ? traceElapsed() : traceRecorder.durationMs;
+
+    Console.println(F("[INFO] Trace Recorder:"));
+    sprintf_P(msg, FMT_TRACE_STATUS, getTraceStateName(traceRecorder.state),
+              traceRecorder.eventCount, TRACE_MAX_EVENTS,
+              traceRecorder.commandCount, TRACE_MAX_COMMANDS,
+              duration, traceRecorder.overflow ? " (OVERFLOW)" : "");
+    Console.println(msg);
+
+    TraceReplayStats &stats = traceRecorder.replayStats;
+    if (isTraceReplayActive()) {
+        sprintf_P(msg, FMT_TRACE_REPLAY_PROGRESS,
+                  traceRecorder.replayMode == TRACE_REPLAY_SYNCED ? "synced" : "timed",
+                  traceRecorder.replayCursor, traceRecorder.eventCount, stats.commandsIssued);
+        Console.println(msg);
+    }
+
+    if (stats.commandsIssued > 0 || stats.eventsMatched > 0) {
+        uint32_t meanDrift = (stats.eventsMatched > 0) ? stats.totalDriftMs / stats.eventsMatched : 0;
+        sprintf_P(msg, FMT_TRACE_REPLAY_RESULT, stats.eventsMatched, stats.eventsMissing,
+                  stats.eventsUnexpected, stats.maxDriftMs, meanDrift);
+        Console.println(msg);
+    }
+}
+
+void printTraceEvents()
+{
+    char msg[LARGE_MSG_SIZE];
+
+    for (uint16_t i = 0; i < traceRecorder.eventCount; i++) {
+        const TraceEvent &event = traceEvents[i];
+        switch (event.type) {
+            case TRACE_EVENT_COMMAND:
+                sprintf_P(msg, FMT_TRACE_EVENT_COMMAND, event.timeMs, getTraceSourceName(event.id),
+                          event.value < traceRecorder.commandCount ? traceCommands[event.value] : "?");
+                break;
+            case TRACE_EVENT_SENSOR:
+                sprintf_P(msg, FMT_TRACE_EVENT_SENSOR, event.timeMs, getTraceSensorName(event.id),
+                          event.value ? "ON" : "OFF");
+                break;
+            case TRACE_EVENT_MOTOR:
+                sprintf_P(msg, FMT_TRACE_EVENT_MOTOR, event.timeMs, event.id, event.value,
+                          (event.value & TRACE_MOTOR_MOVING) ? " moving" : "",
+                          (event.value & TRACE_MOTOR_HLFB_ASSERTED) ? " hlfb" : "",
+                          (event.value & TRACE_MOTOR_ALERTS) ? " alerts" : "",
+                          (event.value & TRACE_MOTOR_HOMED) ? " homed" : "",
+                          (event.value & TRACE_MOTOR_HOMING) ? " homing" : "",
+                          (event.value & TRACE_MOTOR_ENABLED) ? " enabled" : "");
+                break;
+            default:
+                sprintf_P(msg, FMT_TRACE_EVENT_MARKER, event.timeMs, event.id);
+                break;
+        }
+        Console.println(msg);
+    }
+}
@@ -0,0 +1,160 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+//=============================================================================
+// INCLUDES
+//=============================================================================
+#include <Arduino.h>
+#include "ClearCore.h"
+#include "Utils.h"
+#include "CommandController.h"
+
+//=============================================================================
+// TRACE CONFIGURATION
+//=============================================================================
+// Recording buffers (preallocated - a full trace is ~12KB of RAM)
+#define TRACE_MAX_EVENTS 1024                  // Timestamped events per trace
+#define TRACE_MAX_COMMANDS 64                  // Distinct command strings per trace
+#define TRACE_FILE_NAME "TRACE.BIN"            // SD card file for saved traces
+#define TRACE_FILE_MAGIC 0x43525452UL          // "RTRC" little-endian
+#define TRACE_FILE_VERSION 1
+
+// Replay matching
+#define TRACE_REPLAY_MATCH_WINDOW 8            // Expected events scanned ahead when resyncing
+#define TRACE_REPLAY_SYNC_TIMEOUT_MS 10000     // Synced replay: max wait for expected events before a command
+#define TRACE_REPLAY_MAX_REPORTED 10           // Divergences printed individually per replay
+
+//=============================================================================
+// TRACE ENUMS AND STRUCTURES
+//=============================================================================
+
+// Event types
+enum TraceEventType
+{
+    TRACE_EVENT_COMMAND = 1,               // id = source, value = command slot
+    TRACE_EVENT_SENSOR = 2,                // id = sensor index, value = new state
+    TRACE_EVENT_MOTOR = 3,                 // id = rail, value = motor status bits
+    TRACE_EVENT_MARKER = 4                 // id = marker code (start/overflow)
+};
+
+// Command sources (mirrors lastCommandSource)
+enum TraceCommandSource
+{
+    TRACE_SOURCE_SERIAL = 0,
+    TRACE_SOURCE_NETWORK = 1,
+    TRACE_SOURCE_REPLAY = 2
+};
+
+// Motor status bits recorded in TRACE_EVENT_MOTOR values
+#define TRACE_MOTOR_MOVING 0x0001
+#define TRACE_MOTOR_HLFB_ASSERTED 0x0002
+#define TRACE_MOTOR_ALERTS 0x0004
+#define TRACE_MOTOR_HOMED 0x0008
+#define TRACE_MOTOR_HOMING 0x0010
+#define TRACE_MOTOR_ENABLED 0x0020
+
+// Replay pacing
+enum TraceReplayMode
+{
+    TRACE_REPLAY_TIMED,                    // Issue commands at their recorded time offsets
+    TRACE_REPLAY_SYNCED                    // Issue each command once the events before it have been observed
+};
+
+// Trace recorder state
+enum TraceRecorderState
+{
+    TRACE_STATE_IDLE,
+    TRACE_STATE_RECORDING,
+    TRACE_STATE_REPLAYING
+};
+
+// Single trace event (8 bytes, written to SD as-is)
+struct TraceEvent
+{
+    uint32_t timeMs;                       // Milliseconds since trace start
+    uint8_t type;                          // TraceEventType
+    uint8_t id;                            // Source, sensor index or rail
+    uint16_t value;                        // Command slot, sensor state or motor status bits
+};
+
+// SD card file header
+struct TraceFileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t eventCount;
+    uint16_t commandCount;
+    uint16_t commandLength;                // MAX_COMMAND_LENGTH at record time
+    uint32_t durationMs;
+};
+
+// Replay comparison results
+struct TraceReplayStats
+{
+    uint16_t commandsIssued;
+    uint16_t eventsMatched;                // Observed events that matched the recording
+    uint16_t eventsMissing;                // Recorded events that never occurred
+    uint16_t eventsUnexpected;             // Observed events not in the recording
+    uint32_t maxDriftMs;                   // Largest |observed - recorded| time of a matched event
+    uint32_t totalDriftMs;                 // For mean drift
+};
+
+// Recorder and replay state
+struct TraceRecorder
+{
+    TraceRecorderState state;
+    TraceReplayMode replayMode;
+    unsigned long startTime;               // millis() when recording/replay started
+    uint16_t eventCount;
+    uint16_t commandCount;
+    uint32_t durationMs;                   // Length of the recorded trace
+    bool overflow;                         // Recording stopped because a buffer filled
+    bool issuingReplayCommand;             // processCommand called by the replay driver
+    uint16_t lastMotorStatus[2];           // For change detection
+    uint16_t replayCursor;                 // Next event to issue during replay
+    uint16_t expectedCursor;               // Next non-command event expected during replay
+    unsigned long replayWaitStart;         // Synced replay: when we started waiting on a command
+    TraceReplayStats replayStats;
+};
+
+//=============================================================================
+// GLOBAL VARIABLES
+//=============================================================================
+
+extern TraceRecorder traceRecorder;
+extern TraceEvent traceEvents[TRACE_MAX_EVENTS];
+extern char traceCommands[TRACE_MAX_COMMANDS][MAX_COMMAND_LENGTH];
+
+//=============================================================================
+// FUNCTION DECLARATIONS
+//=============================================================================
+
+// Initialization and periodic update (call every loop)
+void initTraceRecorder();
+void updateTraceRecorder();
+
+// Recording control
+bool startTraceRecording();
+void stopTraceRecording();
+void clearTrace();
+bool isTraceRecording();
+
+// Recording hooks
+void recordTraceCommand(const char *command, Stream *output);
+void recordTraceSensorEdges();                 // Call after sensors are updated
+
+// Replay driver
+bool startTraceReplay(TraceReplayMode mode);
+void stopTraceReplay();
+bool isTraceReplayActive();
+
+// SD card persistence
+bool saveTraceToSD();
+bool loadTraceFromSD();
+
+// Reporting
+void printTraceStatus();
+void printTraceEvents();
+const char *getTraceSourceName(uint8_t source);
+
+#endif // TRACE_RECORDER_H
@@ -13,6 +13,9 @@
 #include "Logging.h"
 #include "HandoffController.h"
 #include "LabwareAutomation.h"
+#include "CollisionZoneManager.h"
+#include "MotionTelemetry.h"
+#include "TraceRecorder.h"
 
 // Specify which ClearCore serial COM port is connected to the CCIO-8 board
 #define CcioPort ConnectorCOM0
@@ -75,6 +78,9 @@ void setup()
 
     Console.serialInfo(F("Initializing automation system..."));
     initLabwareSystem();
+    initCollisionZoneManager();
+    initMotionTelemetry();
+    initTraceRecorder();
 
     // Command interface
     commander.attachTree(API_tree);
@@ -97,6 +103,9 @@ void loop()
     // Motor operations
     checkAllHomingProgress();
     checkMoveProgress();
+    updateCollisionZones();
+    updateMotionTelemetry();
+    updateTraceRecorder();
 
     // System monitoring
     if (ccioBoardCount > 0) {